@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""
+Run the benchmark firmware on several targets and tabulate the results per architecture.
+
+For each target the firmware is built in its own build directory (build_<target>) and run
+under the matching QEMU until it prints "BENCH done". The BENCH lines of all runs are then
+printed as Markdown tables, one row per case and one column per target: cycles per operation
+for the cases that report them, and nanoseconds per operation for every case.
+
+    . $IDF_PATH/export.sh
+    python bench_matrix.py                                  # esp32, esp32s3 and esp32c3
+    python bench_matrix.py --targets esp32s3,esp32c3 --suites mcp,codec
+    python bench_matrix.py --skip-build --csv results.csv
+
+QEMU's cycle counter and clock follow emulated time, not a model of the pipeline. To compare
+instruction counts between the Xtensa and RISC-V builds, run QEMU in instruction-counting mode,
+where every instruction takes 2^shift ns of virtual time:
+
+    python bench_matrix.py --qemu-args="-icount shift=0"
+
+Serial logs captured elsewhere, for example from boards with "idf.py monitor | tee s3.log",
+are tabulated the same way and need neither a build nor QEMU:
+
+    python bench_matrix.py --log esp32s3=s3.log --log esp32c3=c3.log
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import csv
+import os
+import queue
+import re
+import signal
+import subprocess
+import sys
+import threading
+import time
+
+DEFAULT_TARGETS = "esp32,esp32s3,esp32c3"
+BENCH_RE = re.compile(r"BENCH (\S+) (\S+) (.*)$")
+FIELD_RE = re.compile(r"(\w+)=(\S+)")
+DONE = "BENCH done"
+
+
+def number(text):
+    value = float(text)
+    return int(value) if value.is_integer() and "." not in text else value
+
+
+def parse_log(lines):
+    """Return {(suite, case): result} from BENCH lines; a result holds the numeric fields or failed=reason"""
+    results = {}
+    for line in lines:
+        line = line.rstrip("\r\n")
+        if DONE in line:
+            break
+        match = BENCH_RE.search(line)
+        if not match:
+            continue
+        suite, case, rest = match.groups()
+        if rest.startswith("FAILED"):
+            results[(suite, case)] = {"failed": rest[len("FAILED"):].strip() or "failed"}
+        else:
+            results[(suite, case)] = {key: number(value) for key, value in FIELD_RE.findall(rest)}
+    return results
+
+
+def build(target, build_dir):
+    print(f"== {target}: building in {build_dir}", file=sys.stderr)
+    subprocess.run(["idf.py", "-B", build_dir, f"-DIDF_TARGET={target}", "build"], check=True)
+
+
+def run_qemu(target, build_dir, qemu_args, timeout):
+    """Run the firmware under QEMU, return its output up to "BENCH done" (also saved to build_dir/bench.log)"""
+    print(f"== {target}: running in QEMU", file=sys.stderr)
+    cmd = ["idf.py", "-B", build_dir, "qemu"]
+    if qemu_args:
+        cmd += ["--qemu-extra-args", qemu_args]
+    # Own process group, so QEMU goes down with idf.py when the run is over
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, stdin=subprocess.DEVNULL,
+                            text=True, errors="replace", start_new_session=True)
+    lines = queue.Queue()
+
+    def reader():
+        for line in proc.stdout:
+            lines.put(line)
+        lines.put(None)
+
+    threading.Thread(target=reader, daemon=True).start()
+
+    output = []
+    finished = False
+    deadline = time.monotonic() + timeout
+    try:
+        while time.monotonic() < deadline:
+            try:
+                line = lines.get(timeout=1.0)
+            except queue.Empty:
+                continue
+            if line is None:
+                break
+            output.append(line)
+            if line.startswith("BENCH") or DONE in line:
+                sys.stderr.write(f"   {line}")
+            if DONE in line:
+                finished = True
+                break
+    finally:
+        if proc.poll() is None:
+            os.killpg(proc.pid, signal.SIGTERM)
+            try:
+                proc.wait(timeout=10)
+            except subprocess.TimeoutExpired:
+                os.killpg(proc.pid, signal.SIGKILL)
+
+    with open(os.path.join(build_dir, "bench.log"), "w") as f:
+        f.writelines(output)
+    if not finished:
+        print(f"== {target}: no '{DONE}' within {timeout} s, tabulating what ran", file=sys.stderr)
+    return output
+
+
+def format_cell(result, metric, baseline):
+    if result is None:
+        return ""
+    if "failed" in result:
+        return "FAILED"
+    value = result.get(metric)
+    if value is None:
+        return "-"
+    text = f"{value:.1f}"
+    if baseline and value and baseline is not result:
+        reference = baseline.get(metric)
+        if reference:
+            text += f" ({value / reference:.2f}x)"
+    return text
+
+
+def print_table(title, metric, cases, targets, results):
+    """Markdown table of one metric; columns after the first show the ratio to the first target"""
+    rows = [case for case in cases if any(metric in results[t].get(case, {}) for t in targets)]
+    if not rows:
+        return
+    print(f"\n### {title}\n")
+    print("| suite | case | " + " | ".join(targets) + " |")
+    print("|---|---|" + "---:|" * len(targets))
+    for case in rows:
+        baseline = results[targets[0]].get(case)
+        if baseline and "failed" in baseline:
+            baseline = None
+        cells = [format_cell(results[t].get(case), metric, baseline) for t in targets]
+        print(f"| {case[0]} | {case[1]} | " + " | ".join(cells) + " |")
+
+
+def write_csv(path, targets, cases, results):
+    with open(path, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["target", "suite", "case", "ops", "us", "ns_per_op", "mops", "cycles_per_op", "failed"])
+        for target in targets:
+            for case in cases:
+                result = results[target].get(case)
+                if result is None:
+                    continue
+                writer.writerow([target, case[0], case[1]] +
+                                [result.get(k, "") for k in ("ops", "us", "ns_per_op", "mops", "cycles_per_op")] +
+                                [result.get("failed", "")])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark matrix across ESP32 targets")
+    parser.add_argument("--targets", default=DEFAULT_TARGETS, help="Comma-separated IDF targets to build and run")
+    parser.add_argument("--suites", help="Comma-separated suites to tabulate (default: all)")
+    parser.add_argument("--skip-build", action="store_true", help="Run the existing build_<target> directories")
+    parser.add_argument("--qemu-args", default="", help="Extra QEMU arguments, e.g. \"-icount shift=0\"")
+    parser.add_argument("--timeout", type=int, default=900, help="Seconds to wait for one target's run")
+    parser.add_argument("--log", action="append", default=[], metavar="TARGET=FILE",
+                        help="Tabulate a captured serial log instead of running QEMU (repeatable)")
+    parser.add_argument("--csv", help="Also write every result to this CSV file")
+    args = parser.parse_args()
+
+    results = {}
+    if args.log:
+        for spec in args.log:
+            target, sep, path = spec.partition("=")
+            if not sep:
+                parser.error(f"--log expects TARGET=FILE, got '{spec}'")
+            with open(path, errors="replace") as f:
+                results[target] = parse_log(f)
+    else:
+        here = os.path.dirname(os.path.abspath(__file__))
+        for target in args.targets.split(","):
+            build_dir = os.path.join(here, f"build_{target}")
+            if not args.skip_build:
+                build(target, build_dir)
+            results[target] = parse_log(run_qemu(target, build_dir, args.qemu_args, args.timeout))
+
+    targets = list(results)
+    suites = set(args.suites.split(",")) if args.suites else None
+    cases = []
+    for target in targets:
+        for case in results[target]:
+            if case not in cases and (suites is None or case[0] in suites):
+                cases.append(case)
+    if not cases:
+        print("No BENCH results found", file=sys.stderr)
+        return 1
+
+    print_table("Cycles per operation", "cycles_per_op", cases, targets, results)
+    print_table("Nanoseconds per operation", "ns_per_op", cases, targets, results)
+    if args.csv:
+        write_csv(args.csv, targets, cases, results)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,71 @@
+#ifndef BENCHMARKS_BENCH_H
+#define BENCHMARKS_BENCH_H
+
+#include <stdint.h>
+
+/**
+ * @brief Print one result line
+ *
+ * Format: "BENCH <suite> <name> ops=<n> us=<elapsed> ns_per_op=<x> mops=<y>", one line per
+ * case so results can be collected from the serial log with grep.
+ *
+ * @param suite Suite name, e.g. "queue"
+ * @param name Case name
+ * @param ops Operations performed
+ * @param elapsed_us Wall time of the case
+ */
+void bench_report(const char* suite, const char* name, uint32_t ops, int64_t elapsed_us);
+
+/**
+ * @brief Print a failed case (wrong result), so a fast but broken case is never read as a win
+ */
+void bench_report_failure(const char* suite, const char* name, const char* reason);
+
+/**
+ * @brief Start of a case timed on one task: wall time and the current core's cycle counter
+ */
+typedef struct {
+  int64_t start_us;       ///< esp_timer_get_time() at the start
+  uint32_t start_cycles;  ///< esp_cpu_get_cycle_count() at the start
+} bench_timer_t;
+
+/**
+ * @brief Start timing a case that runs entirely on the calling task
+ */
+bench_timer_t bench_timer_start(void);
+
+/**
+ * @brief Print one result line for a case started with bench_timer_start()
+ *
+ * Same as bench_report(), with " cycles_per_op=<c>" appended. The cycle counter is per core and
+ * 32 bits wide, so the case must not migrate between cores and must finish within one wraparound
+ * (about 17 s at 240 MHz). Cycles include interrupts taken while the case ran.
+ */
+void bench_report_timer(const char* suite, const char* name, uint32_t ops, bench_timer_t timer);
+
+/**
+ * @brief lockfree_queue SPSC/MPSC rings against xQueue and xRingbuffer
+ */
+void bench_queue_run(void);
+
+/**
+ * @brief executor jobs and fork-join against one task per job and sequential code
+ */
+void bench_executor_run(void);
+
+/**
+ * @brief mcp_server request parsing, dispatch and response writing over an in-process transport
+ */
+void bench_mcp_run(void);
+
+/**
+ * @brief json_kernels string escaping and UTF-8 validation against the cJSON path
+ */
+void bench_json_run(void);
+
+/**
+ * @brief CRC32 and base64 kernels used for binary payloads
+ */
+void bench_codec_run(void);
+
+#endif  // BENCHMARKS_BENCH_H
@@ -0,0 +1,269 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "base64_codec.h"
+#include "bench.h"
+#include "checksum.h"
+#include "esp_rom_crc.h"
+#include "mbedtls/base64.h"
+
+#define BLOCK_SIZE 1023  // A multiple of 3, so base64 has no padding
+#define ENCODED_SIZE (BLOCK_SIZE / 3 * 4)
+#define BLOCKS 200
+#define PART_SIZE 256  // Streaming cases feed the block in parts of this size
+
+static uint8_t s_block[BLOCK_SIZE];
+static unsigned char s_encoded[ENCODED_SIZE + 1];
+static uint8_t s_decoded[BLOCK_SIZE];
+static char s_text[ENCODED_SIZE];
+static char s_chunk[512];
+static uint32_t s_crc_table[256];
+
+static void fill_block(void) {
+  uint32_t x = 0x12345678;
+  for (size_t i = 0; i < BLOCK_SIZE; i++) {
+    // xorshift32: bytes without patterns a kernel could shortcut
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_block[i] = (uint8_t)x;
+  }
+}
+
+static void crc32_table_init(void) {
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    s_crc_table[i] = crc;
+  }
+}
+
+/**
+ * @brief Byte-at-a-time table CRC32, the usual portable software fallback
+ *
+ * Same convention as esp_rom_crc32_le(), so the two must agree.
+ */
+static uint32_t crc32_table(uint32_t crc, const uint8_t* data, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc = (crc >> 8) ^ s_crc_table[(crc ^ data[i]) & 0xFF];
+  }
+  return ~crc;
+}
+
+static void run_crc32(void) {
+  // The standard CRC-32 check value, so a broken table fails instead of agreeing with itself
+  if (crc32_table(0, (const uint8_t*)"123456789", 9) != 0xCBF43926) {
+    bench_report_failure("codec", "crc32_table", "wrong check value");
+    return;
+  }
+  uint32_t expected = crc32_table(0, s_block, BLOCK_SIZE);
+
+  uint32_t crc = 0;
+  bench_timer_t timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    crc = esp_rom_crc32_le(0, s_block, BLOCK_SIZE);
+  }
+  if (crc != expected) {
+    bench_report_failure("codec", "crc32_rom", "checksum mismatch");
+  }
+  else {
+    bench_report_timer("codec", "crc32_rom", BLOCKS * BLOCK_SIZE, timer);
+  }
+
+  timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    crc = crc32_table(0, s_block, BLOCK_SIZE);
+  }
+  if (crc != expected) {
+    bench_report_failure("codec", "crc32_table", "checksum mismatch");
+  }
+  else {
+    bench_report_timer("codec", "crc32_table", BLOCKS * BLOCK_SIZE, timer);
+  }
+
+  // The slicing loop aligns itself first, so check it from every offset
+  bool same = true;
+  for (size_t offset = 0; offset < 4; offset++) {
+    same &= checksum_crc32_sw(0, s_block + offset, BLOCK_SIZE - offset) ==
+            crc32_table(0, s_block + offset, BLOCK_SIZE - offset);
+  }
+  timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    crc = checksum_crc32_sw(0, s_block, BLOCK_SIZE);
+  }
+  if (!same || crc != expected) {
+    bench_report_failure("codec", "crc32_slice4", "checksum mismatch");
+  }
+  else {
+    bench_report_timer("codec", "crc32_slice4", BLOCKS * BLOCK_SIZE, timer);
+  }
+}
+
+/**
+ * @brief Feed the block to a checksum in PART_SIZE parts, as an upload handler would
+ */
+static esp_err_t checksum_stream(checksum_type_t type, uint8_t* digest) {
+  checksum_t ctx;
+  esp_err_t ret = checksum_init(&ctx, type);
+  for (size_t offset = 0; ret == ESP_OK && offset < BLOCK_SIZE; offset += PART_SIZE) {
+    size_t n = BLOCK_SIZE - offset < PART_SIZE ? BLOCK_SIZE - offset : PART_SIZE;
+    ret = checksum_update(&ctx, s_block + offset, n);
+  }
+  if (ret != ESP_OK) {
+    checksum_free(&ctx);
+    return ret;
+  }
+  return checksum_final(&ctx, digest);
+}
+
+/**
+ * @brief The checksum API per algorithm, named after the backend it runs on
+ */
+static void run_checksum(checksum_type_t type) {
+  // FIPS 180-2's "abc" example and the CRC-32 check value
+  static const uint8_t SHA256_ABC[32] = {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40,
+                                         0xde, 0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17,
+                                         0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+  static const uint8_t CRC32_CHECK[4] = {0xCB, 0xF4, 0x39, 0x26};
+  const char* input = type == CHECKSUM_SHA256 ? "abc" : "123456789";
+  const uint8_t* known = type == CHECKSUM_SHA256 ? SHA256_ABC : CRC32_CHECK;
+
+  size_t len = checksum_digest_len(type);
+  char name[32];
+  snprintf(name, sizeof(name), "checksum_%s_%s", checksum_name(type), checksum_backend(type));
+  uint8_t digest[CHECKSUM_MAX_DIGEST_LEN];
+  uint8_t streamed[CHECKSUM_MAX_DIGEST_LEN];
+  if (checksum_compute(type, input, strlen(input), digest) != ESP_OK || memcmp(digest, known, len) != 0) {
+    bench_report_failure("codec", name, "wrong test vector digest");
+    return;
+  }
+
+  esp_err_t ret = ESP_OK;
+  bench_timer_t timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS && ret == ESP_OK; i++) {
+    ret = checksum_compute(type, s_block, BLOCK_SIZE, digest);
+  }
+  if (ret != ESP_OK) {
+    bench_report_failure("codec", name, esp_err_to_name(ret));
+    return;
+  }
+  bench_report_timer("codec", name, BLOCKS * BLOCK_SIZE, timer);
+
+  snprintf(name, sizeof(name), "checksum_%s_%s_stream", checksum_name(type), checksum_backend(type));
+  timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS && ret == ESP_OK; i++) {
+    ret = checksum_stream(type, streamed);
+  }
+  if (ret != ESP_OK || memcmp(streamed, digest, len) != 0) {
+    bench_report_failure("codec", name, "streamed digest differs");
+    return;
+  }
+  bench_report_timer("codec", name, BLOCKS * BLOCK_SIZE, timer);
+}
+
+static void run_base64_mbedtls(void) {
+  size_t written = 0;
+  bench_timer_t timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    if (mbedtls_base64_encode(s_encoded, sizeof(s_encoded), &written, s_block, BLOCK_SIZE) != 0) {
+      bench_report_failure("codec", "base64_encode_mbedtls", "encode failed");
+      return;
+    }
+  }
+  bench_report_timer("codec", "base64_encode_mbedtls", BLOCKS * BLOCK_SIZE, timer);
+
+  timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    if (mbedtls_base64_decode(s_decoded, sizeof(s_decoded), &written, s_encoded, ENCODED_SIZE) != 0) {
+      bench_report_failure("codec", "base64_decode_mbedtls", "decode failed");
+      return;
+    }
+  }
+  if (written != BLOCK_SIZE || memcmp(s_decoded, s_block, BLOCK_SIZE) != 0) {
+    bench_report_failure("codec", "base64_decode_mbedtls", "round trip mismatch");
+    return;
+  }
+  bench_report_timer("codec", "base64_decode_mbedtls", BLOCKS * BLOCK_SIZE, timer);
+}
+
+static esp_err_t count_chunk(void* ctx, const char* data, size_t len) {
+  *(size_t*)ctx += len;
+  return ESP_OK;
+}
+
+/**
+ * @brief base64_codec on the same block; s_encoded must hold mbedTLS's encoding of it
+ */
+static void run_base64_codec(void) {
+  size_t written = 0;
+  bench_timer_t timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    written = base64_encode(s_text, s_block, BLOCK_SIZE);
+  }
+  if (written != ENCODED_SIZE || memcmp(s_text, s_encoded, ENCODED_SIZE) != 0) {
+    bench_report_failure("codec", "base64_encode_codec", "output differs from mbedTLS");
+  }
+  else {
+    bench_report_timer("codec", "base64_encode_codec", BLOCKS * BLOCK_SIZE, timer);
+  }
+
+  memset(s_decoded, 0, sizeof(s_decoded));
+  bool ok = true;
+  timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    ok &= base64_decode(s_decoded, sizeof(s_decoded), (const char*)s_encoded, ENCODED_SIZE, &written) == ESP_OK;
+  }
+  if (!ok || written != BLOCK_SIZE || memcmp(s_decoded, s_block, BLOCK_SIZE) != 0) {
+    bench_report_failure("codec", "base64_decode_codec", "round trip mismatch");
+  }
+  else {
+    bench_report_timer("codec", "base64_decode_codec", BLOCKS * BLOCK_SIZE, timer);
+  }
+
+  // Includes copying the text back in each round, as a received body would arrive
+  timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    memcpy(s_text, s_encoded, ENCODED_SIZE);
+    ok &= base64_decode_in_place(s_text, ENCODED_SIZE, &written) == ESP_OK;
+  }
+  if (!ok || written != BLOCK_SIZE || memcmp(s_text, s_block, BLOCK_SIZE) != 0) {
+    bench_report_failure("codec", "base64_decode_in_place", "round trip mismatch");
+  }
+  else {
+    bench_report_timer("codec", "base64_decode_in_place", BLOCKS * BLOCK_SIZE, timer);
+  }
+
+  // 256-byte writes into 512-character chunks, the shape of a streamed HTTP response
+  size_t total = 0;
+  timer = bench_timer_start();
+  for (int i = 0; i < BLOCKS; i++) {
+    base64_writer_t writer;
+    base64_writer_init(&writer, s_chunk, sizeof(s_chunk), count_chunk, &total);
+    for (size_t offset = 0; offset < BLOCK_SIZE; offset += 256) {
+      size_t n = BLOCK_SIZE - offset < 256 ? BLOCK_SIZE - offset : 256;
+      ok &= base64_writer_write(&writer, s_block + offset, n) == ESP_OK;
+    }
+    ok &= base64_writer_finish(&writer) == ESP_OK;
+  }
+  if (!ok || total != (size_t)BLOCKS * ENCODED_SIZE) {
+    bench_report_failure("codec", "base64_writer", "wrong output length");
+  }
+  else {
+    bench_report_timer("codec", "base64_writer", BLOCKS * BLOCK_SIZE, timer);
+  }
+}
+
+void bench_codec_run(void) {
+  fill_block();
+  crc32_table_init();
+
+  run_crc32();
+  run_checksum(CHECKSUM_CRC32);
+  run_checksum(CHECKSUM_SHA256);
+  run_base64_mbedtls();
+  run_base64_codec();
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+
+#include "bench.h"
+#include "esp_timer.h"
+#include "executor.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#define LEAF_JOBS 20000
+#define TASK_JOBS 1000
+#define TASK_STACK 2048
+#define TASK_PRIORITY 5
+#define FIB_N 24
+#define FIB_CUTOFF 12
+
+static uint32_t s_done_count;
+static uint32_t s_target;
+static SemaphoreHandle_t s_all_done;
+
+static void leaf_job(void* arg) {
+  if (__atomic_add_fetch(&s_done_count, 1, __ATOMIC_RELAXED) == s_target) {
+    xSemaphoreGive(s_all_done);
+  }
+}
+
+static void leaf_task(void* arg) {
+  leaf_job(arg);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Submit LEAF_JOBS empty jobs from this task and wait until all have run
+ */
+static void run_leaf_jobs(void) {
+  s_done_count = 0;
+  s_target = LEAF_JOBS;
+
+  int64_t start_us = esp_timer_get_time();
+  for (uint32_t i = 0; i < LEAF_JOBS; i++) {
+    // The inboxes are small; wait for the workers when they fill up
+    while (executor_submit(leaf_job, NULL) == ESP_ERR_NO_MEM) {
+      taskYIELD();
+    }
+  }
+  xSemaphoreTake(s_all_done, portMAX_DELAY);
+  bench_report("executor", "submit_run_leaf", LEAF_JOBS, esp_timer_get_time() - start_us);
+}
+
+/**
+ * @brief The same work as run_leaf_jobs() with one task created per job, for comparison
+ */
+static void run_task_per_job(void) {
+  s_done_count = 0;
+  s_target = TASK_JOBS;
+
+  int64_t start_us = esp_timer_get_time();
+  for (uint32_t i = 0; i < TASK_JOBS; i++) {
+    while (xTaskCreate(leaf_task, "leaf", TASK_STACK, NULL, TASK_PRIORITY, NULL) != pdPASS) {
+      // Out of heap until the idle task frees deleted tasks
+      vTaskDelay(1);
+    }
+  }
+  xSemaphoreTake(s_all_done, portMAX_DELAY);
+  bench_report("executor", "task_per_job_leaf", TASK_JOBS, esp_timer_get_time() - start_us);
+}
+
+static uint32_t fib_sequential(uint32_t n) { return n < 2 ? n : fib_sequential(n - 1) + fib_sequential(n - 2); }
+
+typedef struct {
+  uint32_t n;
+  uint32_t result;
+} fib_arg_t;
+
+/**
+ * @brief Fork-join Fibonacci: one half as a job, the other inline, sequential below the cutoff
+ */
+static void fib_job(void* arg) {
+  fib_arg_t* fib = (fib_arg_t*)arg;
+  __atomic_add_fetch(&s_done_count, 1, __ATOMIC_RELAXED);
+  if (fib->n < FIB_CUTOFF) {
+    fib->result = fib_sequential(fib->n);
+    return;
+  }
+
+  fib_arg_t left = {fib->n - 1, 0};
+  fib_arg_t right = {fib->n - 2, 0};
+  executor_future_t future;
+  if (executor_submit_future(fib_job, &left, &future) == ESP_OK) {
+    fib_job(&right);
+    executor_future_wait(&future, portMAX_DELAY);
+  }
+  else {
+    fib_job(&left);
+    fib_job(&right);
+  }
+  fib->result = left.result + right.result;
+}
+
+static void run_fork_join(void) {
+  fib_arg_t root = {FIB_N, 0};
+  executor_future_t future;
+  s_done_count = 0;
+
+  int64_t start_us = esp_timer_get_time();
+  if (executor_submit_future(fib_job, &root, &future) != ESP_OK) {
+    bench_report_failure("executor", "fork_join_fib", "submit failed");
+    return;
+  }
+  executor_future_wait(&future, portMAX_DELAY);
+  int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+  if (root.result != fib_sequential(FIB_N)) {
+    bench_report_failure("executor", "fork_join_fib", "wrong result");
+    return;
+  }
+  bench_report("executor", "fork_join_fib", s_done_count, elapsed_us);
+
+  start_us = esp_timer_get_time();
+  volatile uint32_t result = fib_sequential(FIB_N);
+  (void)result;
+  bench_report("executor", "sequential_fib", s_done_count, esp_timer_get_time() - start_us);
+}
+
+void bench_executor_run(void) {
+  s_all_done = xSemaphoreCreateBinary();
+  if (!s_all_done || executor_start() != ESP_OK) {
+    bench_report_failure("executor", "setup", "executor_start failed");
+    return;
+  }
+
+  run_leaf_jobs();
+  run_task_per_job();
+  run_fork_join();
+
+  for (int i = 0; i < executor_worker_count(); i++) {
+    executor_worker_stats_t stats;
+    executor_get_stats(i, &stats);
+    printf("executor worker %d: run=%lu stolen=%lu received=%lu local=%lu sleeps=%lu busy_us=%llu\n", i,
+           (unsigned long)stats.jobs_run, (unsigned long)stats.jobs_stolen, (unsigned long)stats.jobs_received,
+           (unsigned long)stats.local_submits, (unsigned long)stats.sleeps, (unsigned long long)stats.busy_us);
+  }
+
+  executor_stop();
+  vSemaphoreDelete(s_all_done);
+}
@@ -0,0 +1,128 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "bench.h"
+#include "cJSON.h"
+#include "json_kernels.h"
+#include "mcp_protocol.h"
+#include "mcp_tool.h"
+
+#define TEXT_SIZE 1024
+#define ROUNDS 100
+
+// Same texts as the host_build benchmarks: tool output with a few quotes and line breaks, and
+// text with multi-byte UTF-8 in most words
+static std::string make_text(const char* pattern) {
+  std::string s;
+  while (s.size() < TEXT_SIZE) {
+    s += pattern;
+  }
+  return s;
+}
+
+/**
+ * @brief Whether json_escape() prints s exactly as cJSON does
+ */
+static bool escape_matches_cjson(const std::string& s) {
+  cJSON* item = cJSON_CreateString(s.c_str());
+  char* expected = item ? cJSON_PrintUnformatted(item) : NULL;
+  cJSON_Delete(item);
+  if (!expected) {
+    return false;
+  }
+  size_t len = json_escaped_len(s.data(), s.size());
+  char* actual = (char*)malloc(len + 1);
+  bool same = actual && json_escape(actual, s.data(), s.size()) == len && strlen(expected) == len + 2 &&
+              memcmp(expected + 1, actual, len) == 0;
+  free(actual);
+  free(expected);
+  return same;
+}
+
+static void run_escape(const char* variant, const std::string& text) {
+  std::string name = std::string("escape_cjson_") + variant;
+  cJSON* item = cJSON_CreateString(text.c_str());
+  bench_timer_t timer = bench_timer_start();
+  for (int i = 0; i < ROUNDS; i++) {
+    free(cJSON_PrintUnformatted(item));
+  }
+  bench_report_timer("json", name.c_str(), ROUNDS * text.size(), timer);
+  cJSON_Delete(item);
+
+  name = std::string("escape_kernel_") + variant;
+  if (!escape_matches_cjson(text)) {
+    bench_report_failure("json", name.c_str(), "output differs from cJSON");
+    return;
+  }
+  timer = bench_timer_start();
+  for (int i = 0; i < ROUNDS; i++) {
+    char* out = (char*)malloc(json_escaped_len(text.data(), text.size()));
+    json_escape(out, text.data(), text.size());
+    free(out);
+  }
+  bench_report_timer("json", name.c_str(), ROUNDS * text.size(), timer);
+}
+
+static void run_utf8(const char* variant, const std::string& text) {
+  std::string name = std::string("utf8_valid_") + variant;
+  bool valid = true;
+  bench_timer_t timer = bench_timer_start();
+  for (int i = 0; i < ROUNDS; i++) {
+    valid &= json_utf8_valid(text.data(), text.size());
+  }
+  // The same text ending in half a character must fail
+  std::string cut = text + "\xE2\x9C";
+  if (!valid || json_utf8_valid(cut.data(), cut.size())) {
+    bench_report_failure("json", name.c_str(), "wrong verdict");
+    return;
+  }
+  bench_report_timer("json", name.c_str(), ROUNDS * text.size(), timer);
+}
+
+/**
+ * @brief A tools/call response for a text result, through cJSON and written directly
+ */
+static void run_text_response(const std::string& text) {
+  bench_timer_t timer = bench_timer_start();
+  for (int i = 0; i < ROUNDS; i++) {
+    mcp_tool_result_t result = mcp_tool_result_success(text.c_str());
+    free(mcp_protocol_create_response(7, mcp_tool_result_to_json(&result)));
+    mcp_tool_result_free(&result);
+  }
+  bench_report_timer("json", "text_response_cjson", ROUNDS * text.size(), timer);
+
+  mcp_tool_result_t result = mcp_tool_result_success(text.c_str());
+  char* expected = mcp_protocol_create_response(7, mcp_tool_result_to_json(&result));
+  char* actual = mcp_protocol_create_text_response(7, text.c_str());
+  bool same = expected && actual && strcmp(expected, actual) == 0;
+  mcp_tool_result_free(&result);
+  free(expected);
+  free(actual);
+  if (!same) {
+    bench_report_failure("json", "text_response_direct", "output differs from cJSON");
+    return;
+  }
+
+  timer = bench_timer_start();
+  for (int i = 0; i < ROUNDS; i++) {
+    mcp_tool_result_t result = mcp_tool_result_success(text.c_str());
+    free(mcp_protocol_create_text_response(7, result.content));
+    mcp_tool_result_free(&result);
+  }
+  bench_report_timer("json", "text_response_direct", ROUNDS * text.size(), timer);
+}
+
+void bench_json_run(void) {
+  std::string prose = make_text(
+      "Reads the \"living_room\" sensor and averages the last samples.\n"
+      "Temperature 21.5 C, humidity 48 %, pressure 1013 hPa; battery at 87 %.\t");
+  std::string utf8 = make_text("Température 21,5 °C, humidité 48 %, Luftdruck 1013 hPa, 温度 21.5 度, ✓ ");
+
+  run_escape("prose", prose);
+  run_escape("utf8", utf8);
+  run_utf8("ascii", prose);
+  run_utf8("utf8", utf8);
+  run_text_response(prose);
+}
@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "bench.h"
+#include "mcp_protocol.h"
+#include "mcp_schema.h"
+#include "mcp_server_cpp.h"
+#include "mcp_tool.h"
+
+#define PARSE_OPS 2000
+#define WRITE_OPS 2000
+#define DISPATCH_OPS 1000
+#define LIST_OPS 200
+
+static const char CALL_REQUEST[] =
+    "{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"tools/call\",\"params\":{\"name\":\"set_thermostat\","
+    "\"arguments\":{\"temperature\":72.5,\"mode\":\"heat\",\"hold_minutes\":30,\"persist\":true}}}";
+static const char HELLO_REQUEST[] =
+    "{\"jsonrpc\":\"2.0\",\"id\":8,\"method\":\"tools/call\",\"params\":{\"name\":\"hello_world\",\"arguments\":{}}}";
+static const char LIST_REQUEST[] = "{\"jsonrpc\":\"2.0\",\"id\":9,\"method\":\"tools/list\"}";
+
+static const char* const MODES[] = {"heat", "cool", "off"};
+
+// Same tools as the host_build benchmarks, so host and target numbers describe the same work
+static const mcp_param_schema_t THERMOSTAT_PARAMS[] = {
+    MCP_PARAM_NUMBER_REQUIRED("temperature", "Target temperature in Fahrenheit", 40.0, 90.0),
+    {
+        .name = "mode",
+        .type = MCP_TYPE_STRING,
+        .description = "Operating mode",
+        .required = false,
+        .enum_values = const_cast<const char**>(MODES),
+        .enum_count = sizeof(MODES) / sizeof(MODES[0]),
+    },
+    MCP_PARAM_INTEGER("hold_minutes", "Minutes to hold the setpoint before resuming the schedule", 0, 1440),
+    MCP_PARAM_BOOLEAN("persist", "Store the setpoint in NVS"),
+};
+
+static const mcp_param_schema_t SENSOR_PARAMS[] = {
+    MCP_PARAM_STRING_REQUIRED("sensor", "Sensor name"),
+    MCP_PARAM_INTEGER("samples", "Samples to average", 1, 64),
+};
+
+static const char* const SENSOR_TOOLS[] = {"get_temperature", "get_humidity", "get_pressure",
+                                           "get_light",       "get_co2",      "get_voltage"};
+
+// Last response the server sent; assign() keeps the capacity, so steady state does not allocate
+static std::string s_response;
+
+static esp_err_t loopback_init(mcp_transport_t* transport, uint16_t port) { return ESP_OK; }
+
+static esp_err_t loopback_start(mcp_transport_t* transport) { return ESP_OK; }
+
+static esp_err_t loopback_stop(mcp_transport_t* transport) { return ESP_OK; }
+
+static esp_err_t loopback_send_response(mcp_transport_t* transport, const char* response) {
+  s_response.assign(response);
+  return ESP_OK;
+}
+
+static void loopback_destroy(mcp_transport_t* transport) { free(transport); }
+
+/**
+ * @brief In-process transport: a request is handed straight to the server on the calling task
+ *
+ * Leaves the network stack out, so the dispatch cases time only mcp_server's own work and
+ * compare across targets whether or not they have Wi-Fi.
+ */
+static const mcp_transport_vtable_t LOOPBACK_VTABLE = {
+    .init = loopback_init,
+    .start = loopback_start,
+    .stop = loopback_stop,
+    .send_response = loopback_send_response,
+    .destroy = loopback_destroy,
+};
+
+static mcp_transport_t* loopback_create(void) {
+  mcp_transport_t* transport = (mcp_transport_t*)calloc(1, sizeof(mcp_transport_t));
+  if (transport) {
+    transport->vtable = &LOOPBACK_VTABLE;
+  }
+  return transport;
+}
+
+/**
+ * @brief Run the same request ops times through the server and check the last response
+ */
+static void run_request(mcp_transport_t* transport, const char* name, const char* request, uint32_t ops,
+                        const char* expected) {
+  s_response.clear();
+  bench_timer_t timer = bench_timer_start();
+  for (uint32_t i = 0; i < ops; i++) {
+    mcp_transport_invoke_handler(transport, request);
+  }
+  if (s_response.find(expected) == std::string::npos) {
+    bench_report_failure("mcp", name, "unexpected response");
+    return;
+  }
+  bench_report_timer("mcp", name, ops, timer);
+}
+
+/**
+ * @brief JSON-RPC envelope parsing alone
+ */
+static void run_parse(void) {
+  bench_timer_t timer = bench_timer_start();
+  for (uint32_t i = 0; i < PARSE_OPS; i++) {
+    mcp_request_t request;
+    if (mcp_protocol_parse_request(CALL_REQUEST, &request) != ESP_OK || request.id != 7) {
+      bench_report_failure("mcp", "parse_request", "parse failed");
+      return;
+    }
+    mcp_protocol_free_request(&request);
+  }
+  bench_report_timer("mcp", "parse_request", PARSE_OPS, timer);
+}
+
+/**
+ * @brief The JSON writer: a tool result to response text, and a tool's inputSchema to text
+ */
+static void run_write(void) {
+  bench_timer_t timer = bench_timer_start();
+  for (uint32_t i = 0; i < WRITE_OPS; i++) {
+    mcp_tool_result_t result = mcp_tool_result_success("{\"temperature\": 72.5, \"unit\": \"F\", \"age_ms\": 120}");
+    char* response = mcp_protocol_create_response(7, mcp_tool_result_to_json(&result));
+    mcp_tool_result_free(&result);
+    if (!response) {
+      bench_report_failure("mcp", "write_response", "out of memory");
+      return;
+    }
+    free(response);
+  }
+  bench_report_timer("mcp", "write_response", WRITE_OPS, timer);
+
+  timer = bench_timer_start();
+  for (uint32_t i = 0; i < WRITE_OPS; i++) {
+    cJSON* schema = mcp_schema_to_json(THERMOSTAT_PARAMS, sizeof(THERMOSTAT_PARAMS) / sizeof(THERMOSTAT_PARAMS[0]));
+    char* text = schema ? cJSON_PrintUnformatted(schema) : NULL;
+    cJSON_Delete(schema);
+    if (!text) {
+      bench_report_failure("mcp", "write_schema", "out of memory");
+      return;
+    }
+    cJSON_free(text);
+  }
+  bench_report_timer("mcp", "write_schema", WRITE_OPS, timer);
+}
+
+void bench_mcp_run(void) {
+  run_parse();
+  run_write();
+
+  // The server owns the transport from here on; keep a pointer to drive it
+  mcp_transport_t* transport = loopback_create();
+  McpServer server(transport);
+  if (!server.valid()) {
+    bench_report_failure("mcp", "setup", "out of memory");
+    return;
+  }
+  ESP_ERROR_CHECK(server.add_tool("hello_world", "Returns a friendly greeting",
+                                  [] { return McpToolResult::success("Hello from the benchmark!"); }));
+  ESP_ERROR_CHECK(server.add_tool("set_thermostat", "Sets the thermostat target", THERMOSTAT_PARAMS,
+                                  [](const McpToolArgs& args) {
+                                    std::string_view mode = args.get_string("mode", "heat");
+                                    return McpToolResult::format("{\"setpoint\": %.1f, \"mode\": \"%.*s\"}",
+                                                                 args.get_double("temperature"), (int)mode.size(),
+                                                                 mode.data());
+                                  }));
+  for (const char* name : SENSOR_TOOLS) {
+    ESP_ERROR_CHECK(server.add_tool(name, "Reads one sensor, averaged over a number of samples", SENSOR_PARAMS,
+                                    [] { return McpToolResult::success("{\"value\": 21.5}"); }));
+  }
+  ESP_ERROR_CHECK(server.start(0));
+
+  run_request(transport, "dispatch_hello", HELLO_REQUEST, DISPATCH_OPS, "Hello from the benchmark!");
+  run_request(transport, "dispatch_tool_call", CALL_REQUEST, DISPATCH_OPS, "setpoint");
+  run_request(transport, "list_tools", LIST_REQUEST, LIST_OPS, "get_voltage");
+
+  server.stop();
+}
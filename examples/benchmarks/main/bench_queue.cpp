@@ -0,0 +1,242 @@
+#include <stdio.h>
+
+#include "bench.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lockfree_queue.h"
+#include "sdkconfig.h"
+
+#define ITEMS 100000
+#define DEPTH 256
+#define TASK_STACK 3072
+#define TASK_PRIORITY 5
+#define CONSUMER_CORE (CONFIG_FREERTOS_NUMBER_OF_CORES - 1)
+
+// Each element is a uint32_t; the consumer sums what it receives so a lost or duplicated
+// element fails the case
+typedef void (*bench_fn_t)(uint32_t count);
+
+typedef struct {
+  bench_fn_t fn;
+  uint32_t count;
+  SemaphoreHandle_t done;
+} bench_task_arg_t;
+
+static SpscQueue<uint32_t, DEPTH> s_spsc;
+static MpscQueue<uint32_t, DEPTH> s_mpsc;
+static QueueHandle_t s_queue;
+static RingbufHandle_t s_ring;
+static uint64_t s_sum;
+
+/**
+ * @brief Wait for the other side of a lock-free ring
+ *
+ * Yielding lets a producer that shares the consumer's core (or a single-core chip) run at
+ * once instead of at the next time slice; with nothing else ready it returns immediately.
+ */
+static inline void backoff(void) { taskYIELD(); }
+
+static void spsc_produce(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    while (!s_spsc.try_push(i)) {
+      backoff();
+    }
+  }
+}
+
+static void spsc_consume(uint32_t count) {
+  uint32_t value;
+  for (uint32_t i = 0; i < count; i++) {
+    while (!s_spsc.try_pop(value)) {
+      backoff();
+    }
+    s_sum += value;
+  }
+}
+
+static void spsc_produce_batch(uint32_t count) {
+  uint32_t sent = 0;
+  while (sent < count) {
+    uint32_t space;
+    uint32_t* slots = s_spsc.reserve(&space);
+    if (space == 0) {
+      backoff();
+      continue;
+    }
+    uint32_t n = space < count - sent ? space : count - sent;
+    for (uint32_t k = 0; k < n; k++) {
+      slots[k] = sent + k;
+    }
+    s_spsc.commit(n);
+    sent += n;
+  }
+}
+
+static void spsc_consume_batch(uint32_t count) {
+  uint32_t received = 0;
+  while (received < count) {
+    uint32_t available;
+    const uint32_t* items = s_spsc.peek(&available);
+    if (available == 0) {
+      backoff();
+      continue;
+    }
+    for (uint32_t k = 0; k < available; k++) {
+      s_sum += items[k];
+    }
+    s_spsc.release(available);
+    received += available;
+  }
+}
+
+static void mpsc_produce(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    while (!s_mpsc.try_push(i)) {
+      backoff();
+    }
+  }
+}
+
+static void mpsc_consume(uint32_t count) {
+  uint32_t value;
+  for (uint32_t i = 0; i < count; i++) {
+    while (!s_mpsc.try_pop(value)) {
+      backoff();
+    }
+    s_sum += value;
+  }
+}
+
+static void queue_produce(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    xQueueSend(s_queue, &i, portMAX_DELAY);
+  }
+}
+
+static void queue_consume(uint32_t count) {
+  uint32_t value;
+  for (uint32_t i = 0; i < count; i++) {
+    xQueueReceive(s_queue, &value, portMAX_DELAY);
+    s_sum += value;
+  }
+}
+
+static void ring_produce(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    xRingbufferSend(s_ring, &i, sizeof(i), portMAX_DELAY);
+  }
+}
+
+static void ring_consume(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    size_t size;
+    uint32_t* item = (uint32_t*)xRingbufferReceive(s_ring, &size, portMAX_DELAY);
+    s_sum += *item;
+    vRingbufferReturnItem(s_ring, item);
+  }
+}
+
+static void bench_task(void* arg) {
+  bench_task_arg_t* task_arg = (bench_task_arg_t*)arg;
+  task_arg->fn(task_arg->count);
+  xSemaphoreGive(task_arg->done);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Move ITEMS elements from producers to one consumer and report the throughput
+ *
+ * The consumer is pinned to the last core, producer p to core p, so on a dual-core chip an
+ * SPSC case always crosses cores.
+ */
+static void run_case(const char* name, int producers, bench_fn_t produce, bench_fn_t consume) {
+  SemaphoreHandle_t done = xSemaphoreCreateCounting(producers + 1, 0);
+  bench_task_arg_t args[3];
+  uint32_t per_producer = ITEMS / producers;
+  s_sum = 0;
+
+  int64_t start_us = esp_timer_get_time();
+  args[0] = {consume, per_producer * producers, done};
+  xTaskCreatePinnedToCore(bench_task, "consumer", TASK_STACK, &args[0], TASK_PRIORITY, NULL, CONSUMER_CORE);
+  for (int p = 0; p < producers; p++) {
+    args[p + 1] = {produce, per_producer, done};
+    xTaskCreatePinnedToCore(bench_task, "producer", TASK_STACK, &args[p + 1], TASK_PRIORITY, NULL,
+                            p % CONFIG_FREERTOS_NUMBER_OF_CORES);
+  }
+  for (int i = 0; i < producers + 1; i++) {
+    xSemaphoreTake(done, portMAX_DELAY);
+  }
+  int64_t elapsed_us = esp_timer_get_time() - start_us;
+  vSemaphoreDelete(done);
+
+  uint64_t expected = (uint64_t)producers * per_producer * (per_producer - 1) / 2;
+  if (s_sum != expected) {
+    bench_report_failure("queue", name, "checksum mismatch");
+    return;
+  }
+  bench_report("queue", name, per_producer * producers, elapsed_us);
+}
+
+/**
+ * @brief Cost of a push and pop on one task, with nothing to wait for
+ */
+static void run_uncontended(void) {
+  uint32_t value = 0;
+  int64_t start_us = esp_timer_get_time();
+  for (uint32_t i = 0; i < ITEMS; i++) {
+    s_spsc.try_push(i);
+    s_spsc.try_pop(value);
+  }
+  bench_report("queue", "spsc_push_pop_1task", ITEMS, esp_timer_get_time() - start_us);
+
+  start_us = esp_timer_get_time();
+  for (uint32_t i = 0; i < ITEMS; i++) {
+    s_mpsc.try_push(i);
+    s_mpsc.try_pop(value);
+  }
+  bench_report("queue", "mpsc_push_pop_1task", ITEMS, esp_timer_get_time() - start_us);
+
+  start_us = esp_timer_get_time();
+  for (uint32_t i = 0; i < ITEMS; i++) {
+    xQueueSend(s_queue, &i, 0);
+    xQueueReceive(s_queue, &value, 0);
+  }
+  bench_report("queue", "xqueue_send_receive_1task", ITEMS, esp_timer_get_time() - start_us);
+
+  start_us = esp_timer_get_time();
+  for (uint32_t i = 0; i < ITEMS; i++) {
+    xRingbufferSend(s_ring, &i, sizeof(i), 0);
+    size_t size;
+    void* item = xRingbufferReceive(s_ring, &size, 0);
+    vRingbufferReturnItem(s_ring, item);
+  }
+  bench_report("queue", "xringbuffer_send_receive_1task", ITEMS, esp_timer_get_time() - start_us);
+}
+
+void bench_queue_run(void) {
+  s_queue = xQueueCreate(DEPTH, sizeof(uint32_t));
+  // No-split items carry an 8-byte header
+  s_ring = xRingbufferCreate(DEPTH * (sizeof(uint32_t) + 8), RINGBUF_TYPE_NOSPLIT);
+  if (!s_queue || !s_ring) {
+    bench_report_failure("queue", "setup", "out of memory");
+    return;
+  }
+
+  run_uncontended();
+
+  run_case("spsc_1p1c", 1, spsc_produce, spsc_consume);
+  run_case("spsc_batch_1p1c", 1, spsc_produce_batch, spsc_consume_batch);
+  run_case("xqueue_1p1c", 1, queue_produce, queue_consume);
+  run_case("xringbuffer_1p1c", 1, ring_produce, ring_consume);
+
+  run_case("mpsc_2p1c", 2, mpsc_produce, mpsc_consume);
+  run_case("xqueue_2p1c", 2, queue_produce, queue_consume);
+  run_case("xringbuffer_2p1c", 2, ring_produce, ring_consume);
+
+  vQueueDelete(s_queue);
+  vRingbufferDelete(s_ring);
+}
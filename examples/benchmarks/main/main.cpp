@@ -0,0 +1,54 @@
+#include <stdio.h>
+
+#include "bench.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "benchmarks";
+
+void bench_report(const char* suite, const char* name, uint32_t ops, int64_t elapsed_us) {
+  double ns_per_op = elapsed_us > 0 ? (double)elapsed_us * 1000.0 / ops : 0.0;
+  double mops = elapsed_us > 0 ? (double)ops / (double)elapsed_us : 0.0;
+  printf("BENCH %s %s ops=%lu us=%lld ns_per_op=%.1f mops=%.3f\n", suite, name, (unsigned long)ops,
+         (long long)elapsed_us, ns_per_op, mops);
+}
+
+bench_timer_t bench_timer_start(void) {
+  bench_timer_t timer;
+  timer.start_us = esp_timer_get_time();
+  timer.start_cycles = esp_cpu_get_cycle_count();
+  return timer;
+}
+
+void bench_report_timer(const char* suite, const char* name, uint32_t ops, bench_timer_t timer) {
+  uint32_t cycles = esp_cpu_get_cycle_count() - timer.start_cycles;
+  int64_t elapsed_us = esp_timer_get_time() - timer.start_us;
+  double ns_per_op = elapsed_us > 0 ? (double)elapsed_us * 1000.0 / ops : 0.0;
+  double mops = elapsed_us > 0 ? (double)ops / (double)elapsed_us : 0.0;
+  printf("BENCH %s %s ops=%lu us=%lld ns_per_op=%.1f mops=%.3f cycles_per_op=%.1f\n", suite, name,
+         (unsigned long)ops, (long long)elapsed_us, ns_per_op, mops, (double)cycles / ops);
+}
+
+void bench_report_failure(const char* suite, const char* name, const char* reason) {
+  printf("BENCH %s %s FAILED %s\n", suite, name, reason);
+}
+
+extern "C" void app_main(void) {
+  ESP_LOGI(TAG, "Running on %s, %d core(s) at %d MHz", CONFIG_IDF_TARGET, CONFIG_FREERTOS_NUMBER_OF_CORES,
+           CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+
+  // Let boot logging and the idle tasks settle before timing anything
+  vTaskDelay(pdMS_TO_TICKS(500));
+
+  bench_queue_run();
+  bench_executor_run();
+  bench_mcp_run();
+  bench_json_run();
+  bench_codec_run();
+
+  printf("BENCH done\n");
+}
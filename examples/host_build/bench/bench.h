@@ -0,0 +1,57 @@
+#ifndef HOST_BUILD_BENCH_H
+#define HOST_BUILD_BENCH_H
+
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+
+#include "httpd_mock.h"
+
+/// Port the benchmarks start the shared server on; nothing listens, requests go through httpd_mock
+constexpr uint16_t BENCH_PORT = 3000;
+
+/**
+ * @brief Response buffer reused across the iterations of one benchmark
+ */
+class BenchResponse {
+ public:
+  BenchResponse() = default;
+  BenchResponse(const BenchResponse&) = delete;
+  BenchResponse& operator=(const BenchResponse&) = delete;
+  ~BenchResponse() { httpd_mock_response_free(&response_); }
+
+  httpd_mock_response_t* get() { return &response_; }
+  std::string_view body() const { return {response_.body, response_.body_len}; }
+  int status() const { return response_.status; }
+
+ private:
+  httpd_mock_response_t response_ = {};
+};
+
+/**
+ * @brief Serve one request, failing the benchmark if it did not return 200
+ *
+ * @return false after SkipWithError(), so the caller can stop iterating
+ */
+inline bool bench_request(benchmark::State& state, httpd_method_t method, const char* uri, std::string_view body,
+                          BenchResponse& response) {
+  esp_err_t ret = httpd_mock_request(method, uri, body.data(), body.size(), response.get());
+  if (ret != ESP_OK || response.status() != 200) {
+    state.SkipWithError(ret != ESP_OK ? esp_err_to_name(ret) : "HTTP status is not 200");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Skip the benchmark unless the body contains needle, so a fast wrong answer never looks like a win
+ */
+inline bool bench_expect(benchmark::State& state, std::string_view body, std::string_view needle) {
+  if (body.find(needle) == std::string_view::npos) {
+    state.SkipWithError("Unexpected response body");
+    return false;
+  }
+  return true;
+}
+
+#endif  // HOST_BUILD_BENCH_H
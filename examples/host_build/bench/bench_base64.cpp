@@ -0,0 +1,165 @@
+#include <benchmark/benchmark.h>
+#include <string.h>
+
+#include <string>
+#include <string_view>
+
+#include "base64_codec.h"
+
+/// Bytes per case: the payload of one full-size TCP segment
+constexpr size_t PAYLOAD_SIZE = 1436;
+
+static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const std::string& payload() {
+  static const std::string data = [] {
+    std::string s(PAYLOAD_SIZE, '\0');
+    uint32_t seed = 12345;
+    for (char& c : s) {
+      seed = seed * 1664525 + 1013904223;
+      c = (char)(seed >> 24);
+    }
+    return s;
+  }();
+  return data;
+}
+
+/**
+ * @brief Bit-at-a-time encoder, the baseline the codec is timed against
+ */
+static std::string encode_scalar(std::string_view in) {
+  std::string out;
+  uint32_t bits = 0;
+  int nbits = 0;
+  for (unsigned char c : in) {
+    bits = bits << 8 | c;
+    nbits += 8;
+    while (nbits >= 6) {
+      nbits -= 6;
+      out += ALPHABET[(bits >> nbits) & 0x3F];
+    }
+  }
+  if (nbits) {
+    out += ALPHABET[(bits << (6 - nbits)) & 0x3F];
+  }
+  while (out.size() % 4) {
+    out += '=';
+  }
+  return out;
+}
+
+/**
+ * @brief Decoder that searches the alphabet for every character, for canonical padded input only
+ */
+static std::string decode_scalar(std::string_view in) {
+  std::string out;
+  uint32_t bits = 0;
+  int nbits = 0;
+  for (char c : in) {
+    if (c == '=') {
+      break;
+    }
+    bits = bits << 6 | (uint32_t)(strchr(ALPHABET, c) - ALPHABET);
+    nbits += 6;
+    if (nbits >= 8) {
+      nbits -= 8;
+      out += (char)(bits >> nbits);
+    }
+  }
+  return out;
+}
+
+static std::string encode(std::string_view in) {
+  std::string out(BASE64_ENCODED_LEN(in.size()), '\0');
+  out.resize(base64_encode(out.data(), in.data(), in.size()));
+  return out;
+}
+
+static void BM_Base64EncodeScalar(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encode_scalar(payload()));
+  }
+  state.SetBytesProcessed(state.iterations() * payload().size());
+}
+BENCHMARK(BM_Base64EncodeScalar);
+
+static void BM_Base64Encode(benchmark::State& state) {
+  std::string out(BASE64_ENCODED_LEN(payload().size()), '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base64_encode(out.data(), payload().data(), payload().size()));
+  }
+  state.SetBytesProcessed(state.iterations() * payload().size());
+}
+BENCHMARK(BM_Base64Encode);
+
+static void BM_Base64DecodeScalar(benchmark::State& state) {
+  std::string text = encode_scalar(payload());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decode_scalar(text));
+  }
+  state.SetBytesProcessed(state.iterations() * payload().size());
+}
+BENCHMARK(BM_Base64DecodeScalar);
+
+static void BM_Base64Decode(benchmark::State& state) {
+  std::string text = encode(payload());
+  std::string out(payload().size(), '\0');
+  size_t len = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base64_decode(out.data(), out.size(), text.data(), text.size(), &len));
+  }
+  state.SetBytesProcessed(state.iterations() * payload().size());
+}
+BENCHMARK(BM_Base64Decode);
+
+// Includes copying the text back into the buffer each iteration, as a received body would arrive
+static void BM_Base64DecodeInPlace(benchmark::State& state) {
+  std::string text = encode(payload());
+  std::string buf(text.size(), '\0');
+  size_t len = 0;
+  for (auto _ : state) {
+    memcpy(buf.data(), text.data(), text.size());
+    benchmark::DoNotOptimize(base64_decode_in_place(buf.data(), buf.size(), &len));
+  }
+  state.SetBytesProcessed(state.iterations() * payload().size());
+}
+BENCHMARK(BM_Base64DecodeInPlace);
+
+// 64-character lines, as in PEM, which take the per-character path at every line break
+static void BM_Base64DecodeWrapped(benchmark::State& state) {
+  std::string text = encode(payload());
+  std::string wrapped;
+  for (size_t i = 0; i < text.size(); i += 64) {
+    wrapped += text.substr(i, 64) + "\n";
+  }
+  std::string out(payload().size(), '\0');
+  size_t len = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base64_decode(out.data(), out.size(), wrapped.data(), wrapped.size(), &len));
+  }
+  state.SetBytesProcessed(state.iterations() * payload().size());
+}
+BENCHMARK(BM_Base64DecodeWrapped);
+
+// 256-byte writes into 512-character chunks, the shape of a streamed HTTP response
+static void BM_Base64Writer(benchmark::State& state) {
+  char chunk[512];
+  size_t total = 0;
+  auto count = [](void* ctx, const char* data, size_t len) -> esp_err_t {
+    benchmark::DoNotOptimize(data);
+    *static_cast<size_t*>(ctx) += len;
+    return ESP_OK;
+  };
+  for (auto _ : state) {
+    base64_writer_t writer;
+    base64_writer_init(&writer, chunk, sizeof(chunk), count, &total);
+    for (size_t i = 0; i < payload().size(); i += 256) {
+      size_t n = payload().size() - i < 256 ? payload().size() - i : 256;
+      base64_writer_write(&writer, payload().data() + i, n);
+    }
+    base64_writer_finish(&writer);
+  }
+  benchmark::DoNotOptimize(total);
+  state.SetBytesProcessed(state.iterations() * payload().size());
+}
+BENCHMARK(BM_Base64Writer);
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "checksum_crc32.h"
+
+/// Bytes per case: the payload of one full-size TCP segment, as an upload handler receives it
+constexpr size_t PAYLOAD_SIZE = 1436;
+
+static const std::string& payload() {
+  static const std::string data = [] {
+    std::string s(PAYLOAD_SIZE + 3, '\0');
+    uint32_t seed = 54321;
+    for (char& c : s) {
+      seed = seed * 1664525 + 1013904223;
+      c = (char)(seed >> 24);
+    }
+    return s;
+  }();
+  return data;
+}
+
+/**
+ * @brief Bit-at-a-time CRC-32, the baseline the table loop is timed against
+ */
+static uint32_t crc32_bitwise(uint32_t crc, const void* data, size_t len) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= p[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static void BM_Crc32Bitwise(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(crc32_bitwise(0, payload().data(), PAYLOAD_SIZE));
+  }
+  state.SetBytesProcessed(state.iterations() * PAYLOAD_SIZE);
+}
+BENCHMARK(BM_Crc32Bitwise);
+
+// Arg is the start offset, to show the cost of the unaligned head
+static void BM_Crc32Slice4(benchmark::State& state) {
+  const char* p = payload().data() + state.range(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(checksum_crc32_sw(0, p, PAYLOAD_SIZE));
+  }
+  state.SetBytesProcessed(state.iterations() * PAYLOAD_SIZE);
+}
+BENCHMARK(BM_Crc32Slice4)->Arg(0)->Arg(1);
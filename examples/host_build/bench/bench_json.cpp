@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <string_view>
+
+#include "cJSON.h"
+#include "json_kernels.h"
+#include "mcp_protocol.h"
+#include "mcp_tool.h"
+
+/**
+ * @brief Text of the size and shape tools return: mostly plain, a few quotes and line breaks
+ */
+static const std::string& prose() {
+  static const std::string text = [] {
+    std::string s;
+    while (s.size() < 1024) {
+      s += "Reads the \"living_room\" sensor and averages the last samples.\n"
+           "Temperature 21.5 C, humidity 48 %, pressure 1013 hPa; battery at 87 %.\t";
+    }
+    return s;
+  }();
+  return text;
+}
+
+/**
+ * @brief Text with multi-byte UTF-8 in most words
+ */
+static const std::string& utf8_text() {
+  static const std::string text = [] {
+    std::string s;
+    while (s.size() < 1024) {
+      s += "Température 21,5 °C, humidité 48 %, Luftdruck 1013 hPa, 温度 21.5 度, ✓ ";
+    }
+    return s;
+  }();
+  return text;
+}
+
+/**
+ * @brief Byte-at-a-time escape with cJSON's rules, the baseline the kernels are timed against
+ */
+static size_t escape_scalar(char* dst, std::string_view s) {
+  char* out = dst;
+  for (unsigned char c : s) {
+    switch (c) {
+      case '"':
+      case '\\':
+        *out++ = '\\';
+        *out++ = (char)c;
+        break;
+      case '\b':
+        out += sprintf(out, "\\b");
+        break;
+      case '\f':
+        out += sprintf(out, "\\f");
+        break;
+      case '\n':
+        out += sprintf(out, "\\n");
+        break;
+      case '\r':
+        out += sprintf(out, "\\r");
+        break;
+      case '\t':
+        out += sprintf(out, "\\t");
+        break;
+      default:
+        if (c < 0x20) {
+          out += sprintf(out, "\\u%04x", c);
+        }
+        else {
+          *out++ = (char)c;
+        }
+    }
+  }
+  return out - dst;
+}
+
+/**
+ * @brief UTF-8 validation by decoding every code point, the baseline json_utf8_valid() is timed against
+ */
+static bool utf8_valid_scalar(std::string_view s) {
+  size_t i = 0;
+  while (i < s.size()) {
+    unsigned char c = s[i];
+    uint32_t cp;
+    size_t extra;
+    if (c < 0x80) {
+      i++;
+      continue;
+    }
+    else if ((c & 0xE0) == 0xC0) {
+      cp = c & 0x1F;
+      extra = 1;
+    }
+    else if ((c & 0xF0) == 0xE0) {
+      cp = c & 0x0F;
+      extra = 2;
+    }
+    else if ((c & 0xF8) == 0xF0) {
+      cp = c & 0x07;
+      extra = 3;
+    }
+    else {
+      return false;
+    }
+    if (i + extra >= s.size()) {
+      return false;
+    }
+    for (size_t k = 1; k <= extra; k++) {
+      if (((unsigned char)s[i + k] & 0xC0) != 0x80) {
+        return false;
+      }
+      cp = cp << 6 | ((unsigned char)s[i + k] & 0x3F);
+    }
+    static const uint32_t MIN_CP[] = {0, 0x80, 0x800, 0x10000};
+    if (cp < MIN_CP[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+      return false;
+    }
+    i += extra + 1;
+  }
+  return true;
+}
+
+// cJSON printing a string item, the path responses took before the kernels
+static void BM_EscapeCjson(benchmark::State& state, const std::string& (*text)()) {
+  cJSON* item = cJSON_CreateString(text().c_str());
+  for (auto _ : state) {
+    char* printed = cJSON_PrintUnformatted(item);
+    benchmark::DoNotOptimize(printed);
+    free(printed);
+  }
+  cJSON_Delete(item);
+  state.SetBytesProcessed(state.iterations() * text().size());
+}
+BENCHMARK_CAPTURE(BM_EscapeCjson, prose, prose);
+BENCHMARK_CAPTURE(BM_EscapeCjson, utf8, utf8_text);
+
+static void BM_EscapeScalar(benchmark::State& state, const std::string& (*text)()) {
+  std::string out(text().size() * 6, '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(escape_scalar(out.data(), text()));
+  }
+  state.SetBytesProcessed(state.iterations() * text().size());
+}
+BENCHMARK_CAPTURE(BM_EscapeScalar, prose, prose);
+BENCHMARK_CAPTURE(BM_EscapeScalar, utf8, utf8_text);
+
+// Sizing and escaping into a new buffer, as mcp_protocol_create_text_response() does
+static void BM_EscapeKernel(benchmark::State& state, const std::string& (*text)()) {
+  state.SetLabel(json_kernels_impl());
+  const std::string& s = text();
+  for (auto _ : state) {
+    char* out = (char*)malloc(json_escaped_len(s.data(), s.size()));
+    benchmark::DoNotOptimize(json_escape(out, s.data(), s.size()));
+    free(out);
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK_CAPTURE(BM_EscapeKernel, prose, prose);
+BENCHMARK_CAPTURE(BM_EscapeKernel, utf8, utf8_text);
+
+static void BM_Utf8Scalar(benchmark::State& state, const std::string& (*text)()) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(utf8_valid_scalar(text()));
+  }
+  state.SetBytesProcessed(state.iterations() * text().size());
+}
+BENCHMARK_CAPTURE(BM_Utf8Scalar, ascii, prose);
+BENCHMARK_CAPTURE(BM_Utf8Scalar, utf8, utf8_text);
+
+static void BM_Utf8Kernel(benchmark::State& state, const std::string& (*text)()) {
+  state.SetLabel(json_kernels_impl());
+  const std::string& s = text();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(json_utf8_valid(s.data(), s.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * s.size());
+}
+BENCHMARK_CAPTURE(BM_Utf8Kernel, ascii, prose);
+BENCHMARK_CAPTURE(BM_Utf8Kernel, utf8, utf8_text);
+
+// A tools/call response through a cJSON tree, as before
+static void BM_TextResponseCjson(benchmark::State& state) {
+  for (auto _ : state) {
+    mcp_tool_result_t result = mcp_tool_result_success(prose().c_str());
+    char* response = mcp_protocol_create_response(7, mcp_tool_result_to_json(&result));
+    mcp_tool_result_free(&result);
+    benchmark::DoNotOptimize(response);
+    free(response);
+  }
+  state.SetBytesProcessed(state.iterations() * prose().size());
+}
+BENCHMARK(BM_TextResponseCjson);
+
+// The same response written directly, which the server now sends for text results
+static void BM_TextResponseDirect(benchmark::State& state) {
+  for (auto _ : state) {
+    mcp_tool_result_t result = mcp_tool_result_success(prose().c_str());
+    char* response = mcp_protocol_create_text_response(7, result.content);
+    mcp_tool_result_free(&result);
+    benchmark::DoNotOptimize(response);
+    free(response);
+  }
+  state.SetBytesProcessed(state.iterations() * prose().size());
+}
+BENCHMARK(BM_TextResponseDirect);
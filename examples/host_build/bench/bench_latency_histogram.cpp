@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+
+#include "latency_histogram.h"
+
+/// Latencies from 50 us to about 200 ms, log-uniform like a request mix with a long tail
+static const std::array<uint32_t, 1024>& latencies() {
+  static const std::array<uint32_t, 1024> values = [] {
+    std::array<uint32_t, 1024> v{};
+    uint32_t seed = 24680;
+    for (uint32_t& value : v) {
+      seed = seed * 1664525 + 1013904223;
+      value = (50u + (seed >> 24)) << ((seed >> 8) % 12);
+    }
+    return v;
+  }();
+  return values;
+}
+
+static LatencyHistogram<4, 24> s_latency;
+
+// The record path: bucket index and one relaxed atomic increment, from 1 to 4 threads
+static void BM_LatencyHistogramRecord(benchmark::State& state) {
+  const auto& values = latencies();
+  size_t i = 0;
+  for (auto _ : state) {
+    s_latency.record(values[i]);
+    i = (i + 1) & (values.size() - 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LatencyHistogramRecord)->ThreadRange(1, 4);
+
+// p50, p90, p99 and p99.9 in one pass over the 337 buckets
+static void BM_LatencyHistogramQuantiles(benchmark::State& state) {
+  static const float QUANTILES[] = {0.5f, 0.9f, 0.99f, 0.999f};
+  LatencyHistogram<4, 24> hist;
+  for (uint32_t value : latencies()) {
+    hist.record(value);
+  }
+  uint32_t out[4];
+  for (auto _ : state) {
+    hist.quantiles(QUANTILES, out, 4);
+    benchmark::DoNotOptimize(out);
+  }
+  if (out[0] == 0 || out[0] > out[1] || out[1] > out[2] || out[2] > out[3]) {
+    state.SkipWithError("Quantiles are not ascending");
+  }
+}
+BENCHMARK(BM_LatencyHistogramQuantiles);
@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lockfree_queue.h"
+
+/// Items each producer hands over per iteration, tagged with the producer in the top byte
+constexpr uint32_t ITEMS = 1 << 16;
+constexpr uint32_t CAPACITY = 1024;
+
+/**
+ * @brief The host stand-in for xQueue: a mutex around a bounded deque
+ */
+class MutexQueue {
+ public:
+  bool try_push(uint32_t item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (items_.size() == CAPACITY) {
+      return false;
+    }
+    items_.push_back(item);
+    return true;
+  }
+  bool try_pop(uint32_t& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (items_.empty()) {
+      return false;
+    }
+    out = items_.front();
+    items_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::deque<uint32_t> items_;
+};
+
+/**
+ * @brief Move ITEMS from each of producers threads to this one, checking each producer's order
+ *
+ * @return false if an item went missing, was duplicated or arrived out of order
+ */
+template <typename Queue>
+static bool transfer(Queue& queue, uint32_t producers) {
+  std::vector<std::thread> threads;
+  for (uint32_t p = 0; p < producers; p++) {
+    threads.emplace_back([&queue, p] {
+      for (uint32_t i = 0; i < ITEMS; i++) {
+        while (!queue.try_push(p << 24 | i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<uint32_t> next(producers, 0);
+  bool ok = true;
+  for (uint32_t received = 0; received < producers * ITEMS;) {
+    uint32_t item;
+    if (!queue.try_pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    uint32_t p = item >> 24;
+    ok = ok && p < producers && (item & 0xFFFFFF) == next[p];
+    if (p < producers) {
+      next[p]++;
+    }
+    received++;
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return ok;
+}
+
+template <typename Queue>
+static void run_transfer(benchmark::State& state, uint32_t producers) {
+  auto queue = std::make_unique<Queue>();
+  for (auto _ : state) {
+    if (!transfer(*queue, producers)) {
+      state.SkipWithError("Items lost, duplicated or reordered");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * producers * ITEMS);
+}
+
+// One producer thread to one consumer, an item at a time
+static void BM_SpscTransfer(benchmark::State& state) { run_transfer<SpscQueue<uint32_t, CAPACITY>>(state, 1); }
+BENCHMARK(BM_SpscTransfer)->UseRealTime();
+
+static void BM_MpscTransfer(benchmark::State& state) {
+  run_transfer<MpscQueue<uint32_t, CAPACITY>>(state, state.range(0));
+}
+BENCHMARK(BM_MpscTransfer)->DenseRange(1, 4)->UseRealTime();
+
+static void BM_MutexQueueTransfer(benchmark::State& state) { run_transfer<MutexQueue>(state, state.range(0)); }
+BENCHMARK(BM_MutexQueueTransfer)->DenseRange(1, 4)->UseRealTime();
+
+// The same SPSC hand-over in batches through reserve/commit and peek/release, without copying per item
+static void BM_SpscZeroCopy(benchmark::State& state) {
+  auto queue = std::make_unique<SpscQueue<uint32_t, CAPACITY>>();
+  for (auto _ : state) {
+    std::thread producer([&queue] {
+      for (uint32_t i = 0; i < ITEMS;) {
+        uint32_t count;
+        uint32_t* slots = queue->reserve(&count);
+        count = std::min(count, ITEMS - i);
+        for (uint32_t k = 0; k < count; k++) {
+          slots[k] = i + k;
+        }
+        queue->commit(count);
+        i += count;
+        if (count == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    bool ok = true;
+    for (uint32_t i = 0; i < ITEMS;) {
+      uint32_t count;
+      const uint32_t* items = queue->peek(&count);
+      for (uint32_t k = 0; k < count; k++) {
+        ok = ok && items[k] == i + k;
+      }
+      queue->release(count);
+      i += count;
+      if (count == 0) {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+    if (!ok) {
+      state.SkipWithError("Items lost, duplicated or reordered");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+BENCHMARK(BM_SpscZeroCopy)->UseRealTime();
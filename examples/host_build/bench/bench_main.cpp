@@ -0,0 +1,19 @@
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+#include "esp_log.h"
+
+int main(int argc, char** argv) {
+  // Components log at INFO on every server start; keep the table readable unless asked otherwise
+  if (!getenv("ESP_LOG_LEVEL")) {
+    esp_log_level_set("*", ESP_LOG_WARN);
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+#include <string_view>
+
+#include "bench.h"
+#include "mcp_protocol.h"
+#include "mcp_schema.h"
+#include "mcp_server_cpp.h"
+#include "mcp_tool.h"
+
+static constexpr std::string_view CALL_REQUEST =
+    R"({"jsonrpc":"2.0","id":7,"method":"tools/call","params":{"name":"set_thermostat",)"
+    R"("arguments":{"temperature":72.5,"mode":"heat","hold_minutes":30,"persist":true}}})";
+static constexpr std::string_view HELLO_REQUEST =
+    R"({"jsonrpc":"2.0","id":8,"method":"tools/call","params":{"name":"hello_world","arguments":{}}})";
+static constexpr std::string_view LIST_REQUEST = R"({"jsonrpc":"2.0","id":9,"method":"tools/list"})";
+
+static const char* const MODES[] = {"heat", "cool", "off"};
+
+/**
+ * @brief A schema with every constraint kind, like the thermostat tool of the mcp_server example
+ */
+static const mcp_param_schema_t THERMOSTAT_PARAMS[] = {
+    MCP_PARAM_NUMBER_REQUIRED("temperature", "Target temperature in Fahrenheit", 40.0, 90.0),
+    {
+        .name = "mode",
+        .type = MCP_TYPE_STRING,
+        .description = "Operating mode",
+        .required = false,
+        .enum_values = const_cast<const char**>(MODES),
+        .enum_count = sizeof(MODES) / sizeof(MODES[0]),
+    },
+    MCP_PARAM_INTEGER("hold_minutes", "Minutes to hold the setpoint before resuming the schedule", 0, 1440),
+    MCP_PARAM_BOOLEAN("persist", "Store the setpoint in NVS"),
+};
+
+static const mcp_param_schema_t SENSOR_PARAMS[] = {
+    MCP_PARAM_STRING_REQUIRED("sensor", "Sensor name"),
+    MCP_PARAM_INTEGER("samples", "Samples to average", 1, 64),
+};
+
+static const char* const SENSOR_TOOLS[] = {"get_temperature", "get_humidity", "get_pressure",
+                                           "get_light",       "get_co2",      "get_voltage"};
+
+/**
+ * @brief One server for all MCP benchmarks, started on the shared httpd mock
+ *
+ * Eight tools, about what the mcp_server example registers, so tools/list has a realistic size.
+ */
+static McpServer& bench_server() {
+  static McpServer* server = [] {
+    auto* s = new McpServer(MCP_TRANSPORT_HTTP);
+    ESP_ERROR_CHECK(s->add_tool("hello_world", "Returns a friendly greeting",
+                                [] { return McpToolResult::success("Hello from the host!"); }));
+    ESP_ERROR_CHECK(s->add_tool("set_thermostat", "Sets the thermostat target", THERMOSTAT_PARAMS,
+                                [](const McpToolArgs& args) {
+                                  return McpToolResult::format("{\"setpoint\": %.1f, \"mode\": \"%.*s\"}",
+                                                               args.get_double("temperature"),
+                                                               (int)args.get_string("mode", "heat").size(),
+                                                               args.get_string("mode", "heat").data());
+                                }));
+    for (const char* name : SENSOR_TOOLS) {
+      ESP_ERROR_CHECK(s->add_tool(name, "Reads one sensor, averaged over a number of samples", SENSOR_PARAMS,
+                                  [] { return McpToolResult::success("{\"value\": 21.5}"); }));
+    }
+    ESP_ERROR_CHECK(s->start(BENCH_PORT));
+    return s;
+  }();
+  return *server;
+}
+
+// JSON-RPC envelope parsing alone
+static void BM_ParseRequest(benchmark::State& state) {
+  for (auto _ : state) {
+    mcp_request_t request;
+    if (mcp_protocol_parse_request(CALL_REQUEST.data(), &request) != ESP_OK) {
+      state.SkipWithError("Parse failed");
+      break;
+    }
+    benchmark::DoNotOptimize(request.params);
+    mcp_protocol_free_request(&request);
+  }
+  state.SetBytesProcessed(state.iterations() * CALL_REQUEST.size());
+}
+BENCHMARK(BM_ParseRequest);
+
+// inputSchema generation for one tool, without printing
+static void BM_SchemaToJson(benchmark::State& state) {
+  for (auto _ : state) {
+    cJSON* schema = mcp_schema_to_json(THERMOSTAT_PARAMS, sizeof(THERMOSTAT_PARAMS) / sizeof(THERMOSTAT_PARAMS[0]));
+    benchmark::DoNotOptimize(schema);
+    cJSON_Delete(schema);
+  }
+}
+BENCHMARK(BM_SchemaToJson);
+
+// Tool result to JSON-RPC response text
+static void BM_SerializeResult(benchmark::State& state) {
+  for (auto _ : state) {
+    mcp_tool_result_t result = mcp_tool_result_success("{\"temperature\": 72.5, \"unit\": \"F\", \"age_ms\": 120}");
+    char* response = mcp_protocol_create_response(7, mcp_tool_result_to_json(&result));
+    mcp_tool_result_free(&result);
+    if (!response) {
+      state.SkipWithError("Serialization failed");
+      break;
+    }
+    benchmark::DoNotOptimize(response);
+    free(response);
+  }
+}
+BENCHMARK(BM_SerializeResult);
+
+// Full POST / path: shared_httpd, HTTP transport, dispatch, argument access, response
+static void BM_DispatchToolCall(benchmark::State& state) {
+  bench_server();
+  BenchResponse response;
+  for (auto _ : state) {
+    if (!bench_request(state, HTTP_POST, "/", CALL_REQUEST, response)) {
+      break;
+    }
+  }
+  bench_expect(state, response.body(), "setpoint");
+}
+BENCHMARK(BM_DispatchToolCall);
+
+// Dispatch overhead with a handler that does nothing
+static void BM_DispatchHello(benchmark::State& state) {
+  bench_server();
+  BenchResponse response;
+  for (auto _ : state) {
+    if (!bench_request(state, HTTP_POST, "/", HELLO_REQUEST, response)) {
+      break;
+    }
+  }
+  bench_expect(state, response.body(), "Hello from the host!");
+}
+BENCHMARK(BM_DispatchHello);
+
+// tools/list: schema generation and serialization of every tool
+static void BM_ListTools(benchmark::State& state) {
+  bench_server();
+  BenchResponse response;
+  for (auto _ : state) {
+    if (!bench_request(state, HTTP_POST, "/", LIST_REQUEST, response)) {
+      break;
+    }
+  }
+  if (bench_expect(state, response.body(), "get_voltage")) {
+    state.counters["response_bytes"] = response.body().size();
+  }
+}
+BENCHMARK(BM_ListTools);
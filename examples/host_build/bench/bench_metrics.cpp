@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include "bench.h"
+#include "metrics.h"
+
+static const float DURATION_BOUNDS[] = {0.001f, 0.005f, 0.01f, 0.05f, 0.1f, 0.5f, 1.0f};
+
+static METRICS_COUNTER_DEFINE(s_requests, "bench_requests_total", "Requests");
+static METRICS_GAUGE_DEFINE(s_temperature, "bench_temperature_celsius", "Temperature");
+static METRICS_HISTOGRAM_DEFINE(s_duration, "bench_duration_seconds", "Duration", DURATION_BOUNDS);
+
+static void register_metrics() {
+  static bool registered = [] {
+    ESP_ERROR_CHECK(metrics_register(&s_requests.base));
+    ESP_ERROR_CHECK(metrics_register(&s_temperature.base));
+    ESP_ERROR_CHECK(metrics_register(&s_duration.base));
+    ESP_ERROR_CHECK(metrics_register_http(BENCH_PORT));
+    return true;
+  }();
+  (void)registered;
+}
+
+static void BM_CounterInc(benchmark::State& state) {
+  for (auto _ : state) {
+    metrics_counter_inc(&s_requests);
+  }
+}
+BENCHMARK(BM_CounterInc)->ThreadRange(1, 4);
+
+static void BM_HistogramObserve(benchmark::State& state) {
+  double value = 0.0;
+  for (auto _ : state) {
+    metrics_histogram_observe(&s_duration, value);
+    value = value < 1.0 ? value + 0.0007 : 0.0;
+  }
+}
+BENCHMARK(BM_HistogramObserve);
+
+// GET /metrics: Prometheus text rendering and chunked sending of every registered metric
+static void BM_Scrape(benchmark::State& state) {
+  register_metrics();
+  metrics_gauge_set(&s_temperature, 21.5f);
+  BenchResponse response;
+  for (auto _ : state) {
+    if (!bench_request(state, HTTP_GET, "/metrics", {}, response)) {
+      break;
+    }
+  }
+  if (bench_expect(state, response.body(), "bench_duration_seconds_bucket{le=\"+Inf\"}")) {
+    state.counters["response_bytes"] = response.body().size();
+  }
+}
+BENCHMARK(BM_Scrape);
@@ -0,0 +1,152 @@
+#include "esp_console.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct command {
+  esp_console_cmd_t cmd;
+  struct command* next;
+} command_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool s_initialized = false;
+static esp_console_config_t s_config;
+static command_t* s_commands = NULL;
+
+esp_err_t esp_console_init(const esp_console_config_t* config) {
+  if (!config || config->max_cmdline_length == 0 || config->max_cmdline_args == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pthread_mutex_lock(&s_lock);
+  esp_err_t ret = ESP_ERR_INVALID_STATE;
+  if (!s_initialized) {
+    s_config = *config;
+    s_initialized = true;
+    ret = ESP_OK;
+  }
+  pthread_mutex_unlock(&s_lock);
+  return ret;
+}
+
+esp_err_t esp_console_deinit(void) {
+  pthread_mutex_lock(&s_lock);
+  if (!s_initialized) {
+    pthread_mutex_unlock(&s_lock);
+    return ESP_ERR_INVALID_STATE;
+  }
+  while (s_commands) {
+    command_t* next = s_commands->next;
+    free(s_commands);
+    s_commands = next;
+  }
+  s_initialized = false;
+  pthread_mutex_unlock(&s_lock);
+  return ESP_OK;
+}
+
+esp_err_t esp_console_cmd_register(const esp_console_cmd_t* cmd) {
+  if (!cmd || !cmd->command || strchr(cmd->command, ' ') || (!cmd->func && !cmd->func_w_context)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pthread_mutex_lock(&s_lock);
+  command_t** slot = &s_commands;
+  while (*slot && strcmp((*slot)->cmd.command, cmd->command) != 0) {
+    slot = &(*slot)->next;
+  }
+  if (!*slot) {
+    *slot = (command_t*)calloc(1, sizeof(command_t));
+    if (!*slot) {
+      pthread_mutex_unlock(&s_lock);
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  (*slot)->cmd = *cmd;
+  pthread_mutex_unlock(&s_lock);
+  return ESP_OK;
+}
+
+/**
+ * @brief Split line in place into at most argv_size - 1 words, NULL-terminated like main()'s argv
+ */
+static int split_argv(char* line, char** argv, size_t argv_size) {
+  int argc = 0;
+  char* p = line;
+  while (*p && (size_t)argc < argv_size - 1) {
+    while (*p == ' ' || *p == '\t') {
+      p++;
+    }
+    if (!*p) {
+      break;
+    }
+    bool quoted = *p == '"';
+    if (quoted) {
+      p++;
+    }
+    argv[argc++] = p;
+    while (*p && (quoted ? *p != '"' : *p != ' ' && *p != '\t')) {
+      p++;
+    }
+    if (*p) {
+      *p++ = '\0';
+    }
+  }
+  argv[argc] = NULL;
+  return argc;
+}
+
+esp_err_t esp_console_run(const char* cmdline, int* cmd_ret) {
+  if (!cmdline || !cmd_ret) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pthread_mutex_lock(&s_lock);
+  if (!s_initialized) {
+    pthread_mutex_unlock(&s_lock);
+    return ESP_ERR_INVALID_STATE;
+  }
+  esp_console_config_t config = s_config;
+  pthread_mutex_unlock(&s_lock);
+
+  char line[config.max_cmdline_length + 1];
+  snprintf(line, sizeof(line), "%s", cmdline);
+  char* argv[config.max_cmdline_args + 1];
+  int argc = split_argv(line, argv, config.max_cmdline_args + 1);
+  if (argc == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  pthread_mutex_lock(&s_lock);
+  const command_t* found = s_commands;
+  while (found && strcmp(found->cmd.command, argv[0]) != 0) {
+    found = found->next;
+  }
+  esp_console_cmd_t cmd = found ? found->cmd : (esp_console_cmd_t){0};
+  pthread_mutex_unlock(&s_lock);
+  if (!found) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  // Run without the lock, so a command may register others
+  *cmd_ret = cmd.func ? cmd.func(argc, argv) : cmd.func_w_context(cmd.context, argc, argv);
+  return ESP_OK;
+}
+
+static int help_command(int argc, char** argv) {
+  pthread_mutex_lock(&s_lock);
+  for (const command_t* c = s_commands; c; c = c->next) {
+    printf("%s %s\n  %s\n\n", c->cmd.command, c->cmd.hint ? c->cmd.hint : "", c->cmd.help ? c->cmd.help : "");
+  }
+  pthread_mutex_unlock(&s_lock);
+  return 0;
+}
+
+esp_err_t esp_console_register_help_command(void) {
+  esp_console_cmd_t cmd = {
+      .command = "help",
+      .help = "Print the list of registered commands",
+      .func = help_command,
+  };
+  return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,310 @@
+#include "esp_http_server.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "httpd_mock.h"
+
+static const char* TAG = "httpd_mock";
+
+/**
+ * @brief A registered handler, with its URI copied as httpd does
+ */
+typedef struct {
+  char* uri;  // NULL for a free slot
+  httpd_method_t method;
+  esp_err_t (*handler)(httpd_req_t* r);
+  void* user_ctx;
+} handler_t;
+
+/**
+ * @brief The single server httpd_start() creates
+ */
+typedef struct {
+  httpd_config_t config;
+  handler_t* handlers;
+} server_t;
+
+/**
+ * @brief Per-request state behind httpd_req_t.aux
+ */
+typedef struct {
+  const char* body;
+  size_t body_len;
+  size_t body_read;
+  httpd_mock_response_t* response;
+  bool async;  // A copy from httpd_req_async_handler_begin() has not been completed yet
+} request_state_t;
+
+static server_t* s_server = NULL;
+static pthread_mutex_t s_handler_lock = PTHREAD_MUTEX_INITIALIZER;  // httpd runs one handler at a time
+static pthread_mutex_t s_async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_async_done = PTHREAD_COND_INITIALIZER;
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config) {
+  if (!handle || !config) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_server) {
+    ESP_LOGE(TAG, "Only one server is supported");
+    return ESP_ERR_INVALID_STATE;
+  }
+  server_t* server = calloc(1, sizeof(server_t));
+  handler_t* handlers = calloc(config->max_uri_handlers, sizeof(handler_t));
+  if (!server || !handlers) {
+    free(server);
+    free(handlers);
+    return ESP_ERR_HTTPD_ALLOC_MEM;
+  }
+  server->config = *config;
+  server->handlers = handlers;
+  s_server = server;
+  *handle = server;
+  return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+  server_t* server = (server_t*)handle;
+  if (!server || server != s_server) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  for (size_t i = 0; i < server->config.max_uri_handlers; i++) {
+    free(server->handlers[i].uri);
+  }
+  free(server->handlers);
+  free(server);
+  s_server = NULL;
+  return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler) {
+  server_t* server = (server_t*)handle;
+  if (!server || !uri_handler || !uri_handler->uri || !uri_handler->handler) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  handler_t* slot = NULL;
+  for (size_t i = 0; i < server->config.max_uri_handlers; i++) {
+    handler_t* handler = &server->handlers[i];
+    if (!handler->uri) {
+      slot = slot ? slot : handler;
+    }
+    else if (handler->method == uri_handler->method && strcmp(handler->uri, uri_handler->uri) == 0) {
+      return ESP_ERR_HTTPD_HANDLER_EXISTS;
+    }
+  }
+  if (!slot) {
+    return ESP_ERR_HTTPD_HANDLERS_FULL;
+  }
+  slot->uri = strdup(uri_handler->uri);
+  if (!slot->uri) {
+    return ESP_ERR_HTTPD_ALLOC_MEM;
+  }
+  slot->method = uri_handler->method;
+  slot->handler = uri_handler->handler;
+  slot->user_ctx = uri_handler->user_ctx;
+  return ESP_OK;
+}
+
+esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle, const char* uri, httpd_method_t method) {
+  server_t* server = (server_t*)handle;
+  if (!server || !uri) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  for (size_t i = 0; i < server->config.max_uri_handlers; i++) {
+    handler_t* handler = &server->handlers[i];
+    if (handler->uri && handler->method == method && strcmp(handler->uri, uri) == 0) {
+      free(handler->uri);
+      memset(handler, 0, sizeof(*handler));
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+// Same rules as httpd: a trailing '*' matches any rest, a trailing '?' makes the character
+// before it optional, and "/path/?*" matches "/path", "/path/" and "/path/anything"
+bool httpd_uri_match_wildcard(const char* uri_template, const char* uri_to_match, size_t match_upto) {
+  size_t tpl_len = strlen(uri_template);
+  size_t exact_len = tpl_len;
+  bool any_rest = tpl_len > 0 && uri_template[tpl_len - 1] == '*';
+  if (any_rest) {
+    exact_len--;
+  }
+  bool optional_last = exact_len > 0 && uri_template[exact_len - 1] == '?';
+  if (optional_last) {
+    exact_len--;
+  }
+
+  if (optional_last && exact_len > 0 && match_upto == exact_len - 1 &&
+      strncmp(uri_template, uri_to_match, exact_len - 1) == 0) {
+    return true;  // Matched without the optional character
+  }
+  if (match_upto < exact_len || strncmp(uri_template, uri_to_match, exact_len) != 0) {
+    return false;
+  }
+  return any_rest || match_upto == exact_len;
+}
+
+static request_state_t* state_of(httpd_req_t* r) { return (request_state_t*)r->aux; }
+
+static esp_err_t append_body(httpd_mock_response_t* response, const char* buf, size_t len) {
+  if (response->body_len + len + 1 > response->body_capacity) {
+    size_t capacity = response->body_capacity ? response->body_capacity : 256;
+    while (capacity < response->body_len + len + 1) {
+      capacity *= 2;
+    }
+    char* body = realloc(response->body, capacity);
+    if (!body) {
+      return ESP_ERR_NO_MEM;
+    }
+    response->body = body;
+    response->body_capacity = capacity;
+  }
+  memcpy(response->body + response->body_len, buf, len);
+  response->body_len += len;
+  response->body[response->body_len] = '\0';
+  return ESP_OK;
+}
+
+int httpd_req_recv(httpd_req_t* r, char* buf, size_t buf_len) {
+  request_state_t* state = state_of(r);
+  size_t remaining = state->body_len - state->body_read;
+  size_t len = buf_len < remaining ? buf_len : remaining;
+  memcpy(buf, state->body + state->body_read, len);
+  state->body_read += len;
+  return (int)len;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out) {
+  if (!r || !out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  httpd_req_t* copy = malloc(sizeof(httpd_req_t));
+  if (!copy) {
+    return ESP_ERR_NO_MEM;
+  }
+  *copy = *r;
+  pthread_mutex_lock(&s_async_lock);
+  state_of(r)->async = true;
+  pthread_mutex_unlock(&s_async_lock);
+  *out = copy;
+  return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t* r) {
+  if (!r) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pthread_mutex_lock(&s_async_lock);
+  state_of(r)->async = false;
+  pthread_cond_broadcast(&s_async_done);
+  pthread_mutex_unlock(&s_async_lock);
+  free(r);
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status) {
+  state_of(r)->response->status = atoi(status);
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type) {
+  httpd_mock_response_t* response = state_of(r)->response;
+  snprintf(response->content_type, sizeof(response->content_type), "%s", type);
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value) { return ESP_OK; }
+
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+  size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? strlen(buf) : (size_t)buf_len;
+  return len ? append_body(state_of(r)->response, buf, len) : ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+  state_of(r)->response->chunks++;
+  return httpd_resp_send(r, buf, buf_len);
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t* req, httpd_err_code_t error, const char* msg) {
+  static const int codes[] = {500, 501, 505, 400, 401, 403, 404, 405, 408, 411, 413, 414, 431};
+  httpd_mock_response_t* response = state_of(req)->response;
+  response->status = codes[error];
+  response->body_len = 0;
+  return append_body(response, msg ? msg : "", msg ? strlen(msg) : 0);
+}
+
+esp_err_t httpd_mock_request(httpd_method_t method, const char* uri, const char* body, size_t body_len,
+                             httpd_mock_response_t* response) {
+  if (!uri || !response || (body_len && !body)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_server) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  response->status = 200;
+  snprintf(response->content_type, sizeof(response->content_type), "text/html");
+  response->body_len = 0;
+  response->chunks = 0;
+  if (append_body(response, "", 0) != ESP_OK) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  size_t uri_len = strlen(uri);
+  if (uri_len > HTTPD_MAX_URI_LEN) {
+    response->status = 414;
+    return ESP_ERR_HTTPD_INVALID_REQ;
+  }
+  const char* query = strchr(uri, '?');
+  size_t path_len = query ? (size_t)(query - uri) : uri_len;
+
+  const handler_t* match = NULL;
+  for (size_t i = 0; i < s_server->config.max_uri_handlers && !match; i++) {
+    const handler_t* handler = &s_server->handlers[i];
+    if (!handler->uri || handler->method != method) {
+      continue;
+    }
+    bool matched = s_server->config.uri_match_fn
+                       ? s_server->config.uri_match_fn(handler->uri, uri, path_len)
+                       : strlen(handler->uri) == path_len && strncmp(handler->uri, uri, path_len) == 0;
+    if (matched) {
+      match = handler;
+    }
+  }
+  if (!match) {
+    response->status = 404;
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  request_state_t state = {.body = body, .body_len = body_len, .body_read = 0, .response = response};
+  httpd_req_t req = {
+      .handle = s_server,
+      .method = method,
+      .content_len = body_len,
+      .aux = &state,
+      .user_ctx = match->user_ctx,
+  };
+  memcpy(req.uri, uri, uri_len + 1);
+  pthread_mutex_lock(&s_handler_lock);
+  esp_err_t ret = match->handler(&req);
+  pthread_mutex_unlock(&s_handler_lock);
+
+  // A detached request is answered from another thread; the response is complete once it is done
+  pthread_mutex_lock(&s_async_lock);
+  while (state.async) {
+    pthread_cond_wait(&s_async_done, &s_async_lock);
+  }
+  pthread_mutex_unlock(&s_async_lock);
+  return ret;
+}
+
+void httpd_mock_response_free(httpd_mock_response_t* response) {
+  free(response->body);
+  response->body = NULL;
+  response->body_len = 0;
+  response->body_capacity = 0;
+}
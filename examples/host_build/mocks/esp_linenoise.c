@@ -0,0 +1,98 @@
+#include "esp_linenoise.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "linenoise_mock.h"
+
+/// How long esp_linenoise_get_line() waits for a line before it returns ESP_ERR_TIMEOUT
+#define GET_LINE_WAIT_MS 10
+
+struct esp_linenoise_instance {
+  esp_linenoise_config_t config;
+};
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_line_pushed = PTHREAD_COND_INITIALIZER;
+static char* s_lines[LINENOISE_MOCK_MAX_LINES];
+static size_t s_head = 0;
+static size_t s_count = 0;
+
+void esp_linenoise_get_instance_config_default(esp_linenoise_config_t* config) {
+  memset(config, 0, sizeof(*config));
+  config->prompt = "> ";
+  config->in_fd = -1;
+  config->out_fd = -1;
+}
+
+esp_err_t esp_linenoise_create_instance(const esp_linenoise_config_t* config, esp_linenoise_handle_t* out_handle) {
+  if (!config || !out_handle) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_linenoise_handle_t handle = (esp_linenoise_handle_t)calloc(1, sizeof(*handle));
+  if (!handle) {
+    return ESP_ERR_NO_MEM;
+  }
+  handle->config = *config;
+  *out_handle = handle;
+  return ESP_OK;
+}
+
+esp_err_t esp_linenoise_delete_instance(esp_linenoise_handle_t handle) {
+  if (!handle) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  free(handle);
+  return ESP_OK;
+}
+
+esp_err_t esp_linenoise_get_line(esp_linenoise_handle_t handle, char* buf, size_t buf_size) {
+  if (!handle || !buf || buf_size == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += GET_LINE_WAIT_MS * 1000000L;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  pthread_mutex_lock(&s_lock);
+  while (s_count == 0) {
+    if (pthread_cond_timedwait(&s_line_pushed, &s_lock, &deadline) != 0) {
+      pthread_mutex_unlock(&s_lock);
+      return ESP_ERR_TIMEOUT;
+    }
+  }
+  char* line = s_lines[s_head];
+  s_head = (s_head + 1) % LINENOISE_MOCK_MAX_LINES;
+  s_count--;
+  pthread_mutex_unlock(&s_lock);
+
+  snprintf(buf, buf_size, "%s", line);
+  free(line);
+  return ESP_OK;
+}
+
+esp_err_t esp_linenoise_mock_push_line(const char* line) {
+  char* copy = strdup(line);
+  if (!copy) {
+    return ESP_ERR_NO_MEM;
+  }
+  pthread_mutex_lock(&s_lock);
+  if (s_count == LINENOISE_MOCK_MAX_LINES) {
+    pthread_mutex_unlock(&s_lock);
+    free(copy);
+    return ESP_ERR_NO_MEM;
+  }
+  s_lines[(s_head + s_count) % LINENOISE_MOCK_MAX_LINES] = copy;
+  s_count++;
+  pthread_cond_signal(&s_line_pushed);
+  pthread_mutex_unlock(&s_lock);
+  return ESP_OK;
+}
@@ -0,0 +1,29 @@
+#include "esp_log.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "esp_timer.h"
+
+static int s_level = -1;  // Read from ESP_LOG_LEVEL on first use
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) { s_level = level; }
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+  if (s_level < 0) {
+    const char* env = getenv("ESP_LOG_LEVEL");
+    s_level = env ? atoi(env) : ESP_LOG_INFO;
+  }
+  if ((int)level > s_level) {
+    return;
+  }
+
+  static const char letters[] = "NEWIDV";
+  fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000), tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "esp_chip_info.h"
+#include "esp_heap_caps.h"
+#include "esp_ota_ops.h"
+#include "esp_random.h"
+#include "esp_system.h"
+
+// About what an ESP32 running Wi-Fi and the HTTP server has left
+#define FREE_HEAP_BYTES (180 * 1024)
+#define MIN_FREE_HEAP_BYTES (150 * 1024)
+#define LARGEST_FREE_BLOCK_BYTES (110 * 1024)
+
+esp_reset_reason_t esp_reset_reason(void) { return ESP_RST_POWERON; }
+
+void esp_restart(void) {
+  fflush(stdout);
+  fprintf(stderr, "esp_restart()\n");
+  exit(0);
+}
+
+uint32_t esp_get_free_heap_size(void) { return FREE_HEAP_BYTES; }
+
+uint32_t esp_get_minimum_free_heap_size(void) { return MIN_FREE_HEAP_BYTES; }
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return LARGEST_FREE_BLOCK_BYTES; }
+
+void esp_chip_info(esp_chip_info_t* out_info) {
+  *out_info = (esp_chip_info_t){.model = CHIP_ESP32, .features = 0, .revision = 300, .cores = 2};
+}
+
+const esp_app_desc_t* esp_app_get_description(void) {
+  static const esp_app_desc_t desc = {
+      .version = "host",
+      .project_name = "host_build",
+      .time = __TIME__,
+      .date = __DATE__,
+      .idf_ver = "host",
+  };
+  return &desc;
+}
+
+uint32_t esp_random(void) { return ((uint32_t)random() << 16) ^ (uint32_t)random(); }
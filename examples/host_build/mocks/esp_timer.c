@@ -0,0 +1,15 @@
+#include "esp_timer.h"
+
+#include <time.h>
+
+static int64_t monotonic_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t s_start_us;
+
+__attribute__((constructor)) static void record_start(void) { s_start_us = monotonic_us(); }
+
+int64_t esp_timer_get_time(void) { return monotonic_us() - s_start_us; }
@@ -0,0 +1,202 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos_mock.h"
+
+struct tskTaskControlBlock {
+  TaskFunction_t function;
+  void* arg;
+  char name[configMAX_TASK_NAME_LEN];
+  pthread_mutex_t lock;
+  pthread_cond_t notified;
+  uint32_t notify_count;
+};
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_task_ended = PTHREAD_COND_INITIALIZER;
+static int s_running = 0;
+static __thread TaskHandle_t s_current = NULL;
+
+/**
+ * @brief Absolute CLOCK_REALTIME deadline ticks (milliseconds) from now, for pthread timed waits
+ */
+static struct timespec deadline_after(TickType_t ticks) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += ticks / 1000;
+  deadline.tv_nsec += (long)(ticks % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+  return deadline;
+}
+
+/**
+ * @brief Wait on cond until ready() or the deadline; portMAX_DELAY waits forever
+ *
+ * @return true if ready() holds on return
+ */
+static bool wait_until(pthread_cond_t* cond, pthread_mutex_t* lock, TickType_t ticks, bool (*ready)(void*),
+                       void* context) {
+  struct timespec deadline = deadline_after(ticks);
+  while (!ready(context)) {
+    if (ticks == portMAX_DELAY) {
+      pthread_cond_wait(cond, lock);
+    }
+    else if (pthread_cond_timedwait(cond, lock, &deadline) == ETIMEDOUT) {
+      return ready(context);
+    }
+  }
+  return true;
+}
+
+static void* task_main(void* param) {
+  TaskHandle_t task = (TaskHandle_t)param;
+  s_current = task;
+  task->function(task->arg);
+
+  pthread_mutex_lock(&s_lock);
+  s_running--;
+  pthread_cond_broadcast(&s_task_ended);
+  pthread_mutex_unlock(&s_lock);
+  pthread_cond_destroy(&task->notified);
+  pthread_mutex_destroy(&task->lock);
+  free(task);
+  return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* created_task, BaseType_t core_id) {
+  TaskHandle_t task = (TaskHandle_t)calloc(1, sizeof(*task));
+  if (!task) {
+    return pdFAIL;
+  }
+  task->function = function;
+  task->arg = arg;
+  snprintf(task->name, sizeof(task->name), "%s", name ? name : "");
+  pthread_mutex_init(&task->lock, NULL);
+  pthread_cond_init(&task->notified, NULL);
+
+  // As in FreeRTOS, the handle is stored before the task can run
+  if (created_task) {
+    *created_task = task;
+  }
+  pthread_mutex_lock(&s_lock);
+  s_running++;
+  pthread_mutex_unlock(&s_lock);
+
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, task_main, task) != 0) {
+    pthread_mutex_lock(&s_lock);
+    s_running--;
+    pthread_mutex_unlock(&s_lock);
+    if (created_task) {
+      *created_task = NULL;
+    }
+    free(task);
+    return pdFAIL;
+  }
+  pthread_detach(thread);
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task && task != s_current) {
+    fprintf(stderr, "vTaskDelete() of another task is not supported on the host\n");
+    abort();
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  struct timespec ts = {.tv_sec = ticks / 1000, .tv_nsec = (long)(ticks % 1000) * 1000000};
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+  }
+}
+
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(esp_timer_get_time() / 1000); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return s_current; }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  pthread_mutex_lock(&task->lock);
+  task->notify_count++;
+  pthread_cond_signal(&task->notified);
+  pthread_mutex_unlock(&task->lock);
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken) {
+  xTaskNotifyGive(task);
+  if (higher_priority_task_woken) {
+    *higher_priority_task_woken = pdTRUE;
+  }
+}
+
+static bool notified(void* context) { return ((TaskHandle_t)context)->notify_count > 0; }
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+  TaskHandle_t self = s_current;
+  if (!self) {
+    fprintf(stderr, "ulTaskNotifyTake() outside a task\n");
+    abort();
+  }
+  pthread_mutex_lock(&self->lock);
+  uint32_t count = 0;
+  if (wait_until(&self->notified, &self->lock, ticks, notified, self)) {
+    count = self->notify_count;
+    self->notify_count = clear_on_exit ? 0 : count - 1;
+  }
+  pthread_mutex_unlock(&self->lock);
+  return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max_count, UBaseType_t initial_count,
+                                                 StaticSemaphore_t* storage) {
+  pthread_mutex_init(&storage->lock, NULL);
+  pthread_cond_init(&storage->given, NULL);
+  storage->count = initial_count;
+  storage->max_count = max_count;
+  return storage;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  pthread_mutex_lock(&semaphore->lock);
+  BaseType_t ret = pdFALSE;
+  if (semaphore->count < semaphore->max_count) {
+    semaphore->count++;
+    pthread_cond_signal(&semaphore->given);
+    ret = pdTRUE;
+  }
+  pthread_mutex_unlock(&semaphore->lock);
+  return ret;
+}
+
+static bool available(void* context) { return ((SemaphoreHandle_t)context)->count > 0; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  pthread_mutex_lock(&semaphore->lock);
+  BaseType_t ret = pdFALSE;
+  if (wait_until(&semaphore->given, &semaphore->lock, ticks, available, semaphore)) {
+    semaphore->count--;
+    ret = pdTRUE;
+  }
+  pthread_mutex_unlock(&semaphore->lock);
+  return ret;
+}
+
+static bool no_tasks(void* context) { return s_running == 0; }
+
+bool freertos_mock_wait_tasks(uint32_t timeout_ms) {
+  pthread_mutex_lock(&s_lock);
+  bool idle = wait_until(&s_task_ended, &s_lock, timeout_ms, no_tasks, NULL);
+  pthread_mutex_unlock(&s_lock);
+  return idle;
+}
@@ -0,0 +1,71 @@
+#ifndef HOST_BUILD_DRIVER_UART_H
+#define HOST_BUILD_DRIVER_UART_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// No-ops: the host console reads lines from the linenoise mock, not from a UART
+
+typedef int uart_port_t;
+
+#define UART_NUM_0 0
+
+typedef enum {
+  UART_DATA_5_BITS,
+  UART_DATA_6_BITS,
+  UART_DATA_7_BITS,
+  UART_DATA_8_BITS,
+} uart_word_length_t;
+
+typedef enum {
+  UART_PARITY_DISABLE = 0,
+  UART_PARITY_EVEN = 2,
+  UART_PARITY_ODD = 3,
+} uart_parity_t;
+
+typedef enum {
+  UART_STOP_BITS_1 = 1,
+  UART_STOP_BITS_1_5 = 2,
+  UART_STOP_BITS_2 = 3,
+} uart_stop_bits_t;
+
+typedef enum {
+  UART_HW_FLOWCTRL_DISABLE = 0,
+  UART_HW_FLOWCTRL_RTS = 1,
+  UART_HW_FLOWCTRL_CTS = 2,
+  UART_HW_FLOWCTRL_CTS_RTS = 3,
+} uart_hw_flowcontrol_t;
+
+typedef int uart_sclk_t;
+
+typedef struct {
+  int baud_rate;
+  uart_word_length_t data_bits;
+  uart_parity_t parity;
+  uart_stop_bits_t stop_bits;
+  uart_hw_flowcontrol_t flow_ctrl;
+  uint8_t rx_flow_ctrl_thresh;
+  uart_sclk_t source_clk;
+  struct {
+    uint32_t allow_pd : 1;
+    uint32_t backup_before_sleep : 1;
+  } flags;
+} uart_config_t;
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t* uart_queue, int intr_alloc_flags);
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t* uart_config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_DRIVER_UART_H
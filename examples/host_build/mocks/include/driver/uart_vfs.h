@@ -0,0 +1,23 @@
+#ifndef HOST_BUILD_DRIVER_UART_VFS_H
+#define HOST_BUILD_DRIVER_UART_VFS_H
+
+#include "esp_err.h"
+#include "esp_vfs_dev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// No-ops, as driver/uart.h
+
+esp_err_t uart_vfs_dev_port_set_rx_line_endings(int uart_num, esp_line_endings_t mode);
+
+esp_err_t uart_vfs_dev_port_set_tx_line_endings(int uart_num, esp_line_endings_t mode);
+
+void uart_vfs_dev_use_driver(int uart_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_DRIVER_UART_VFS_H
@@ -0,0 +1,30 @@
+#ifndef HOST_BUILD_ESP_CHIP_INFO_H
+#define HOST_BUILD_ESP_CHIP_INFO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  CHIP_ESP32 = 1,
+} esp_chip_model_t;
+
+typedef struct {
+  esp_chip_model_t model;
+  uint32_t features;
+  uint16_t revision;
+  uint8_t cores;
+} esp_chip_info_t;
+
+/**
+ * @brief A dual-core ESP32, revision 3.0
+ */
+void esp_chip_info(esp_chip_info_t* out_info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_CHIP_INFO_H
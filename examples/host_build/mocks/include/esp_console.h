@@ -0,0 +1,75 @@
+#ifndef HOST_BUILD_ESP_CONSOLE_H
+#define HOST_BUILD_ESP_CONSOLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The command registry and esp_console_run() of the console component, without argtable: the
+// line is split on whitespace, with double quotes grouping words, and handed to the command
+
+typedef struct {
+  size_t max_cmdline_length;  ///< Longest line esp_console_run() accepts
+  size_t max_cmdline_args;    ///< Most words per line; later ones are dropped
+  uint32_t heap_alloc_caps;   ///< Ignored
+  int hint_color;             ///< Ignored
+  int hint_bold;              ///< Ignored
+} esp_console_config_t;
+
+typedef int (*esp_console_cmd_func_t)(int argc, char** argv);
+typedef int (*esp_console_cmd_func_with_context_t)(void* context, int argc, char** argv);
+
+typedef struct {
+  const char* command;                                 ///< Name, without spaces
+  const char* help;                                    ///< Printed by the help command
+  const char* hint;                                    ///< Printed after the name by help
+  esp_console_cmd_func_t func;                         ///< Handler, or NULL with func_w_context
+  void* argtable;                                      ///< Ignored
+  esp_console_cmd_func_with_context_t func_w_context;  ///< Handler that gets context
+  void* context;                                       ///< Passed to func_w_context
+} esp_console_cmd_t;
+
+/**
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if already initialized
+ */
+esp_err_t esp_console_init(const esp_console_config_t* config);
+
+/**
+ * @brief Drop every registered command
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t esp_console_deinit(void);
+
+/**
+ * @brief Register a command, replacing one with the same name
+ *
+ * The struct is copied; the strings it points to must outlive the registration.
+ */
+esp_err_t esp_console_cmd_register(const esp_console_cmd_t* cmd);
+
+/**
+ * @brief Split a line into words and run the command named by the first
+ *
+ * @param cmdline Line
+ * @param cmd_ret Receives the command's return value
+ * @return ESP_OK if a command ran, ESP_ERR_INVALID_ARG for an empty line, ESP_ERR_NOT_FOUND for
+ *         an unknown command, ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t esp_console_run(const char* cmdline, int* cmd_ret);
+
+/**
+ * @brief Register "help", which prints every command with its hint and help text
+ */
+esp_err_t esp_console_register_help_command(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_CONSOLE_H
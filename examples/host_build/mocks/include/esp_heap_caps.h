@@ -0,0 +1,24 @@
+#ifndef HOST_BUILD_ESP_HEAP_CAPS_H
+#define HOST_BUILD_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+
+/**
+ * @brief A fixed figure, like esp_get_free_heap_size()
+ */
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_HEAP_CAPS_H
@@ -0,0 +1,47 @@
+#ifndef HOST_BUILD_ESP_LINENOISE_H
+#define HOST_BUILD_ESP_LINENOISE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// There is no terminal: esp_linenoise_get_line() returns the lines a test queued with
+// esp_linenoise_mock_push_line() (see linenoise_mock.h), one per call
+
+typedef struct esp_linenoise_instance* esp_linenoise_handle_t;
+
+/**
+ * @brief The fields the components set; the mock reads none of them
+ */
+typedef struct {
+  const char* prompt;
+  bool allow_empty_line;
+  int in_fd;
+  int out_fd;
+  bool allow_dumb_mode;
+} esp_linenoise_config_t;
+
+void esp_linenoise_get_instance_config_default(esp_linenoise_config_t* config);
+
+esp_err_t esp_linenoise_create_instance(const esp_linenoise_config_t* config, esp_linenoise_handle_t* out_handle);
+
+esp_err_t esp_linenoise_delete_instance(esp_linenoise_handle_t handle);
+
+/**
+ * @brief Next queued line, without its newline
+ *
+ * @return ESP_OK, or ESP_ERR_TIMEOUT if no line was queued within a few milliseconds, which a
+ *         caller treats like a read error on the target
+ */
+esp_err_t esp_linenoise_get_line(esp_linenoise_handle_t handle, char* buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_LINENOISE_H
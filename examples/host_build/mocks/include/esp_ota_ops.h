@@ -0,0 +1,29 @@
+#ifndef HOST_BUILD_ESP_OTA_OPS_H
+#define HOST_BUILD_ESP_OTA_OPS_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The application description only; there are no partitions to update
+
+typedef struct {
+  char version[32];
+  char project_name[32];
+  char time[16];
+  char date[16];
+  char idf_ver[32];
+} esp_app_desc_t;
+
+/**
+ * @brief Version "host", project "host_build" and the build time of the mocks
+ */
+const esp_app_desc_t* esp_app_get_description(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_OTA_OPS_H
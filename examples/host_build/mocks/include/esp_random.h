@@ -0,0 +1,19 @@
+#ifndef HOST_BUILD_ESP_RANDOM_H
+#define HOST_BUILD_ESP_RANDOM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pseudo-random, from the C library; not for keys
+ */
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_RANDOM_H
@@ -0,0 +1,19 @@
+#ifndef HOST_BUILD_ESP_VFS_H
+#define HOST_BUILD_ESP_VFS_H
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Paths go straight to the host file system, so only the limits are needed
+
+#define ESP_VFS_PATH_MAX 15
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_VFS_H
@@ -0,0 +1,20 @@
+#ifndef HOST_BUILD_ESP_VFS_DEV_H
+#define HOST_BUILD_ESP_VFS_DEV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Line ending conversion of the console drivers; the host's stdio does none
+
+typedef enum {
+  ESP_LINE_ENDINGS_CRLF,
+  ESP_LINE_ENDINGS_CR,
+  ESP_LINE_ENDINGS_LF,
+} esp_line_endings_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_ESP_VFS_DEV_H
@@ -0,0 +1,53 @@
+#ifndef HOST_BUILD_FREERTOS_H
+#define HOST_BUILD_FREERTOS_H
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Only what the host-built components use: types, spinlock critical sections, tasks on host
+// threads (freertos/task.h) and semaphores (freertos/semphr.h)
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define configMAX_TASK_NAME_LEN 16
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+/**
+ * @brief Spinlock standing in for the ESP-IDF portMUX, safe across host threads
+ */
+typedef struct {
+  volatile int locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+static inline void vPortEnterCritical(portMUX_TYPE* mux) {
+  while (__atomic_exchange_n(&mux->locked, 1, __ATOMIC_ACQUIRE)) {
+  }
+}
+
+static inline void vPortExitCritical(portMUX_TYPE* mux) { __atomic_store_n(&mux->locked, 0, __ATOMIC_RELEASE); }
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_FREERTOS_H
@@ -0,0 +1,18 @@
+#ifndef HOST_BUILD_FREERTOS_QUEUE_H
+#define HOST_BUILD_FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The handle type only, for driver APIs that take an optional event queue
+
+typedef struct QueueDefinition* QueueHandle_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_FREERTOS_QUEUE_H
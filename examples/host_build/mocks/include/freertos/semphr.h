@@ -0,0 +1,46 @@
+#ifndef HOST_BUILD_FREERTOS_SEMPHR_H
+#define HOST_BUILD_FREERTOS_SEMPHR_H
+
+#include <pthread.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Counting and binary semaphores in caller-provided storage, on a pthread mutex and condition
+
+struct QueueDefinition {
+  pthread_mutex_t lock;
+  pthread_cond_t given;
+  UBaseType_t count;
+  UBaseType_t max_count;
+};
+
+typedef struct QueueDefinition StaticSemaphore_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max_count, UBaseType_t initial_count,
+                                                 StaticSemaphore_t* storage);
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* storage) {
+  return xSemaphoreCreateCountingStatic(1, 0, storage);
+}
+
+/**
+ * @return pdTRUE, or pdFALSE if the count is already at its maximum
+ */
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+/**
+ * @return pdTRUE, or pdFALSE if the semaphore was not given within ticks
+ */
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_FREERTOS_SEMPHR_H
@@ -0,0 +1,67 @@
+#ifndef HOST_BUILD_FREERTOS_TASK_H
+#define HOST_BUILD_FREERTOS_TASK_H
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tasks run on detached host threads. Stack size, priority and core are accepted and ignored.
+// vTaskDelete(NULL) returns, so a task ends when its function does; FreeRTOS code calls it last
+// anyway. freertos_mock.h waits for tasks to end.
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* arg);
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* created_task, BaseType_t core_id);
+
+static inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* arg,
+                                     UBaseType_t priority, TaskHandle_t* created_task) {
+  return xTaskCreatePinnedToCore(function, name, stack_depth, arg, priority, created_task, tskNO_AFFINITY);
+}
+
+/**
+ * @brief End the calling task; deleting another task is not supported and aborts
+ */
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+
+/**
+ * @brief Milliseconds since the program started, at configTICK_RATE_HZ 1000
+ */
+TickType_t xTaskGetTickCount(void);
+
+/**
+ * @brief The calling task, NULL on a thread that xTaskCreate() did not start (such as main)
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+/**
+ * @brief Increment the task's notification count, waking it if it waits in ulTaskNotifyTake()
+ */
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken);
+
+/**
+ * @brief Wait for the calling task's notification count to be non-zero
+ *
+ * @param clear_on_exit pdTRUE to reset the count to 0, pdFALSE to decrement it
+ * @param ticks Longest wait
+ * @return The count before it was cleared or decremented, 0 on timeout
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_FREERTOS_TASK_H
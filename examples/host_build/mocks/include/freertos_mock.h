@@ -0,0 +1,25 @@
+#ifndef HOST_BUILD_FREERTOS_MOCK_H
+#define HOST_BUILD_FREERTOS_MOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wait until every task started with xTaskCreate() has returned from its function
+ *
+ * Lets a test destroy what its tasks use only after they are gone.
+ *
+ * @param timeout_ms Longest wait
+ * @return true if no task is running any more
+ */
+bool freertos_mock_wait_tasks(uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_FREERTOS_MOCK_H
@@ -0,0 +1,56 @@
+#ifndef HOST_BUILD_HTTPD_MOCK_H
+#define HOST_BUILD_HTTPD_MOCK_H
+
+#include <stddef.h>
+
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Response captured from a handler by httpd_mock_request()
+ *
+ * Zero-initialize it before the first request. The body buffer is kept between requests, so
+ * a loop reusing one response does not allocate once the buffer has grown.
+ */
+typedef struct {
+  int status;             ///< Status code, 200 unless the handler set another one
+  char content_type[64];  ///< Last httpd_resp_set_type(), "text/html" by default like httpd
+  char* body;             ///< Response body, NUL-terminated
+  size_t body_len;        ///< Body length without the terminator
+  size_t body_capacity;   ///< Allocated size of body
+  size_t chunks;          ///< httpd_resp_send_chunk() calls, including the final empty one
+} httpd_mock_response_t;
+
+/**
+ * @brief Serve one request with the handlers registered on the running server
+ *
+ * Handlers are matched in registration order with the server's uri_match_fn (exact match if
+ * none), and the query string is ignored when matching, as in httpd.
+ * Like the single httpd task, only one handler runs at a time across threads.
+ * A handler that detaches the request with httpd_req_async_handler_begin() is waited for until
+ * the copy is completed, from whichever thread answers it.
+ *
+ * @param method Request method
+ * @param uri Request URI
+ * @param body Request body, may be NULL when body_len is 0
+ * @param body_len Request body length
+ * @param response Receives the response
+ * @return ESP_OK if a handler ran and returned ESP_OK, ESP_ERR_INVALID_STATE without a server,
+ *         ESP_ERR_NOT_FOUND (status 404) if no handler matched, or the handler's error
+ */
+esp_err_t httpd_mock_request(httpd_method_t method, const char* uri, const char* body, size_t body_len,
+                             httpd_mock_response_t* response);
+
+/**
+ * @brief Free the body buffer of a response
+ */
+void httpd_mock_response_free(httpd_mock_response_t* response);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_HTTPD_MOCK_H
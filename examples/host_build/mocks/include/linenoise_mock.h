@@ -0,0 +1,24 @@
+#ifndef HOST_BUILD_LINENOISE_MOCK_H
+#define HOST_BUILD_LINENOISE_MOCK_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Lines esp_linenoise_mock_push_line() holds until they are read
+#define LINENOISE_MOCK_MAX_LINES 16
+
+/**
+ * @brief Queue a line for esp_linenoise_get_line(), as if typed and followed by Enter
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM when LINENOISE_MOCK_MAX_LINES lines are waiting
+ */
+esp_err_t esp_linenoise_mock_push_line(const char* line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_LINENOISE_MOCK_H
@@ -0,0 +1,37 @@
+#ifndef HOST_BUILD_MBEDTLS_SHA256_H
+#define HOST_BUILD_MBEDTLS_SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief SHA-256 state; the fields are internal to the mock
+ */
+typedef struct {
+  uint32_t state[8];
+  uint64_t total;      // Bytes hashed so far
+  uint8_t buffer[64];  // Partial block
+  size_t buffered;     // Bytes in buffer
+} mbedtls_sha256_context;
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx);
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx);
+
+/**
+ * @brief Start a digest; only SHA-256 (is224 == 0) is supported
+ *
+ * @return 0, or -1 for SHA-224
+ */
+int mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224);
+int mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t ilen);
+int mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char output[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_MBEDTLS_SHA256_H
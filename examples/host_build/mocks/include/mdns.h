@@ -0,0 +1,33 @@
+#ifndef HOST_BUILD_MDNS_H
+#define HOST_BUILD_MDNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// No-op responder: every call succeeds and nothing is advertised. mdns_mock.h reports the service port.
+
+typedef struct {
+  const char* key;
+  const char* value;
+} mdns_txt_item_t;
+
+esp_err_t mdns_init(void);
+void mdns_free(void);
+esp_err_t mdns_hostname_set(const char* hostname);
+esp_err_t mdns_instance_name_set(const char* instance_name);
+esp_err_t mdns_service_add(const char* instance_name, const char* service_type, const char* proto, uint16_t port,
+                           mdns_txt_item_t txt[], size_t num_items);
+esp_err_t mdns_service_remove(const char* service_type, const char* proto);
+esp_err_t mdns_service_txt_item_set(const char* service_type, const char* proto, const char* key, const char* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_MDNS_H
@@ -0,0 +1,19 @@
+#ifndef HOST_BUILD_MDNS_MOCK_H
+#define HOST_BUILD_MDNS_MOCK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Port of the service last passed to mdns_service_add(), 0 if none or after removal
+ */
+uint16_t mdns_mock_service_port(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_MDNS_MOCK_H
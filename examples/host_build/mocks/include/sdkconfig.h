@@ -0,0 +1,28 @@
+#ifndef HOST_BUILD_SDKCONFIG_H
+#define HOST_BUILD_SDKCONFIG_H
+
+// Component defaults from the Kconfig files, as menuconfig would write them. CONFIG_PM_ENABLE
+// is off: the host has no frequency scaling, so pm_activity only counts.
+
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_FREERTOS_NUMBER_OF_CORES 2
+
+#define CONFIG_SHARED_HTTPD_MAX_OPEN_SOCKETS 7
+#define CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS 16
+#define CONFIG_SHARED_HTTPD_STACK_SIZE 8192
+#define CONFIG_SHARED_HTTPD_LRU_PURGE 1
+
+#define CONFIG_PM_ACTIVITY_MIN_FREQ_MHZ 40
+
+#define CONFIG_EXECUTOR_WORKER_STACK_SIZE 4096
+#define CONFIG_EXECUTOR_WORKER_PRIORITY 5
+#define CONFIG_EXECUTOR_DEQUE_SIZE 64
+#define CONFIG_EXECUTOR_INBOX_SIZE 32
+
+// Console on UART0, which the host stands in for with the linenoise mock
+#define CONFIG_ESP_CONSOLE_UART_DEFAULT 1
+#define CONFIG_ESP_CONSOLE_UART_BAUDRATE 115200
+#define CONFIG_SIMPLE_CLI_TASK_STACK_SIZE 4096
+
+#endif  // HOST_BUILD_SDKCONFIG_H
@@ -0,0 +1,20 @@
+#ifndef HOST_BUILD_STRLCPY_H
+#define HOST_BUILD_STRLCPY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// newlib declares these in string.h, glibc only from 2.38. The build force-includes this header
+// when the C library lacks them.
+
+size_t strlcpy(char* dst, const char* src, size_t size);
+size_t strlcat(char* dst, const char* src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HOST_BUILD_STRLCPY_H
@@ -0,0 +1,12 @@
+#include "mcp_transport_socket.h"
+
+#include "esp_log.h"
+
+static const char* TAG = "mcp_socket";
+
+// The lwIP transport runs its own select() task; the host build serves MCP through the httpd
+// transport and httpd_mock_request() instead
+mcp_transport_t* mcp_transport_socket_create(void) {
+  ESP_LOGE(TAG, "The lwIP socket transport is not available in the host build");
+  return NULL;
+}
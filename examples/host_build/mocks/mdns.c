@@ -0,0 +1,30 @@
+#include "mdns.h"
+
+#include "mdns_mock.h"
+
+static uint16_t s_service_port = 0;
+
+esp_err_t mdns_init(void) { return ESP_OK; }
+
+void mdns_free(void) {}
+
+esp_err_t mdns_hostname_set(const char* hostname) { return ESP_OK; }
+
+esp_err_t mdns_instance_name_set(const char* instance_name) { return ESP_OK; }
+
+esp_err_t mdns_service_add(const char* instance_name, const char* service_type, const char* proto, uint16_t port,
+                           mdns_txt_item_t txt[], size_t num_items) {
+  s_service_port = port;
+  return ESP_OK;
+}
+
+esp_err_t mdns_service_remove(const char* service_type, const char* proto) {
+  s_service_port = 0;
+  return ESP_OK;
+}
+
+esp_err_t mdns_service_txt_item_set(const char* service_type, const char* proto, const char* key, const char* value) {
+  return ESP_OK;
+}
+
+uint16_t mdns_mock_service_port(void) { return s_service_port; }
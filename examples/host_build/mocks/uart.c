@@ -0,0 +1,15 @@
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t* uart_queue, int intr_alloc_flags) {
+  return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t* uart_config) { return ESP_OK; }
+
+esp_err_t uart_vfs_dev_port_set_rx_line_endings(int uart_num, esp_line_endings_t mode) { return ESP_OK; }
+
+esp_err_t uart_vfs_dev_port_set_tx_line_endings(int uart_num, esp_line_endings_t mode) { return ESP_OK; }
+
+void uart_vfs_dev_use_driver(int uart_num) {}
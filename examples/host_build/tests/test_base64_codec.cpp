@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base64_codec.h"
+
+static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static std::string random_bytes(size_t len) {
+  std::string s(len, '\0');
+  uint32_t seed = 12345;
+  for (char& c : s) {
+    seed = seed * 1664525 + 1013904223;
+    c = (char)(seed >> 24);
+  }
+  return s;
+}
+
+/**
+ * @brief Bit-at-a-time encoder, the reference for the codec
+ */
+static std::string encode_reference(const std::string& in) {
+  std::string out;
+  uint32_t bits = 0;
+  int nbits = 0;
+  for (unsigned char c : in) {
+    bits = bits << 8 | c;
+    nbits += 8;
+    while (nbits >= 6) {
+      nbits -= 6;
+      out += ALPHABET[(bits >> nbits) & 0x3F];
+    }
+  }
+  if (nbits) {
+    out += ALPHABET[(bits << (6 - nbits)) & 0x3F];
+  }
+  while (out.size() % 4) {
+    out += '=';
+  }
+  return out;
+}
+
+static std::string encode(const std::string& in) {
+  std::string out(BASE64_ENCODED_LEN(in.size()), '\0');
+  out.resize(base64_encode(out.data(), in.data(), in.size()));
+  return out;
+}
+
+static esp_err_t decode(const std::string& in, std::string* out) {
+  out->assign(BASE64_DECODED_MAX(in.size()), '\0');
+  size_t len = 0;
+  esp_err_t ret = base64_decode(out->data(), out->size(), in.data(), in.size(), &len);
+  out->resize(len);
+  return ret;
+}
+
+/**
+ * @brief Encode in with base64_encode_update() calls of the given sizes in turn
+ *
+ * A size of 0 makes an empty call.
+ */
+static std::string encode_in_parts(const std::string& in, const std::vector<size_t>& parts) {
+  std::string out(BASE64_ENCODED_LEN(in.size()) + 4, '\0');
+  base64_encoder_t encoder;
+  base64_encoder_init(&encoder);
+  size_t n = 0;
+  for (size_t pos = 0, p = 0; pos < in.size(); p++) {
+    size_t part = std::min(parts[p % parts.size()], in.size() - pos);
+    size_t written = base64_encode_update(&encoder, out.data() + n, in.data() + pos, part);
+    EXPECT_EQ(written % 4, 0u);
+    n += written;
+    pos += part;
+  }
+  n += base64_encode_final(&encoder, out.data() + n);
+  out.resize(n);
+  return out;
+}
+
+/**
+ * @brief Decode text onto itself with base64_decode_update() calls of the given sizes in turn
+ *
+ * A size of 0 makes an empty call, as a transport may.
+ */
+static esp_err_t decode_in_parts(std::string text, const std::vector<size_t>& parts, std::string* out) {
+  base64_decoder_t decoder;
+  base64_decoder_init(&decoder);
+  size_t n = 0;
+  esp_err_t ret = ESP_OK;
+  for (size_t pos = 0, p = 0; pos < text.size() && ret == ESP_OK; p++) {
+    size_t part = std::min(parts[p % parts.size()], text.size() - pos);
+    size_t written = 0;
+    ret = base64_decode_update(&decoder, text.data() + n, text.size() - n, text.data() + pos, part, &written);
+    n += written;
+    pos += part;
+  }
+  out->assign(text.data(), n);
+  return ret != ESP_OK ? ret : base64_decode_final(&decoder);
+}
+
+static esp_err_t append_chunk(void* ctx, const char* data, size_t len) {
+  static_cast<std::vector<std::string>*>(ctx)->emplace_back(data, len);
+  return ESP_OK;
+}
+
+TEST(Base64Codec, Rfc4648Vectors) {
+  static const char* const VECTORS[][2] = {
+      {"", ""},           {"f", "Zg=="},         {"fo", "Zm8="},          {"foo", "Zm9v"},
+      {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+  };
+  for (const auto& vector : VECTORS) {
+    std::string decoded;
+    EXPECT_EQ(encode(vector[0]), vector[1]);
+    EXPECT_EQ(decode(vector[1], &decoded), ESP_OK) << vector[1];
+    EXPECT_EQ(decoded, vector[0]);
+  }
+}
+
+TEST(Base64Codec, MatchesTheBitwiseEncoderAtEveryLengthAndAlignment) {
+  const std::string data = random_bytes(64 + 3);
+  for (size_t offset = 0; offset < 4; offset++) {
+    for (size_t len = 0; len <= 64; len++) {
+      std::string in = data.substr(offset, len);
+      std::string out(BASE64_ENCODED_LEN(len) + 3, '\0');
+      size_t n = base64_encode(out.data() + offset, data.data() + offset, len);
+      ASSERT_EQ(out.substr(offset, n), encode_reference(in)) << "length " << len << ", offset " << offset;
+
+      std::string decoded;
+      ASSERT_EQ(decode(encode_reference(in), &decoded), ESP_OK);
+      ASSERT_EQ(decoded, in) << "length " << len;
+    }
+  }
+}
+
+TEST(Base64Codec, DecodesUnpaddedAndWrappedText) {
+  const std::string data = random_bytes(64);
+  for (size_t len = 0; len <= 64; len++) {
+    std::string in = data.substr(0, len);
+    std::string text = encode(in);
+    std::string decoded;
+    EXPECT_EQ(decode(text.substr(0, text.find('=')), &decoded), ESP_OK);
+    EXPECT_EQ(decoded, in) << "unpadded, length " << len;
+
+    std::string wrapped;
+    for (size_t i = 0; i < text.size(); i++) {
+      wrapped += text[i];
+      wrapped += i % 5 == 4 ? "\r\n" : i % 7 == 6 ? " \t" : "";
+    }
+    EXPECT_EQ(decode(wrapped, &decoded), ESP_OK);
+    EXPECT_EQ(decoded, in) << "wrapped, length " << len;
+  }
+}
+
+TEST(Base64Codec, StreamingEncodeAcrossChunkBoundaries) {
+  const std::string data = random_bytes(64);
+  for (size_t len = 0; len <= 64; len++) {
+    std::string in = data.substr(0, len);
+    std::string text = encode(in);
+    for (size_t split = 0; split <= len; split++) {
+      EXPECT_EQ(encode_in_parts(in, {split, len}), text) << "split at " << split;
+    }
+    for (size_t part = 1; part <= 7; part++) {
+      EXPECT_EQ(encode_in_parts(in, {part}), text) << "parts of " << part;
+    }
+    EXPECT_EQ(encode_in_parts(in, {1, 2, 0, 4, 5}), text);
+  }
+}
+
+TEST(Base64Codec, WriterSendsFullChunksThenTheRest) {
+  const std::string in = random_bytes(100);
+  const std::string text = encode(in);
+  for (size_t size : {4, 5, 8, 64, 256}) {
+    for (size_t write : {1, 2, 3, 7, 100}) {
+      std::vector<std::string> chunks;
+      std::vector<char> buf(size);
+      base64_writer_t writer;
+      base64_writer_init(&writer, buf.data(), buf.size(), append_chunk, &chunks);
+      for (size_t pos = 0; pos < in.size(); pos += write) {
+        ASSERT_EQ(base64_writer_write(&writer, in.data() + pos, std::min(write, in.size() - pos)), ESP_OK);
+      }
+      ASSERT_EQ(base64_writer_finish(&writer), ESP_OK);
+
+      std::string joined;
+      for (size_t i = 0; i < chunks.size(); i++) {
+        if (i + 1 < chunks.size()) {
+          EXPECT_EQ(chunks[i].size(), size / 4 * 4) << "chunk " << i << " of " << size << "-character buffer";
+        }
+        joined += chunks[i];
+      }
+      EXPECT_EQ(joined, text) << size << "-character buffer, writes of " << write;
+    }
+  }
+}
+
+TEST(Base64Codec, WriterStopsOnSinkError) {
+  char buf[8];
+  int calls = 0;
+  auto failing = [](void* ctx, const char* data, size_t len) -> esp_err_t {
+    ++*static_cast<int*>(ctx);
+    return ESP_FAIL;
+  };
+  base64_writer_t writer;
+  base64_writer_init(&writer, buf, sizeof(buf), failing, &calls);
+  EXPECT_EQ(base64_writer_write(&writer, "0123456789", 10), ESP_FAIL);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(Base64Codec, DecodesInPlace) {
+  const std::string data = random_bytes(64);
+  for (size_t len = 0; len <= 64; len++) {
+    std::string in = data.substr(0, len);
+    std::string buf = encode(in);
+    size_t out_len = 0;
+    ASSERT_EQ(base64_decode_in_place(buf.data(), buf.size(), &out_len), ESP_OK);
+    EXPECT_EQ(buf.substr(0, out_len), in) << "length " << len;
+  }
+}
+
+TEST(Base64Codec, StreamingDecodeInPlaceSplitAnywhere) {
+  const std::string in = random_bytes(40);
+  std::string wrapped;
+  for (char c : encode(in)) {
+    wrapped += c;
+    wrapped += c == 'A' ? "\n" : "";
+  }
+  std::string decoded;
+  for (size_t split = 0; split <= wrapped.size(); split++) {
+    EXPECT_EQ(decode_in_parts(wrapped, {split, wrapped.size()}, &decoded), ESP_OK);
+    EXPECT_EQ(decoded, in) << "split at " << split;
+  }
+  for (size_t part = 1; part <= 5; part++) {
+    EXPECT_EQ(decode_in_parts(wrapped, {part}, &decoded), ESP_OK);
+    EXPECT_EQ(decoded, in) << "parts of " << part;
+  }
+  // The padding may arrive in a later call than the group it ends
+  EXPECT_EQ(decode_in_parts("Zm8=", {3, 1}, &decoded), ESP_OK);
+  EXPECT_EQ(decoded, "fo");
+  EXPECT_EQ(decode_in_parts("Zg==", {2, 1, 1}, &decoded), ESP_OK);
+  EXPECT_EQ(decoded, "f");
+}
+
+TEST(Base64Codec, RejectsMalformedInput) {
+  static const char* const MALFORMED[] = {
+      "Zm9v!", "Zm9v\x80", "Zm-v", "Zm_v",  // Characters outside the alphabet
+      "Zg==Zg==", "Zg=a", "Zm=v",           // Data after padding
+  };
+  std::string decoded;
+  for (const char* text : MALFORMED) {
+    EXPECT_EQ(decode(text, &decoded), ESP_ERR_INVALID_ARG) << text;
+  }
+  EXPECT_EQ(decode(std::string("Zm9v\0Zm9v", 9), &decoded), ESP_ERR_INVALID_ARG);
+}
+
+TEST(Base64Codec, RejectsTruncatedInput) {
+  std::string decoded;
+  for (const char* text : {"Z", "Zm9vY", "Zm9vYmFyZ", "Zm9v\nY\n"}) {
+    EXPECT_EQ(decode(text, &decoded), ESP_ERR_INVALID_ARG) << text;
+    EXPECT_EQ(decode_in_parts(text, {1}, &decoded), ESP_ERR_INVALID_ARG) << text;
+  }
+}
+
+TEST(Base64Codec, RejectsWrongPadding) {
+  std::string decoded;
+  for (const char* text : {"=", "Z=", "Z===", "=Zg=", "Zg=", "Zm8==", "Zg===", "Zm9v====", "Zm9vY==="}) {
+    EXPECT_EQ(decode(text, &decoded), ESP_ERR_INVALID_ARG) << text;
+    EXPECT_EQ(decode_in_parts(text, {1}, &decoded), ESP_ERR_INVALID_ARG) << text;
+  }
+}
+
+TEST(Base64Codec, RejectsTooSmallOutput) {
+  char small[2];
+  size_t out_len = 0;
+  EXPECT_EQ(base64_decode(small, sizeof(small), "Zm9v", 4, &out_len), ESP_ERR_INVALID_SIZE);
+  EXPECT_LE(out_len, sizeof(small));
+  EXPECT_EQ(base64_decode(small, sizeof(small), "Zm8=", 4, &out_len), ESP_OK);
+  EXPECT_EQ(std::string(small, out_len), "fo");
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "checksum.h"
+
+static std::string random_bytes(size_t len) {
+  std::string s(len, '\0');
+  uint32_t seed = 54321;
+  for (char& c : s) {
+    seed = seed * 1664525 + 1013904223;
+    c = (char)(seed >> 24);
+  }
+  return s;
+}
+
+/**
+ * @brief Bit-at-a-time CRC-32, the reference for the table loop
+ */
+static uint32_t crc32_bitwise(uint32_t crc, const void* data, size_t len) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= p[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static std::vector<uint8_t> compute(checksum_type_t type, const std::string& data) {
+  std::vector<uint8_t> digest(checksum_digest_len(type));
+  EXPECT_EQ(checksum_compute(type, data.data(), data.size(), digest.data()), ESP_OK);
+  return digest;
+}
+
+/**
+ * @brief Feed data to checksum_update() in parts of the given sizes in turn, 0 making an empty call
+ */
+static std::vector<uint8_t> compute_in_parts(checksum_type_t type, const std::string& data,
+                                             const std::vector<size_t>& parts) {
+  checksum_t ctx;
+  EXPECT_EQ(checksum_init(&ctx, type), ESP_OK);
+  for (size_t pos = 0, p = 0; pos < data.size(); p++) {
+    size_t part = std::min(parts[p % parts.size()], data.size() - pos);
+    EXPECT_EQ(checksum_update(&ctx, data.data() + pos, part), ESP_OK);
+    pos += part;
+  }
+  std::vector<uint8_t> digest(checksum_digest_len(type));
+  EXPECT_EQ(checksum_final(&ctx, digest.data()), ESP_OK);
+  return digest;
+}
+
+static std::string hex(const std::vector<uint8_t>& digest) {
+  std::string text;
+  for (uint8_t byte : digest) {
+    text += "0123456789abcdef"[byte >> 4];
+    text += "0123456789abcdef"[byte & 15];
+  }
+  return text;
+}
+
+TEST(Crc32, CheckValue) {
+  EXPECT_EQ(checksum_crc32_sw(0, "123456789", 9), 0xCBF43926u);
+  EXPECT_EQ(checksum_crc32(0, "123456789", 9), 0xCBF43926u);
+  EXPECT_EQ(checksum_crc32_sw(0, "", 0), 0u);
+  EXPECT_STREQ(checksum_crc32_backend(), "slice4");
+}
+
+TEST(Crc32, SliceMatchesBitwiseAtEveryOffsetAndTailLength) {
+  const std::string data = random_bytes(1436 + 8 + 3);
+  std::vector<size_t> lengths;
+  for (size_t len = 0; len <= 64; len++) {
+    lengths.push_back(len);
+  }
+  for (size_t tail = 0; tail < 8; tail++) {
+    lengths.push_back(1436 + tail);
+  }
+  for (size_t offset = 0; offset < 4; offset++) {
+    for (size_t len : lengths) {
+      const char* p = data.data() + offset;
+      uint32_t want = crc32_bitwise(0, p, len);
+      ASSERT_EQ(checksum_crc32_sw(0, p, len), want) << "offset " << offset << ", length " << len;
+      ASSERT_EQ(checksum_crc32(0, p, len), want) << "offset " << offset << ", length " << len;
+    }
+  }
+}
+
+TEST(Crc32, ChainsAcrossEverySplit) {
+  const std::string data = random_bytes(64);
+  for (size_t len = 0; len <= 64; len++) {
+    uint32_t want = crc32_bitwise(0, data.data(), len);
+    for (size_t split = 0; split <= len; split++) {
+      uint32_t crc = checksum_crc32_sw(0, data.data(), split);
+      ASSERT_EQ(checksum_crc32_sw(crc, data.data() + split, len - split), want)
+          << "length " << len << ", split at " << split;
+    }
+  }
+}
+
+TEST(Checksum, Crc32DigestIsBigEndian) {
+  EXPECT_EQ(hex(compute(CHECKSUM_CRC32, "123456789")), "cbf43926");
+  EXPECT_EQ(hex(compute(CHECKSUM_CRC32, "")), "00000000");
+}
+
+TEST(Checksum, Sha256Vectors) {
+  EXPECT_EQ(hex(compute(CHECKSUM_SHA256, "")), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  EXPECT_EQ(hex(compute(CHECKSUM_SHA256, "abc")), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  EXPECT_EQ(hex(compute(CHECKSUM_SHA256, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST(Checksum, AnySplitGivesTheSameDigest) {
+  const std::string data = random_bytes(300);
+  static const std::vector<size_t> PARTS[] = {{1}, {2, 3}, {0, 7, 0, 5}, {63, 1, 64, 65}, {150}, {300}};
+  for (checksum_type_t type : {CHECKSUM_CRC32, CHECKSUM_SHA256}) {
+    const std::vector<uint8_t> whole = compute(type, data);
+    for (const std::vector<size_t>& parts : PARTS) {
+      EXPECT_EQ(compute_in_parts(type, data, parts), whole) << checksum_name(type) << ", parts of " << parts[0];
+    }
+    for (size_t split = 0; split <= 70; split++) {
+      EXPECT_EQ(compute_in_parts(type, data, {split, data.size()}), whole)
+          << checksum_name(type) << ", split at " << split;
+    }
+  }
+}
+
+TEST(Checksum, VerifyComparesWithTheExpectedDigest) {
+  const std::string data = random_bytes(1000);
+  for (checksum_type_t type : {CHECKSUM_CRC32, CHECKSUM_SHA256}) {
+    std::vector<uint8_t> expected = compute(type, data);
+    checksum_t ctx;
+
+    ASSERT_EQ(checksum_init(&ctx, type), ESP_OK);
+    ASSERT_EQ(checksum_update(&ctx, data.data(), 333), ESP_OK);
+    ASSERT_EQ(checksum_update(&ctx, data.data() + 333, data.size() - 333), ESP_OK);
+    EXPECT_EQ(checksum_verify(&ctx, expected.data(), expected.size()), ESP_OK) << checksum_name(type);
+
+    for (size_t byte : {(size_t)0, expected.size() - 1}) {
+      std::vector<uint8_t> wrong = expected;
+      wrong[byte] ^= 0x01;
+      ASSERT_EQ(checksum_init(&ctx, type), ESP_OK);
+      ASSERT_EQ(checksum_update(&ctx, data.data(), data.size()), ESP_OK);
+      EXPECT_EQ(checksum_verify(&ctx, wrong.data(), wrong.size()), ESP_ERR_INVALID_CRC) << checksum_name(type);
+    }
+
+    ASSERT_EQ(checksum_init(&ctx, type), ESP_OK);
+    ASSERT_EQ(checksum_update(&ctx, data.data(), data.size()), ESP_OK);
+    EXPECT_EQ(checksum_verify(&ctx, expected.data(), expected.size() - 1), ESP_ERR_INVALID_SIZE);
+  }
+}
+
+TEST(Checksum, UnknownTypeIsRejected) {
+  checksum_t ctx;
+  EXPECT_EQ(checksum_init(&ctx, (checksum_type_t)7), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(checksum_digest_len((checksum_type_t)7), 0u);
+  EXPECT_STREQ(checksum_name((checksum_type_t)7), "unknown");
+}
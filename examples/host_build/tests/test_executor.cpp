@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "executor.h"
+#include "executor_deque.h"
+#include "freertos_mock.h"
+#include "lockfree_queue.h"
+
+static job_t make_job(uintptr_t id) { return job_t{nullptr, reinterpret_cast<void*>(id), nullptr}; }
+
+static uintptr_t job_id(const job_t& job) { return reinterpret_cast<uintptr_t>(job.arg); }
+
+TEST(ExecutorDeque, OwnerTakesNewestThiefStealsOldest) {
+  deque_t deque = {};
+  for (uintptr_t i = 0; i < 4; i++) {
+    job_t job = make_job(i);
+    ASSERT_TRUE(deque_push(&deque, &job));
+  }
+  job_t job;
+  ASSERT_TRUE(deque_take(&deque, &job));
+  EXPECT_EQ(job_id(job), 3u);
+  ASSERT_TRUE(deque_steal(&deque, &job));
+  EXPECT_EQ(job_id(job), 0u);
+  ASSERT_TRUE(deque_take(&deque, &job));
+  EXPECT_EQ(job_id(job), 2u);
+  ASSERT_TRUE(deque_steal(&deque, &job));
+  EXPECT_EQ(job_id(job), 1u);
+  EXPECT_FALSE(deque_take(&deque, &job));
+  EXPECT_FALSE(deque_steal(&deque, &job));
+}
+
+TEST(ExecutorDeque, FullAtCapacity) {
+  deque_t deque = {};
+  job_t job = make_job(0);
+  for (int i = 0; i < EXECUTOR_DEQUE_SIZE; i++) {
+    ASSERT_TRUE(deque_push(&deque, &job));
+  }
+  EXPECT_FALSE(deque_push(&deque, &job));
+  ASSERT_TRUE(deque_steal(&deque, &job));
+  EXPECT_TRUE(deque_push(&deque, &job));
+}
+
+TEST(ExecutorDeque, IndicesWrapAround) {
+  deque_t deque = {};
+  uintptr_t next_id = 0;
+  uintptr_t next_stolen = 0;
+  for (int round = 0; round < 10 * EXECUTOR_DEQUE_SIZE; round++) {
+    // Three in, the newest two taken, the oldest left for a thief: top and bottom both advance
+    for (int i = 0; i < 3; i++) {
+      job_t job = make_job(next_id++);
+      ASSERT_TRUE(deque_push(&deque, &job));
+    }
+    job_t job;
+    ASSERT_TRUE(deque_take(&deque, &job));
+    EXPECT_EQ(job_id(job), next_id - 1);
+    ASSERT_TRUE(deque_take(&deque, &job));
+    EXPECT_EQ(job_id(job), next_id - 2);
+    ASSERT_TRUE(deque_steal(&deque, &job));
+    EXPECT_EQ(job_id(job), next_stolen);
+    next_stolen += 3;
+  }
+}
+
+// Owner and thief race for a deque holding one job; exactly one of them must get it
+TEST(ExecutorDeque, LastJobGoesToExactlyOneSide) {
+  constexpr uintptr_t ROUNDS = 200000;
+  deque_t deque = {};
+  std::unique_ptr<std::atomic<int>[]> got(new std::atomic<int>[ROUNDS]());
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> stolen{0};
+
+  std::thread thief([&] {
+    job_t job;
+    while (!done.load(std::memory_order_relaxed)) {
+      if (deque_steal(&deque, &job)) {
+        got[job_id(job)]++;
+        stolen++;
+      }
+    }
+  });
+  for (uintptr_t i = 0; i < ROUNDS; i++) {
+    job_t job = make_job(i);
+    ASSERT_TRUE(deque_push(&deque, &job));
+    if (deque_take(&deque, &job)) {
+      ASSERT_EQ(job_id(job), i);
+      got[i]++;
+    }
+  }
+  done = true;
+  thief.join();
+
+  for (uintptr_t i = 0; i < ROUNDS; i++) {
+    ASSERT_EQ(got[i].load(), 1) << "job " << i;
+  }
+  RecordProperty("stolen", stolen.load());
+}
+
+// Bursts of jobs taken by the owner while two thieves steal; every job is run exactly once
+TEST(ExecutorDeque, BurstsWithTwoThieves) {
+  constexpr uintptr_t JOBS = 200000;
+  deque_t deque = {};
+  std::unique_ptr<std::atomic<int>[]> got(new std::atomic<int>[JOBS]());
+  std::atomic<bool> done{false};
+
+  auto steal_loop = [&] {
+    job_t job;
+    while (!done.load(std::memory_order_relaxed)) {
+      if (deque_steal(&deque, &job)) {
+        got[job_id(job)]++;
+      }
+    }
+  };
+  std::thread thief1(steal_loop);
+  std::thread thief2(steal_loop);
+  uintptr_t next_id = 0;
+  while (next_id < JOBS) {
+    uintptr_t burst = 1 + next_id % 8;
+    for (uintptr_t i = 0; i < burst && next_id < JOBS; i++) {
+      job_t job = make_job(next_id++);
+      ASSERT_TRUE(deque_push(&deque, &job));
+    }
+    job_t job;
+    while (deque_take(&deque, &job)) {
+      got[job_id(job)]++;
+    }
+  }
+  // A take that lost the last job to a thief returns false, so the deque may still be draining
+  job_t job;
+  while (deque_steal(&deque, &job)) {
+    got[job_id(job)]++;
+  }
+  done = true;
+  thief1.join();
+  thief2.join();
+
+  for (uintptr_t i = 0; i < JOBS; i++) {
+    ASSERT_EQ(got[i].load(), 1) << "job " << i;
+  }
+}
+
+// The worker inbox: an MPSC ring of jobs that every producer pushes to without waiting
+TEST(ExecutorInbox, ManyProducersOneConsumer) {
+  constexpr uintptr_t PRODUCERS = 4;
+  constexpr uintptr_t PER_PRODUCER = 50000;
+  constexpr uint32_t CAPACITY = CONFIG_EXECUTOR_INBOX_SIZE;
+  lfq_mpsc_t inbox;
+  uint32_t seq[CAPACITY];
+  job_t jobs[CAPACITY];
+  ASSERT_EQ(lfq_mpsc_init(&inbox, seq, jobs, sizeof(job_t), CAPACITY), ESP_OK);
+
+  std::vector<std::thread> producers;
+  for (uintptr_t p = 0; p < PRODUCERS; p++) {
+    producers.emplace_back([&, p] {
+      for (uintptr_t i = 0; i < PER_PRODUCER; i++) {
+        job_t job = make_job(p << 24 | i);
+        while (!lfq_mpsc_push(&inbox, &job)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Each producer's jobs arrive in the order it pushed them
+  std::vector<uintptr_t> next(PRODUCERS, 0);
+  for (uintptr_t received = 0; received < PRODUCERS * PER_PRODUCER;) {
+    job_t job;
+    if (!lfq_mpsc_pop(&inbox, &job)) {
+      std::this_thread::yield();
+      continue;
+    }
+    uintptr_t producer = job_id(job) >> 24;
+    ASSERT_LT(producer, PRODUCERS);
+    ASSERT_EQ(job_id(job) & 0xFFFFFF, next[producer]++);
+    received++;
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  job_t job;
+  EXPECT_FALSE(lfq_mpsc_pop(&inbox, &job));
+}
+
+/**
+ * @brief A running executor, stopped after each test
+ */
+class ExecutorTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_EQ(executor_start(), ESP_OK); }
+
+  void TearDown() override {
+    if (executor_is_running()) {
+      EXPECT_EQ(executor_stop(), ESP_OK);
+    }
+    EXPECT_TRUE(freertos_mock_wait_tasks(1000));
+  }
+
+  /**
+   * @brief Submit, retrying while the queues are full
+   */
+  static void submit(executor_fn_t fn, void* arg) {
+    esp_err_t ret;
+    while ((ret = executor_submit(fn, arg)) == ESP_ERR_NO_MEM) {
+      std::this_thread::yield();
+    }
+    ASSERT_EQ(ret, ESP_OK);
+  }
+};
+
+static void count_job(void* arg) { static_cast<std::atomic<int>*>(arg)->fetch_add(1); }
+
+TEST_F(ExecutorTest, RunsJobsFromManyTasks) {
+  constexpr int SUBMITTERS = 4;
+  constexpr int PER_SUBMITTER = 2000;
+  std::atomic<int> count{0};
+  std::vector<std::thread> submitters;
+  for (int s = 0; s < SUBMITTERS; s++) {
+    submitters.emplace_back([&] {
+      for (int i = 0; i < PER_SUBMITTER; i++) {
+        submit(count_job, &count);
+      }
+    });
+  }
+  for (std::thread& submitter : submitters) {
+    submitter.join();
+  }
+  ASSERT_EQ(executor_stop(), ESP_OK);
+  EXPECT_EQ(count.load(), SUBMITTERS * PER_SUBMITTER);
+}
+
+TEST_F(ExecutorTest, SubmitFromIsr) {
+  std::atomic<int> count{0};
+  BaseType_t woken = pdFALSE;
+  ASSERT_EQ(executor_submit_from_isr(count_job, &count, &woken), ESP_OK);
+  EXPECT_EQ(executor_submit_from_isr(count_job, &count, nullptr), ESP_ERR_INVALID_ARG);
+  ASSERT_EQ(executor_stop(), ESP_OK);
+  EXPECT_EQ(count.load(), 1);
+}
+
+TEST_F(ExecutorTest, FutureCompletes) {
+  int value = 0;
+  executor_future_t future;
+  ASSERT_EQ(executor_submit_future([](void* arg) { *static_cast<int*>(arg) = 42; }, &value, &future), ESP_OK);
+  ASSERT_EQ(executor_future_wait(&future, portMAX_DELAY), ESP_OK);
+  EXPECT_EQ(value, 42);
+
+  auto task = make_executor_task([] { return 7 * 6; });
+  ASSERT_EQ(task.start(), ESP_OK);
+  ASSERT_EQ(task.wait(), ESP_OK);
+  EXPECT_EQ(task.result(), 42);
+}
+
+TEST_F(ExecutorTest, FutureWaitTimesOutUntilJobRuns) {
+  std::atomic<bool> release{false};
+  executor_future_t future;
+  ASSERT_EQ(executor_submit_future(
+                [](void* arg) {
+                  while (!static_cast<std::atomic<bool>*>(arg)->load()) {
+                    std::this_thread::yield();
+                  }
+                },
+                &release, &future),
+            ESP_OK);
+  EXPECT_EQ(executor_future_wait(&future, pdMS_TO_TICKS(20)), ESP_ERR_TIMEOUT);
+  release = true;
+  EXPECT_EQ(executor_future_wait(&future, portMAX_DELAY), ESP_OK);
+}
+
+/**
+ * @brief Sum of [begin, end), split into jobs that wait on the halves they submit
+ */
+static uint64_t parallel_sum(uint64_t begin, uint64_t end) {
+  if (end - begin <= 64) {
+    uint64_t sum = 0;
+    for (uint64_t i = begin; i < end; i++) {
+      sum += i;
+    }
+    return sum;
+  }
+  uint64_t mid = begin + (end - begin) / 2;
+  auto left = make_executor_task([=] { return parallel_sum(begin, mid); });
+  auto right = make_executor_task([=] { return parallel_sum(mid, end); });
+  if (left.start() != ESP_OK || right.start() != ESP_OK) {
+    return 0;
+  }
+  // On a worker, waiting runs other jobs, so nesting deeper than the worker count cannot deadlock
+  if (left.wait() != ESP_OK || right.wait() != ESP_OK) {
+    return 0;
+  }
+  return left.result() + right.result();
+}
+
+TEST_F(ExecutorTest, NestedFuturesOnWorkers) {
+  constexpr uint64_t N = 16384;
+  auto root = make_executor_task([] { return parallel_sum(0, N); });
+  ASSERT_EQ(root.start(), ESP_OK);
+  ASSERT_EQ(root.wait(), ESP_OK);
+  EXPECT_EQ(root.result(), N * (N - 1) / 2);
+
+  uint32_t stolen = 0;
+  for (int i = 0; i < executor_worker_count(); i++) {
+    executor_worker_stats_t stats;
+    ASSERT_EQ(executor_get_stats(i, &stats), ESP_OK);
+    stolen += stats.jobs_stolen;
+  }
+  RecordProperty("jobs_stolen", stolen);
+}
+
+TEST_F(ExecutorTest, StopDrainsQueuedJobs) {
+  constexpr int JOBS = 500;
+  std::atomic<int> count{0};
+  for (int i = 0; i < JOBS; i++) {
+    submit(
+        [](void* arg) {
+          std::this_thread::sleep_for(std::chrono::microseconds(20));
+          count_job(arg);
+        },
+        &count);
+  }
+  ASSERT_EQ(executor_stop(), ESP_OK);
+  EXPECT_EQ(count.load(), JOBS);
+  EXPECT_FALSE(executor_is_running());
+  EXPECT_EQ(executor_submit(count_job, &count), ESP_ERR_INVALID_STATE);
+  EXPECT_EQ(executor_stop(), ESP_ERR_INVALID_STATE);
+  EXPECT_TRUE(freertos_mock_wait_tasks(1000));
+
+  // Starts again after a stop
+  ASSERT_EQ(executor_start(), ESP_OK);
+  EXPECT_EQ(executor_start(), ESP_ERR_INVALID_STATE);
+  ASSERT_EQ(executor_submit([&count] { count++; }), ESP_OK);
+  ASSERT_EQ(executor_stop(), ESP_OK);
+  EXPECT_EQ(count.load(), JOBS + 1);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "fir_decimator.h"
+
+constexpr size_t TAPS = 32;
+
+/// The adc_capture default: cutoff at 80% of the output Nyquist frequency
+static std::vector<int16_t> design(size_t taps, uint32_t decimation) {
+  std::vector<int16_t> coeffs(taps);
+  fir_design_lowpass_q15(coeffs.data(), taps, 0.4f / (float)decimation);
+  return coeffs;
+}
+
+static std::vector<int16_t> noise(size_t count) {
+  std::vector<int16_t> samples(count);
+  uint32_t seed = 13579;
+  for (int16_t& sample : samples) {
+    seed = seed * 1664525 + 1013904223;
+    sample = (int16_t)(seed >> 16);
+  }
+  return samples;
+}
+
+/**
+ * @brief Run the decimator over input, handing it blocks of the given sizes in turn
+ */
+static std::vector<int16_t> run(const std::vector<int16_t>& coeffs, uint32_t decimation,
+                                const std::vector<int16_t>& input, const std::vector<size_t>& blocks = {4096}) {
+  fir_decimator_t fir;
+  std::vector<int16_t> delay(2 * coeffs.size());
+  EXPECT_TRUE(fir_decimator_init(&fir, coeffs.data(), delay.data(), coeffs.size(), decimation));
+
+  std::vector<int16_t> output(input.size() / decimation + blocks.size() + 1);
+  size_t produced = 0;
+  for (size_t pos = 0, b = 0; pos < input.size(); b++) {
+    size_t n = std::min(blocks[b % blocks.size()], input.size() - pos);
+    produced += fir_decimator_process(&fir, input.data() + pos, n, output.data() + produced);
+    pos += n;
+  }
+  output.resize(produced);
+  return output;
+}
+
+/**
+ * @brief Direct-form convolution at every input sample, rounded like the Q15 decimator
+ */
+static std::vector<int16_t> reference(const std::vector<int16_t>& coeffs, const std::vector<int16_t>& input) {
+  std::vector<int16_t> output(input.size());
+  for (size_t n = 0; n < input.size(); n++) {
+    int32_t acc = 0;
+    for (size_t k = 0; k < coeffs.size() && k <= n; k++) {
+      acc += (int32_t)coeffs[k] * input[n - k];
+    }
+    acc = (acc + (1 << 14)) >> 15;
+    output[n] = (int16_t)std::clamp<int32_t>(acc, INT16_MIN, INT16_MAX);
+  }
+  return output;
+}
+
+TEST(FirDecimator, DesignIsSymmetricWithUnityDcGain) {
+  for (uint32_t decimation : {1u, 4u, 8u}) {
+    std::vector<int16_t> coeffs = design(TAPS, decimation);
+    int32_t sum = 0;
+    for (size_t i = 0; i < TAPS; i++) {
+      EXPECT_EQ(coeffs[i], coeffs[TAPS - 1 - i]) << "tap " << i;
+      sum += coeffs[i];
+    }
+    // Each tap rounds by at most half an LSB
+    EXPECT_NEAR(sum, 32768, (int)TAPS / 2) << "decimation " << decimation;
+  }
+}
+
+TEST(FirDecimator, ImpulseResponseIsTheCoefficients) {
+  std::vector<int16_t> coeffs = design(TAPS, 4);
+  // -32768 is exactly -1.0 in Q15, so each output is exactly -coeff
+  std::vector<int16_t> impulse(TAPS + 8, 0);
+  impulse[0] = INT16_MIN;
+  std::vector<int16_t> output = run(coeffs, 1, impulse);
+  ASSERT_EQ(output.size(), impulse.size());
+  for (size_t k = 0; k < TAPS; k++) {
+    EXPECT_EQ(output[k], -coeffs[k]) << "tap " << k;
+  }
+  for (size_t k = TAPS; k < output.size(); k++) {
+    EXPECT_EQ(output[k], 0) << "after the last tap, sample " << k;
+  }
+}
+
+TEST(FirDecimator, DecimatedImpulseLandsOnTheOutputPhase) {
+  constexpr uint32_t D = 4;
+  std::vector<int16_t> coeffs = design(TAPS, D);
+  // Outputs are taken at inputs D-1, 2D-1, ...; an impulse at p shows up as coeff[m*D + D-1 - p]
+  for (size_t p = 0; p < D; p++) {
+    std::vector<int16_t> impulse(TAPS + 2 * D, 0);
+    impulse[p] = INT16_MIN;
+    std::vector<int16_t> output = run(coeffs, D, impulse);
+    ASSERT_EQ(output.size(), impulse.size() / D);
+    for (size_t m = 0; m < output.size(); m++) {
+      size_t k = m * D + D - 1 - p;
+      EXPECT_EQ(output[m], k < TAPS ? -coeffs[k] : 0) << "impulse at " << p << ", output " << m;
+    }
+  }
+}
+
+TEST(FirDecimator, MatchesReferenceConvolution) {
+  std::vector<int16_t> input = noise(1000);
+  for (uint32_t decimation : {1u, 3u, 8u}) {
+    std::vector<int16_t> coeffs = design(TAPS, decimation);
+    std::vector<int16_t> full = reference(coeffs, input);
+    std::vector<int16_t> output = run(coeffs, decimation, input);
+    ASSERT_EQ(output.size(), input.size() / decimation);
+    for (size_t m = 0; m < output.size(); m++) {
+      ASSERT_EQ(output[m], full[m * decimation + decimation - 1]) << "decimation " << decimation << ", output " << m;
+    }
+  }
+}
+
+TEST(FirDecimator, PhaseCarriesAcrossBlocks) {
+  constexpr uint32_t D = 5;
+  std::vector<int16_t> coeffs = design(TAPS, D);
+  std::vector<int16_t> input = noise(2000);
+  std::vector<int16_t> whole = run(coeffs, D, input);
+  // Block sizes that are not multiples of D, including single samples and empty blocks
+  EXPECT_EQ(run(coeffs, D, input, {1}), whole);
+  EXPECT_EQ(run(coeffs, D, input, {7, 0, 3, 64, 2}), whole);
+  EXPECT_EQ(run(coeffs, D, input, {TAPS + 1}), whole);
+}
+
+TEST(FirDecimator, DcPassesAtUnityGain) {
+  std::vector<int16_t> coeffs = design(TAPS, 4);
+  std::vector<int16_t> output = run(coeffs, 4, std::vector<int16_t>(400, 1000));
+  for (size_t m = TAPS / 4; m < output.size(); m++) {
+    EXPECT_NEAR(output[m], 1000, 2) << "output " << m;
+  }
+}
+
+TEST(FirDecimator, InitRejectsBadArguments) {
+  std::vector<int16_t> coeffs = design(TAPS, 1);
+  std::vector<int16_t> delay(2 * TAPS);
+  fir_decimator_t fir;
+  EXPECT_FALSE(fir_decimator_init(&fir, coeffs.data(), delay.data(), 0, 1));
+  EXPECT_FALSE(fir_decimator_init(&fir, coeffs.data(), delay.data(), TAPS, 0));
+  EXPECT_FALSE(fir_decimator_init(&fir, nullptr, delay.data(), TAPS, 1));
+  EXPECT_FALSE(fir_decimator_init(&fir, coeffs.data(), nullptr, TAPS, 1));
+}
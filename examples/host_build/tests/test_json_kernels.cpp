@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "cJSON.h"
+#include "json_kernels.h"
+
+/// Past one 16-byte vector and a 32-bit word on either side, so every head and tail path runs
+constexpr size_t MAX_LEN = 48;
+constexpr size_t OFFSETS = 16;
+
+/**
+ * @brief s escaped by cJSON, without the quotes
+ *
+ * cJSON stops at NUL, so each NUL is escaped here as the \\u00xx form it gives other control
+ * characters.
+ */
+static std::string cjson_escape(const std::string& s) {
+  std::string escaped;
+  size_t start = 0;
+  while (true) {
+    size_t end = s.find('\0', start);
+    std::string part = s.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    cJSON* item = cJSON_CreateString(part.c_str());
+    char* printed = cJSON_PrintUnformatted(item);
+    escaped.append(printed + 1, strlen(printed) - 2);
+    free(printed);
+    cJSON_Delete(item);
+    if (end == std::string::npos) {
+      return escaped;
+    }
+    escaped += "\\u0000";
+    start = end + 1;
+  }
+}
+
+static std::string kernel_escape(const char* s, size_t len) {
+  std::string out(json_escaped_len(s, len), '\0');
+  EXPECT_EQ(json_escape(out.data(), s, len), out.size());
+  return out;
+}
+
+/**
+ * @brief UTF-8 validation by decoding every code point, the reference for json_utf8_valid()
+ */
+static bool utf8_valid_reference(const std::string& s) {
+  size_t i = 0;
+  while (i < s.size()) {
+    unsigned char c = s[i];
+    uint32_t cp;
+    size_t extra;
+    if (c < 0x80) {
+      i++;
+      continue;
+    }
+    else if ((c & 0xE0) == 0xC0) {
+      cp = c & 0x1F;
+      extra = 1;
+    }
+    else if ((c & 0xF0) == 0xE0) {
+      cp = c & 0x0F;
+      extra = 2;
+    }
+    else if ((c & 0xF8) == 0xF0) {
+      cp = c & 0x07;
+      extra = 3;
+    }
+    else {
+      return false;
+    }
+    if (i + extra >= s.size()) {
+      return false;
+    }
+    for (size_t k = 1; k <= extra; k++) {
+      if (((unsigned char)s[i + k] & 0xC0) != 0x80) {
+        return false;
+      }
+      cp = cp << 6 | ((unsigned char)s[i + k] & 0x3F);
+    }
+    static const uint32_t MIN_CP[] = {0, 0x80, 0x800, 0x10000};
+    if (cp < MIN_CP[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+      return false;
+    }
+    i += extra + 1;
+  }
+  return true;
+}
+
+/**
+ * @brief Call fn(s, len) with text placed at every position of every plain ASCII padding up to
+ *        MAX_LEN, at every offset from a 16-byte aligned buffer
+ */
+template <typename Fn>
+static void for_each_placement(const std::string& text, Fn fn) {
+  alignas(16) char buffer[OFFSETS + MAX_LEN];
+  for (size_t offset = 0; offset < OFFSETS; offset++) {
+    char* s = buffer + offset;
+    for (size_t len = text.size(); len <= MAX_LEN; len++) {
+      for (size_t pos = 0; pos + text.size() <= len; pos++) {
+        memset(s, 'a', len);
+        memcpy(s + pos, text.data(), text.size());
+        fn(s, len);
+      }
+    }
+  }
+}
+
+TEST(JsonKernels, EscapesLikeCjson) {
+  EXPECT_EQ(kernel_escape("", 0), "");
+  const std::string mixed = "say \"hi\"\\\b\f\n\r\t\x01\x1f\x7f end";
+  EXPECT_EQ(kernel_escape(mixed.data(), mixed.size()), R"(say \"hi\"\\\b\f\n\r\t\u0001\u001f)" "\x7f end");
+  EXPECT_EQ(kernel_escape(mixed.data(), mixed.size()), cjson_escape(mixed));
+}
+
+TEST(JsonKernels, EscapesEveryByteAtEveryPositionAndAlignment) {
+  for (int byte = 0; byte < 256; byte++) {
+    const std::string text(1, (char)byte);
+    const std::string escaped = cjson_escape(text);
+    for_each_placement(text, [&](const char* s, size_t len) {
+      size_t pos = std::string(s, len).find(text);
+      std::string expected = std::string(pos, 'a') + escaped + std::string(len - pos - 1, 'a');
+      ASSERT_EQ(json_escaped_len(s, len), expected.size()) << "byte " << byte << ", length " << len;
+      ASSERT_EQ(kernel_escape(s, len), expected) << "byte " << byte << ", length " << len;
+      ASSERT_EQ(json_escape_scan(s, len), escaped.size() == 1 ? len : pos) << "byte " << byte << ", length " << len;
+    });
+  }
+}
+
+TEST(JsonKernels, EscapeScanStopsAtTheFirstSpecialByte) {
+  const std::string text = "plain text long enough to fill a vector, then \"quoted\" and \\";
+  EXPECT_EQ(json_escape_scan(text.data(), text.size()), text.find('"'));
+  EXPECT_EQ(json_escape_scan(text.data(), text.find('"')), text.find('"'));
+  const std::string utf8 = "Température 21,5 °C, 温度 ✓";
+  EXPECT_EQ(json_escape_scan(utf8.data(), utf8.size()), utf8.size());
+}
+
+TEST(JsonKernels, AcceptsValidUtf8AtEveryPositionAndAlignment) {
+  static const char* const VALID[] = {
+      "\x7f", "\xc2\x80", "\xdf\xbf",          // Either end of one and two bytes
+      "\xe0\xa0\x80", "\xef\xbf\xbf",          // Three bytes
+      "\xed\x9f\xbf", "\xee\x80\x80",          // Either side of the surrogates
+      "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf",  // Four bytes, up to U+10FFFF
+      "\xc2\xb0", "\xe2\x9c\x93",              // Degree sign and check mark
+  };
+  EXPECT_TRUE(json_utf8_valid("", 0));
+  EXPECT_TRUE(json_utf8_valid("a\0b", 3));
+  for (const char* valid : VALID) {
+    for_each_placement(valid, [&](const char* s, size_t len) {
+      ASSERT_TRUE(json_utf8_valid(s, len)) << "\"" << valid << "\" in " << len << " bytes";
+    });
+  }
+}
+
+TEST(JsonKernels, RejectsInvalidUtf8AtEveryPositionAndAlignment) {
+  static const char* const INVALID[] = {
+      "\x80", "\xbf",                          // Lone continuation bytes
+      "\xc0\x80", "\xc1\xbf",                  // Overlong in two bytes
+      "\xe0\x80\x80", "\xe0\x9f\xbf",          // Overlong in three bytes
+      "\xf0\x80\x80\x80", "\xf0\x8f\xbf\xbf",  // Overlong in four bytes
+      "\xed\xa0\x80", "\xed\xbf\xbf",          // Surrogates
+      "\xf4\x90\x80\x80", "\xf5\x80\x80\x80",  // Above U+10FFFF
+      "\xc2", "\xe2\x82", "\xf0\x9f\x98",      // Truncated
+      "\xc2\x41", "\xe2\x28\xa1",              // Continuation byte missing
+      "\xfe", "\xff",                          // Bytes that never occur
+  };
+  for (size_t i = 0; i < sizeof(INVALID) / sizeof(INVALID[0]); i++) {
+    for_each_placement(INVALID[i], [&](const char* s, size_t len) {
+      ASSERT_FALSE(json_utf8_valid(s, len)) << "sequence " << i << " in " << len << " bytes";
+    });
+  }
+}
+
+TEST(JsonKernels, RandomBytesMatchTheReferences) {
+  alignas(16) char buffer[OFFSETS + MAX_LEN];
+  uint32_t seed = 12345;
+  for (size_t offset = 0; offset < OFFSETS; offset++) {
+    char* s = buffer + offset;
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+      for (int round = 0; round < 50; round++) {
+        for (size_t k = 0; k < len; k++) {
+          seed = seed * 1664525 + 1013904223;
+          // Odd rounds only draw lead and continuation bytes, so some of them are valid UTF-8
+          s[k] = (char)(round % 2 ? 0x80 | seed >> 25 : seed >> 24);
+        }
+        std::string input(s, len);
+        ASSERT_EQ(kernel_escape(s, len), cjson_escape(input)) << "length " << len;
+        ASSERT_EQ(json_utf8_valid(s, len), utf8_valid_reference(input)) << "length " << len;
+      }
+    }
+  }
+}
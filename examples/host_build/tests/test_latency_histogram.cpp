@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <string.h>
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "latency_histogram.h"
+
+/**
+ * @brief A single-slot histogram with its counters, for the precisions chosen at run time
+ */
+class Histogram {
+ public:
+  Histogram(uint8_t sub_bits, uint8_t max_bits) : counts_(LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits)) {
+    EXPECT_EQ(latency_histogram_init(&hist_, sub_bits, max_bits, counts_.data(), 1), ESP_OK);
+  }
+
+  latency_histogram_t* get() { return &hist_; }
+  std::vector<uint64_t> buckets() const {
+    std::vector<uint64_t> counts;
+    for (uint32_t i = 0; i < hist_.bucket_count; i++) {
+      counts.push_back(latency_histogram_bucket_count(&hist_, i));
+    }
+    return counts;
+  }
+
+ private:
+  std::vector<uint32_t> counts_;
+  latency_histogram_t hist_;
+};
+
+class LatencyHistogramBuckets : public testing::TestWithParam<std::pair<uint8_t, uint8_t>> {};
+
+TEST_P(LatencyHistogramBuckets, BoundsTileTheRange) {
+  auto [sub_bits, max_bits] = GetParam();
+  Histogram histogram(sub_bits, max_bits);
+  const latency_histogram_t* hist = histogram.get();
+  uint32_t overflow = hist->bucket_count - 1u;
+
+  EXPECT_EQ(latency_histogram_bucket_lower(hist, 0), 0u);
+  for (uint32_t i = 0; i < overflow; i++) {
+    uint32_t lower = latency_histogram_bucket_lower(hist, i);
+    uint32_t upper = latency_histogram_bucket_upper(hist, i);
+    ASSERT_LE(lower, upper) << "bucket " << i;
+    ASSERT_EQ(latency_histogram_bucket_index(hist, lower), i) << "lower bound " << lower;
+    ASSERT_EQ(latency_histogram_bucket_index(hist, upper), i) << "upper bound " << upper;
+    ASSERT_EQ(latency_histogram_bucket_index(hist, upper + 1u), i + 1u) << "past bucket " << i;
+    // The width is the reported error, at most 2^-sub_bits of the smallest value in the bucket
+    ASSERT_LE(upper - lower, lower >> sub_bits) << "bucket " << i;
+  }
+  EXPECT_EQ(latency_histogram_bucket_upper(hist, overflow - 1u), (1u << max_bits) - 1u);
+  EXPECT_EQ(latency_histogram_bucket_lower(hist, overflow), 1u << max_bits);
+  EXPECT_EQ(latency_histogram_bucket_upper(hist, overflow), UINT32_MAX);
+  EXPECT_EQ(latency_histogram_bucket_index(hist, UINT32_MAX), overflow);
+}
+
+TEST_P(LatencyHistogramBuckets, SmallValuesAreExact) {
+  auto [sub_bits, max_bits] = GetParam();
+  Histogram histogram(sub_bits, max_bits);
+  for (uint32_t value = 0; value < (2u << sub_bits); value++) {
+    ASSERT_EQ(latency_histogram_bucket_index(histogram.get(), value), value);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Precisions, LatencyHistogramBuckets,
+                         testing::Values(std::make_pair(1, 2), std::make_pair(1, 31), std::make_pair(4, 24),
+                                         std::make_pair(7, 20), std::make_pair(10, 11), std::make_pair(10, 31)),
+                         [](const testing::TestParamInfo<std::pair<uint8_t, uint8_t>>& info) {
+                           return "Sub" + std::to_string(info.param.first) + "Max" +
+                                  std::to_string(info.param.second);
+                         });
+
+TEST(LatencyHistogram, InitRejectsUnsupportedPrecision) {
+  uint32_t counts[LATENCY_HISTOGRAM_BUCKETS(10, 31)];
+  latency_histogram_t hist;
+  EXPECT_EQ(latency_histogram_init(&hist, 0, 24, counts, 1), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(latency_histogram_init(&hist, 11, 24, counts, 1), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(latency_histogram_init(&hist, 4, 4, counts, 1), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(latency_histogram_init(&hist, 4, 32, counts, 1), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(latency_histogram_init(&hist, 4, 24, counts, 2), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(latency_histogram_init(&hist, 4, 24, nullptr, 1), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(latency_histogram_init(&hist, 4, 24, counts, 1), ESP_OK);
+  EXPECT_EQ(hist.bucket_count, 337);
+}
+
+TEST(LatencyHistogram, QuantilesOfAnEmptyHistogramAreZero) {
+  LatencyHistogram<4, 24> hist;
+  EXPECT_EQ(hist.count(), 0u);
+  EXPECT_EQ(hist.quantile(0.0f), 0u);
+  EXPECT_EQ(hist.quantile(0.99f), 0u);
+}
+
+TEST(LatencyHistogram, QuantilesNeverUnderReport) {
+  LatencyHistogram<4, 24> hist;
+  for (uint32_t value = 1; value <= 10000; value++) {
+    hist.record(value);
+  }
+  ASSERT_EQ(hist.count(), 10000u);
+
+  EXPECT_EQ(hist.quantile(0.0f), 1u);
+  for (float q : {0.001f, 0.25f, 0.5f, 0.9f, 0.99f, 0.999f, 1.0f}) {
+    uint32_t exact = (uint32_t)ceil((double)q * 10000.0);  // The rank, as the histogram computes it
+    uint32_t reported = hist.quantile(q);
+    EXPECT_GE(reported, exact) << "q " << q;
+    EXPECT_LE(reported, exact + (uint32_t)(exact * decltype(hist)::kRelativeError)) << "q " << q;
+  }
+}
+
+TEST(LatencyHistogram, QuantilesInOnePassMatchSingleQueries) {
+  LatencyHistogram<4, 24> hist;
+  uint32_t seed = 1;
+  for (int i = 0; i < 5000; i++) {
+    seed = seed * 1664525 + 1013904223;
+    hist.record(seed >> 12);  // Up to 2^20, with a long tail of empty buckets between samples
+  }
+  const float quantiles[] = {0.0f, 0.5f, 0.5f, 0.9f, 0.99f, 1.0f};
+  uint32_t values[6];
+  hist.quantiles(quantiles, values, 6);
+  for (size_t i = 0; i < 6; i++) {
+    EXPECT_EQ(values[i], hist.quantile(quantiles[i])) << "q " << quantiles[i];
+  }
+}
+
+TEST(LatencyHistogram, OverflowReadsAsMax) {
+  LatencyHistogram<4, 10> hist;
+  hist.record(5);
+  hist.record(1023);
+  hist.record(1024);
+  EXPECT_EQ(hist.quantile(0.3f), 5u);
+  EXPECT_EQ(hist.quantile(0.6f), 1023u);
+  EXPECT_EQ(hist.quantile(1.0f), UINT32_MAX);
+}
+
+TEST(LatencyHistogram, ConcurrentRecordsAreAllCounted) {
+  constexpr int THREADS = 4;
+  constexpr uint32_t PER_THREAD = 100000;
+  LatencyHistogram<4, 24> hist;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; t++) {
+    threads.emplace_back([&hist] {
+      for (uint32_t i = 0; i < PER_THREAD; i++) {
+        hist.record(i & 15);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(hist.count(), THREADS * PER_THREAD);
+  EXPECT_EQ(latency_histogram_bucket_count(hist.handle(), 15), THREADS * PER_THREAD / 16);
+}
+
+TEST(LatencyHistogram, MergeAddsAndDrainEmptiesTheSource) {
+  LatencyHistogram<4, 24> live;
+  LatencyHistogram<4, 24, false> interval;
+  for (uint32_t value = 0; value < 1000; value++) {
+    live.record(value);
+  }
+  interval.record(5);
+
+  interval.merge(live);
+  EXPECT_EQ(interval.count(), 1001u);
+  EXPECT_EQ(live.count(), 1000u);
+
+  interval.reset();
+  EXPECT_EQ(interval.count(), 0u);
+  interval.merge(live, true);
+  EXPECT_EQ(interval.count(), 1000u);
+  EXPECT_EQ(live.count(), 0u);
+  uint32_t last = latency_histogram_bucket_index(interval.handle(), 999);
+  EXPECT_EQ(interval.quantile(1.0f), latency_histogram_bucket_upper(interval.handle(), last));
+}
+
+TEST(LatencyHistogram, MergeRejectsAnotherPrecision) {
+  Histogram a(4, 24), b(4, 20), c(5, 24);
+  EXPECT_EQ(latency_histogram_merge(a.get(), b.get(), false), ESP_ERR_INVALID_ARG);
+  EXPECT_EQ(latency_histogram_merge(a.get(), c.get(), false), ESP_ERR_INVALID_ARG);
+}
+
+TEST(LatencyHistogram, SerializeRoundTrips) {
+  LatencyHistogram<4, 24> source;
+  source.record(0);
+  source.record(1);
+  source.record(1);
+  for (int i = 0; i < 300; i++) {
+    source.record(20000);  // Count above 127: a two-byte varint
+  }
+  source.record(16777215);
+  source.record(UINT32_MAX);
+
+  uint8_t blob[decltype(source)::kSerializedMax];
+  size_t len = source.serialize(blob, sizeof(blob));
+  ASSERT_GT(len, (size_t)LATENCY_HISTOGRAM_HEADER_SIZE);
+  EXPECT_EQ(blob[0], 'L');
+  EXPECT_EQ(blob[1], 'H');
+  EXPECT_EQ(blob[2], LATENCY_HISTOGRAM_VERSION);
+
+  LatencyHistogram<4, 24> restored;
+  ASSERT_EQ(restored.merge_serialized(blob, len), ESP_OK);
+  Histogram expected(4, 24), actual(4, 24);
+  ASSERT_EQ(latency_histogram_merge(expected.get(), source.handle(), false), ESP_OK);
+  ASSERT_EQ(latency_histogram_merge(actual.get(), restored.handle(), false), ESP_OK);
+  EXPECT_EQ(actual.buckets(), expected.buckets());
+
+  // Merging again adds, and an empty histogram is the header alone
+  ASSERT_EQ(restored.merge_serialized(blob, len), ESP_OK);
+  EXPECT_EQ(restored.count(), 2 * source.count());
+  LatencyHistogram<4, 24> empty;
+  EXPECT_EQ(empty.serialize(blob, sizeof(blob)), (size_t)LATENCY_HISTOGRAM_HEADER_SIZE);
+}
+
+TEST(LatencyHistogram, SerializedMaxFitsEveryBucketFull) {
+  Histogram full(4, 24);
+  latency_histogram_t* hist = full.get();
+  for (uint32_t i = 0; i < hist->bucket_count; i++) {
+    hist->counts[i] = UINT32_MAX;
+  }
+  std::vector<uint8_t> blob(LATENCY_HISTOGRAM_SERIALIZED_MAX(4, 24));
+  size_t len = latency_histogram_serialize(hist, blob.data(), blob.size());
+  ASSERT_GT(len, 0u);
+  EXPECT_LE(len, blob.size());
+  EXPECT_EQ(latency_histogram_serialize(hist, blob.data(), len - 1), 0u);
+  EXPECT_EQ(latency_histogram_serialize(hist, blob.data(), LATENCY_HISTOGRAM_HEADER_SIZE - 1), 0u);
+}
+
+TEST(LatencyHistogram, MergeSerializedRejectsBadInputUnchanged) {
+  LatencyHistogram<4, 24> source;
+  for (uint32_t value = 0; value < 5000; value += 7) {
+    source.record(value);
+  }
+  uint8_t blob[decltype(source)::kSerializedMax];
+  size_t len = source.serialize(blob, sizeof(blob));
+  ASSERT_GT(len, 0u);
+
+  LatencyHistogram<4, 24> dest;
+  dest.record(42);
+  // Every truncation that cuts a varint in half; cuts between bucket entries are valid prefixes
+  for (size_t cut = 0; cut < len; cut++) {
+    esp_err_t ret = dest.merge_serialized(blob, cut);
+    if (ret == ESP_OK) {
+      dest.reset();
+      dest.record(42);
+      continue;
+    }
+    ASSERT_EQ(ret, ESP_ERR_INVALID_SIZE) << "cut at " << cut;
+    ASSERT_EQ(dest.count(), 1u) << "cut at " << cut;
+  }
+
+  uint8_t bad[sizeof(blob)];
+  memcpy(bad, blob, len);
+  bad[2] = LATENCY_HISTOGRAM_VERSION + 1;
+  EXPECT_EQ(dest.merge_serialized(bad, len), ESP_ERR_INVALID_VERSION);
+  memcpy(bad, blob, len);
+  bad[3] = 5;
+  EXPECT_EQ(dest.merge_serialized(bad, len), ESP_ERR_INVALID_ARG);
+  memcpy(bad, blob, len);
+  bad[0] = 'X';
+  EXPECT_EQ(dest.merge_serialized(bad, len), ESP_ERR_INVALID_SIZE);
+
+  // A skip that runs past the last bucket
+  const uint8_t past_end[] = {'L', 'H', LATENCY_HISTOGRAM_VERSION, 4, 24, 0xD1, 0x02, 1};
+  EXPECT_EQ(dest.merge_serialized(past_end, sizeof(past_end)), ESP_ERR_INVALID_SIZE);
+  EXPECT_EQ(dest.count(), 1u);
+}
@@ -0,0 +1,14 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include "esp_log.h"
+
+int main(int argc, char** argv) {
+  // Components log at INFO on every server start; keep the output readable unless asked otherwise
+  if (!getenv("ESP_LOG_LEVEL")) {
+    esp_log_level_set("*", ESP_LOG_WARN);
+  }
+
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
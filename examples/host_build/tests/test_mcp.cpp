@@ -0,0 +1,312 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "cJSON.h"
+#include "httpd_mock.h"
+#include "mcp_protocol.h"
+#include "mcp_schema.h"
+#include "mcp_server_cpp.h"
+#include "mdns_mock.h"
+#include "shared_httpd.h"
+
+using JsonPtr = std::unique_ptr<cJSON, decltype(&cJSON_Delete)>;
+
+static JsonPtr parse_json(const std::string& text) { return JsonPtr(cJSON_Parse(text.c_str()), cJSON_Delete); }
+
+TEST(McpProtocol, ParsesToolsCall) {
+  mcp_request_t request;
+  ASSERT_EQ(mcp_protocol_parse_request(
+                R"({"jsonrpc":"2.0","id":7,"method":"tools/call","params":{"name":"echo","arguments":{"x":1}}})",
+                &request),
+            ESP_OK);
+  EXPECT_STREQ(request.jsonrpc, "2.0");
+  EXPECT_STREQ(request.method, "tools/call");
+  EXPECT_EQ(request.id, 7);
+  EXPECT_TRUE(request.id_is_valid);
+  EXPECT_FALSE(request.is_notification);
+  ASSERT_NE(request.params, nullptr);
+  EXPECT_STREQ(cJSON_GetObjectItem(request.params, "name")->valuestring, "echo");
+  mcp_protocol_free_request(&request);
+}
+
+TEST(McpProtocol, RequestWithoutIdIsNotification) {
+  mcp_request_t request;
+  ASSERT_EQ(mcp_protocol_parse_request(R"({"jsonrpc":"2.0","method":"notifications/initialized"})", &request), ESP_OK);
+  EXPECT_TRUE(request.is_notification);
+  EXPECT_FALSE(request.id_is_valid);
+  EXPECT_EQ(request.params, nullptr);
+  mcp_protocol_free_request(&request);
+}
+
+TEST(McpProtocol, RejectsMalformedRequests) {
+  mcp_request_t request;
+  EXPECT_EQ(mcp_protocol_parse_request(R"({"jsonrpc":"2.0","id":1,"method":)", &request), ESP_FAIL);
+  EXPECT_EQ(mcp_protocol_parse_request(R"({"jsonrpc":"2.0","id":1})", &request), ESP_FAIL);
+  EXPECT_EQ(mcp_protocol_parse_request(R"({"jsonrpc":"2.0","id":1,"method":42})", &request), ESP_FAIL);
+  EXPECT_EQ(mcp_protocol_parse_request("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"a\xC3\"}", &request), ESP_FAIL);
+  EXPECT_EQ(mcp_protocol_parse_request(nullptr, &request), ESP_ERR_INVALID_ARG);
+}
+
+TEST(McpProtocol, ErrorResponseCarriesCodeAndId) {
+  char* text = mcp_protocol_create_error(3, -32601, "Method not found");
+  ASSERT_NE(text, nullptr);
+  JsonPtr response = parse_json(text);
+  free(text);
+  ASSERT_TRUE(response);
+  EXPECT_EQ(cJSON_GetObjectItem(response.get(), "id")->valueint, 3);
+  cJSON* error = cJSON_GetObjectItem(response.get(), "error");
+  ASSERT_NE(error, nullptr);
+  EXPECT_EQ(cJSON_GetObjectItem(error, "code")->valueint, -32601);
+  EXPECT_STREQ(cJSON_GetObjectItem(error, "message")->valuestring, "Method not found");
+}
+
+TEST(McpProtocol, TextResponseEscapesContent) {
+  char* text = mcp_protocol_create_text_response(4, "line \"one\"\n\ttab\\");
+  ASSERT_NE(text, nullptr);
+  JsonPtr response = parse_json(text);
+  free(text);
+  ASSERT_TRUE(response);
+  cJSON* content = cJSON_GetObjectItem(cJSON_GetObjectItem(response.get(), "result"), "content");
+  ASSERT_TRUE(cJSON_IsArray(content));
+  EXPECT_STREQ(cJSON_GetObjectItem(cJSON_GetArrayItem(content, 0), "text")->valuestring, "line \"one\"\n\ttab\\");
+}
+
+TEST(McpProtocol, TextResponseMatchesTheCjsonOne) {
+  const char* content = "Température 21,5 °C \"living_room\"\n\x01 done";
+  mcp_tool_result_t result = mcp_tool_result_success(content);
+  char* expected = mcp_protocol_create_response(7, mcp_tool_result_to_json(&result));
+  char* actual = mcp_protocol_create_text_response(7, content);
+  ASSERT_NE(expected, nullptr);
+  ASSERT_NE(actual, nullptr);
+  EXPECT_STREQ(actual, expected);
+  free(expected);
+  free(actual);
+  mcp_tool_result_free(&result);
+}
+
+static const char* const MODES[] = {"heat", "cool", "off"};
+
+static const mcp_param_schema_t THERMOSTAT_PARAMS[] = {
+    MCP_PARAM_NUMBER_REQUIRED("temperature", "Target temperature", 40.0, 90.5),
+    {
+        .name = "mode",
+        .type = MCP_TYPE_STRING,
+        .description = "Operating mode",
+        .required = false,
+        .enum_values = const_cast<const char**>(MODES),
+        .enum_count = sizeof(MODES) / sizeof(MODES[0]),
+    },
+    MCP_PARAM_INTEGER("hold_minutes", "Minutes to hold", 0, 1440),
+    MCP_PARAM_BOOLEAN_REQUIRED("persist", "Store in NVS"),
+};
+
+TEST(McpSchema, ObjectWithPropertiesAndRequired) {
+  JsonPtr schema(mcp_schema_to_json(THERMOSTAT_PARAMS, sizeof(THERMOSTAT_PARAMS) / sizeof(THERMOSTAT_PARAMS[0])),
+                 cJSON_Delete);
+  ASSERT_TRUE(schema);
+  EXPECT_STREQ(cJSON_GetObjectItem(schema.get(), "type")->valuestring, "object");
+
+  cJSON* properties = cJSON_GetObjectItem(schema.get(), "properties");
+  ASSERT_EQ(cJSON_GetArraySize(properties), 4);
+  cJSON* temperature = cJSON_GetObjectItem(properties, "temperature");
+  EXPECT_STREQ(cJSON_GetObjectItem(temperature, "type")->valuestring, "number");
+  EXPECT_DOUBLE_EQ(cJSON_GetObjectItem(temperature, "minimum")->valuedouble, 40.0);
+  EXPECT_DOUBLE_EQ(cJSON_GetObjectItem(temperature, "maximum")->valuedouble, 90.5);
+
+  cJSON* hold = cJSON_GetObjectItem(properties, "hold_minutes");
+  EXPECT_STREQ(cJSON_GetObjectItem(hold, "type")->valuestring, "integer");
+  EXPECT_EQ(cJSON_GetObjectItem(hold, "maximum")->valueint, 1440);
+
+  cJSON* mode_enum = cJSON_GetObjectItem(cJSON_GetObjectItem(properties, "mode"), "enum");
+  ASSERT_EQ(cJSON_GetArraySize(mode_enum), 3);
+  EXPECT_STREQ(cJSON_GetArrayItem(mode_enum, 2)->valuestring, "off");
+
+  cJSON* required = cJSON_GetObjectItem(schema.get(), "required");
+  ASSERT_EQ(cJSON_GetArraySize(required), 2);
+  EXPECT_STREQ(cJSON_GetArrayItem(required, 0)->valuestring, "temperature");
+  EXPECT_STREQ(cJSON_GetArrayItem(required, 1)->valuestring, "persist");
+}
+
+TEST(McpSchema, NumericBoundsOnlyForNumbers) {
+  mcp_param_schema_t param = MCP_PARAM_STRING("name", "Name");
+  param.has_minimum = true;
+  param.minimum = 3;
+  JsonPtr json(mcp_schema_param_to_json(&param), cJSON_Delete);
+  ASSERT_TRUE(json);
+  EXPECT_EQ(cJSON_GetObjectItem(json.get(), "minimum"), nullptr);
+  EXPECT_EQ(mcp_schema_param_to_json(nullptr), nullptr);
+}
+
+/**
+ * @brief A server on the shared httpd mock, with one tool that echoes and one that fails
+ */
+class McpDispatch : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(server_.add_tool("set_thermostat", "Sets the thermostat target", THERMOSTAT_PARAMS,
+                               [](const McpToolArgs& args) {
+                                 return McpToolResult::format("setpoint %.1f %s", args.get_double("temperature"),
+                                                              args.get_bool("persist") ? "saved" : "volatile");
+                               }),
+              ESP_OK);
+    ASSERT_EQ(server_.add_tool("fail", "Always fails", [] { return McpToolResult::error("Sensor offline"); }), ESP_OK);
+    ASSERT_EQ(server_.start(3000), ESP_OK);
+  }
+
+  void TearDown() override { httpd_mock_response_free(&response_); }
+
+  /**
+   * @brief POST body to / and parse the JSON-RPC response
+   */
+  JsonPtr post(const std::string& body) {
+    EXPECT_EQ(httpd_mock_request(HTTP_POST, "/", body.data(), body.size(), &response_), ESP_OK);
+    EXPECT_EQ(response_.status, 200);
+    return parse_json(std::string(response_.body, response_.body_len));
+  }
+
+  static int error_code(const JsonPtr& response) {
+    cJSON* error = cJSON_GetObjectItem(response.get(), "error");
+    return error ? cJSON_GetObjectItem(error, "code")->valueint : 0;
+  }
+
+  McpServer server_{MCP_TRANSPORT_HTTP};
+  httpd_mock_response_t response_ = {};
+};
+
+TEST_F(McpDispatch, CallsToolWithArguments) {
+  JsonPtr response = post(
+      R"({"jsonrpc":"2.0","id":11,"method":"tools/call",)"
+      R"("params":{"name":"set_thermostat","arguments":{"temperature":72.5,"persist":true}}})");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(cJSON_GetObjectItem(response.get(), "id")->valueint, 11);
+  cJSON* result = cJSON_GetObjectItem(response.get(), "result");
+  ASSERT_NE(result, nullptr);
+  cJSON* text = cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(result, "content"), 0), "text");
+  EXPECT_STREQ(text->valuestring, "setpoint 72.5 saved");
+}
+
+TEST_F(McpDispatch, ToolErrorIsReportedInResult) {
+  JsonPtr response = post(R"({"jsonrpc":"2.0","id":12,"method":"tools/call","params":{"name":"fail"}})");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(error_code(response), 0);
+  cJSON* result = cJSON_GetObjectItem(response.get(), "result");
+  ASSERT_NE(result, nullptr);
+  EXPECT_STREQ(cJSON_GetObjectItem(result, "error")->valuestring, "Sensor offline");
+}
+
+TEST_F(McpDispatch, ProtocolErrors) {
+  EXPECT_EQ(error_code(post(R"({"jsonrpc":"2.0","id":1,"method":"tools/call","params":{"name":"missing"}})")),
+            -32602);
+  EXPECT_EQ(error_code(post(R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{}})")), -32602);
+  EXPECT_EQ(error_code(post(R"({"jsonrpc":"2.0","id":3,"method":"resources/list"})")), -32601);
+  EXPECT_EQ(error_code(post(R"({"jsonrpc":"2.0","id":4,"method":"tools/ca)")), -32700);
+}
+
+TEST_F(McpDispatch, ListsToolsWithSchemas) {
+  JsonPtr response = post(R"({"jsonrpc":"2.0","id":13,"method":"tools/list"})");
+  ASSERT_TRUE(response);
+  cJSON* tools = cJSON_GetObjectItem(cJSON_GetObjectItem(response.get(), "result"), "tools");
+  ASSERT_EQ(cJSON_GetArraySize(tools), 2);
+  cJSON* thermostat = nullptr;
+  for (int i = 0; i < cJSON_GetArraySize(tools); i++) {
+    cJSON* tool = cJSON_GetArrayItem(tools, i);
+    if (strcmp(cJSON_GetObjectItem(tool, "name")->valuestring, "set_thermostat") == 0) {
+      thermostat = tool;
+    }
+  }
+  ASSERT_NE(thermostat, nullptr);
+  cJSON* schema = cJSON_GetObjectItem(thermostat, "inputSchema");
+  EXPECT_EQ(cJSON_GetArraySize(cJSON_GetObjectItem(schema, "properties")), 4);
+  EXPECT_EQ(cJSON_GetArraySize(cJSON_GetObjectItem(schema, "required")), 2);
+}
+
+TEST_F(McpDispatch, InitializeReportsServerInfo) {
+  JsonPtr response =
+      post(R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05"}})");
+  ASSERT_TRUE(response);
+  cJSON* result = cJSON_GetObjectItem(response.get(), "result");
+  ASSERT_NE(result, nullptr);
+  EXPECT_NE(cJSON_GetObjectItem(result, "serverInfo"), nullptr);
+  EXPECT_NE(cJSON_GetObjectItem(result, "capabilities"), nullptr);
+}
+
+/**
+ * @brief Parks its call and answers it from another thread, after that thread got a request of its own through
+ */
+static mcp_tool_result_t deferring_tool(const mcp_tool_args_t* args) {
+  mcp_tool_deferred_t* deferred = mcp_tool_defer(args);
+  if (!deferred) {
+    return mcp_tool_result_success("answered at once");
+  }
+  std::thread([deferred] {
+    httpd_mock_response_t other = {};
+    const std::string body = R"({"jsonrpc":"2.0","id":2,"method":"tools/list"})";
+    bool served = httpd_mock_request(HTTP_POST, "/", body.data(), body.size(), &other) == ESP_OK &&
+                  other.status == 200 && strstr(other.body, "\"tools\"");
+    httpd_mock_response_free(&other);
+    mcp_tool_result_t result = mcp_tool_result_success(served ? "answered later" : "httpd was blocked");
+    mcp_tool_deferred_complete(deferred, &result);
+  }).detach();
+  return mcp_tool_result_deferred();
+}
+
+static mcp_tool_result_t forgetful_tool(const mcp_tool_args_t* args) { return mcp_tool_result_deferred(); }
+
+static const mcp_tool_definition_t DEFERRING_TOOL = {
+    .name = "defer", .description = "Answers later", .handler = deferring_tool};
+static const mcp_tool_definition_t FORGETFUL_TOOL = {
+    .name = "forget", .description = "Claims to answer later but never defers", .handler = forgetful_tool};
+
+static const char* result_text(const JsonPtr& response) {
+  cJSON* content = cJSON_GetObjectItem(cJSON_GetObjectItem(response.get(), "result"), "content");
+  cJSON* text = cJSON_GetObjectItem(cJSON_GetArrayItem(content, 0), "text");
+  return cJSON_IsString(text) ? text->valuestring : "";
+}
+
+TEST_F(McpDispatch, DeferredCallLeavesHttpdFreeUntilAnswered) {
+  ASSERT_EQ(server_.register_tool(DEFERRING_TOOL), ESP_OK);
+  JsonPtr response = post(R"({"jsonrpc":"2.0","id":21,"method":"tools/call","params":{"name":"defer"}})");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(cJSON_GetObjectItem(response.get(), "id")->valueint, 21);
+  EXPECT_STREQ(result_text(response), "answered later");
+}
+
+TEST_F(McpDispatch, PipelineStepsAreNeverDeferred) {
+  ASSERT_EQ(server_.register_tool(DEFERRING_TOOL), ESP_OK);
+  JsonPtr response =
+      post(R"({"jsonrpc":"2.0","id":22,"method":"tools/pipeline","params":{"steps":[{"name":"defer"}]}})");
+  ASSERT_TRUE(response);
+  cJSON* results = cJSON_GetObjectItem(cJSON_GetObjectItem(response.get(), "result"), "results");
+  ASSERT_EQ(cJSON_GetArraySize(results), 1);
+  cJSON* content = cJSON_GetObjectItem(cJSON_GetArrayItem(results, 0), "content");
+  cJSON* text = cJSON_GetObjectItem(cJSON_GetArrayItem(content, 0), "text");
+  ASSERT_NE(text, nullptr);
+  EXPECT_STREQ(text->valuestring, "answered at once");
+}
+
+TEST_F(McpDispatch, DeferredResultWithoutDeferringIsAnError) {
+  ASSERT_EQ(server_.register_tool(FORGETFUL_TOOL), ESP_OK);
+  JsonPtr response = post(R"({"jsonrpc":"2.0","id":23,"method":"tools/call","params":{"name":"forget"}})");
+  ASSERT_TRUE(response);
+  cJSON* result = cJSON_GetObjectItem(response.get(), "result");
+  ASSERT_NE(result, nullptr);
+  EXPECT_STREQ(cJSON_GetObjectItem(result, "error")->valuestring, "Tool did not produce a result");
+}
+
+TEST(McpMdns, AdvertisesThePortSharedHttpdListensOn) {
+  // Another component started the shared server first, on a different port
+  ASSERT_EQ(shared_httpd_start(8080), ESP_OK);
+  {
+    McpServer server(MCP_TRANSPORT_HTTP);
+    ASSERT_EQ(server.enable_mdns("thermostat", "Thermostat"), ESP_OK);
+    ASSERT_EQ(server.start(3000), ESP_OK);
+    EXPECT_EQ(mdns_mock_service_port(), 8080);
+  }
+  EXPECT_EQ(mdns_mock_service_port(), 0);
+  EXPECT_EQ(shared_httpd_stop(), ESP_OK);
+}
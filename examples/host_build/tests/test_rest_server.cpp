@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "cJSON.h"
+#include "httpd_mock.h"
+#include "shared_httpd.h"
+
+extern "C" esp_err_t start_rest_server(const char* base_path);
+
+using JsonPtr = std::unique_ptr<cJSON, decltype(&cJSON_Delete)>;
+
+static const char INDEX_HTML[] = "<!doctype html><title>OTA testbed</title>";
+
+/**
+ * @brief The ota_testbed REST API, serving files from a temporary directory
+ *
+ * start_rest_server() has no counterpart that stops it, so the server is started once per
+ * process and left running.
+ */
+class RestServer : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    // The base path is limited to ESP_VFS_PATH_MAX characters, as on the target
+    char dir_template[] = "/tmp/restXXXXXX";
+    ASSERT_NE(mkdtemp(dir_template), nullptr);
+    s_base_path = dir_template;
+    FILE* index = fopen((s_base_path + "/index.html").c_str(), "w");
+    ASSERT_NE(index, nullptr);
+    fputs(INDEX_HTML, index);
+    fclose(index);
+    ASSERT_EQ(start_rest_server(s_base_path.c_str()), ESP_OK);
+  }
+
+  static void TearDownTestSuite() {
+    unlink((s_base_path + "/index.html").c_str());
+    rmdir(s_base_path.c_str());
+  }
+
+  void TearDown() override { httpd_mock_response_free(&response_); }
+
+  esp_err_t request(httpd_method_t method, const char* uri) {
+    return httpd_mock_request(method, uri, nullptr, 0, &response_);
+  }
+
+  JsonPtr body_json() const { return JsonPtr(cJSON_Parse(response_.body), cJSON_Delete); }
+
+  static std::string s_base_path;
+  httpd_mock_response_t response_ = {};
+};
+
+std::string RestServer::s_base_path;
+
+TEST_F(RestServer, SystemInfo) {
+  ASSERT_EQ(request(HTTP_GET, "/api/v1/system/info"), ESP_OK);
+  EXPECT_EQ(response_.status, 200);
+  EXPECT_STREQ(response_.content_type, "application/json");
+  JsonPtr info = body_json();
+  ASSERT_TRUE(info);
+  EXPECT_STREQ(cJSON_GetObjectItem(info.get(), "version")->valuestring, "host");
+  EXPECT_EQ(cJSON_GetObjectItem(info.get(), "cores")->valueint, 2);
+  EXPECT_STREQ(cJSON_GetObjectItem(info.get(), "reset_reason")->valuestring, "poweron");
+  EXPECT_TRUE(cJSON_IsNumber(cJSON_GetObjectItem(info.get(), "uptime_ms")));
+}
+
+TEST_F(RestServer, SystemMemory) {
+  ASSERT_EQ(request(HTTP_GET, "/api/v1/system/memory"), ESP_OK);
+  JsonPtr memory = body_json();
+  ASSERT_TRUE(memory);
+  EXPECT_GT(cJSON_GetObjectItem(memory.get(), "free_heap")->valuedouble, 0);
+  EXPECT_LE(cJSON_GetObjectItem(memory.get(), "min_free_heap")->valuedouble,
+            cJSON_GetObjectItem(memory.get(), "free_heap")->valuedouble);
+}
+
+TEST_F(RestServer, LeakReportsSize) {
+  ASSERT_EQ(request(HTTP_POST, "/api/v1/system/leak"), ESP_OK);
+  JsonPtr leak = body_json();
+  ASSERT_TRUE(leak);
+  EXPECT_STREQ(cJSON_GetObjectItem(leak.get(), "status")->valuestring, "success");
+  int bytes = cJSON_GetObjectItem(leak.get(), "leaked_bytes")->valueint;
+  EXPECT_GE(bytes, 1024);
+  EXPECT_LE(bytes, 10240);
+}
+
+TEST_F(RestServer, ServesIndexForDirectory) {
+  ASSERT_EQ(request(HTTP_GET, "/"), ESP_OK);
+  EXPECT_EQ(response_.status, 200);
+  EXPECT_STREQ(response_.content_type, "text/html");
+  EXPECT_EQ(std::string(response_.body, response_.body_len), INDEX_HTML);
+  EXPECT_EQ(response_.chunks, 2u);
+}
+
+TEST_F(RestServer, MissingFileIs500) {
+  EXPECT_EQ(request(HTTP_GET, "/missing.js"), ESP_FAIL);
+  EXPECT_EQ(response_.status, 500);
+}
+
+TEST_F(RestServer, CountsRequestsInMetrics) {
+  ASSERT_EQ(request(HTTP_GET, "/api/v1/system/info"), ESP_OK);
+  ASSERT_EQ(request(HTTP_GET, "/metrics"), ESP_OK);
+  std::string metrics(response_.body, response_.body_len);
+  EXPECT_NE(metrics.find("rest_requests_total{endpoint=\"info\"}"), std::string::npos);
+  EXPECT_NE(metrics.find("esp_heap_free_bytes"), std::string::npos);
+}
+
+TEST_F(RestServer, RestartRespondsThenResets) {
+  EXPECT_EXIT(request(HTTP_POST, "/api/v1/system/restart"), testing::ExitedWithCode(0), "esp_restart");
+}
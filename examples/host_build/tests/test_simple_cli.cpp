@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "freertos_mock.h"
+#include "linenoise_mock.h"
+#include "simple_cli.h"
+
+static std::mutex s_lock;
+static std::vector<std::string> s_calls;
+
+/**
+ * @brief Record the words of the line, joined with '|'
+ */
+static int record_command(int argc, char** argv) {
+  std::string call = argv[0];
+  for (int i = 1; i < argc; i++) {
+    call += '|';
+    call += argv[i];
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  s_calls.push_back(call);
+  return 0;
+}
+
+static int failing_command(int argc, char** argv) { return ESP_ERR_INVALID_STATE; }
+
+constexpr std::array<esp_console_cmd_t, 2> COMMANDS = {{
+    {.command = "record", .help = "Record the arguments", .hint = "<words...>", .func = &record_command},
+    {.command = "fail", .help = "Return an error", .hint = NULL, .func = &failing_command},
+}};
+
+/**
+ * @brief A CLI on the UART interface, reading lines from the linenoise mock
+ */
+class SimpleCliTest : public testing::Test {
+ protected:
+  void TearDown() override {
+    cli_.stop();
+    EXPECT_TRUE(freertos_mock_wait_tasks(1000));
+    esp_console_deinit();
+    s_calls.clear();
+  }
+
+  /**
+   * @brief Wait up to a second for the commands to have recorded count calls
+   */
+  static std::vector<std::string> wait_for_calls(size_t count) {
+    for (int i = 0; i < 100; i++) {
+      {
+        std::lock_guard<std::mutex> lock(s_lock);
+        if (s_calls.size() >= count) {
+          return s_calls;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::lock_guard<std::mutex> lock(s_lock);
+    return s_calls;
+  }
+
+  SimpleCLI cli_{"test> ", SimpleCLIInterface::UART};
+};
+
+TEST_F(SimpleCliTest, RunsLinesInOrder) {
+  cli_.register_commands(COMMANDS);
+  cli_.start();
+
+  // Unknown commands, empty lines and failing commands leave the REPL running
+  ASSERT_EQ(esp_linenoise_mock_push_line("record a \"b c\""), ESP_OK);
+  ASSERT_EQ(esp_linenoise_mock_push_line("nope"), ESP_OK);
+  ASSERT_EQ(esp_linenoise_mock_push_line("   "), ESP_OK);
+  ASSERT_EQ(esp_linenoise_mock_push_line("fail"), ESP_OK);
+  ASSERT_EQ(esp_linenoise_mock_push_line("record done"), ESP_OK);
+
+  std::vector<std::string> calls = wait_for_calls(2);
+  ASSERT_EQ(calls.size(), 2u);
+  EXPECT_EQ(calls[0], "record|a|b c");
+  EXPECT_EQ(calls[1], "record|done");
+}
+
+TEST_F(SimpleCliTest, RegistersCommandAfterStart) {
+  cli_.start();
+  cli_.register_command(COMMANDS[0]);
+  ASSERT_EQ(esp_linenoise_mock_push_line("record late"), ESP_OK);
+
+  std::vector<std::string> calls = wait_for_calls(1);
+  ASSERT_EQ(calls.size(), 1u);
+  EXPECT_EQ(calls[0], "record|late");
+}
+
+TEST_F(SimpleCliTest, StopEndsTask) {
+  cli_.start();
+  cli_.stop();
+  EXPECT_TRUE(freertos_mock_wait_tasks(1000));
+
+  // The console and its commands outlive the task
+  int ret;
+  EXPECT_EQ(esp_console_run("help", &ret), ESP_OK);
+}
@@ -1,13 +1,22 @@
 #include <stdio.h>
 #include <string.h>
 
-#include <chrono>
-#include <thread>
-
 #include "esp_netif.h"
 #include "nvs_flash.h"
+#include "timer_wheel.h"
 #include "wifi_connect.h"
 
+static timer_wheel_timer_t s_status_timer;
+
+static void print_wifi_status(void* arg) {
+  if (is_wifi_connected()) {
+    printf("WiFi is connected!\n");
+  }
+  else {
+    printf("WiFi is not connected.\n");
+  }
+}
+
 extern "C" void app_main(void) {
   // Initialize NVS
   esp_err_t ret = nvs_flash_init();
@@ -22,13 +31,8 @@ extern "C" void app_main(void) {
 
   connect_to_wifi();
 
-  while (true) {
-    if (is_wifi_connected()) {
-      printf("WiFi is connected!\n");
-    }
-    else {
-      printf("WiFi is not connected.\n");
-    }
-    std::this_thread::sleep_for(std::chrono::seconds(5));
-  }
+  // A periodic timer instead of a polling loop, so app_main can return and free its stack
+  ESP_ERROR_CHECK(timer_wheel_start());
+  timer_wheel_timer_init(&s_status_timer, "wifi_status", print_wifi_status, NULL);
+  ESP_ERROR_CHECK(timer_wheel_schedule_periodic(&s_status_timer, 5000));
 }
\ No newline at end of file
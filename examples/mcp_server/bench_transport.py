@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+Benchmark the MCP endpoint of a running device.
+
+Sends a fixed number of JSON-RPC requests over a keep-alive connection (and optionally
+a fresh connection per request) and reports throughput and latency percentiles. Run it
+once per transport build to compare the esp_http_server transport with the lwIP socket
+transport, e.g. against QEMU with the port forwarded to the host:
+
+    python bench_transport.py --url http://localhost:3000 --label httpd
+    python bench_transport.py --url http://localhost:3000 --label lwip
+
+With --interval-ms the device goes idle between requests, so the latencies include waking
+up and raising the CPU frequency (compare CONFIG_PM_ENABLE builds, see README.md).
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import http.client
+import json
+import statistics
+import time
+from urllib.parse import urlparse
+
+REQUESTS = {
+    "tools/list": {"jsonrpc": "2.0", "id": 1, "method": "tools/list"},
+    "tools/call": {
+        "jsonrpc": "2.0",
+        "id": 2,
+        "method": "tools/call",
+        "params": {"name": "hello_world", "arguments": {}},
+    },
+}
+
+
+def percentile(samples, pct):
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def run(host, port, body, count, keep_alive, interval_ms=0):
+    payload = json.dumps(body).encode()
+    headers = {"Content-Type": "application/json"}
+    if not keep_alive:
+        headers["Connection"] = "close"
+
+    latencies = []
+    conn = None
+    idle = 0.0
+    start = time.perf_counter()
+    for i in range(count):
+        if interval_ms and i > 0:
+            # Idle time is left out of req/s so it stays the device's own rate
+            t_idle = time.perf_counter()
+            time.sleep(interval_ms / 1000.0)
+            idle += time.perf_counter() - t_idle
+        if conn is None:
+            conn = http.client.HTTPConnection(host, port, timeout=10)
+        t0 = time.perf_counter()
+        conn.request("POST", "/", body=payload, headers=headers)
+        response = conn.getresponse()
+        response.read()
+        latencies.append((time.perf_counter() - t0) * 1000.0)
+        if response.status != 200:
+            raise RuntimeError(f"HTTP {response.status}")
+        if not keep_alive:
+            conn.close()
+            conn = None
+    elapsed = time.perf_counter() - start - idle
+    if conn is not None:
+        conn.close()
+
+    return {
+        "req_per_s": count / elapsed,
+        "p50": statistics.median(latencies),
+        "p95": percentile(latencies, 95),
+        "p99": percentile(latencies, 99),
+        "max": max(latencies),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark an MCP HTTP endpoint")
+    parser.add_argument("--url", default="http://localhost:3000", help="Base URL of the MCP server")
+    parser.add_argument("--count", type=int, default=200, help="Requests per scenario")
+    parser.add_argument("--warmup", type=int, default=10, help="Warmup requests per scenario")
+    parser.add_argument("--label", default="device", help="Label printed with the results (e.g. transport name)")
+    parser.add_argument("--no-close", action="store_true", help="Skip the connection-per-request scenarios")
+    parser.add_argument("--interval-ms", type=int, default=0,
+                        help="Pause between requests so each one starts from an idle device")
+    args = parser.parse_args()
+
+    url = urlparse(args.url)
+    host, port = url.hostname, url.port or 80
+
+    modes = [True] if args.no_close else [True, False]
+    print(f"| {'transport':<10} | {'method':<10} | {'conn':<10} | {'req/s':>8} | {'p50 ms':>8} | "
+          f"{'p95 ms':>8} | {'p99 ms':>8} | {'max ms':>8} |")
+    print(f"|{'-' * 12}|{'-' * 12}|{'-' * 12}|{'-' * 10}|{'-' * 10}|{'-' * 10}|{'-' * 10}|{'-' * 10}|")
+    for name, body in REQUESTS.items():
+        for keep_alive in modes:
+            run(host, port, body, args.warmup, keep_alive)
+            r = run(host, port, body, args.count, keep_alive, args.interval_ms)
+            conn = "keep-alive" if keep_alive else "close"
+            print(f"| {args.label:<10} | {name:<10} | {conn:<10} | {r['req_per_s']:>8.1f} | {r['p50']:>8.2f} | "
+                  f"{r['p95']:>8.2f} | {r['p99']:>8.2f} | {r['max']:>8.2f} |")
+
+
+if __name__ == "__main__":
+    main()
@@ -2,93 +2,183 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "adc_capture.h"
+#include "adc_capture_export.h"
+#include "control_loop.h"
+#include "esp_event.h"
+#include "esp_littlefs.h"
 #include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_netif_sntp.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "mcp_schema.h"
-#include "mcp_server.h"
+#include "mcp_server_cpp.h"
+#include "mcp_wait.h"
+#include "metrics.h"
+#include "nvs_flash.h"
+#include "pm_activity.h"
+#include "qemu_internet.h"
+#include "sensor_sampler.h"
+#include "stack_monitor.h"
+#include "timer_wheel.h"
+#include "ts_store.h"
+#include "ts_store_export.h"
 #include "wifi_connect.h"
 
 static const char* TAG = "main";
-static double thermostat_setpoint = 72.0;  // Default setpoint in degrees
+static const float DEFAULT_SETPOINT = 72.0f;  // Default setpoint in degrees
+static control_loop_t* thermostat_loop = NULL;
+static volatile float heater_duty = 0.0f;
+static sensor_handle_t temperature_sensor = SENSOR_HANDLE_INVALID;
+static ts_series_t* temperature_history = NULL;
+
+// Wall clock is considered valid once SNTP has moved it past this (2023-11-14)
+static const int64_t TIME_VALID_AFTER_MS = 1700000000000LL;
+
+// The history task looks for a new sample at the sampling rate
+static const uint32_t TEMPERATURE_PERIOD_MS = 1000;
+#define HISTORY_TASK_STACK_SIZE 4096  // A #define so stack_report.py can resolve it
 
 /**
- * @brief Hello World tool handler
+ * @brief Mount the storage partition and open the temperature history series
  *
- * This is a simple example tool that returns a greeting message.
+ * History is optional; the example keeps running without it.
  */
-static mcp_tool_result_t hello_world_handler(const mcp_tool_args_t* args) {
-  ESP_LOGI(TAG, "Hello World tool called");
-  return mcp_tool_result_success("Hello from ESP32 MCP Server!");
+static void init_history() {
+  esp_vfs_littlefs_conf_t storage_conf = {
+      .base_path = "/storage",
+      .partition_label = "storage",
+      .format_if_mount_failed = true,
+      .dont_mount = false,
+  };
+
+  esp_err_t ret = esp_vfs_littlefs_register(&storage_conf);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to mount storage (%s), history disabled", esp_err_to_name(ret));
+    return;
+  }
+
+  ts_series_config_t history_config = TS_SERIES_DEFAULT_CONFIG("temperature");
+  history_config.scale = 10.0f;  // 0.1 degree resolution
+  if (ts_store_init("/storage/ts") != ESP_OK || ts_series_open(&history_config, &temperature_history) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to open temperature history");
+    temperature_history = NULL;
+  }
 }
 
 /**
- * @brief Get Temperature tool handler
+ * @brief Read the temperature sensor
  *
- * Returns the current temperature reading.
+ * Runs on the sensor sampler task, never in the request path. Only reads the sensor, so
+ * the snapshot is published on time; the history is recorded by history_task.
  * Currently returns a random value between 40 and 80 degrees.
  * TODO: Replace with actual sensor reading.
  */
-static mcp_tool_result_t get_temperature_handler(const mcp_tool_args_t* args) {
-  ESP_LOGI(TAG, "Get Temperature tool called");
+static esp_err_t read_temperature(float* values, void* context) {
+  values[0] = 40.0f + ((float)(rand() % 41));
+  return ESP_OK;
+}
 
-  // Generate random temperature between 40 and 80 degrees
-  float temperature = 40.0f + ((float)(rand() % 41));
+/**
+ * @brief Append each new temperature snapshot to the history
+ *
+ * A low-priority task of its own, since LittleFS writes and flushes can take tens of
+ * milliseconds and must not delay the sampler or the timer wheel.
+ */
+static void history_task(void* arg) {
+  int64_t last_timestamp_us = 0;
+  TickType_t wake = xTaskGetTickCount();
+  while (true) {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(TEMPERATURE_PERIOD_MS));
 
-  char result[64];
-  snprintf(result, sizeof(result), "{\"temperature\": %.1f, \"unit\": \"F\"}", temperature);
+    sensor_snapshot_t snapshot;
+    if (sensor_sampler_read(temperature_sensor, &snapshot) != ESP_OK || snapshot.timestamp_us == last_timestamp_us) {
+      continue;
+    }
+    last_timestamp_us = snapshot.timestamp_us;
 
-  return mcp_tool_result_success(result);
+    // Record once SNTP has set the clock, so timestamps are comparable across restarts
+    int64_t now_ms = ts_store_now_ms();
+    if (now_ms > TIME_VALID_AFTER_MS) {
+      int64_t sampled_ms = now_ms - (esp_timer_get_time() - snapshot.timestamp_us) / 1000;
+      ts_series_append(temperature_history, sampled_ms, snapshot.values[0]);
+    }
+  }
 }
 
 /**
- * @brief Set Thermostat tool handler
- *
- * Sets the thermostat setpoint temperature.
- * Currently stores in a global variable.
- * TODO: Integrate with actual thermostat control.
+ * @brief Sampler that lets the wait_for tool watch the temperature snapshot
  */
-static mcp_tool_result_t set_thermostat_handler(const mcp_tool_args_t* args) {
-  ESP_LOGI(TAG, "Set Thermostat tool called");
+static bool temperature_sampler(double* out, void* context) {
+  float temperature;
+  if (sensor_sampler_read_value(temperature_sensor, 0, &temperature, NULL) != ESP_OK) {
+    return false;
+  }
+  *out = temperature;
+  return true;
+}
 
-  // Get the temperature value from arguments using helper function
-  double new_setpoint = mcp_tool_args_get_double(args, "temperature", -999.0);
+/**
+ * @brief Thermostat control step, runs every 10 ms on the control loop task
+ *
+ * PI controller from the latest temperature snapshot to a heater duty cycle. If the read
+ * overlaps a publish (ESP_ERR_TIMEOUT), the step runs on the last good temperature rather
+ * than skipping a period.
+ * TODO: Drive the heater output (e.g. LEDC PWM) from heater_duty.
+ */
+static void thermostat_step(const control_loop_tick_t* tick, void* context) {
+  static float integral = 0.0f;
+  static float last_temperature = 0.0f;
+  static bool have_temperature = false;
+  const float kp = 0.2f;
+  const float ki = 0.01f;
 
-  // Validate the temperature is within a reasonable range
-  if (new_setpoint == -999.0 || new_setpoint < 40.0 || new_setpoint > 90.0) {
-    return mcp_tool_result_error("Invalid temperature value (must be between 40 and 90 degrees)");
+  float temperature;
+  if (sensor_sampler_read_value(temperature_sensor, 0, &temperature, NULL) == ESP_OK) {
+    last_temperature = temperature;
+    have_temperature = true;
+  }
+  else if (have_temperature) {
+    temperature = last_temperature;
+  }
+  else {
+    return;
   }
 
-  thermostat_setpoint = new_setpoint;
-
-  char result[64];
-  snprintf(result, sizeof(result), "{\"setpoint\": %.1f, \"status\": \"success\"}", thermostat_setpoint);
+  float error = tick->setpoint - temperature;
+  float dt = tick->period_us / 1e6f;
+  integral += error * dt;
+  integral = integral > 50.0f ? 50.0f : (integral < -50.0f ? -50.0f : integral);
 
-  ESP_LOGI(TAG, "Thermostat setpoint updated to %.1f", thermostat_setpoint);
-  return mcp_tool_result_success(result);
+  float duty = kp * error + ki * integral;
+  heater_duty = duty > 1.0f ? 1.0f : (duty < 0.0f ? 0.0f : duty);
 }
 
+#if CONFIG_EXAMPLE_MCP_TRANSPORT_HTTPD
 /**
- * @brief Declarative tool definition for hello_world
+ * @brief Seconds spent with at least one request or command running at full CPU speed
+ *
+ * Divided by esp_uptime_seconds this is the active ratio to compare against idle current.
  */
-static const mcp_tool_definition_t HELLO_WORLD_TOOL = {
-    .name = "hello_world",
-    .description = "Returns a friendly greeting from the ESP32",
-    .handler = hello_world_handler,
-    .parameters = NULL,
-    .parameter_count = 0,
-};
+static double read_pm_active_seconds(void* context) {
+  pm_activity_stats_t stats;
+  pm_activity_get_stats(&stats);
+  return stats.active_us / 1e6;
+}
 
-/**
- * @brief Declarative tool definition for get_temperature
- */
-static const mcp_tool_definition_t GET_TEMPERATURE_TOOL = {
-    .name = "get_temperature",
-    .description = "Gets the current temperature reading in Fahrenheit",
-    .handler = get_temperature_handler,
-    .parameters = NULL,
-    .parameter_count = 0,
-};
+static double read_pm_activities(void* context) {
+  pm_activity_stats_t stats;
+  pm_activity_get_stats(&stats);
+  return stats.activities;
+}
+
+static METRICS_GAUGE_DEFINE_FN(pm_active_seconds, "pm_active_seconds", "Time spent handling requests at full CPU speed",
+                               read_pm_active_seconds, NULL);
+static METRICS_GAUGE_DEFINE_FN(pm_activities, "pm_activities", "Requests and commands handled as PM activities",
+                               read_pm_activities, NULL);
+#endif
 
 /**
  * @brief Parameter schema for set_thermostat tool
@@ -99,16 +189,83 @@ static const mcp_param_schema_t SET_THERMOSTAT_PARAMS[] = {
 };
 
 /**
- * @brief Declarative tool definition for set_thermostat
+ * @brief Parameter schema for get_control_stats tool
  */
-static const mcp_tool_definition_t SET_THERMOSTAT_TOOL = {
-    .name = "set_thermostat",
-    .description = "Sets the thermostat setpoint temperature in Fahrenheit",
-    .handler = set_thermostat_handler,
-    .parameters = SET_THERMOSTAT_PARAMS,
-    .parameter_count = sizeof(SET_THERMOSTAT_PARAMS) / sizeof(SET_THERMOSTAT_PARAMS[0]),
+static const mcp_param_schema_t GET_CONTROL_STATS_PARAMS[] = {
+    MCP_PARAM_BOOLEAN("reset", "Reset the statistics after reading them"),
 };
 
+/**
+ * @brief Register the example's own tools
+ *
+ * Handlers are lambdas; the thermostat ones capture the loop they control.
+ */
+static esp_err_t register_tools(McpServer& server, control_loop_t* loop) {
+  esp_err_t ret = server.add_tool("hello_world", "Returns a friendly greeting from the ESP32", [] {
+    ESP_LOGI(TAG, "Hello World tool called");
+    return McpToolResult::success("Hello from ESP32 MCP Server!");
+  });
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  // Returns the latest temperature snapshot and its age
+  ret = server.add_tool("get_temperature", "Gets the current temperature reading in Fahrenheit", [] {
+    ESP_LOGI(TAG, "Get Temperature tool called");
+    float temperature;
+    uint32_t age_ms;
+    if (sensor_sampler_read_value(temperature_sensor, 0, &temperature, &age_ms) != ESP_OK) {
+      return McpToolResult::error("Temperature not available yet");
+    }
+    return McpToolResult::format("{\"temperature\": %.1f, \"unit\": \"F\", \"age_ms\": %lu}", temperature,
+                                 (unsigned long)age_ms);
+  });
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  // The control loop picks the new setpoint up at its next step
+  auto set_thermostat = [loop](const McpToolArgs& args) {
+    ESP_LOGI(TAG, "Set Thermostat tool called");
+    double new_setpoint = args.get_double("temperature", -999.0);
+    if (new_setpoint < 40.0 || new_setpoint > 90.0) {
+      return McpToolResult::error("Invalid temperature value (must be between 40 and 90 degrees)");
+    }
+    control_loop_set_setpoint(loop, (float)new_setpoint);
+    ESP_LOGI(TAG, "Thermostat setpoint updated to %.1f", new_setpoint);
+    return McpToolResult::format("{\"setpoint\": %.1f, \"status\": \"success\"}", new_setpoint);
+  };
+  ret = server.add_tool("set_thermostat", "Sets the thermostat setpoint temperature in Fahrenheit",
+                        SET_THERMOSTAT_PARAMS, set_thermostat);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  // Thermostat loop timing (jitter and execution time quantiles and histograms) and heater duty
+  auto get_control_stats = [loop](const McpToolArgs& args) {
+    char stats[640];
+    int len = control_loop_format_stats(loop, stats, sizeof(stats));
+    if (len < 0) {
+      return McpToolResult::error("Failed to read control loop stats");
+    }
+    // Truncated JSON would corrupt the whole result, so report it instead of embedding it
+    if ((size_t)len >= sizeof(stats)) {
+      ESP_LOGE(TAG, "Control loop stats need more than %u bytes", (unsigned)sizeof(stats));
+      return McpToolResult::error("Control loop stats truncated");
+    }
+    McpToolResult result = McpToolResult::format("{\"setpoint\": %.1f, \"heater_duty\": %.2f, \"timing\": %s}",
+                                                 control_loop_get_setpoint(loop), heater_duty, stats);
+    if (args.get_bool("reset", false)) {
+      control_loop_reset_stats(loop);
+    }
+    return result;
+  };
+  return server.add_tool("get_control_stats",
+                         "Gets thermostat control loop timing: alarm-to-step latency and step execution time "
+                         "histograms (bucket i counts [2^(i-1), 2^i) us), overruns and missed ticks",
+                         GET_CONTROL_STATS_PARAMS, get_control_stats);
+}
+
 extern "C" void app_main(void) {
   ESP_LOGI(TAG, "Starting MCP Server example");
 
@@ -119,10 +276,19 @@ extern "C" void app_main(void) {
     ret = nvs_flash_init();
   }
   ESP_ERROR_CHECK(ret);
+
+  // Scale the CPU down between requests; before any server can start an activity
+  ESP_ERROR_CHECK(pm_activity_init());
+
   // Initialize network interface
   ESP_ERROR_CHECK(esp_netif_init());
   ESP_ERROR_CHECK(esp_event_loop_create_default());
 
+#if CONFIG_EXAMPLE_MCP_NETWORK_QEMU
+  // Bring up the QEMU OpenEth interface (blocks until DHCP completes)
+  ESP_LOGI(TAG, "Connecting to QEMU network...");
+  ESP_ERROR_CHECK(qemu_internet_connect());
+#else
   // Connect to WiFi
   ESP_LOGI(TAG, "Connecting to WiFi...");
   connect_to_wifi();
@@ -132,38 +298,109 @@ extern "C" void app_main(void) {
     vTaskDelay(pdMS_TO_TICKS(100));
   }
   ESP_LOGI(TAG, "WiFi connected!");
+#endif
 
-  // Create MCP server with HTTP transport
-  mcp_server_t* server = mcp_server_create(MCP_TRANSPORT_HTTP);
-  if (!server) {
+  // Wall clock for history timestamps; syncs in the background
+  esp_sntp_config_t sntp_config = ESP_NETIF_SNTP_DEFAULT_CONFIG("pool.ntp.org");
+  esp_netif_sntp_init(&sntp_config);
+  init_history();
+
+  // Sample the temperature sensor in the background so tools only read the latest snapshot
+  const sensor_config_t temperature_config = {
+      .name = "temperature",
+      .period_ms = TEMPERATURE_PERIOD_MS,
+      .value_count = 1,
+      .read = read_temperature,
+      .context = NULL,
+  };
+  ESP_ERROR_CHECK(sensor_sampler_register(&temperature_config, &temperature_sensor));
+  ESP_ERROR_CHECK(sensor_sampler_start());
+  if (temperature_history &&
+      xTaskCreate(history_task, "history", HISTORY_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create history task, history disabled");
+  }
+
+  // Track every task's stack high-water mark, logged each minute for stack_report.py
+  ESP_ERROR_CHECK(timer_wheel_start());
+  ESP_ERROR_CHECK(stack_monitor_start());
+
+  // Fixed-rate thermostat loop on the last core, away from WiFi/lwIP on core 0
+  const control_loop_config_t loop_config = {
+      .name = "thermostat",
+      .period_us = 10000,
+      .core_id = portNUM_PROCESSORS - 1,
+      .priority = configMAX_PRIORITIES - 2,
+      .initial_setpoint = DEFAULT_SETPOINT,
+      .step = thermostat_step,
+      .context = NULL,
+  };
+  ESP_ERROR_CHECK(control_loop_create(&loop_config, &thermostat_loop));
+
+  // Create MCP server with the selected HTTP transport; destroyed on any early return
+#if CONFIG_EXAMPLE_MCP_TRANSPORT_LWIP
+  McpServer server(MCP_TRANSPORT_HTTP_LWIP);
+#else
+  McpServer server(MCP_TRANSPORT_HTTP);
+#endif
+  if (!server.valid()) {
     ESP_LOGE(TAG, "Failed to create MCP server");
     return;
   }
 
-  // Register all tools using declarative API
-  const mcp_tool_definition_t* tools[] = {
-      &HELLO_WORLD_TOOL,
-      &GET_TEMPERATURE_TOOL,
-      &SET_THERMOSTAT_TOOL,
-  };
+  // Values the built-in wait_for tool can watch
+  ESP_ERROR_CHECK(mcp_wait_register_value("temperature", temperature_sampler, NULL));
 
-  esp_err_t ret = mcp_server_register_tools(server, tools, sizeof(tools) / sizeof(tools[0]));
+  // The example's tools, then the ones the shared components define in C
+  const mcp_tool_definition_t* const component_tools[] = {
+      &MCP_WAIT_FOR_TOOL,
+      &TS_QUERY_HISTORY_TOOL,
+  };
+  ret = register_tools(server, thermostat_loop);
+  if (ret == ESP_OK) {
+    ret = server.register_tools(component_tools);
+  }
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "Failed to register tools");
-    mcp_server_destroy(server);
     return;
   }
 
-  // Start the server on port 3000
-  ret = mcp_server_start(server, 3000);
+  // Advertise as _mcp._tcp so clients can discover the device and skip tools/list when cached
+  ret = server.enable_mdns(CONFIG_EXAMPLE_MCP_MDNS_HOSTNAME, "ESP32 MCP Server");
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "mDNS advertisement disabled");
+  }
+
+  // Start the server on the configured port
+  ret = server.start(CONFIG_EXAMPLE_MCP_PORT);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "Failed to start MCP server");
-    mcp_server_destroy(server);
     return;
   }
 
-  ESP_LOGI(TAG, "MCP Server running on port 3000");
-  ESP_LOGI(TAG, "Registered tools: %zu", mcp_server_get_tool_count(server));
+#if CONFIG_EXAMPLE_MCP_TRANSPORT_HTTPD
+  // History for dashboards and Prometheus scrapes, on the MCP listener
+  ESP_ERROR_CHECK(ts_store_register_http(CONFIG_EXAMPLE_MCP_PORT));
+  ESP_ERROR_CHECK(metrics_register_system());
+  ESP_ERROR_CHECK(metrics_register(&pm_active_seconds.base));
+  ESP_ERROR_CHECK(metrics_register(&pm_activities.base));
+  ESP_ERROR_CHECK(metrics_register_http(CONFIG_EXAMPLE_MCP_PORT));
+#endif
+
+#if CONFIG_EXAMPLE_MCP_ADC_CAPTURE
+  // kHz-rate capture, exported over MCP (short blocks) and as a chunked HTTP stream
+  adc_capture_config_t adc_config = ADC_CAPTURE_DEFAULT_CONFIG();
+  adc_config.channel = (adc_channel_t)CONFIG_EXAMPLE_MCP_ADC_CHANNEL;
+  if (adc_capture_init(&adc_config) == ESP_OK) {
+    server.register_tool(ADC_CAPTURE_TOOL);
+#if CONFIG_EXAMPLE_MCP_TRANSPORT_HTTPD
+    // Shares the MCP listener; the lwIP transport owns its port, so no stream there
+    ESP_ERROR_CHECK(adc_capture_register_http(CONFIG_EXAMPLE_MCP_PORT));
+#endif
+  }
+#endif
+
+  ESP_LOGI(TAG, "MCP Server running on port %d", CONFIG_EXAMPLE_MCP_PORT);
+  ESP_LOGI(TAG, "Registered tools: %zu", server.tool_count());
   ESP_LOGI(TAG, "Ready to accept requests!");
 
   // Keep running
@@ -15,8 +15,11 @@
 #include "esp_log.h"
 #include "esp_ota_ops.h"
 #include "esp_random.h"
+#include "esp_system.h"
 #include "esp_timer.h"
 #include "esp_vfs.h"
+#include "metrics.h"
+#include "shared_httpd.h"
 
 static const char* REST_TAG = "esp-rest";
 #define REST_CHECK(a, str, goto_tag, ...)                                        \
@@ -35,6 +38,15 @@ typedef struct rest_server_context {
   char scratch[SCRATCH_BUFSIZE];
 } rest_server_context_t;
 
+/* Per-endpoint request counters, one labeled series each under rest_requests_total */
+static METRICS_COUNTER_DEFINE_LABELED(info_requests, "rest_requests_total", "endpoint=\"info\"",
+                                      "REST API requests by endpoint");
+static METRICS_COUNTER_DEFINE_LABELED(memory_requests, "rest_requests_total", "endpoint=\"memory\"",
+                                      "REST API requests by endpoint");
+static METRICS_COUNTER_DEFINE_LABELED(leak_requests, "rest_requests_total", "endpoint=\"leak\"",
+                                      "REST API requests by endpoint");
+static METRICS_COUNTER_DEFINE(leaked_bytes, "rest_leaked_bytes_total", "Bytes leaked on purpose via /system/leak");
+
 #define CHECK_FILE_EXTENSION(filename, ext) (strcasecmp(&filename[strlen(filename) - strlen(ext)], ext) == 0)
 
 /* Set HTTP response content type according to file extension */
@@ -153,6 +165,7 @@ static esp_err_t rest_common_get_handler(httpd_req_t* req) {
 
 /* Simple handler for getting system handler */
 static esp_err_t system_info_get_handler(httpd_req_t* req) {
+  metrics_counter_inc(&info_requests);
   httpd_resp_set_type(req, "application/json");
   cJSON* root = cJSON_CreateObject();
   esp_chip_info_t chip_info;
@@ -184,6 +197,7 @@ static esp_err_t system_info_get_handler(httpd_req_t* req) {
 
 /* Simple handler for getting memory data */
 static esp_err_t system_memory_get_handler(httpd_req_t* req) {
+  metrics_counter_inc(&memory_requests);
   httpd_resp_set_type(req, "application/json");
   cJSON* root = cJSON_CreateObject();
   cJSON_AddNumberToObject(root, "free_heap", esp_get_free_heap_size());
@@ -197,6 +211,7 @@ static esp_err_t system_memory_get_handler(httpd_req_t* req) {
 
 /* Handler for intentionally leaking memory */
 static esp_err_t leak_memory_post_handler(httpd_req_t* req) {
+  metrics_counter_inc(&leak_requests);
   httpd_resp_set_type(req, "application/json");
 
   // Leak random amount between 1024 and 10240 bytes (10kB)
@@ -207,6 +222,7 @@ static esp_err_t leak_memory_post_handler(httpd_req_t* req) {
   if (leaked_memory) {
     cJSON_AddNumberToObject(root, "leaked_bytes", leak_size);
     cJSON_AddStringToObject(root, "status", "success");
+    metrics_counter_add(&leaked_bytes, leak_size);
     ESP_LOGW(REST_TAG, "Intentionally leaked %zu bytes at %p", leak_size, leaked_memory);
   }
   else {
@@ -248,44 +264,49 @@ esp_err_t start_rest_server(const char* base_path) {
   REST_CHECK(rest_context, "No memory for rest context", err);
   strlcpy(rest_context->base_path, base_path, sizeof(rest_context->base_path));
 
-  httpd_handle_t server = NULL;
-  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-  config.uri_match_fn = httpd_uri_match_wildcard;
-
+  /* REST API and static assets share one httpd instance with any other module (e.g. MCP) */
   ESP_LOGI(REST_TAG, "Starting HTTP Server");
-  REST_CHECK(httpd_start(&server, &config) == ESP_OK, "Start server failed", err_start);
+  REST_CHECK(shared_httpd_start(80) == ESP_OK, "Start server failed", err_start);
 
   /* URI handler for fetching system info */
   httpd_uri_t system_info_get_uri = {
       .uri = "/api/v1/system/info", .method = HTTP_GET, .handler = system_info_get_handler, .user_ctx = rest_context};
-  httpd_register_uri_handler(server, &system_info_get_uri);
+  shared_httpd_register_uri(&system_info_get_uri);
 
   /* URI handler for fetching memory data */
   httpd_uri_t system_memory_get_uri = {.uri = "/api/v1/system/memory",
                                        .method = HTTP_GET,
                                        .handler = system_memory_get_handler,
                                        .user_ctx = rest_context};
-  httpd_register_uri_handler(server, &system_memory_get_uri);
+  shared_httpd_register_uri(&system_memory_get_uri);
 
   /* URI handler for leaking memory */
   httpd_uri_t leak_memory_post_uri = {
       .uri = "/api/v1/system/leak", .method = HTTP_POST, .handler = leak_memory_post_handler, .user_ctx = rest_context};
-  httpd_register_uri_handler(server, &leak_memory_post_uri);
+  shared_httpd_register_uri(&leak_memory_post_uri);
 
   /* URI handler for restarting */
   httpd_uri_t restart_post_uri = {
       .uri = "/api/v1/system/restart", .method = HTTP_POST, .handler = restart_post_handler, .user_ctx = rest_context};
-  httpd_register_uri_handler(server, &restart_post_uri);
+  shared_httpd_register_uri(&restart_post_uri);
 
   /* URI handler for crashing */
   httpd_uri_t crash_post_uri = {
       .uri = "/api/v1/system/crash", .method = HTTP_POST, .handler = crash_post_handler, .user_ctx = rest_context};
-  httpd_register_uri_handler(server, &crash_post_uri);
+  shared_httpd_register_uri(&crash_post_uri);
+
+  /* Prometheus scrape endpoint, must be registered before the catch-all below */
+  metrics_register(&info_requests.base);
+  metrics_register(&memory_requests.base);
+  metrics_register(&leak_requests.base);
+  metrics_register(&leaked_bytes.base);
+  metrics_register_system();
+  metrics_register_http(80);
 
   /* URI handler for getting web server files */
   httpd_uri_t common_get_uri = {
       .uri = "/*", .method = HTTP_GET, .handler = rest_common_get_handler, .user_ctx = rest_context};
-  httpd_register_uri_handler(server, &common_get_uri);
+  shared_httpd_register_uri(&common_get_uri);
 
   return ESP_OK;
 err_start:
@@ -2,9 +2,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <chrono>
-#include <thread>
-
 #include "esp_crt_bundle.h"
 #include "esp_event.h"
 #include "esp_http_client.h"
@@ -15,6 +12,7 @@
 #include "lwip/dns.h"
 #include "lwip/netdb.h"
 #include "qemu_internet.h"
+#include "timer_wheel.h"
 
 #define MAX_HTTP_RECV_BUFFER 512
 #define MAX_HTTP_OUTPUT_BUFFER 2048
@@ -26,6 +24,10 @@ extern const char howsmyssl_com_root_cert_pem_end[] asm("_binary_howsmyssl_com_r
 
 static const char* TAG = "HTTP_CLIENT";
 
+static timer_wheel_timer_t s_heartbeat_timer;
+
+static void heartbeat(void* arg) { ESP_LOGI(TAG, "Running..."); }
+
 esp_err_t _http_event_handler(esp_http_client_event_t* evt) {
   static char* output_buffer;  // Buffer to store response of http request from event handler
   static int output_len;       // Stores number of bytes read
@@ -174,8 +176,7 @@ extern "C" void app_main(void) {
   // Test direct HTTPS (may crash QEMU depending on mbedTLS settings)
   https_with_url();
 
-  while (true) {
-    ESP_LOGI(TAG, "Running...");
-    std::this_thread::sleep_for(std::chrono::seconds(3));
-  }
+  ESP_ERROR_CHECK(timer_wheel_start());
+  timer_wheel_timer_init(&s_heartbeat_timer, "heartbeat", heartbeat, NULL);
+  ESP_ERROR_CHECK(timer_wheel_schedule_periodic(&s_heartbeat_timer, 3000));
 }
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include "adc_capture.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "fir_decimator.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lockfree_queue.h"
+#include "sdkconfig.h"
+#include "soc/soc_caps.h"
+
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+#include "dsps_fird.h"
+#endif
+
+static const char* TAG = "adc_capture";
+
+#define FRAME_SAMPLES CONFIG_ADC_CAPTURE_FRAME_SAMPLES
+#define FRAME_BYTES (FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+#define READ_TIMEOUT_MS 100
+
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ADC_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ADC_GET_CHANNEL(p) ((p)->type1.channel)
+#define ADC_GET_DATA(p) ((p)->type1.data)
+#define ADC_MATCHES_UNIT(p, u) (true)
+#else
+#define ADC_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ADC_GET_CHANNEL(p) ((p)->type2.channel)
+#define ADC_GET_DATA(p) ((p)->type2.data)
+#define ADC_MATCHES_UNIT(p, u) ((p)->type2.unit == (u))
+#endif
+
+/**
+ * @brief Capture state (internal)
+ *
+ * Two rings sit between the ADC and the reader: the driver's DMA pool, drained one frame
+ * at a time by the capture task, and the lock-free output ring holding filtered samples.
+ * The capture task filters frame N while DMA fills frame N + 1, and the reader can fall
+ * behind by up to the stream buffer size before samples are dropped.
+ */
+typedef struct {
+  adc_capture_config_t config;
+  adc_continuous_handle_t adc;
+  lfq_spsc_t ring;
+  int16_t* ring_buffer;
+  SemaphoreHandle_t data_ready;  // Given after every write to the ring; wakes a blocked reader
+  volatile TaskHandle_t task;
+  volatile bool running;
+
+  int16_t* coeffs;
+  int16_t* delay;
+  size_t taps;
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+  fir_s16_t dsp;
+#else
+  fir_decimator_t fir;
+#endif
+
+  uint8_t* frame;
+  int16_t* raw;
+  int16_t* out;
+
+  adc_capture_stats_t stats;
+  atomic_uint dma_overflows;
+} adc_capture_t;
+
+static adc_capture_t s_capture;
+static bool s_initialized = false;
+
+static bool IRAM_ATTR on_pool_overflow(adc_continuous_handle_t handle, const adc_continuous_evt_data_t* edata,
+                                       void* user_data) {
+  atomic_fetch_add_explicit(&s_capture.dma_overflows, 1, memory_order_relaxed);
+  return false;
+}
+
+static void reset_filter(void) {
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+  dsps_fird_s16_aexx_free(&s_capture.dsp);
+  memset(s_capture.delay, 0, 2 * s_capture.taps * sizeof(int16_t));
+  dsps_fird_init_s16(&s_capture.dsp, s_capture.coeffs, s_capture.delay, s_capture.taps, s_capture.config.decimation,
+                     0, 0);
+#else
+  fir_decimator_init(&s_capture.fir, s_capture.coeffs, s_capture.delay, s_capture.taps,
+                     s_capture.config.decimation);
+#endif
+}
+
+/**
+ * @brief Extract the configured channel from a DMA frame as signed Q15 samples
+ */
+static size_t parse_frame(const uint8_t* frame, uint32_t length, int16_t* raw) {
+  size_t count = 0;
+  for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+    const adc_digi_output_data_t* p = (const adc_digi_output_data_t*)&frame[i];
+    if (ADC_GET_CHANNEL(p) != s_capture.config.channel || !ADC_MATCHES_UNIT(p, s_capture.config.unit)) {
+      continue;
+    }
+    // 12-bit unsigned conversion result, centered and scaled to full int16 range
+    raw[count++] = (int16_t)(((int32_t)ADC_GET_DATA(p) - 2048) << 4);
+  }
+  return count;
+}
+
+static size_t decimate(const int16_t* raw, size_t count, int16_t* out) {
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+  // The PIE kernel consumes whole decimation periods; a partial tail can only come from a
+  // short DMA frame and is skipped rather than corrupting the filter phase
+  size_t outputs = count / s_capture.config.decimation;
+  return outputs ? (size_t)dsps_fird_s16(&s_capture.dsp, raw, out, outputs) : 0;
+#else
+  return fir_decimator_process(&s_capture.fir, raw, count, out);
+#endif
+}
+
+static void capture_task(void* arg) {
+  ESP_LOGI(TAG, "Capture task started");
+
+  while (s_capture.running) {
+    uint32_t length = 0;
+    esp_err_t ret = adc_continuous_read(s_capture.adc, s_capture.frame, FRAME_BYTES, &length, READ_TIMEOUT_MS);
+    if (ret == ESP_ERR_TIMEOUT) {
+      continue;
+    }
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG, "ADC read failed: %s", esp_err_to_name(ret));
+      break;
+    }
+
+    size_t count = parse_frame(s_capture.frame, length, s_capture.raw);
+    size_t produced = decimate(s_capture.raw, count, s_capture.out);
+
+    s_capture.stats.frames++;
+    s_capture.stats.raw_samples += count;
+
+    uint32_t written = lfq_spsc_push(&s_capture.ring, s_capture.out, produced);
+    s_capture.stats.dropped_samples += produced - written;
+    if (written > 0) {
+      s_capture.stats.output_samples += written;
+      xSemaphoreGive(s_capture.data_ready);
+    }
+  }
+
+  ESP_LOGI(TAG, "Capture task stopped");
+  s_capture.running = false;
+  s_capture.task = NULL;
+  vTaskDelete(NULL);
+}
+
+static void free_buffers(void) {
+  heap_caps_free(s_capture.coeffs);
+  heap_caps_free(s_capture.delay);
+  heap_caps_free(s_capture.frame);
+  heap_caps_free(s_capture.raw);
+  heap_caps_free(s_capture.out);
+  heap_caps_free(s_capture.ring_buffer);
+  if (s_capture.data_ready) {
+    vSemaphoreDelete(s_capture.data_ready);
+  }
+}
+
+static esp_err_t setup_filter(const adc_capture_config_t* config) {
+  size_t taps = config->fir_coeffs ? config->fir_taps : CONFIG_ADC_CAPTURE_FIR_TAPS;
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+  // The PIE kernel processes 8 taps per iteration; zero-pad to a multiple of 8
+  size_t padded = (taps + 7) & ~(size_t)7;
+#else
+  size_t padded = taps;
+#endif
+
+  // 16-byte alignment for 128-bit PIE loads; harmless on other targets
+  s_capture.coeffs = heap_caps_aligned_calloc(16, padded, sizeof(int16_t), MALLOC_CAP_DEFAULT);
+  s_capture.delay = heap_caps_aligned_calloc(16, 2 * padded, sizeof(int16_t), MALLOC_CAP_DEFAULT);
+  if (!s_capture.coeffs || !s_capture.delay) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  if (config->fir_coeffs) {
+    memcpy(s_capture.coeffs, config->fir_coeffs, taps * sizeof(int16_t));
+  }
+  else {
+    // Pass band up to 80% of the output Nyquist frequency
+    fir_design_lowpass_q15(s_capture.coeffs, taps, 0.4f / (float)config->decimation);
+  }
+  s_capture.taps = padded;
+  return ESP_OK;
+}
+
+esp_err_t adc_capture_init(const adc_capture_config_t* config) {
+  if (!config || config->decimation == 0 || (config->fir_coeffs && config->fir_taps == 0)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (config->sample_rate_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW || config->sample_rate_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) {
+    ESP_LOGE(TAG, "Sample rate %lu Hz out of range (%d - %d)", (unsigned long)config->sample_rate_hz,
+             SOC_ADC_SAMPLE_FREQ_THRES_LOW, SOC_ADC_SAMPLE_FREQ_THRES_HIGH);
+    return ESP_ERR_INVALID_ARG;
+  }
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+  if (FRAME_SAMPLES % config->decimation != 0) {
+    ESP_LOGE(TAG, "Frame size (%d samples) must be a multiple of the decimation factor", FRAME_SAMPLES);
+    return ESP_ERR_INVALID_ARG;
+  }
+#endif
+
+  memset(&s_capture, 0, sizeof(s_capture));
+  s_capture.config = *config;
+
+  esp_err_t ret = setup_filter(config);
+  if (ret != ESP_OK) {
+    free_buffers();
+    return ret;
+  }
+
+  s_capture.frame = heap_caps_malloc(FRAME_BYTES, MALLOC_CAP_DEFAULT);
+  s_capture.raw = heap_caps_malloc(FRAME_SAMPLES * sizeof(int16_t), MALLOC_CAP_DEFAULT);
+  s_capture.out = heap_caps_aligned_alloc(16, (FRAME_SAMPLES / config->decimation + 1) * sizeof(int16_t),
+                                          MALLOC_CAP_DEFAULT);
+  // The ring holds a power of two of samples, the largest that fits the configured size
+  uint32_t ring_samples = 1u << (31 - __builtin_clz(CONFIG_ADC_CAPTURE_STREAM_BUFFER_SIZE / sizeof(int16_t)));
+  s_capture.ring_buffer = heap_caps_malloc(ring_samples * sizeof(int16_t), MALLOC_CAP_DEFAULT);
+  s_capture.data_ready = xSemaphoreCreateBinary();
+  if (!s_capture.frame || !s_capture.raw || !s_capture.out || !s_capture.ring_buffer || !s_capture.data_ready) {
+    ESP_LOGE(TAG, "Failed to allocate capture buffers");
+    free_buffers();
+    return ESP_ERR_NO_MEM;
+  }
+  lfq_spsc_init(&s_capture.ring, s_capture.ring_buffer, sizeof(int16_t), ring_samples);
+
+  adc_continuous_handle_cfg_t handle_config = {
+      .max_store_buf_size = FRAME_BYTES * CONFIG_ADC_CAPTURE_DMA_FRAMES,
+      .conv_frame_size = FRAME_BYTES,
+  };
+  ret = adc_continuous_new_handle(&handle_config, &s_capture.adc);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create ADC handle: %s", esp_err_to_name(ret));
+    free_buffers();
+    return ret;
+  }
+
+  adc_digi_pattern_config_t pattern = {
+      .atten = config->atten,
+      .channel = config->channel,
+      .unit = config->unit,
+      .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH,
+  };
+  adc_continuous_config_t adc_config = {
+      .pattern_num = 1,
+      .adc_pattern = &pattern,
+      .sample_freq_hz = config->sample_rate_hz,
+      .conv_mode = config->unit == ADC_UNIT_1 ? ADC_CONV_SINGLE_UNIT_1 : ADC_CONV_SINGLE_UNIT_2,
+      .format = ADC_OUTPUT_FORMAT,
+  };
+  ret = adc_continuous_config(s_capture.adc, &adc_config);
+  if (ret == ESP_OK) {
+    adc_continuous_evt_cbs_t callbacks = {.on_pool_ovf = on_pool_overflow};
+    ret = adc_continuous_register_event_callbacks(s_capture.adc, &callbacks, NULL);
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to configure ADC: %s", esp_err_to_name(ret));
+    adc_continuous_deinit(s_capture.adc);
+    free_buffers();
+    return ret;
+  }
+
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+  dsps_fird_init_s16(&s_capture.dsp, s_capture.coeffs, s_capture.delay, s_capture.taps, config->decimation, 0, 0);
+#endif
+
+  s_initialized = true;
+  ESP_LOGI(TAG, "ADC capture ready: unit %d channel %d, %lu Hz / %lu = %lu Hz, %u taps (%s)", config->unit + 1,
+           config->channel, (unsigned long)config->sample_rate_hz, (unsigned long)config->decimation,
+           (unsigned long)adc_capture_get_output_rate(), (unsigned)s_capture.taps,
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+           "esp-dsp"
+#else
+           "scalar"
+#endif
+  );
+  return ESP_OK;
+}
+
+esp_err_t adc_capture_deinit(void) {
+  if (!s_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (s_capture.task) {
+    adc_capture_stop();
+  }
+
+#if CONFIG_ADC_CAPTURE_USE_ESP_DSP
+  dsps_fird_s16_aexx_free(&s_capture.dsp);
+#endif
+  adc_continuous_deinit(s_capture.adc);
+  free_buffers();
+  memset(&s_capture, 0, sizeof(s_capture));
+  s_initialized = false;
+  return ESP_OK;
+}
+
+esp_err_t adc_capture_start(void) {
+  if (!s_initialized || s_capture.task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // The capture task is stopped, so neither side of the ring is in use
+  lfq_spsc_reset(&s_capture.ring);
+  xSemaphoreTake(s_capture.data_ready, 0);
+  reset_filter();
+  memset(&s_capture.stats, 0, sizeof(s_capture.stats));
+  atomic_store(&s_capture.dma_overflows, 0);
+
+  esp_err_t ret = adc_continuous_start(s_capture.adc);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to start ADC: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  s_capture.running = true;
+  TaskHandle_t task = NULL;
+  if (xTaskCreate(capture_task, "adc_capture", CONFIG_ADC_CAPTURE_TASK_STACK_SIZE, NULL,
+                  CONFIG_ADC_CAPTURE_TASK_PRIORITY, &task) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create capture task");
+    s_capture.running = false;
+    adc_continuous_stop(s_capture.adc);
+    return ESP_ERR_NO_MEM;
+  }
+  s_capture.task = task;
+  return ESP_OK;
+}
+
+esp_err_t adc_capture_stop(void) {
+  if (!s_capture.task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  s_capture.running = false;
+  while (s_capture.task) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  return adc_continuous_stop(s_capture.adc);
+}
+
+size_t adc_capture_read(int16_t* out, size_t max_samples, TickType_t timeout) {
+  if (!s_initialized || !out || max_samples == 0) {
+    return 0;
+  }
+
+  // data_ready may still be given from samples read earlier, so wake-ups are only a hint to
+  // look at the ring again until the timeout has passed
+  TickType_t start = xTaskGetTickCount();
+  size_t count = lfq_spsc_pop(&s_capture.ring, out, max_samples);
+  while (count == 0) {
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= timeout || xSemaphoreTake(s_capture.data_ready, timeout - elapsed) != pdTRUE) {
+      break;
+    }
+    count = lfq_spsc_pop(&s_capture.ring, out, max_samples);
+  }
+  return count;
+}
+
+uint32_t adc_capture_get_output_rate(void) {
+  if (s_capture.config.decimation == 0) {
+    return 0;
+  }
+  return s_capture.config.sample_rate_hz / s_capture.config.decimation;
+}
+
+esp_err_t adc_capture_get_stats(adc_capture_stats_t* out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *out = s_capture.stats;
+  out->dma_overflows = atomic_load_explicit(&s_capture.dma_overflows, memory_order_relaxed);
+  return ESP_OK;
+}
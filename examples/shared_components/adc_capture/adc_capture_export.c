@@ -0,0 +1,183 @@
+#include "adc_capture_export.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "adc_capture.h"
+#include "base64_codec.h"
+#include "esp_log.h"
+#include "mcp_schema.h"
+#include "sdkconfig.h"
+#include "shared_httpd.h"
+
+static const char* TAG = "adc_export";
+
+#define STREAM_CHUNK_SAMPLES 512
+#define STREAM_DEFAULT_SAMPLES 16384
+#define STREAM_READ_TIMEOUT_MS 1000
+
+// Samples read from the ring per encoder call; the encoder carries partial groups across calls
+#define ENCODE_CHUNK_SAMPLES 96
+
+// The result and the JSON-RPC response built from it are each about 2.7 bytes per sample
+_Static_assert(CONFIG_ADC_CAPTURE_MCP_MAX_SAMPLES <= 4096, "MCP captures above 4096 samples are not heap-safe");
+
+/**
+ * @brief Fill a buffer completely from the capture ring
+ *
+ * @return Number of samples read, less than count only on timeout
+ */
+static size_t read_exact(int16_t* out, size_t count) {
+  size_t total = 0;
+  while (total < count) {
+    size_t n = adc_capture_read(out + total, count - total, pdMS_TO_TICKS(STREAM_READ_TIMEOUT_MS));
+    if (n == 0) {
+      break;
+    }
+    total += n;
+  }
+  return total;
+}
+
+static esp_err_t stream_handler(httpd_req_t* req) {
+  uint32_t samples = STREAM_DEFAULT_SAMPLES;
+  char query[32];
+  char value[12];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+      httpd_query_key_value(query, "samples", value, sizeof(value)) == ESP_OK) {
+    samples = strtoul(value, NULL, 10);
+  }
+  if (samples == 0) {
+    return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "samples must be positive");
+  }
+
+  int16_t* chunk = malloc(STREAM_CHUNK_SAMPLES * sizeof(int16_t));
+  if (!chunk) {
+    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+  }
+
+  if (adc_capture_start() != ESP_OK) {
+    free(chunk);
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    return httpd_resp_sendstr(req, "Capture busy");
+  }
+
+  char rate[12];
+  snprintf(rate, sizeof(rate), "%lu", (unsigned long)adc_capture_get_output_rate());
+  httpd_resp_set_type(req, "application/octet-stream");
+  httpd_resp_set_hdr(req, "X-Sample-Rate", rate);
+  httpd_resp_set_hdr(req, "X-Sample-Format", "s16le");
+
+  esp_err_t ret = ESP_OK;
+  uint32_t sent = 0;
+  while (sent < samples) {
+    size_t want = samples - sent < STREAM_CHUNK_SAMPLES ? samples - sent : STREAM_CHUNK_SAMPLES;
+    size_t n = read_exact(chunk, want);
+    if (n == 0) {
+      ESP_LOGE(TAG, "Capture stalled after %lu samples", (unsigned long)sent);
+      ret = ESP_ERR_TIMEOUT;
+      break;
+    }
+    // Xtensa and RISC-V are little-endian, so the ring contents are already s16le
+    ret = httpd_resp_send_chunk(req, (const char*)chunk, n * sizeof(int16_t));
+    if (ret != ESP_OK) {
+      ESP_LOGW(TAG, "Client went away after %lu samples", (unsigned long)sent);
+      break;
+    }
+    sent += n;
+  }
+
+  adc_capture_stop();
+  free(chunk);
+
+  adc_capture_stats_t stats;
+  adc_capture_get_stats(&stats);
+  ESP_LOGI(TAG, "Streamed %lu samples (%lu dropped, %lu DMA overflows)", (unsigned long)sent,
+           (unsigned long)stats.dropped_samples, (unsigned long)stats.dma_overflows);
+
+  if (ret != ESP_OK) {
+    // Headers are already out; an incomplete chunked body is the only way to signal failure
+    return ESP_FAIL;
+  }
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+esp_err_t adc_capture_register_http(uint16_t port) {
+  esp_err_t ret = shared_httpd_start(port);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  httpd_uri_t stream_uri = {
+      .uri = "/adc/stream",
+      .method = HTTP_GET,
+      .handler = stream_handler,
+      .user_ctx = NULL,
+  };
+  return shared_httpd_register_uri(&stream_uri);
+}
+
+static mcp_tool_result_t capture_handler(const mcp_tool_args_t* args) {
+  int samples = mcp_tool_args_get_int(args, "samples", 256);
+  if (samples < 1 || samples > CONFIG_ADC_CAPTURE_MCP_MAX_SAMPLES) {
+    return mcp_tool_result_error("Invalid samples");
+  }
+
+  // Header, base64 body and closing
+  size_t capacity = 128 + BASE64_ENCODED_LEN((size_t)samples * sizeof(int16_t)) + 8;
+  char* result = malloc(capacity);
+  if (!result) {
+    return mcp_tool_result_error("Out of memory");
+  }
+
+  if (adc_capture_start() != ESP_OK) {
+    free(result);
+    return mcp_tool_result_error("Capture busy");
+  }
+
+  int header_len = snprintf(result, capacity, "{\"rate_hz\": %lu, \"format\": \"s16le\", \"data\": \"",
+                            (unsigned long)adc_capture_get_output_rate());
+  size_t len = header_len;
+
+  base64_encoder_t encoder;
+  base64_encoder_init(&encoder);
+  int16_t chunk[ENCODE_CHUNK_SAMPLES];
+  int captured = 0;
+  while (captured < samples) {
+    size_t want = samples - captured < ENCODE_CHUNK_SAMPLES ? samples - captured : ENCODE_CHUNK_SAMPLES;
+    size_t n = read_exact(chunk, want);
+    if (n == 0) {
+      break;
+    }
+
+    len += base64_encode_update(&encoder, result + len, chunk, n * sizeof(int16_t));
+    captured += n;
+    if (n < want) {
+      break;
+    }
+  }
+
+  adc_capture_stop();
+  len += base64_encode_final(&encoder, result + len);
+  snprintf(result + len, capacity - len, "\", \"count\": %d}", captured);
+
+  if (captured == 0) {
+    free(result);
+    return mcp_tool_result_error("Capture timed out");
+  }
+  return mcp_tool_result_success_take(result);
+}
+
+static const mcp_param_schema_t CAPTURE_PARAMS[] = {
+    MCP_PARAM_INTEGER("samples", "Number of filtered samples to capture (default 256)", 1,
+                      CONFIG_ADC_CAPTURE_MCP_MAX_SAMPLES),
+};
+
+const mcp_tool_definition_t ADC_CAPTURE_TOOL = {
+    .name = "adc_capture",
+    .description = "Captures a block of filtered ADC samples. Returns the output sample rate and the samples "
+                   "as base64-encoded little-endian int16.",
+    .handler = capture_handler,
+    .parameters = CAPTURE_PARAMS,
+    .parameter_count = sizeof(CAPTURE_PARAMS) / sizeof(CAPTURE_PARAMS[0]),
+};
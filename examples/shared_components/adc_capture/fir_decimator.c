@@ -0,0 +1,79 @@
+#include "fir_decimator.h"
+
+#include <math.h>
+#include <string.h>
+
+#define PI_F 3.14159265358979f
+
+void fir_design_lowpass_q15(int16_t* coeffs, size_t taps, float cutoff) {
+  float window[taps];
+  float sum = 0.0f;
+  float center = (float)(taps - 1) / 2.0f;
+
+  for (size_t i = 0; i < taps; i++) {
+    float x = (float)i - center;
+    float sinc = (x == 0.0f) ? 2.0f * cutoff : sinf(2.0f * PI_F * cutoff * x) / (PI_F * x);
+    float hamming = (taps > 1) ? 0.54f - 0.46f * cosf(2.0f * PI_F * (float)i / (float)(taps - 1)) : 1.0f;
+    window[i] = sinc * hamming;
+    sum += window[i];
+  }
+
+  // Normalize for unity DC gain, then quantize
+  for (size_t i = 0; i < taps; i++) {
+    float q = window[i] / sum * 32768.0f;
+    coeffs[i] = (int16_t)(q > 32767.0f ? 32767 : (q < -32768.0f ? -32768 : lrintf(q)));
+  }
+}
+
+bool fir_decimator_init(fir_decimator_t* fir, const int16_t* coeffs, int16_t* delay, size_t taps,
+                        uint32_t decimation) {
+  if (!fir || !coeffs || !delay || taps == 0 || decimation == 0) {
+    return false;
+  }
+
+  fir->coeffs = coeffs;
+  fir->delay = delay;
+  fir->taps = taps;
+  fir->pos = 0;
+  fir->decimation = decimation;
+  fir->phase = 0;
+  memset(delay, 0, 2 * taps * sizeof(int16_t));
+  return true;
+}
+
+size_t fir_decimator_process(fir_decimator_t* fir, const int16_t* in, size_t count, int16_t* out) {
+  const size_t taps = fir->taps;
+  const int16_t* coeffs = fir->coeffs;
+  int16_t* delay = fir->delay;
+  size_t pos = fir->pos;
+  uint32_t phase = fir->phase;
+  size_t produced = 0;
+
+  for (size_t n = 0; n < count; n++) {
+    // Every sample is written twice so the newest taps samples are always contiguous at
+    // delay[pos + 1 .. pos + taps], which keeps the dot product a single linear loop
+    delay[pos] = in[n];
+    delay[pos + taps] = in[n];
+    pos = (pos + 1 == taps) ? 0 : pos + 1;
+
+    if (++phase < fir->decimation) {
+      continue;
+    }
+    phase = 0;
+
+    // delay[pos .. pos + taps - 1] holds the window oldest first; coeffs are applied
+    // newest first so the filter is a convolution, not a correlation
+    const int16_t* window = &delay[pos];
+    int32_t acc = 0;
+    for (size_t k = 0; k < taps; k++) {
+      acc += (int32_t)coeffs[k] * window[taps - 1 - k];
+    }
+
+    acc = (acc + (1 << 14)) >> 15;
+    out[produced++] = (int16_t)(acc > INT16_MAX ? INT16_MAX : (acc < INT16_MIN ? INT16_MIN : acc));
+  }
+
+  fir->pos = pos;
+  fir->phase = phase;
+  return produced;
+}
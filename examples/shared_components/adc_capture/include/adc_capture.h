@@ -0,0 +1,109 @@
+#ifndef PRODESP32_ADC_CAPTURE_H
+#define PRODESP32_ADC_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_adc/adc_continuous.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Capture configuration
+ */
+typedef struct {
+  adc_unit_t unit;           ///< ADC unit
+  adc_channel_t channel;     ///< ADC channel on that unit
+  adc_atten_t atten;         ///< Input attenuation
+  uint32_t sample_rate_hz;   ///< Raw ADC conversion rate
+  uint32_t decimation;       ///< Output one filtered sample every decimation raw samples
+  const int16_t* fir_coeffs; ///< Q15 anti-alias filter, NULL for a built-in low-pass
+  size_t fir_taps;           ///< Number of coefficients in fir_coeffs
+} adc_capture_config_t;
+
+/**
+ * @brief Default configuration: ADC1 channel 0, 20 kHz raw, decimated by 4 to 5 kHz
+ */
+#define ADC_CAPTURE_DEFAULT_CONFIG()                                                              \
+  {                                                                                               \
+    .unit = ADC_UNIT_1, .channel = ADC_CHANNEL_0, .atten = ADC_ATTEN_DB_12, .sample_rate_hz = 20000, \
+    .decimation = 4, .fir_coeffs = NULL, .fir_taps = 0,                                           \
+  }
+
+/**
+ * @brief Capture statistics
+ */
+typedef struct {
+  uint32_t frames;           ///< DMA frames processed
+  uint32_t raw_samples;      ///< Raw samples for the configured channel
+  uint32_t output_samples;   ///< Filtered samples written to the output ring
+  uint32_t dropped_samples;  ///< Filtered samples dropped because the reader fell behind
+  uint32_t dma_overflows;    ///< Times the driver's DMA pool overflowed
+} adc_capture_stats_t;
+
+/**
+ * @brief Initialize the ADC in continuous (DMA) mode
+ *
+ * @param config Capture configuration
+ * @return ESP_OK on success
+ */
+esp_err_t adc_capture_init(const adc_capture_config_t* config);
+
+/**
+ * @brief Release the ADC and all capture buffers
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t adc_capture_deinit(void);
+
+/**
+ * @brief Start capturing
+ *
+ * Clears the output ring and filter state, starts the DMA conversion and the capture task.
+ * A capture has exactly one reader, so this fails while a capture is already running.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized or already running
+ */
+esp_err_t adc_capture_start(void);
+
+/**
+ * @brief Stop capturing
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t adc_capture_stop(void);
+
+/**
+ * @brief Read filtered samples from the output ring
+ *
+ * @param out Output buffer
+ * @param max_samples Capacity of out in samples
+ * @param timeout Ticks to wait for at least one sample
+ * @return Number of samples read (0 on timeout)
+ */
+size_t adc_capture_read(int16_t* out, size_t max_samples, TickType_t timeout);
+
+/**
+ * @brief Get the output sample rate (raw rate divided by the decimation factor)
+ *
+ * @return Output rate in Hz, 0 if not initialized
+ */
+uint32_t adc_capture_get_output_rate(void);
+
+/**
+ * @brief Get capture statistics since the last start
+ *
+ * @param out Receives the statistics
+ * @return ESP_OK on success
+ */
+esp_err_t adc_capture_get_stats(adc_capture_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_ADC_CAPTURE_H
@@ -0,0 +1,40 @@
+#ifndef PRODESP32_ADC_CAPTURE_EXPORT_H
+#define PRODESP32_ADC_CAPTURE_EXPORT_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "mcp_tool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register GET /adc/stream on the shared HTTP server
+ *
+ * Each request runs one capture of `?samples=N` filtered samples and streams them as
+ * chunked little-endian int16 (application/octet-stream). The output rate is reported in
+ * the X-Sample-Rate header. Samples go from the capture ring straight into HTTP chunks, so
+ * the capture length is not limited by RAM.
+ *
+ * @param port Port for the shared server if it is not running yet
+ * @return ESP_OK on success
+ */
+esp_err_t adc_capture_register_http(uint16_t port);
+
+/**
+ * @brief MCP tool that captures a short block and returns it base64 encoded
+ *
+ * Samples are encoded into the result as they arrive; the raw capture is never buffered.
+ * The result is held whole, and copied once more into the JSON-RPC response, so the sample
+ * count is limited by CONFIG_ADC_CAPTURE_MCP_MAX_SAMPLES (at most 4096, about 11 KB of
+ * base64). Use the HTTP stream for longer captures.
+ */
+extern const mcp_tool_definition_t ADC_CAPTURE_TOOL;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_ADC_CAPTURE_EXPORT_H
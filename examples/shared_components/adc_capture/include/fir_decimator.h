@@ -0,0 +1,67 @@
+#ifndef PRODESP32_FIR_DECIMATOR_H
+#define PRODESP32_FIR_DECIMATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Q15 FIR filter with integer decimation (portable scalar implementation)
+ *
+ * Has no ESP-IDF dependencies so it builds and runs on the host unchanged.
+ */
+typedef struct {
+  const int16_t* coeffs;  ///< Q15 coefficients, taps entries
+  int16_t* delay;         ///< Delay line, 2 * taps entries (caller owned)
+  size_t taps;            ///< Number of taps
+  size_t pos;             ///< Next write position in the delay line
+  uint32_t decimation;    ///< Output one sample every decimation inputs
+  uint32_t phase;         ///< Inputs consumed since the last output
+} fir_decimator_t;
+
+/**
+ * @brief Design a windowed-sinc (Hamming) low-pass filter in Q15
+ *
+ * @param coeffs Output coefficients, taps entries
+ * @param taps Number of taps
+ * @param cutoff Cutoff frequency as a fraction of the input sample rate (0 < cutoff < 0.5)
+ */
+void fir_design_lowpass_q15(int16_t* coeffs, size_t taps, float cutoff);
+
+/**
+ * @brief Initialize a decimator
+ *
+ * @param fir Decimator state
+ * @param coeffs Q15 coefficients (must outlive the decimator). The accumulator is 32-bit,
+ *               so the sum of absolute coefficient values must stay below 65536 (2.0)
+ * @param delay Delay line with room for 2 * taps samples (must outlive the decimator)
+ * @param taps Number of taps
+ * @param decimation Decimation factor (1 = filter only)
+ * @return true on success, false on invalid arguments
+ */
+bool fir_decimator_init(fir_decimator_t* fir, const int16_t* coeffs, int16_t* delay, size_t taps,
+                        uint32_t decimation);
+
+/**
+ * @brief Filter and decimate a block of samples
+ *
+ * The block length does not have to be a multiple of the decimation factor; the phase
+ * carries over to the next call.
+ *
+ * @param fir Decimator state
+ * @param in Input samples
+ * @param count Number of input samples
+ * @param out Output samples, room for count / decimation + 1 entries
+ * @return Number of output samples written
+ */
+size_t fir_decimator_process(fir_decimator_t* fir, const int16_t* in, size_t count, int16_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_FIR_DECIMATOR_H
@@ -0,0 +1,262 @@
+#include "base64_codec.h"
+
+#include <string.h>
+
+static const char ENCODE[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Character classes above the 6-bit values; all have the high bit set, so one OR over a group
+// tells whether the fast path can take it
+#define INVALID 0xFF
+#define SPACE 0xFE
+#define PAD 0xFD
+
+// Reverse of ENCODE, built at compile time so it lives in flash like the forward table
+#define DEC_ROW(c)                                  \
+  ((c) >= 'A' && (c) <= 'Z'   ? (c) - 'A'           \
+   : (c) >= 'a' && (c) <= 'z' ? (c) - 'a' + 26      \
+   : (c) >= '0' && (c) <= '9' ? (c) - '0' + 52      \
+   : (c) == '+'               ? 62                  \
+   : (c) == '/'               ? 63                  \
+   : (c) == '='               ? PAD                 \
+   : (c) == ' ' || (c) == '\t' || (c) == '\r' || (c) == '\n' ? SPACE : INVALID)
+#define DEC4(c) DEC_ROW(c), DEC_ROW((c) + 1), DEC_ROW((c) + 2), DEC_ROW((c) + 3)
+#define DEC16(c) DEC4(c), DEC4((c) + 4), DEC4((c) + 8), DEC4((c) + 12)
+#define DEC64(c) DEC16(c), DEC16((c) + 16), DEC16((c) + 32), DEC16((c) + 48)
+
+static const uint8_t DECODE[256] = {DEC64(0), DEC64(64), DEC64(128), DEC64(192)};
+
+/**
+ * @brief Encode whole 3-byte groups, four per iteration where possible
+ *
+ * @return Characters written; len - len % 3 bytes are consumed
+ */
+static size_t encode_groups(char* dst, const uint8_t* src, size_t len) {
+  char* out = dst;
+  size_t i = 0;
+  for (; i + 12 <= len; i += 12) {
+    for (int k = 0; k < 12; k += 3) {
+      uint32_t v = (uint32_t)src[i + k] << 16 | (uint32_t)src[i + k + 1] << 8 | src[i + k + 2];
+      out[0] = ENCODE[v >> 18];
+      out[1] = ENCODE[(v >> 12) & 0x3F];
+      out[2] = ENCODE[(v >> 6) & 0x3F];
+      out[3] = ENCODE[v & 0x3F];
+      out += 4;
+    }
+  }
+  for (; i + 3 <= len; i += 3) {
+    uint32_t v = (uint32_t)src[i] << 16 | (uint32_t)src[i + 1] << 8 | src[i + 2];
+    out[0] = ENCODE[v >> 18];
+    out[1] = ENCODE[(v >> 12) & 0x3F];
+    out[2] = ENCODE[(v >> 6) & 0x3F];
+    out[3] = ENCODE[v & 0x3F];
+    out += 4;
+  }
+  return (size_t)(out - dst);
+}
+
+/**
+ * @brief Encode the last 1 or 2 bytes with padding
+ */
+static void encode_tail(char* dst, const uint8_t* src, size_t len) {
+  uint32_t v = (uint32_t)src[0] << 16 | (len > 1 ? (uint32_t)src[1] << 8 : 0);
+  dst[0] = ENCODE[v >> 18];
+  dst[1] = ENCODE[(v >> 12) & 0x3F];
+  dst[2] = len > 1 ? ENCODE[(v >> 6) & 0x3F] : '=';
+  dst[3] = '=';
+}
+
+size_t base64_encode(char* dst, const void* src, size_t len) {
+  const uint8_t* in = (const uint8_t*)src;
+  size_t out = encode_groups(dst, in, len);
+  size_t rest = len % 3;
+  if (rest) {
+    encode_tail(dst + out, in + len - rest, rest);
+    out += 4;
+  }
+  return out;
+}
+
+void base64_encoder_init(base64_encoder_t* encoder) { memset(encoder, 0, sizeof(*encoder)); }
+
+size_t base64_encode_update(base64_encoder_t* encoder, char* dst, const void* src, size_t len) {
+  const uint8_t* in = (const uint8_t*)src;
+  size_t out = 0;
+
+  // Complete the group left over from the previous call
+  if (encoder->pending_len) {
+    size_t need = 3 - encoder->pending_len;
+    if (len < need) {
+      memcpy(encoder->pending + encoder->pending_len, in, len);
+      encoder->pending_len += (uint8_t)len;
+      return 0;
+    }
+    uint8_t group[3];
+    memcpy(group, encoder->pending, encoder->pending_len);
+    memcpy(group + encoder->pending_len, in, need);
+    out = encode_groups(dst, group, 3);
+    encoder->pending_len = 0;
+    in += need;
+    len -= need;
+  }
+
+  out += encode_groups(dst + out, in, len);
+  size_t rest = len % 3;
+  memcpy(encoder->pending, in + len - rest, rest);
+  encoder->pending_len = (uint8_t)rest;
+  return out;
+}
+
+size_t base64_encode_final(base64_encoder_t* encoder, char* dst) {
+  size_t out = 0;
+  if (encoder->pending_len) {
+    encode_tail(dst, encoder->pending, encoder->pending_len);
+    out = 4;
+  }
+  encoder->pending_len = 0;
+  return out;
+}
+
+void base64_decoder_init(base64_decoder_t* decoder) { memset(decoder, 0, sizeof(*decoder)); }
+
+esp_err_t base64_decode_update(base64_decoder_t* decoder, void* dst, size_t dst_size, const char* src, size_t len,
+                               size_t* out_len) {
+  const uint8_t* in = (const uint8_t*)src;
+  uint8_t* out = (uint8_t*)dst;
+  uint8_t* end = out + dst_size;
+  const uint8_t* in_end = in + len;
+  esp_err_t ret = ESP_OK;
+
+  while (in < in_end) {
+    // Fast path: four data characters on a group boundary. Three bytes are written after four
+    // characters are read, so in-place decoding stays behind the input.
+    if (decoder->nbits == 0 && !decoder->padded && in_end - in >= 4) {
+      uint8_t a = DECODE[in[0]];
+      uint8_t b = DECODE[in[1]];
+      uint8_t c = DECODE[in[2]];
+      uint8_t d = DECODE[in[3]];
+      if (((a | b | c | d) & 0x80) == 0) {
+        if (end - out < 3) {
+          ret = ESP_ERR_INVALID_SIZE;
+          break;
+        }
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+        out[0] = (uint8_t)(v >> 16);
+        out[1] = (uint8_t)(v >> 8);
+        out[2] = (uint8_t)v;
+        out += 3;
+        in += 4;
+        continue;
+      }
+    }
+
+    // One character at a time: whitespace, padding, errors and groups split across calls
+    uint8_t value = DECODE[*in];
+    if (value == SPACE) {
+      in++;
+      continue;
+    }
+    if (value == PAD) {
+      // Padding ends a group after 2 or 3 data characters, and must fill it up to 4
+      if (decoder->group < 2) {
+        ret = ESP_ERR_INVALID_ARG;
+        break;
+      }
+      decoder->padded = true;
+      decoder->bits = 0;
+      decoder->nbits = 0;
+      decoder->group = (decoder->group + 1) & 3;
+      in++;
+      continue;
+    }
+    if (value == INVALID || decoder->padded) {
+      ret = ESP_ERR_INVALID_ARG;
+      break;
+    }
+
+    decoder->bits = decoder->bits << 6 | value;
+    decoder->nbits += 6;
+    decoder->group = (decoder->group + 1) & 3;
+    in++;
+    if (decoder->nbits >= 8) {
+      if (out == end) {
+        ret = ESP_ERR_INVALID_SIZE;
+        break;
+      }
+      decoder->nbits -= 8;
+      *out++ = (uint8_t)(decoder->bits >> decoder->nbits);
+      decoder->bits &= (1u << decoder->nbits) - 1;
+    }
+  }
+
+  *out_len = (size_t)(out - (uint8_t*)dst);
+  return ret;
+}
+
+esp_err_t base64_decode_final(const base64_decoder_t* decoder) {
+  if (decoder->padded) {
+    return decoder->group == 0 ? ESP_OK : ESP_ERR_INVALID_ARG;
+  }
+  // Without padding, a group may stop after 2 or 3 characters, never after 1
+  return decoder->group == 1 ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t base64_decode(void* dst, size_t dst_size, const char* src, size_t len, size_t* out_len) {
+  base64_decoder_t decoder;
+  base64_decoder_init(&decoder);
+  esp_err_t ret = base64_decode_update(&decoder, dst, dst_size, src, len, out_len);
+  return ret != ESP_OK ? ret : base64_decode_final(&decoder);
+}
+
+esp_err_t base64_decode_in_place(char* buf, size_t len, size_t* out_len) {
+  return base64_decode(buf, len, buf, len, out_len);
+}
+
+void base64_writer_init(base64_writer_t* writer, char* buf, size_t size, base64_sink_t sink, void* ctx) {
+  base64_encoder_init(&writer->encoder);
+  writer->buf = buf;
+  writer->size = size;
+  writer->used = 0;
+  writer->sink = sink;
+  writer->ctx = ctx;
+}
+
+static esp_err_t writer_flush(base64_writer_t* writer) {
+  if (writer->used == 0) {
+    return ESP_OK;
+  }
+  esp_err_t ret = writer->sink(writer->ctx, writer->buf, writer->used);
+  writer->used = 0;
+  return ret;
+}
+
+esp_err_t base64_writer_write(base64_writer_t* writer, const void* data, size_t len) {
+  const uint8_t* in = (const uint8_t*)data;
+  while (len) {
+    size_t groups = (writer->size - writer->used) / 4;
+    if (groups == 0) {
+      esp_err_t ret = writer_flush(writer);
+      if (ret != ESP_OK) {
+        return ret;
+      }
+      continue;
+    }
+    // As many bytes as fill the free groups, counting the ones the encoder holds back
+    size_t take = groups * 3 - writer->encoder.pending_len;
+    take = take < len ? take : len;
+    writer->used += base64_encode_update(&writer->encoder, writer->buf + writer->used, in, take);
+    in += take;
+    len -= take;
+  }
+  return ESP_OK;
+}
+
+esp_err_t base64_writer_finish(base64_writer_t* writer) {
+  if (writer->encoder.pending_len && writer->size - writer->used < 4) {
+    esp_err_t ret = writer_flush(writer);
+    if (ret != ESP_OK) {
+      return ret;
+    }
+  }
+  writer->used += base64_encode_final(&writer->encoder, writer->buf + writer->used);
+  return writer_flush(writer);
+}
@@ -0,0 +1,197 @@
+#ifndef PRODESP32_BASE64_CODEC_H
+#define PRODESP32_BASE64_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Characters base64_encode() writes for len bytes, padding included
+ */
+#define BASE64_ENCODED_LEN(len) (((len) + 2) / 3 * 4)
+
+/**
+ * @brief Upper bound of the bytes any decode call writes for len characters
+ */
+#define BASE64_DECODED_MAX(len) (((len) + 3) / 4 * 3)
+
+/**
+ * @brief Streaming encoder state
+ *
+ * Holds the bytes of an incomplete 3-byte group between calls. Initialize with
+ * base64_encoder_init().
+ */
+typedef struct {
+  uint8_t pending[2];   ///< Bytes waiting for the rest of their group
+  uint8_t pending_len;  ///< Number of bytes in pending (0..2)
+} base64_encoder_t;
+
+/**
+ * @brief Streaming decoder state
+ *
+ * Decoded bits are written out as soon as a whole byte is available, so the output never gets
+ * ahead of the input and a buffer can be decoded onto itself chunk by chunk. Initialize with
+ * base64_decoder_init().
+ */
+typedef struct {
+  uint32_t bits;  ///< Decoded bits not written yet, right-aligned
+  uint8_t nbits;  ///< Number of valid bits in bits (0, 2, 4 or 6)
+  uint8_t group;  ///< Characters of the current 4-character group, padding included
+  bool padded;    ///< '=' seen: only the rest of the padding and whitespace may follow
+} base64_decoder_t;
+
+/**
+ * @brief Receives encoded text from a base64_writer_t
+ *
+ * @param ctx Context given to base64_writer_init()
+ * @param data Encoded characters, not NUL-terminated
+ * @param len Number of characters
+ * @return ESP_OK to continue; any other value stops the writer and is returned to its caller
+ */
+typedef esp_err_t (*base64_sink_t)(void* ctx, const char* data, size_t len);
+
+/**
+ * @brief Encoder that fills a buffer and hands it to a sink whenever it is full
+ *
+ * For sending large binary payloads as base64 in transport-sized chunks, such as
+ * httpd_resp_send_chunk() calls, without holding the whole encoded text.
+ */
+typedef struct {
+  base64_encoder_t encoder;  ///< Encoding state
+  char* buf;                 ///< Chunk buffer
+  size_t size;               ///< Size of buf, at least 4
+  size_t used;               ///< Characters in buf not yet sent
+  base64_sink_t sink;        ///< Receives each full chunk and the final partial one
+  void* ctx;                 ///< Passed to sink
+} base64_writer_t;
+
+/**
+ * @brief Encode a whole buffer, with padding
+ *
+ * @param dst Output, at least BASE64_ENCODED_LEN(len) characters; not NUL-terminated
+ * @param src Bytes to encode
+ * @param len Number of bytes
+ * @return Characters written
+ */
+size_t base64_encode(char* dst, const void* src, size_t len);
+
+/**
+ * @brief Decode a whole buffer
+ *
+ * Accepts input with or without padding. Whitespace (space, tab, CR, LF) is skipped, so PEM
+ * bodies decode as they are.
+ *
+ * @param dst Output; may be src itself, see base64_decode_in_place()
+ * @param dst_size Size of dst; BASE64_DECODED_MAX(len) is always enough
+ * @param src Base64 text, need not be NUL-terminated
+ * @param len Number of characters
+ * @param out_len Receives the number of bytes written
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for malformed input or ESP_ERR_INVALID_SIZE if dst is too small
+ */
+esp_err_t base64_decode(void* dst, size_t dst_size, const char* src, size_t len, size_t* out_len);
+
+/**
+ * @brief Decode a buffer onto itself
+ *
+ * The decoded bytes start at buf[0]. Useful for a received body, which needs no second buffer.
+ *
+ * @param buf Base64 text in, decoded bytes out
+ * @param len Number of characters
+ * @param out_len Receives the number of decoded bytes
+ * @return ESP_OK or ESP_ERR_INVALID_ARG for malformed input
+ */
+esp_err_t base64_decode_in_place(char* buf, size_t len, size_t* out_len);
+
+/**
+ * @brief Start a new encoding
+ */
+void base64_encoder_init(base64_encoder_t* encoder);
+
+/**
+ * @brief Encode the next part of the input
+ *
+ * Writes only complete 4-character groups; up to two bytes are held back for the next call.
+ *
+ * @param encoder Encoder state
+ * @param dst Output, at least BASE64_ENCODED_LEN(len) characters
+ * @param src Bytes to encode
+ * @param len Number of bytes
+ * @return Characters written, a multiple of 4
+ */
+size_t base64_encode_update(base64_encoder_t* encoder, char* dst, const void* src, size_t len);
+
+/**
+ * @brief Write the held-back bytes, padded, and reset the encoder
+ *
+ * @param encoder Encoder state
+ * @param dst Output, at least 4 characters
+ * @return Characters written, 0 or 4
+ */
+size_t base64_encode_final(base64_encoder_t* encoder, char* dst);
+
+/**
+ * @brief Start a new decoding
+ */
+void base64_decoder_init(base64_decoder_t* decoder);
+
+/**
+ * @brief Decode the next part of the input
+ *
+ * The input may be split anywhere, including inside a group or the padding. dst may be the
+ * same buffer as src: the output never overtakes the input.
+ *
+ * @param decoder Decoder state
+ * @param dst Output
+ * @param dst_size Size of dst; BASE64_DECODED_MAX(len) is always enough
+ * @param src Base64 text
+ * @param len Number of characters
+ * @param out_len Receives the number of bytes written
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for malformed input or ESP_ERR_INVALID_SIZE if dst is too small
+ */
+esp_err_t base64_decode_update(base64_decoder_t* decoder, void* dst, size_t dst_size, const char* src, size_t len,
+                               size_t* out_len);
+
+/**
+ * @brief Check that the input ended on a complete group
+ *
+ * @param decoder Decoder state
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if the input stopped inside a group that padding cannot end
+ */
+esp_err_t base64_decode_final(const base64_decoder_t* decoder);
+
+/**
+ * @brief Start encoding into chunks
+ *
+ * @param writer Writer state
+ * @param buf Chunk buffer; a multiple of 4 in size fills every chunk completely
+ * @param size Size of buf, at least 4
+ * @param sink Receives the chunks
+ * @param ctx Passed to sink
+ */
+void base64_writer_init(base64_writer_t* writer, char* buf, size_t size, base64_sink_t sink, void* ctx);
+
+/**
+ * @brief Encode bytes, sending each chunk to the sink as it fills
+ *
+ * @return ESP_OK or the sink's error
+ */
+esp_err_t base64_writer_write(base64_writer_t* writer, const void* data, size_t len);
+
+/**
+ * @brief Encode the held-back bytes with padding and send what is left in the buffer
+ *
+ * @return ESP_OK or the sink's error
+ */
+esp_err_t base64_writer_finish(base64_writer_t* writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_BASE64_CODEC_H
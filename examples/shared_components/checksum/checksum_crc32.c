@@ -0,0 +1,58 @@
+#include "checksum_crc32.h"
+
+#include <string.h>
+
+#include "crc32_table.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_rom_crc.h"
+#include "sdkconfig.h"
+#endif
+
+#if defined(ESP_PLATFORM) && CONFIG_CHECKSUM_CRC32_ROM
+#define CHECKSUM_CRC32_ROM 1
+#endif
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The slicing loop takes the first byte in memory to be the lowest byte of a word"
+#endif
+
+static inline uint32_t crc32_byte(uint32_t crc, uint8_t b) { return (crc >> 8) ^ CRC32_TABLE[0][(crc ^ b) & 0xFF]; }
+
+uint32_t checksum_crc32_sw(uint32_t crc, const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  crc = ~crc;
+
+  // Aligned words only: Xtensa has no unaligned loads
+  while (len && ((uintptr_t)p & 3)) {
+    crc = crc32_byte(crc, *p++);
+    len--;
+  }
+  for (; len >= 4; len -= 4, p += 4) {
+    uint32_t w;
+    memcpy(&w, __builtin_assume_aligned(p, 4), sizeof(w));
+    crc ^= w;
+    crc = CRC32_TABLE[3][crc & 0xFF] ^ CRC32_TABLE[2][(crc >> 8) & 0xFF] ^ CRC32_TABLE[1][(crc >> 16) & 0xFF] ^
+          CRC32_TABLE[0][crc >> 24];
+  }
+  while (len--) {
+    crc = crc32_byte(crc, *p++);
+  }
+  return ~crc;
+}
+
+#if CHECKSUM_CRC32_ROM
+
+uint32_t checksum_crc32(uint32_t crc, const void* data, size_t len) {
+  return esp_rom_crc32_le(crc, (const uint8_t*)data, len);
+}
+
+const char* checksum_crc32_backend(void) { return "rom"; }
+
+#else
+
+uint32_t checksum_crc32(uint32_t crc, const void* data, size_t len) { return checksum_crc32_sw(crc, data, len); }
+
+const char* checksum_crc32_backend(void) { return "slice4"; }
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef PRODESP32_CHECKSUM_H
+#define PRODESP32_CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "checksum_crc32.h"
+#include "esp_err.h"
+#include "mbedtls/sha256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Integrity check algorithms
+ */
+typedef enum {
+  CHECKSUM_CRC32,   ///< CRC-32, 4-byte digest, big-endian (0xCBF43926 for "123456789")
+  CHECKSUM_SHA256,  ///< SHA-256, 32-byte digest
+} checksum_type_t;
+
+/// Largest digest any checksum_type_t produces
+#define CHECKSUM_MAX_DIGEST_LEN 32
+
+/**
+ * @brief Streaming checksum state
+ *
+ * Owned by the caller, for example on the stack of an upload handler. Start with checksum_init()
+ * and end with checksum_final(), checksum_verify() or checksum_free().
+ */
+typedef struct {
+  checksum_type_t type;  ///< Algorithm chosen at checksum_init()
+  union {
+    uint32_t crc32;                 ///< CHECKSUM_CRC32 state
+    mbedtls_sha256_context sha256;  ///< CHECKSUM_SHA256 state
+  };
+} checksum_t;
+
+/**
+ * @brief Start a new checksum
+ *
+ * @param ctx State to initialize
+ * @param type Algorithm
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown type, or ESP_FAIL if the SHA engine fails
+ */
+esp_err_t checksum_init(checksum_t* ctx, checksum_type_t type);
+
+/**
+ * @brief Add the next part of the data
+ *
+ * Any split of the data gives the same digest. With the SHA peripheral, parts that are multiples
+ * of 64 bytes avoid buffering partial blocks.
+ *
+ * @return ESP_OK or ESP_FAIL if the SHA engine fails
+ */
+esp_err_t checksum_update(checksum_t* ctx, const void* data, size_t len);
+
+/**
+ * @brief Write the digest and release the state
+ *
+ * @param ctx State; must be initialized again before reuse
+ * @param digest Output, checksum_digest_len(ctx->type) bytes
+ * @return ESP_OK or ESP_FAIL if the SHA engine fails
+ */
+esp_err_t checksum_final(checksum_t* ctx, uint8_t* digest);
+
+/**
+ * @brief Finish and compare with an expected digest, for example from an OTA manifest
+ *
+ * @param ctx State; released as by checksum_final()
+ * @param expected Expected digest
+ * @param len Length of expected
+ * @return ESP_OK on a match, ESP_ERR_INVALID_CRC on a mismatch, ESP_ERR_INVALID_SIZE if len is not
+ *         the digest length of the algorithm
+ */
+esp_err_t checksum_verify(checksum_t* ctx, const uint8_t* expected, size_t len);
+
+/**
+ * @brief Release the state without a digest, when a transfer is abandoned
+ */
+void checksum_free(checksum_t* ctx);
+
+/**
+ * @brief One-shot checksum of a buffer
+ *
+ * @param type Algorithm
+ * @param data Bytes
+ * @param len Number of bytes
+ * @param digest Output, checksum_digest_len(type) bytes
+ * @return As checksum_init()
+ */
+esp_err_t checksum_compute(checksum_type_t type, const void* data, size_t len, uint8_t* digest);
+
+/**
+ * @brief Digest length in bytes, 0 for an unknown type
+ */
+size_t checksum_digest_len(checksum_type_t type);
+
+/**
+ * @brief Algorithm name: "crc32" or "sha256"
+ */
+const char* checksum_name(checksum_type_t type);
+
+/**
+ * @brief Backend compiled in for an algorithm
+ *
+ * "rom" or "slice4" for CRC32, "hw" for SHA-256 on the SHA peripheral (CONFIG_MBEDTLS_HARDWARE_SHA)
+ * and "sw" for mbedTLS's software SHA-256.
+ */
+const char* checksum_backend(checksum_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_CHECKSUM_H
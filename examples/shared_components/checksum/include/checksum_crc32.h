@@ -0,0 +1,41 @@
+#ifndef PRODESP32_CHECKSUM_CRC32_H
+#define PRODESP32_CHECKSUM_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as zlib's crc32() and esp_rom_crc32_le())
+ *
+ * The chip ROM's esp_rom_crc32_le() in ESP-IDF builds with CHECKSUM_CRC32_ROM set,
+ * checksum_crc32_sw() otherwise. Chains like zlib: start with 0 and pass each result back in for
+ * the next part of the data.
+ *
+ * @param crc 0, or the result for the data before this part
+ * @param data Bytes to add
+ * @param len Number of bytes
+ * @return CRC of everything so far
+ */
+uint32_t checksum_crc32(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief The same CRC-32 in software, four bytes per step from 4 KB of tables in flash
+ *
+ * Always available, so the ROM backend can be checked and timed against it.
+ */
+uint32_t checksum_crc32_sw(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief Name of the backend checksum_crc32() uses: "rom" or "slice4"
+ */
+const char* checksum_crc32_backend(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_CHECKSUM_CRC32_H
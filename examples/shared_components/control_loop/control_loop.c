@@ -0,0 +1,320 @@
+#include "control_loop.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "latency_histogram.h"
+
+static const char* TAG = "control_loop";
+
+#define TIMER_RESOLUTION_HZ 1000000  // 1 tick = 1 us
+#define MIN_PERIOD_US 100
+#define STOP_POLL_MS 100
+
+// Quantile histograms: 12.5% precision up to 1 s, written only by the loop task
+#define QUANTILE_SUB_BITS 3
+#define QUANTILE_MAX_BITS 20
+#define QUANTILE_BUCKETS LATENCY_HISTOGRAM_BUCKETS(QUANTILE_SUB_BITS, QUANTILE_MAX_BITS)
+
+/**
+ * @brief Control loop structure (internal)
+ */
+struct control_loop {
+  control_loop_config_t config;
+  gptimer_handle_t timer;
+  TaskHandle_t task;
+  SemaphoreHandle_t done;  // Given once after timer setup, once after the task stopped the timer
+  esp_err_t setup_result;
+  volatile bool running;
+  atomic_uint setpoint_bits;
+  atomic_bool reset_requested;
+  control_loop_stats_t stats;
+  latency_histogram_t latency_quantiles;
+  latency_histogram_t exec_quantiles;
+  uint32_t latency_counts[QUANTILE_BUCKETS];
+  uint32_t exec_counts[QUANTILE_BUCKETS];
+};
+
+static inline uint32_t float_to_bits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static inline float bits_to_float(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static inline int hist_bucket(uint32_t us) {
+  if (us == 0) {
+    return 0;
+  }
+  int bucket = 32 - __builtin_clz(us);
+  return bucket < CONTROL_LOOP_HIST_BUCKETS ? bucket : CONTROL_LOOP_HIST_BUCKETS - 1;
+}
+
+static bool IRAM_ATTR on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_ctx) {
+  control_loop_t* loop = (control_loop_t*)user_ctx;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(loop->task, &woken);
+  return woken == pdTRUE;
+}
+
+static esp_err_t setup_timer(control_loop_t* loop) {
+  gptimer_config_t timer_config = {
+      .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+      .direction = GPTIMER_COUNT_UP,
+      .resolution_hz = TIMER_RESOLUTION_HZ,
+  };
+  esp_err_t ret = gptimer_new_timer(&timer_config, &loop->timer);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  // The counter reloads to 0 on every alarm, so reading it in the task gives the
+  // alarm-to-step latency directly
+  gptimer_alarm_config_t alarm_config = {
+      .alarm_count = loop->config.period_us,
+      .reload_count = 0,
+      .flags.auto_reload_on_alarm = true,
+  };
+  gptimer_event_callbacks_t callbacks = {.on_alarm = on_alarm};
+
+  ret = gptimer_register_event_callbacks(loop->timer, &callbacks, loop);
+  if (ret == ESP_OK) {
+    ret = gptimer_set_alarm_action(loop->timer, &alarm_config);
+  }
+  if (ret == ESP_OK) {
+    ret = gptimer_enable(loop->timer);
+  }
+  if (ret == ESP_OK) {
+    ret = gptimer_start(loop->timer);
+    if (ret != ESP_OK) {
+      gptimer_disable(loop->timer);
+    }
+  }
+  if (ret != ESP_OK) {
+    gptimer_del_timer(loop->timer);
+    loop->timer = NULL;
+  }
+  return ret;
+}
+
+static void teardown_timer(control_loop_t* loop) {
+  gptimer_stop(loop->timer);
+  gptimer_disable(loop->timer);
+  gptimer_del_timer(loop->timer);
+  loop->timer = NULL;
+}
+
+static void record_step(control_loop_t* loop, uint32_t latency_us, uint32_t exec_us, uint32_t missed) {
+  control_loop_stats_t* stats = &loop->stats;
+
+  stats->iterations++;
+  stats->missed_ticks += missed;
+  if (latency_us + exec_us > loop->config.period_us) {
+    stats->overruns++;
+  }
+  if (latency_us > stats->max_latency_us) {
+    stats->max_latency_us = latency_us;
+  }
+  if (exec_us > stats->max_exec_us) {
+    stats->max_exec_us = exec_us;
+  }
+  stats->latency_hist[hist_bucket(latency_us)]++;
+  stats->exec_hist[hist_bucket(exec_us)]++;
+  latency_histogram_record(&loop->latency_quantiles, latency_us);
+  latency_histogram_record(&loop->exec_quantiles, exec_us);
+}
+
+static void loop_task(void* arg) {
+  control_loop_t* loop = (control_loop_t*)arg;
+
+  // Allocating the timer here, rather than in control_loop_create(), places its interrupt
+  // on this task's core
+  loop->task = xTaskGetCurrentTaskHandle();
+  loop->setup_result = setup_timer(loop);
+  bool ok = loop->setup_result == ESP_OK;
+  xSemaphoreGive(loop->done);
+  if (!ok) {
+    // The creator frees the loop; nothing may touch it from here on
+    vTaskDelete(NULL);
+    return;
+  }
+
+  uint32_t iteration = 0;
+  while (loop->running) {
+    uint32_t pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(STOP_POLL_MS));
+    if (pending == 0) {
+      continue;
+    }
+
+    uint64_t since_alarm = 0;
+    gptimer_get_raw_count(loop->timer, &since_alarm);
+    int64_t start_us = esp_timer_get_time();
+
+    if (atomic_exchange_explicit(&loop->reset_requested, false, memory_order_acquire)) {
+      memset(&loop->stats, 0, sizeof(loop->stats));
+      latency_histogram_reset(&loop->latency_quantiles);
+      latency_histogram_reset(&loop->exec_quantiles);
+    }
+
+    control_loop_tick_t tick = {
+        .iteration = iteration++,
+        .period_us = loop->config.period_us,
+        .latency_us = (uint32_t)since_alarm,
+        .setpoint = bits_to_float(atomic_load_explicit(&loop->setpoint_bits, memory_order_relaxed)),
+    };
+    loop->config.step(&tick, loop->config.context);
+
+    uint32_t exec_us = (uint32_t)(esp_timer_get_time() - start_us);
+    record_step(loop, tick.latency_us, exec_us, pending - 1);
+  }
+
+  teardown_timer(loop);
+  ESP_LOGI(TAG, "Loop %s stopped after %lu steps", loop->config.name, (unsigned long)loop->stats.iterations);
+  xSemaphoreGive(loop->done);
+  vTaskDelete(NULL);
+}
+
+esp_err_t control_loop_create(const control_loop_config_t* config, control_loop_t** out_loop) {
+  if (!config || !config->step || !out_loop || config->period_us < MIN_PERIOD_US) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  control_loop_t* loop = calloc(1, sizeof(control_loop_t));
+  if (!loop) {
+    return ESP_ERR_NO_MEM;
+  }
+  loop->config = *config;
+  if (!loop->config.name) {
+    loop->config.name = "control_loop";
+  }
+  atomic_init(&loop->setpoint_bits, float_to_bits(config->initial_setpoint));
+  atomic_init(&loop->reset_requested, false);
+  latency_histogram_init(&loop->latency_quantiles, QUANTILE_SUB_BITS, QUANTILE_MAX_BITS, loop->latency_counts, 1);
+  latency_histogram_init(&loop->exec_quantiles, QUANTILE_SUB_BITS, QUANTILE_MAX_BITS, loop->exec_counts, 1);
+
+  loop->done = xSemaphoreCreateBinary();
+  if (!loop->done) {
+    free(loop);
+    return ESP_ERR_NO_MEM;
+  }
+
+  loop->running = true;
+  BaseType_t created = xTaskCreatePinnedToCore(loop_task, loop->config.name, CONFIG_CONTROL_LOOP_TASK_STACK_SIZE, loop,
+                                               config->priority, NULL, config->core_id);
+  if (created != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create loop task");
+    vSemaphoreDelete(loop->done);
+    free(loop);
+    return ESP_ERR_NO_MEM;
+  }
+
+  xSemaphoreTake(loop->done, portMAX_DELAY);
+  if (loop->setup_result != ESP_OK) {
+    esp_err_t ret = loop->setup_result;
+    ESP_LOGE(TAG, "Failed to set up loop timer: %s", esp_err_to_name(ret));
+    vSemaphoreDelete(loop->done);
+    free(loop);
+    return ret;
+  }
+
+  ESP_LOGI(TAG, "Loop %s running every %lu us on core %d", loop->config.name, (unsigned long)config->period_us,
+           config->core_id);
+  *out_loop = loop;
+  return ESP_OK;
+}
+
+esp_err_t control_loop_destroy(control_loop_t* loop) {
+  if (!loop) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  loop->running = false;
+  xSemaphoreTake(loop->done, portMAX_DELAY);
+  vSemaphoreDelete(loop->done);
+  free(loop);
+  return ESP_OK;
+}
+
+void control_loop_set_setpoint(control_loop_t* loop, float setpoint) {
+  atomic_store_explicit(&loop->setpoint_bits, float_to_bits(setpoint), memory_order_relaxed);
+}
+
+float control_loop_get_setpoint(const control_loop_t* loop) {
+  return bits_to_float(atomic_load_explicit(&((control_loop_t*)loop)->setpoint_bits, memory_order_relaxed));
+}
+
+esp_err_t control_loop_get_stats(const control_loop_t* loop, control_loop_stats_t* out) {
+  if (!loop || !out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *out = loop->stats;
+  return ESP_OK;
+}
+
+void control_loop_reset_stats(control_loop_t* loop) {
+  atomic_store_explicit(&loop->reset_requested, true, memory_order_release);
+}
+
+static int format_hist(char* buffer, size_t size, const uint32_t* hist) {
+  int len = 0;
+  for (int i = 0; i < CONTROL_LOOP_HIST_BUCKETS && (size_t)len < size; i++) {
+    len += snprintf(buffer + len, size - len, "%s%lu", i ? "," : "", (unsigned long)hist[i]);
+  }
+  return len;
+}
+
+int control_loop_format_stats(const control_loop_t* loop, char* buffer, size_t size) {
+  control_loop_stats_t stats;
+  if (control_loop_get_stats(loop, &stats) != ESP_OK || !buffer || size == 0) {
+    return -1;
+  }
+
+  static const float quantiles[] = {0.5f, 0.99f, 0.999f};
+  uint32_t latency_q[3];
+  uint32_t exec_q[3];
+  latency_histogram_quantiles(&loop->latency_quantiles, quantiles, latency_q, 3);
+  latency_histogram_quantiles(&loop->exec_quantiles, quantiles, exec_q, 3);
+
+  int len = snprintf(buffer, size,
+                     "{\"period_us\": %lu, \"iterations\": %lu, \"overruns\": %lu, \"missed_ticks\": %lu, "
+                     "\"max_latency_us\": %lu, \"max_exec_us\": %lu, \"latency_us\": {\"p50\": %lu, "
+                     "\"p99\": %lu, \"p999\": %lu}, \"exec_us\": {\"p50\": %lu, \"p99\": %lu, \"p999\": %lu}, "
+                     "\"latency_hist\": [",
+                     (unsigned long)loop->config.period_us, (unsigned long)stats.iterations,
+                     (unsigned long)stats.overruns, (unsigned long)stats.missed_ticks,
+                     (unsigned long)stats.max_latency_us, (unsigned long)stats.max_exec_us,
+                     (unsigned long)latency_q[0], (unsigned long)latency_q[1], (unsigned long)latency_q[2],
+                     (unsigned long)exec_q[0], (unsigned long)exec_q[1], (unsigned long)exec_q[2]);
+  if (len < 0 || (size_t)len >= size) {
+    return len;
+  }
+  len += format_hist(buffer + len, size - len, stats.latency_hist);
+  if ((size_t)len >= size) {
+    return len;
+  }
+  len += snprintf(buffer + len, size - len, "], \"exec_hist\": [");
+  if ((size_t)len >= size) {
+    return len;
+  }
+  len += format_hist(buffer + len, size - len, stats.exec_hist);
+  if ((size_t)len >= size) {
+    return len;
+  }
+  len += snprintf(buffer + len, size - len, "]}");
+  return len;
+}
@@ -0,0 +1,147 @@
+#ifndef PRODESP32_CONTROL_LOOP_H
+#define PRODESP32_CONTROL_LOOP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of histogram buckets
+ *
+ * Bucket 0 counts 0 us, bucket i counts [2^(i-1), 2^i) us, the last bucket everything above.
+ */
+#define CONTROL_LOOP_HIST_BUCKETS 16
+
+/**
+ * @brief Opaque control loop handle
+ */
+typedef struct control_loop control_loop_t;
+
+/**
+ * @brief Information passed to every step
+ */
+typedef struct {
+  uint32_t iteration;   ///< Step number since start
+  uint32_t period_us;   ///< Nominal period
+  uint32_t latency_us;  ///< Time from timer alarm to the start of this step
+  float setpoint;       ///< Setpoint at the start of this step
+} control_loop_tick_t;
+
+/**
+ * @brief Step callback, called once per period on the loop task
+ *
+ * @param tick Timing information and current setpoint
+ * @param context User context from the configuration
+ */
+typedef void (*control_loop_step_fn_t)(const control_loop_tick_t* tick, void* context);
+
+/**
+ * @brief Control loop configuration
+ */
+typedef struct {
+  const char* name;             ///< Task name
+  uint32_t period_us;           ///< Loop period (>= 100 us)
+  int core_id;                  ///< Core to pin the loop task and timer ISR to
+  uint32_t priority;            ///< Loop task priority
+  float initial_setpoint;       ///< Setpoint before the first update
+  control_loop_step_fn_t step;  ///< Step callback
+  void* context;                ///< User context passed to step
+} control_loop_config_t;
+
+/**
+ * @brief Timing statistics
+ *
+ * Updated by the loop task without locking; a copy taken while the loop runs may be off by
+ * the step in progress.
+ */
+typedef struct {
+  uint32_t iterations;                                ///< Steps executed
+  uint32_t overruns;                                  ///< Steps whose latency + execution exceeded the period
+  uint32_t missed_ticks;                              ///< Timer alarms that fired while a step was still running
+  uint32_t max_latency_us;                            ///< Worst alarm-to-step latency
+  uint32_t max_exec_us;                               ///< Worst step execution time
+  uint32_t latency_hist[CONTROL_LOOP_HIST_BUCKETS];   ///< Alarm-to-step latency (jitter) histogram
+  uint32_t exec_hist[CONTROL_LOOP_HIST_BUCKETS];      ///< Step execution time histogram
+} control_loop_stats_t;
+
+/**
+ * @brief Create and start a control loop
+ *
+ * Creates the loop task pinned to config->core_id. The task allocates the hardware timer
+ * itself so the alarm interrupt is serviced on the same core.
+ *
+ * @param config Loop configuration
+ * @param out_loop Receives the loop handle
+ * @return ESP_OK on success
+ */
+esp_err_t control_loop_create(const control_loop_config_t* config, control_loop_t** out_loop);
+
+/**
+ * @brief Stop a control loop and free its resources
+ *
+ * @param loop Loop handle
+ * @return ESP_OK on success
+ */
+esp_err_t control_loop_destroy(control_loop_t* loop);
+
+/**
+ * @brief Update the setpoint
+ *
+ * Lock-free and safe from any task or ISR. Takes effect at the next step.
+ *
+ * @param loop Loop handle
+ * @param setpoint New setpoint
+ */
+void control_loop_set_setpoint(control_loop_t* loop, float setpoint);
+
+/**
+ * @brief Get the current setpoint
+ *
+ * @param loop Loop handle
+ * @return Setpoint
+ */
+float control_loop_get_setpoint(const control_loop_t* loop);
+
+/**
+ * @brief Copy the timing statistics
+ *
+ * @param loop Loop handle
+ * @param out Receives the statistics
+ * @return ESP_OK on success
+ */
+esp_err_t control_loop_get_stats(const control_loop_t* loop, control_loop_stats_t* out);
+
+/**
+ * @brief Reset the timing statistics
+ *
+ * Takes effect at the next step, so a reset never races a step in progress.
+ *
+ * @param loop Loop handle
+ */
+void control_loop_reset_stats(control_loop_t* loop);
+
+/**
+ * @brief Format the timing statistics as JSON
+ *
+ * Includes p50/p99/p99.9 of latency and execution time, reported as bucket upper bounds
+ * within 12.5%.
+ *
+ * @param loop Loop handle
+ * @param buffer Output buffer
+ * @param size Size of buffer (about 512 bytes is enough)
+ * @return Number of characters written, or negative on error. A value >= size means the
+ *         buffer was too small and the JSON is cut off; unlike snprintf, it is not
+ *         necessarily the full length needed
+ */
+int control_loop_format_stats(const control_loop_t* loop, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_CONTROL_LOOP_H
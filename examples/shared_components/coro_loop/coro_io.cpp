@@ -0,0 +1,135 @@
+#include "coro_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "coro_io";
+
+CoroTask<ssize_t> coro_recv(int fd, void* buf, size_t len, uint32_t timeout_ms) {
+  while (true) {
+    ssize_t received = recv(fd, buf, len, MSG_DONTWAIT);
+    if (received >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+      co_return received;
+    }
+    esp_err_t ret = co_await coro_wait_fd(fd, CORO_READ, timeout_ms);
+    if (ret != ESP_OK) {
+      errno = EAGAIN;
+      co_return -1;
+    }
+  }
+}
+
+CoroTask<ssize_t> coro_send_all(int fd, const void* buf, size_t len, uint32_t timeout_ms) {
+  const uint8_t* data = static_cast<const uint8_t*>(buf);
+  size_t sent = 0;
+  while (sent < len) {
+    ssize_t written = send(fd, data + sent, len - sent, MSG_DONTWAIT);
+    if (written >= 0) {
+      sent += written;
+      continue;
+    }
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      co_return -1;
+    }
+    esp_err_t ret = co_await coro_wait_fd(fd, CORO_WRITE, timeout_ms);
+    if (ret != ESP_OK) {
+      errno = EAGAIN;
+      co_return -1;
+    }
+  }
+  co_return (ssize_t)len;
+}
+
+CoroTask<int> coro_accept(int listen_fd, struct sockaddr* addr, socklen_t* addr_len, uint32_t timeout_ms) {
+  // A readable listening socket has a connection queued, so accept() returns at once
+  esp_err_t ret = co_await coro_wait_fd(listen_fd, CORO_READ, timeout_ms);
+  if (ret != ESP_OK) {
+    errno = EAGAIN;
+    co_return -1;
+  }
+  co_return accept(listen_fd, addr, addr_len);
+}
+
+CoroTask<int> coro_connect(int fd, const struct sockaddr* addr, socklen_t addr_len, uint32_t timeout_ms) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    co_return -1;
+  }
+
+  int ret = connect(fd, addr, addr_len);
+  int error = ret == 0 ? 0 : errno;
+  if (error == EINPROGRESS) {
+    esp_err_t wait_ret = co_await coro_wait_fd(fd, CORO_WRITE, timeout_ms);
+    if (wait_ret != ESP_OK) {
+      error = ETIMEDOUT;
+    }
+    else {
+      socklen_t error_len = sizeof(error);
+      if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_len) < 0) {
+        error = errno;
+      }
+    }
+  }
+
+  fcntl(fd, F_SETFL, flags);
+  if (error != 0) {
+    errno = error;
+    co_return -1;
+  }
+  co_return 0;
+}
+
+// Runs on the event loop task
+static void event_handler(void* arg, esp_event_base_t base, int32_t id, void* data) {
+  CoroWaiter* waiter = static_cast<CoroWaiter*>(arg);
+  if (waiter->try_complete()) {
+    waiter->result = ESP_OK;
+    coro_loop_post_waiter(waiter);
+  }
+}
+
+bool CoroEventWait::await_suspend(std::coroutine_handle<> handle) {
+  waiter.handle = handle;
+  waiter.state = CoroWaiter::WAITING;
+  waiter.result = ESP_OK;
+
+  esp_err_t ret = esp_event_handler_instance_register(base, id, event_handler, &waiter, &instance);
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to register event handler: %s", esp_err_to_name(ret));
+    waiter.state = CoroWaiter::DONE;
+    waiter.result = ret;
+    instance = nullptr;
+    return false;
+  }
+  // The event may have fired between await_ready() and the registration
+  if (already && already() && waiter.try_complete()) {
+    return false;
+  }
+
+  // The handler's post is drained only after this coroutine has suspended
+  waiter.deadline_us = coro_loop_deadline(timeout_ms);
+  coro_loop_add_waiter(&waiter);
+  return true;
+}
+
+esp_err_t CoroEventWait::await_resume() {
+  if (instance) {
+    // Also waits for a handler that is running right now, so the waiter can go away after this
+    esp_event_handler_instance_unregister(base, id, instance);
+    instance = nullptr;
+  }
+  return waiter.result;
+}
+
+CoroTask<esp_err_t> coro_http_perform(esp_http_client_handle_t client) {
+  while (true) {
+    esp_err_t ret = esp_http_client_perform(client);
+    if (ret != ESP_ERR_HTTP_EAGAIN) {
+      co_return ret;
+    }
+    co_await coro_sleep_ms(CONFIG_CORO_LOOP_HTTP_POLL_MS);
+  }
+}
@@ -0,0 +1,461 @@
+#include "coro_loop.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_vfs_eventfd.h"
+#include "freertos/task.h"
+#include "lockfree_queue.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "coro_loop";
+
+// A posted wake-up: a spawned coroutine to start, or a waiter completed by another task
+struct PostItem {
+  void* handle;
+  CoroWaiter* waiter;
+};
+
+static TaskHandle_t s_task = NULL;
+static int s_wake_fd = -1;
+static uint32_t s_wake_pending;  // An eventfd write is outstanding; later posters skip theirs
+static MpscQueue<PostItem, CONFIG_CORO_LOOP_POST_QUEUE_SIZE> s_posts;
+
+// Loop-task state
+static CoroWaiter* s_deadlines[CONFIG_CORO_LOOP_MAX_TIMERS];  // Min-heap on deadline_us
+static uint32_t s_deadline_count;
+static std::vector<void*> s_spawned;  // Coroutines spawned from the loop itself
+static CoroWaiter* s_fd_waiters = NULL;
+static CoroWaiter* s_ready_head = NULL;
+static CoroWaiter* s_ready_tail = NULL;
+static coro_loop_stats_t s_stats;
+
+static void heap_swap(uint32_t a, uint32_t b) {
+  std::swap(s_deadlines[a], s_deadlines[b]);
+  s_deadlines[a]->heap_index = a;
+  s_deadlines[b]->heap_index = b;
+}
+
+static void heap_sift_up(uint32_t index) {
+  while (index > 0) {
+    uint32_t parent = (index - 1) / 2;
+    if (s_deadlines[parent]->deadline_us <= s_deadlines[index]->deadline_us) {
+      break;
+    }
+    heap_swap(index, parent);
+    index = parent;
+  }
+}
+
+static void heap_sift_down(uint32_t index) {
+  uint32_t size = s_deadline_count;
+  while (true) {
+    uint32_t smallest = index;
+    uint32_t left = 2 * index + 1;
+    uint32_t right = left + 1;
+    if (left < size && s_deadlines[left]->deadline_us < s_deadlines[smallest]->deadline_us) {
+      smallest = left;
+    }
+    if (right < size && s_deadlines[right]->deadline_us < s_deadlines[smallest]->deadline_us) {
+      smallest = right;
+    }
+    if (smallest == index) {
+      return;
+    }
+    heap_swap(index, smallest);
+    index = smallest;
+  }
+}
+
+static void heap_remove(CoroWaiter* waiter) {
+  uint32_t index = waiter->heap_index;
+  if (index == UINT32_MAX) {
+    return;
+  }
+  uint32_t last = s_deadline_count - 1;
+  if (index != last) {
+    heap_swap(index, last);
+  }
+  s_deadline_count--;
+  waiter->heap_index = UINT32_MAX;
+  if (index < s_deadline_count) {
+    heap_sift_down(index);
+    heap_sift_up(index);
+  }
+}
+
+static void fd_unlink(CoroWaiter* waiter) {
+  if (waiter->prev) {
+    waiter->prev->next = waiter->next;
+  }
+  else {
+    s_fd_waiters = waiter->next;
+  }
+  if (waiter->next) {
+    waiter->next->prev = waiter->prev;
+  }
+  waiter->next = NULL;
+  waiter->prev = NULL;
+  s_stats.sockets--;
+}
+
+void coro_loop_make_ready(CoroWaiter* waiter) {
+  waiter->next = NULL;
+  if (s_ready_tail) {
+    s_ready_tail->next = waiter;
+  }
+  else {
+    s_ready_head = waiter;
+  }
+  s_ready_tail = waiter;
+}
+
+void coro_loop_add_waiter(CoroWaiter* waiter) {
+  if (waiter->deadline_us != INT64_MAX) {
+    if (s_deadline_count == CONFIG_CORO_LOOP_MAX_TIMERS) {
+      // No room to track the deadline: fail the wait now rather than let it hang past its timeout
+      ESP_LOGW(TAG, "Timer heap full (%d), failing the wait", CONFIG_CORO_LOOP_MAX_TIMERS);
+      if (waiter->try_complete()) {
+        waiter->result = ESP_ERR_NO_MEM;
+        if (waiter->on_timeout) {
+          waiter->on_timeout(waiter);
+        }
+        coro_loop_make_ready(waiter);
+      }
+      return;
+    }
+    waiter->heap_index = s_deadline_count;
+    s_deadlines[s_deadline_count++] = waiter;
+    heap_sift_up(waiter->heap_index);
+  }
+  if (waiter->fd >= 0) {
+    waiter->prev = NULL;
+    waiter->next = s_fd_waiters;
+    if (s_fd_waiters) {
+      s_fd_waiters->prev = waiter;
+    }
+    s_fd_waiters = waiter;
+    s_stats.sockets++;
+  }
+}
+
+/**
+ * @brief A waiter completed by someone (fd, timeout, poster): detach it and queue it
+ */
+static void finish_waiter(CoroWaiter* waiter) {
+  heap_remove(waiter);
+  if (waiter->fd >= 0 && (waiter->prev || s_fd_waiters == waiter)) {
+    fd_unlink(waiter);
+  }
+  coro_loop_make_ready(waiter);
+}
+
+static void wake_loop() {
+  if (!__atomic_exchange_n(&s_wake_pending, 1, __ATOMIC_SEQ_CST)) {
+    uint64_t one = 1;
+    write(s_wake_fd, &one, sizeof(one));
+  }
+}
+
+static void post(const PostItem& item) {
+  __atomic_fetch_add(&s_stats.posts, 1, __ATOMIC_RELAXED);
+  while (!s_posts.try_push(item)) {
+    // The loop is behind; let it drain
+    wake_loop();
+    vTaskDelay(1);
+  }
+  wake_loop();
+}
+
+void coro_loop_post(std::coroutine_handle<> handle) {
+  if (coro_loop_in_loop()) {
+    // Never wait on the post queue from the task that drains it
+    s_spawned.push_back(handle.address());
+    return;
+  }
+  post(PostItem{handle.address(), NULL});
+}
+
+void coro_loop_post_waiter(CoroWaiter* waiter) {
+  if (coro_loop_in_loop()) {
+    finish_waiter(waiter);
+    return;
+  }
+  post(PostItem{NULL, waiter});
+}
+
+int64_t coro_loop_deadline(uint32_t timeout_ms) {
+  return timeout_ms == CORO_WAIT_FOREVER ? INT64_MAX : esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+}
+
+void coro_loop_task_started() { __atomic_fetch_add(&s_stats.tasks, 1, __ATOMIC_RELAXED); }
+
+void coro_loop_task_finished() { __atomic_fetch_sub(&s_stats.tasks, 1, __ATOMIC_RELAXED); }
+
+static void resume(std::coroutine_handle<> handle) {
+  s_stats.resumes++;
+  handle.resume();
+}
+
+static void drain_posts() {
+  if (!s_spawned.empty()) {
+    std::vector<void*> spawned;
+    spawned.swap(s_spawned);
+    for (void* handle : spawned) {
+      resume(std::coroutine_handle<>::from_address(handle));
+    }
+  }
+
+  PostItem item;
+  while (s_posts.try_pop(item)) {
+    if (item.waiter) {
+      finish_waiter(item.waiter);
+    }
+    else {
+      resume(std::coroutine_handle<>::from_address(item.handle));
+    }
+  }
+}
+
+static void run_ready() {
+  // Only the waiters queued so far; ones queued while running (coro_yield()) wait a pass
+  CoroWaiter* waiter = s_ready_head;
+  s_ready_head = NULL;
+  s_ready_tail = NULL;
+  while (waiter) {
+    CoroWaiter* next = waiter->next;
+    waiter->next = NULL;
+    resume(waiter->handle);
+    waiter = next;
+  }
+}
+
+static void expire_deadlines(int64_t now_us) {
+  while (s_deadline_count > 0 && s_deadlines[0]->deadline_us <= now_us) {
+    CoroWaiter* waiter = s_deadlines[0];
+    heap_remove(waiter);
+    // Lost races (already completed by another task) are resumed through their post instead
+    if (!waiter->try_complete()) {
+      continue;
+    }
+    waiter->result = ESP_ERR_TIMEOUT;
+    if (waiter->on_timeout) {
+      waiter->on_timeout(waiter);
+    }
+    finish_waiter(waiter);
+  }
+}
+
+/**
+ * @brief Block in select() until a socket is ready, a deadline passes or something is posted
+ */
+static void wait_for_events() {
+  fd_set readable;
+  fd_set writable;
+  FD_ZERO(&readable);
+  FD_ZERO(&writable);
+  FD_SET(s_wake_fd, &readable);
+  int max_fd = s_wake_fd;
+  for (CoroWaiter* waiter = s_fd_waiters; waiter; waiter = waiter->next) {
+    if (waiter->events & CORO_READ) {
+      FD_SET(waiter->fd, &readable);
+    }
+    if (waiter->events & CORO_WRITE) {
+      FD_SET(waiter->fd, &writable);
+    }
+    if (waiter->fd > max_fd) {
+      max_fd = waiter->fd;
+    }
+  }
+
+  struct timeval timeout = {0, 0};
+  struct timeval* timeout_ptr = &timeout;
+  if (!s_ready_head && s_spawned.empty()) {
+    if (s_deadline_count == 0) {
+      timeout_ptr = NULL;
+    }
+    else {
+      int64_t wait_us = s_deadlines[0]->deadline_us - esp_timer_get_time();
+      if (wait_us > 0) {
+        timeout.tv_sec = wait_us / 1000000;
+        timeout.tv_usec = wait_us % 1000000;
+      }
+    }
+  }
+
+  int ready = select(max_fd + 1, &readable, &writable, NULL, timeout_ptr);
+  if (ready < 0) {
+    if (errno == EINTR) {
+      return;
+    }
+    // Usually a socket closed while waited on: wake every socket waiter so its next call
+    // reports the error
+    ESP_LOGD(TAG, "select failed: %s", strerror(errno));
+    while (s_fd_waiters) {
+      CoroWaiter* waiter = s_fd_waiters;
+      if (waiter->try_complete()) {
+        waiter->result = ESP_OK;
+        finish_waiter(waiter);
+      }
+      else {
+        fd_unlink(waiter);
+      }
+    }
+    return;
+  }
+
+  if (FD_ISSET(s_wake_fd, &readable)) {
+    uint64_t count;
+    read(s_wake_fd, &count, sizeof(count));
+    // Cleared before draining, so a post after this point writes again
+    __atomic_store_n(&s_wake_pending, 0, __ATOMIC_SEQ_CST);
+  }
+
+  CoroWaiter* waiter = s_fd_waiters;
+  while (waiter) {
+    CoroWaiter* next = waiter->next;
+    bool fired = ((waiter->events & CORO_READ) && FD_ISSET(waiter->fd, &readable)) ||
+                 ((waiter->events & CORO_WRITE) && FD_ISSET(waiter->fd, &writable));
+    if (fired && waiter->try_complete()) {
+      waiter->result = ESP_OK;
+      finish_waiter(waiter);
+    }
+    waiter = next;
+  }
+}
+
+static void loop_task(void* arg) {
+  while (true) {
+    int64_t start_us = esp_timer_get_time();
+    drain_posts();
+    run_ready();
+    expire_deadlines(esp_timer_get_time());
+    run_ready();
+
+    uint32_t run_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (run_us > s_stats.max_run_us) {
+      s_stats.max_run_us = run_us;
+    }
+    s_stats.timers = s_deadline_count;
+    wait_for_events();
+  }
+}
+
+esp_err_t coro_loop_start() {
+  if (s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Other components may have registered the eventfd VFS already
+  esp_vfs_eventfd_config_t eventfd_config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+  esp_err_t ret = esp_vfs_eventfd_register(&eventfd_config);
+  if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(TAG, "Failed to register eventfd: %s", esp_err_to_name(ret));
+    return ret;
+  }
+  s_wake_fd = eventfd(0, 0);
+  if (s_wake_fd < 0) {
+    ESP_LOGE(TAG, "Failed to create eventfd: %s", strerror(errno));
+    return ESP_ERR_NO_MEM;
+  }
+
+  if (xTaskCreate(loop_task, "coro_loop", CONFIG_CORO_LOOP_TASK_STACK_SIZE, NULL, CONFIG_CORO_LOOP_TASK_PRIORITY,
+                  &s_task) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create task");
+    close(s_wake_fd);
+    s_wake_fd = -1;
+    s_task = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+bool coro_loop_in_loop() { return s_task && xTaskGetCurrentTaskHandle() == s_task; }
+
+esp_err_t coro_loop_get_stats(coro_loop_stats_t* out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // Plain word reads; individual fields may be a pass apart
+  *out = s_stats;
+  return ESP_OK;
+}
+
+void CoroEvent::set() {
+  CoroWaiter* winners = NULL;
+  portENTER_CRITICAL(&lock_);
+  __atomic_store_n(&set_, true, __ATOMIC_RELEASE);
+  CoroWaiter* waiter = waiters_;
+  waiters_ = NULL;
+  while (waiter) {
+    CoroWaiter* next = waiter->next;
+    waiter->next = NULL;
+    waiter->prev = NULL;
+    // A waiter that just timed out is left to the loop, which is blocked on this lock
+    if (waiter->try_complete()) {
+      waiter->result = ESP_OK;
+      waiter->next = winners;
+      winners = waiter;
+    }
+    waiter = next;
+  }
+  portEXIT_CRITICAL(&lock_);
+
+  while (winners) {
+    CoroWaiter* next = winners->next;
+    coro_loop_post_waiter(winners);
+    winners = next;
+  }
+}
+
+bool CoroEvent::Awaiter::await_suspend(std::coroutine_handle<> handle) {
+  waiter.handle = handle;
+  waiter.context = event;
+  waiter.on_timeout = unlink_on_timeout;
+  waiter.result = ESP_OK;
+
+  portENTER_CRITICAL(&event->lock_);
+  if (event->set_) {
+    portEXIT_CRITICAL(&event->lock_);
+    return false;
+  }
+  waiter.state = CoroWaiter::WAITING;
+  waiter.prev = NULL;
+  waiter.next = event->waiters_;
+  if (event->waiters_) {
+    event->waiters_->prev = &waiter;
+  }
+  event->waiters_ = &waiter;
+  portEXIT_CRITICAL(&event->lock_);
+
+  // A set() from another task from here on posts the waiter; the loop drains posts only after
+  // this coroutine has suspended, by which time the deadline is registered
+  waiter.deadline_us = coro_loop_deadline(timeout_ms);
+  coro_loop_add_waiter(&waiter);
+  return true;
+}
+
+void CoroEvent::unlink_on_timeout(CoroWaiter* waiter) {
+  CoroEvent* event = static_cast<CoroEvent*>(waiter->context);
+  portENTER_CRITICAL(&event->lock_);
+  if (waiter->prev || event->waiters_ == waiter) {
+    if (waiter->prev) {
+      waiter->prev->next = waiter->next;
+    }
+    else {
+      event->waiters_ = waiter->next;
+    }
+    if (waiter->next) {
+      waiter->next->prev = waiter->prev;
+    }
+  }
+  waiter->next = NULL;
+  waiter->prev = NULL;
+  portEXIT_CRITICAL(&event->lock_);
+}
@@ -0,0 +1,150 @@
+#ifndef PRODESP32_CORO_IO_H
+#define PRODESP32_CORO_IO_H
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "coro_loop.h"
+#include "esp_event.h"
+#include "esp_http_client.h"
+
+/**
+ * @brief Awaitable that suspends until a socket is readable or writable (see coro_wait_fd())
+ */
+struct CoroFdWait {
+  CoroWaiter waiter;
+  int fd;
+  uint8_t events;
+  uint32_t timeout_ms;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    waiter.handle = handle;
+    waiter.fd = fd;
+    waiter.events = events;
+    waiter.state = CoroWaiter::WAITING;
+    waiter.deadline_us = coro_loop_deadline(timeout_ms);
+    coro_loop_add_waiter(&waiter);
+  }
+  esp_err_t await_resume() const noexcept { return waiter.result; }
+};
+
+/**
+ * @brief Wait for a socket to become ready
+ *
+ * The building block of the socket coroutines below. A socket closed while waited on wakes the
+ * waiter with ESP_OK; the next call on it reports the error.
+ *
+ * @param fd Socket
+ * @param events CORO_READ and/or CORO_WRITE
+ * @param timeout_ms Timeout, CORO_WAIT_FOREVER for none
+ * @return (after co_await) ESP_OK when ready, ESP_ERR_TIMEOUT otherwise
+ */
+inline CoroFdWait coro_wait_fd(int fd, uint8_t events, uint32_t timeout_ms) {
+  return CoroFdWait{{}, fd, events, timeout_ms};
+}
+
+/**
+ * @brief Receive what is available, waiting for it if there is nothing yet
+ *
+ * @param fd Connected socket (blocking or not; the call itself never blocks)
+ * @param buf Buffer
+ * @param len Buffer size
+ * @param timeout_ms Timeout, CORO_WAIT_FOREVER for none
+ * @return (after co_await) Bytes received, 0 when the peer closed, -1 on error with errno set
+ *         (EAGAIN on timeout)
+ */
+CoroTask<ssize_t> coro_recv(int fd, void* buf, size_t len, uint32_t timeout_ms);
+
+/**
+ * @brief Send a whole buffer, waiting whenever the socket's send buffer is full
+ *
+ * @param fd Connected socket
+ * @param buf Data
+ * @param len Data length
+ * @param timeout_ms Longest wait for the socket to drain, per wait
+ * @return (after co_await) len, or -1 on error with errno set (EAGAIN on timeout)
+ */
+CoroTask<ssize_t> coro_send_all(int fd, const void* buf, size_t len, uint32_t timeout_ms);
+
+/**
+ * @brief Accept a connection
+ *
+ * @param listen_fd Listening socket
+ * @param addr Receives the peer address, may be NULL
+ * @param addr_len In/out size of addr, may be NULL
+ * @param timeout_ms Timeout, CORO_WAIT_FOREVER for none
+ * @return (after co_await) The new socket, or -1 on error with errno set (EAGAIN on timeout)
+ */
+CoroTask<int> coro_accept(int listen_fd, struct sockaddr* addr, socklen_t* addr_len, uint32_t timeout_ms);
+
+/**
+ * @brief Connect a socket without blocking the loop
+ *
+ * The socket is switched to non-blocking for the handshake and restored afterwards.
+ *
+ * @param fd Unconnected socket
+ * @param addr Peer address
+ * @param addr_len Size of addr
+ * @param timeout_ms Timeout, CORO_WAIT_FOREVER for none
+ * @return (after co_await) 0 when connected, or -1 on error with errno set (ETIMEDOUT on
+ *         timeout)
+ */
+CoroTask<int> coro_connect(int fd, const struct sockaddr* addr, socklen_t addr_len, uint32_t timeout_ms);
+
+/**
+ * @brief Awaitable for one esp_event (see coro_wait_event())
+ */
+struct CoroEventWait {
+  esp_event_base_t base;
+  int32_t id;
+  uint32_t timeout_ms;
+  bool (*already)();
+  CoroWaiter waiter;
+  esp_event_handler_instance_t instance;
+
+  bool await_ready() const { return already && already(); }
+  bool await_suspend(std::coroutine_handle<> handle);
+  esp_err_t await_resume();
+};
+
+/**
+ * @brief Wait for an event on the default event loop
+ *
+ * The condition is checked again after the handler is registered, so an event that fires
+ * between a check and the wait is not missed. Waiting for Wi-Fi to come up:
+ *
+ * @code
+ * esp_err_t ret = co_await coro_wait_event(IP_EVENT, IP_EVENT_STA_GOT_IP, 30000, is_wifi_connected);
+ * if (ret != ESP_OK) {
+ *   ESP_LOGW(TAG, "No network yet");
+ * }
+ * @endcode
+ *
+ * @param base Event base
+ * @param id Event id, or ESP_EVENT_ANY_ID
+ * @param timeout_ms Timeout, CORO_WAIT_FOREVER for none
+ * @param already Returns true if the awaited state is already reached, may be NULL
+ * @return (after co_await) ESP_OK once the event fired (or already() was true), ESP_ERR_TIMEOUT,
+ *         or the registration error
+ */
+inline CoroEventWait coro_wait_event(esp_event_base_t base, int32_t id, uint32_t timeout_ms,
+                                     bool (*already)() = nullptr) {
+  return CoroEventWait{base, id, timeout_ms, already, {}, nullptr};
+}
+
+/**
+ * @brief Run an HTTP request without blocking the loop
+ *
+ * The client must be created with is_async = true, which esp_http_client supports for HTTPS.
+ * The request is driven step by step, polling every CONFIG_CORO_LOOP_HTTP_POLL_MS while the
+ * connection has nothing to offer. Read the status and headers with the usual getters
+ * afterwards; the body is delivered to the client's event handler as with
+ * esp_http_client_perform().
+ *
+ * @param client Client created with is_async = true
+ * @return (after co_await) The esp_http_client_perform() result
+ */
+CoroTask<esp_err_t> coro_http_perform(esp_http_client_handle_t client);
+
+#endif  // PRODESP32_CORO_IO_H
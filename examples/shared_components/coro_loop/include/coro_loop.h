@@ -0,0 +1,439 @@
+#ifndef PRODESP32_CORO_LOOP_H
+#define PRODESP32_CORO_LOOP_H
+
+#if !defined(__cplusplus) || __cplusplus < 202002L
+#error "coro_loop needs C++20: set(CMAKE_CXX_STANDARD 20) in the project CMakeLists.txt"
+#endif
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/**
+ * @brief A suspended coroutine waiting for something the loop delivers
+ *
+ * Every awaitable in this component embeds one. It lives in the waiting coroutine's frame, so
+ * waiting never allocates. A wait with a timeout also takes one of the CONFIG_CORO_LOOP_MAX_TIMERS
+ * entries of the loop's deadline heap. The fields are internal.
+ */
+struct CoroWaiter {
+  enum State : uint8_t { IDLE, WAITING, DONE };
+
+  std::coroutine_handle<> handle;
+  int64_t deadline_us = INT64_MAX;   ///< esp_timer time at which the wait times out
+  uint32_t heap_index = UINT32_MAX;  ///< Position in the loop's deadline heap
+  int fd = -1;                       ///< Socket waited on, -1 for none
+  uint8_t events = 0;                ///< CORO_READ and/or CORO_WRITE
+  uint8_t state = IDLE;              ///< Completed by whoever moves it from WAITING to DONE
+  esp_err_t result = ESP_OK;         ///< ESP_OK, ESP_ERR_TIMEOUT, or ESP_ERR_NO_MEM if the heap was full
+  CoroWaiter* next = nullptr;        ///< Link in the fd list, ready list or an event's list
+  CoroWaiter* prev = nullptr;
+  void (*on_timeout)(CoroWaiter*) = nullptr;  ///< Unlinks the waiter from its source on timeout
+  void* context = nullptr;                    ///< For on_timeout
+
+  /**
+   * @brief Claim completion; true for exactly one of the competing completers
+   */
+  bool try_complete() {
+    uint8_t expected = WAITING;
+    return __atomic_compare_exchange_n(&state, &expected, DONE, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+  }
+};
+
+#define CORO_READ 0x01
+#define CORO_WRITE 0x02
+#define CORO_WAIT_FOREVER UINT32_MAX
+
+/**
+ * @brief Loop statistics
+ */
+typedef struct {
+  uint32_t tasks;       ///< Spawned coroutines still running
+  uint32_t timers;      ///< Waiters with a deadline
+  uint32_t sockets;     ///< Waiters on a socket
+  uint32_t resumes;     ///< Coroutine resumptions since start
+  uint32_t posts;       ///< Wake-ups posted from other tasks
+  uint32_t max_run_us;  ///< Longest stretch of running coroutines between two waits
+} coro_loop_stats_t;
+
+/**
+ * @brief Start the loop task
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already running, ESP_ERR_NO_MEM if the
+ *         task or its wake-up descriptor could not be created
+ */
+esp_err_t coro_loop_start();
+
+/**
+ * @brief Whether the caller runs on the loop task
+ */
+bool coro_loop_in_loop();
+
+/**
+ * @brief Copy the loop statistics
+ */
+esp_err_t coro_loop_get_stats(coro_loop_stats_t* out);
+
+/**
+ * @brief Resume a coroutine on the loop task; safe from any task (not from ISRs)
+ */
+void coro_loop_post(std::coroutine_handle<> handle);
+
+/**
+ * @brief Complete a waiter from another task; the loop resumes it (internal)
+ *
+ * The caller must have won waiter->try_complete().
+ */
+void coro_loop_post_waiter(CoroWaiter* waiter);
+
+/**
+ * @brief Register a waiter with the loop: its deadline and socket, if any (loop task, internal)
+ *
+ * If the deadline heap is full the waiter completes at once with ESP_ERR_NO_MEM.
+ */
+void coro_loop_add_waiter(CoroWaiter* waiter);
+
+/**
+ * @brief Queue a waiter to be resumed on the next loop pass (loop task, internal)
+ */
+void coro_loop_make_ready(CoroWaiter* waiter);
+
+/**
+ * @brief Deadline for a timeout in ms, INT64_MAX for CORO_WAIT_FOREVER (internal)
+ */
+int64_t coro_loop_deadline(uint32_t timeout_ms);
+
+/**
+ * @brief Count spawned coroutines for the statistics (internal)
+ */
+void coro_loop_task_started();
+void coro_loop_task_finished();
+
+template <typename T>
+class CoroTask;
+
+/**
+ * @brief State shared by all coroutine promises (internal)
+ */
+struct CoroPromiseBase {
+  std::coroutine_handle<> continuation;
+  bool detached = false;
+
+  // Frames come from the heap; a failed allocation yields an invalid task instead of aborting
+  static void* operator new(size_t size) noexcept { return malloc(size); }
+  static void operator delete(void* ptr) noexcept { free(ptr); }
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+      CoroPromiseBase& promise = self.promise();
+      if (promise.detached) {
+        self.destroy();
+        coro_loop_task_finished();
+        return std::noop_coroutine();
+      }
+      // Symmetric transfer: resume the awaiting coroutine without growing the stack
+      return promise.continuation ? promise.continuation : std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() noexcept { abort(); }
+};
+
+template <typename T>
+struct CoroPromise : CoroPromiseBase {
+  T value{};
+  CoroTask<T> get_return_object() noexcept;
+  static CoroTask<T> get_return_object_on_allocation_failure() noexcept;
+  template <typename U>
+  void return_value(U&& result) {
+    value = std::forward<U>(result);
+  }
+  T take() { return std::move(value); }
+};
+
+template <>
+struct CoroPromise<void> : CoroPromiseBase {
+  CoroTask<void> get_return_object() noexcept;
+  static CoroTask<void> get_return_object_on_allocation_failure() noexcept;
+  void return_void() {}
+  void take() {}
+};
+
+/**
+ * @brief A coroutine that produces a T (or nothing)
+ *
+ * Lazy: it starts when awaited or spawned, and runs on the loop task. Awaiting it suspends the
+ * caller until it returns, then yields its result. The frame is freed when the CoroTask goes
+ * out of scope, or when a spawned task finishes.
+ *
+ * @code
+ * CoroTask<int> read_sensor_async() {
+ *   co_await coro_sleep_ms(20);  // conversion time
+ *   co_return sensor_read_result();
+ * }
+ *
+ * CoroTask<void> poller() {
+ *   while (true) {
+ *     int value = co_await read_sensor_async();
+ *     publish(value);
+ *     co_await coro_sleep_ms(1000);
+ *   }
+ * }
+ *
+ * coro_spawn(poller());
+ * @endcode
+ */
+template <typename T = void>
+class [[nodiscard]] CoroTask {
+ public:
+  using promise_type = CoroPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  CoroTask() = default;
+  explicit CoroTask(Handle handle) : handle_(handle) {}
+  CoroTask(CoroTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+  CoroTask& operator=(CoroTask&& other) noexcept {
+    if (this != &other) {
+      if (handle_) {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  CoroTask(const CoroTask&) = delete;
+  CoroTask& operator=(const CoroTask&) = delete;
+  ~CoroTask() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  /**
+   * @brief False if the frame could not be allocated
+   */
+  bool valid() const { return static_cast<bool>(handle_); }
+
+  /**
+   * @brief Hand over the frame (used by coro_spawn())
+   */
+  Handle release() { return std::exchange(handle_, nullptr); }
+
+  struct Awaiter {
+    Handle handle;
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+      handle.promise().continuation = caller;
+      return handle;
+    }
+    T await_resume() { return handle.promise().take(); }
+  };
+
+  Awaiter operator co_await() & noexcept {
+    assert(handle_ && "awaiting a CoroTask whose frame could not be allocated");
+    return Awaiter{handle_};
+  }
+  Awaiter operator co_await() && noexcept {
+    assert(handle_ && "awaiting a CoroTask whose frame could not be allocated");
+    return Awaiter{handle_};
+  }
+
+ private:
+  Handle handle_;
+};
+
+template <typename T>
+CoroTask<T> CoroPromise<T>::get_return_object() noexcept {
+  return CoroTask<T>(std::coroutine_handle<CoroPromise<T>>::from_promise(*this));
+}
+
+template <typename T>
+CoroTask<T> CoroPromise<T>::get_return_object_on_allocation_failure() noexcept {
+  return CoroTask<T>();
+}
+
+inline CoroTask<void> CoroPromise<void>::get_return_object() noexcept {
+  return CoroTask<void>(std::coroutine_handle<CoroPromise<void>>::from_promise(*this));
+}
+
+inline CoroTask<void> CoroPromise<void>::get_return_object_on_allocation_failure() noexcept {
+  return CoroTask<void>();
+}
+
+/**
+ * @brief Run a coroutine on the loop without waiting for it; safe from any task
+ *
+ * The loop owns the frame and frees it when the coroutine returns.
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the frame could not be allocated
+ */
+inline esp_err_t coro_spawn(CoroTask<void>&& task) {
+  if (!task.valid()) {
+    return ESP_ERR_NO_MEM;
+  }
+  auto handle = task.release();
+  handle.promise().detached = true;
+  coro_loop_task_started();
+  coro_loop_post(handle);
+  return ESP_OK;
+}
+
+/**
+ * @brief Run a coroutine on the loop and block the calling task until it returns
+ *
+ * This is the bridge from blocking code, such as an MCP tool handler on the transport task:
+ * the task sleeps, and the I/O inside the coroutine shares the loop with everything else.
+ * Never call it from the loop task itself.
+ *
+ * @code
+ * static mcp_tool_result_t fetch_handler(const mcp_tool_args_t* args) {
+ *   return coro_block_on(fetch_status_async(mcp_tool_args_get_string(args, "url", "")));
+ * }
+ * @endcode
+ */
+template <typename T>
+T coro_block_on(CoroTask<T> task) {
+  assert(!coro_loop_in_loop() && "coro_block_on() would deadlock the loop");
+  StaticSemaphore_t storage;
+  SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&storage);
+
+  if constexpr (std::is_void_v<T>) {
+    auto run = [](CoroTask<void> inner, SemaphoreHandle_t done) -> CoroTask<void> {
+      co_await std::move(inner);
+      xSemaphoreGive(done);
+    };
+    if (coro_spawn(run(std::move(task), done)) == ESP_OK) {
+      xSemaphoreTake(done, portMAX_DELAY);
+    }
+    vSemaphoreDelete(done);
+  }
+  else {
+    T result{};
+    auto run = [](CoroTask<T> inner, T* out, SemaphoreHandle_t done) -> CoroTask<void> {
+      *out = co_await std::move(inner);
+      xSemaphoreGive(done);
+    };
+    if (coro_spawn(run(std::move(task), &result, done)) == ESP_OK) {
+      xSemaphoreTake(done, portMAX_DELAY);
+    }
+    vSemaphoreDelete(done);
+    return result;
+  }
+}
+
+/**
+ * @brief Awaitable that suspends for a time (see coro_sleep_ms())
+ */
+struct CoroSleep {
+  CoroWaiter waiter;
+  uint32_t ms;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    waiter.handle = handle;
+    waiter.state = CoroWaiter::WAITING;
+    waiter.deadline_us = coro_loop_deadline(ms);
+    coro_loop_add_waiter(&waiter);
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Suspend the coroutine for at least ms milliseconds
+ */
+inline CoroSleep coro_sleep_ms(uint32_t ms) { return CoroSleep{{}, ms}; }
+
+/**
+ * @brief Awaitable that lets the other ready coroutines run first (see coro_yield())
+ */
+struct CoroYield {
+  CoroWaiter waiter;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    waiter.handle = handle;
+    waiter.state = CoroWaiter::DONE;
+    coro_loop_make_ready(&waiter);
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Give the other ready coroutines a turn, for long computations on the loop
+ */
+inline CoroYield coro_yield() { return CoroYield{}; }
+
+/**
+ * @brief One-shot event that coroutines can wait for, set from any task
+ *
+ * Once set it stays set until reset(), so a set() that comes before the wait is not lost.
+ *
+ * @code
+ * static CoroEvent s_calibrated;
+ *
+ * // Any task
+ * s_calibrated.set();
+ *
+ * // Coroutine
+ * esp_err_t ret = co_await s_calibrated.wait(5000);  // ESP_ERR_TIMEOUT after 5 s
+ * @endcode
+ */
+class CoroEvent {
+ public:
+  CoroEvent() = default;
+  CoroEvent(const CoroEvent&) = delete;
+  CoroEvent& operator=(const CoroEvent&) = delete;
+
+  /**
+   * @brief Set the event and resume every waiting coroutine
+   */
+  void set();
+
+  /**
+   * @brief Clear the event
+   */
+  void reset() { __atomic_store_n(&set_, false, __ATOMIC_RELEASE); }
+
+  bool is_set() const { return __atomic_load_n(&set_, __ATOMIC_ACQUIRE); }
+
+  struct Awaiter {
+    CoroEvent* event;
+    uint32_t timeout_ms;
+    CoroWaiter waiter;
+
+    bool await_ready() const noexcept { return event->is_set(); }
+    bool await_suspend(std::coroutine_handle<> handle);
+    esp_err_t await_resume() const noexcept { return waiter.result; }
+  };
+
+  /**
+   * @brief Wait until the event is set
+   *
+   * @param timeout_ms Timeout, CORO_WAIT_FOREVER for none
+   * @return (after co_await) ESP_OK once set, ESP_ERR_TIMEOUT otherwise
+   */
+  Awaiter wait(uint32_t timeout_ms = CORO_WAIT_FOREVER) { return Awaiter{this, timeout_ms, {}}; }
+
+ private:
+  static void unlink_on_timeout(CoroWaiter* waiter);
+
+  portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  bool set_ = false;
+  CoroWaiter* waiters_ = nullptr;
+};
+
+#endif  // PRODESP32_CORO_LOOP_H
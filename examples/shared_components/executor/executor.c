@@ -0,0 +1,326 @@
+#include "executor.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "executor_deque.h"
+#include "freertos/task.h"
+#include "lockfree_queue.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "executor";
+
+#define WORKERS CONFIG_FREERTOS_NUMBER_OF_CORES
+#define INBOX_SIZE CONFIG_EXECUTOR_INBOX_SIZE
+#define HELP_POLL_TICKS 1
+
+_Static_assert((EXECUTOR_DEQUE_SIZE & (EXECUTOR_DEQUE_SIZE - 1)) == 0, "EXECUTOR_DEQUE_SIZE must be a power of two");
+_Static_assert((INBOX_SIZE & (INBOX_SIZE - 1)) == 0, "EXECUTOR_INBOX_SIZE must be a power of two");
+
+/**
+ * @brief Worker state (internal)
+ *
+ * Jobs from outside the executor arrive in the inbox, an MPSC ring any task or ISR can push
+ * to. The worker moves them onto its deque, where the other worker can steal them.
+ */
+typedef struct {
+  deque_t deque;
+  lfq_mpsc_t inbox;
+  uint32_t inbox_seq[INBOX_SIZE];
+  job_t inbox_jobs[INBOX_SIZE];
+  TaskHandle_t task;
+  uint32_t sleeping;  // Set while blocked (or about to block) waiting for a notification
+  executor_worker_stats_t stats;
+} worker_t;
+
+static worker_t s_workers[WORKERS];
+static bool s_running = false;  // Atomic accesses only
+static uint32_t s_next_worker = 0;
+static StaticSemaphore_t s_exited_storage;
+static SemaphoreHandle_t s_exited = NULL;
+
+// Statistics are written only by their worker but read by anyone through executor_get_stats(),
+// so both sides use relaxed atomics; a reader sees each counter whole, if not all of them at once
+#define STAT_ADD(field, n) \
+  __atomic_store_n(&(field), __atomic_load_n(&(field), __ATOMIC_RELAXED) + (n), __ATOMIC_RELAXED)
+#define STAT_READ(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+static worker_t* current_worker(void) {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (int i = 0; i < WORKERS; i++) {
+    if (s_workers[i].task == self) {
+      return &s_workers[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Wake a worker if it is sleeping
+ *
+ * The full fence orders the caller's queue write before the sleeping flag read; the worker
+ * sets the flag before its last look at the queues, so one of the two always sees the other.
+ */
+static void wake(worker_t* worker, BaseType_t* woken_from_isr) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (!__atomic_exchange_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST)) {
+    return;
+  }
+  if (woken_from_isr) {
+    vTaskNotifyGiveFromISR(worker->task, woken_from_isr);
+  }
+  else {
+    xTaskNotifyGive(worker->task);
+  }
+}
+
+static worker_t* pick_worker(void) {
+  for (int i = 0; i < WORKERS; i++) {
+    if (__atomic_load_n(&s_workers[i].sleeping, __ATOMIC_RELAXED)) {
+      return &s_workers[i];
+    }
+  }
+  return &s_workers[__atomic_fetch_add(&s_next_worker, 1, __ATOMIC_RELAXED) % WORKERS];
+}
+
+static esp_err_t submit(const job_t* job, BaseType_t* woken_from_isr) {
+  if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  worker_t* self = woken_from_isr ? NULL : current_worker();
+  if (self && deque_push(&self->deque, job)) {
+    STAT_ADD(self->stats.local_submits, 1);
+    for (int i = 0; i < WORKERS; i++) {
+      if (&s_workers[i] != self) {
+        wake(&s_workers[i], NULL);
+      }
+    }
+    return ESP_OK;
+  }
+
+  // From outside, or the own deque is full: go through an inbox, trying each worker once
+  worker_t* target = pick_worker();
+  for (int i = 0; i < WORKERS; i++) {
+    if (lfq_mpsc_push(&target->inbox, job)) {
+      wake(target, woken_from_isr);
+      return ESP_OK;
+    }
+    target = &s_workers[(target - s_workers + 1) % WORKERS];
+  }
+  return ESP_ERR_NO_MEM;
+}
+
+static bool next_job(worker_t* self, job_t* job) {
+  if (deque_take(&self->deque, job)) {
+    return true;
+  }
+
+  // Move the inbox onto the deque so the other worker can steal from it, then take the newest
+  job_t incoming;
+  bool moved = false;
+  while (lfq_mpsc_pop(&self->inbox, &incoming)) {
+    STAT_ADD(self->stats.jobs_received, 1);
+    moved = true;
+    if (!deque_push(&self->deque, &incoming)) {
+      // Deque full (it was empty a moment ago, so only with a tiny deque): run this one next
+      *job = incoming;
+      return true;
+    }
+  }
+  if (moved && deque_take(&self->deque, job)) {
+    return true;
+  }
+
+  for (int i = 1; i < WORKERS; i++) {
+    worker_t* victim = &s_workers[(self - s_workers + i) % WORKERS];
+    if (deque_steal(&victim->deque, job)) {
+      STAT_ADD(self->stats.jobs_stolen, 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+static void run_job(worker_t* self, const job_t* job) {
+  int64_t start_us = esp_timer_get_time();
+  job->fn(job->arg);
+  uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+  STAT_ADD(self->stats.jobs_run, 1);
+  STAT_ADD(self->stats.busy_us, elapsed_us);
+  if (elapsed_us > self->stats.max_job_us) {
+    __atomic_store_n(&self->stats.max_job_us, elapsed_us, __ATOMIC_RELAXED);
+  }
+
+  if (job->future) {
+    // A waiting worker polls completed but only returns after taking the semaphore, so the
+    // future is not touched after the give
+    __atomic_store_n(&job->future->completed, true, __ATOMIC_RELEASE);
+    xSemaphoreGive(job->future->done);
+  }
+}
+
+static void worker_task(void* arg) {
+  worker_t* self = (worker_t*)arg;
+  job_t job;
+
+  while (true) {
+    if (next_job(self, &job)) {
+      run_job(self, &job);
+      continue;
+    }
+
+    __atomic_store_n(&self->sleeping, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (next_job(self, &job)) {
+      __atomic_store_n(&self->sleeping, 0, __ATOMIC_RELAXED);
+      run_job(self, &job);
+      continue;
+    }
+    if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+      // A waker that already cleared the flag is about to notify this task; take that first, so
+      // no notification reaches a deleted task
+      if (!__atomic_exchange_n(&self->sleeping, 0, __ATOMIC_SEQ_CST)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      }
+      break;
+    }
+    STAT_ADD(self->stats.sleeps, 1);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    __atomic_store_n(&self->sleeping, 0, __ATOMIC_RELAXED);
+  }
+
+  xSemaphoreGive(s_exited);
+  vTaskDelete(NULL);
+}
+
+esp_err_t executor_start(void) {
+  if (__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  memset(s_workers, 0, sizeof(s_workers));
+  s_exited = xSemaphoreCreateCountingStatic(WORKERS, 0, &s_exited_storage);
+  for (int i = 0; i < WORKERS; i++) {
+    lfq_mpsc_init(&s_workers[i].inbox, s_workers[i].inbox_seq, s_workers[i].inbox_jobs, sizeof(job_t), INBOX_SIZE);
+  }
+
+  // Submissions are accepted from here on and wait in the inboxes until the workers start
+  __atomic_store_n(&s_running, true, __ATOMIC_RELEASE);
+  for (int i = 0; i < WORKERS; i++) {
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "executor%d", i);
+    if (xTaskCreatePinnedToCore(worker_task, name, CONFIG_EXECUTOR_WORKER_STACK_SIZE, &s_workers[i],
+                                CONFIG_EXECUTOR_WORKER_PRIORITY, &s_workers[i].task, i) != pdPASS) {
+      ESP_LOGE(TAG, "Failed to create worker %d", i);
+      __atomic_store_n(&s_running, false, __ATOMIC_RELEASE);
+      for (int j = 0; j < i; j++) {
+        wake(&s_workers[j], NULL);
+        xSemaphoreTake(s_exited, portMAX_DELAY);
+      }
+      memset(s_workers, 0, sizeof(s_workers));
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  ESP_LOGI(TAG, "Started %d worker(s), %d-job deques", WORKERS, EXECUTOR_DEQUE_SIZE);
+  return ESP_OK;
+}
+
+esp_err_t executor_stop(void) {
+  if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  __atomic_store_n(&s_running, false, __ATOMIC_RELEASE);
+  for (int i = 0; i < WORKERS; i++) {
+    // Sleeping workers wake, find nothing left and exit; busy ones exit once they run dry
+    wake(&s_workers[i], NULL);
+  }
+  for (int i = 0; i < WORKERS; i++) {
+    xSemaphoreTake(s_exited, portMAX_DELAY);
+  }
+
+  memset(s_workers, 0, sizeof(s_workers));
+  return ESP_OK;
+}
+
+bool executor_is_running(void) { return __atomic_load_n(&s_running, __ATOMIC_ACQUIRE); }
+
+esp_err_t executor_submit(executor_fn_t fn, void* arg) {
+  if (!fn) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  job_t job = {.fn = fn, .arg = arg, .future = NULL};
+  return submit(&job, NULL);
+}
+
+esp_err_t executor_submit_from_isr(executor_fn_t fn, void* arg, BaseType_t* higher_priority_task_woken) {
+  if (!fn || !higher_priority_task_woken) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  job_t job = {.fn = fn, .arg = arg, .future = NULL};
+  return submit(&job, higher_priority_task_woken);
+}
+
+esp_err_t executor_submit_future(executor_fn_t fn, void* arg, executor_future_t* future) {
+  if (!fn || !future) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  future->completed = false;
+  future->done = xSemaphoreCreateBinaryStatic(&future->storage);
+  job_t job = {.fn = fn, .arg = arg, .future = future};
+  return submit(&job, NULL);
+}
+
+esp_err_t executor_future_wait(executor_future_t* future, TickType_t timeout) {
+  if (!future || !future->done) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  worker_t* self = current_worker();
+  if (!self) {
+    return xSemaphoreTake(future->done, timeout) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+  }
+
+  // On a worker, keep running jobs (possibly the awaited one) until the future completes
+  TickType_t start = xTaskGetTickCount();
+  job_t job;
+  while (!__atomic_load_n(&future->completed, __ATOMIC_ACQUIRE)) {
+    if (next_job(self, &job)) {
+      run_job(self, &job);
+      continue;
+    }
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= timeout) {
+      return ESP_ERR_TIMEOUT;
+    }
+    // The other worker is running it; poll briefly rather than sleep, so new work is picked up
+    if (xSemaphoreTake(future->done, HELP_POLL_TICKS) == pdTRUE) {
+      return ESP_OK;
+    }
+  }
+  // Completed is set just before the give
+  xSemaphoreTake(future->done, portMAX_DELAY);
+  return ESP_OK;
+}
+
+int executor_worker_count(void) { return WORKERS; }
+
+esp_err_t executor_get_stats(int worker, executor_worker_stats_t* out) {
+  if (!out || worker < 0 || worker >= WORKERS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const executor_worker_stats_t* stats = &s_workers[worker].stats;
+  out->jobs_run = STAT_READ(stats->jobs_run);
+  out->jobs_stolen = STAT_READ(stats->jobs_stolen);
+  out->jobs_received = STAT_READ(stats->jobs_received);
+  out->local_submits = STAT_READ(stats->local_submits);
+  out->sleeps = STAT_READ(stats->sleeps);
+  out->busy_us = STAT_READ(stats->busy_us);
+  out->max_job_us = STAT_READ(stats->max_job_us);
+  return ESP_OK;
+}
@@ -0,0 +1,99 @@
+#ifndef PRODESP32_EXECUTOR_DEQUE_H
+#define PRODESP32_EXECUTOR_DEQUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "executor.h"
+#include "lockfree_queue.h"
+#include "sdkconfig.h"
+
+// Private to executor.c; a header of its own so host tests can drive the deque directly
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EXECUTOR_DEQUE_SIZE CONFIG_EXECUTOR_DEQUE_SIZE
+
+typedef struct {
+  executor_fn_t fn;
+  void* arg;
+  executor_future_t* future;
+} job_t;
+
+/**
+ * @brief Work-stealing deque (Chase-Lev, bounded)
+ *
+ * The owning worker pushes and takes at bottom (newest first); other workers steal from top
+ * (oldest first). Only a take racing a steal for the last job needs a compare-and-swap.
+ */
+typedef struct {
+  int32_t top LFQ_ALIGNED;
+  int32_t bottom LFQ_ALIGNED;
+  job_t jobs[EXECUTOR_DEQUE_SIZE];
+} deque_t;
+
+// A thief that stalls may read a slot while the owner rewrites it a lap later. It then loses
+// the compare-and-swap and drops the copy, but the accesses must still be atomic to be defined.
+static inline void job_store(job_t* slot, const job_t* job) {
+  __atomic_store_n(&slot->fn, job->fn, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->arg, job->arg, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->future, job->future, __ATOMIC_RELAXED);
+}
+
+static inline void job_load(const job_t* slot, job_t* job) {
+  job->fn = __atomic_load_n(&slot->fn, __ATOMIC_RELAXED);
+  job->arg = __atomic_load_n(&slot->arg, __ATOMIC_RELAXED);
+  job->future = __atomic_load_n(&slot->future, __ATOMIC_RELAXED);
+}
+
+static inline bool deque_push(deque_t* deque, const job_t* job) {
+  int32_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+  int32_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  if (bottom - top >= EXECUTOR_DEQUE_SIZE) {
+    return false;
+  }
+  job_store(&deque->jobs[bottom & (EXECUTOR_DEQUE_SIZE - 1)], job);
+  // Pairs with the acquire load of bottom in deque_steal(), publishing the job and what it points to
+  __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static inline bool deque_take(deque_t* deque, job_t* job) {
+  int32_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+  __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int32_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+  if (top > bottom) {
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  *job = deque->jobs[bottom & (EXECUTOR_DEQUE_SIZE - 1)];
+  if (top == bottom) {
+    // Last job: a thief may be taking it at the same time
+    bool won = __atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return won;
+  }
+  return true;
+}
+
+static inline bool deque_steal(deque_t* deque, job_t* job) {
+  int32_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int32_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+  if (top >= bottom) {
+    return false;
+  }
+  job_load(&deque->jobs[top & (EXECUTOR_DEQUE_SIZE - 1)], job);
+  // Losing the race means the owner or another thief got the job; the copy is discarded
+  return __atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_EXECUTOR_DEQUE_H
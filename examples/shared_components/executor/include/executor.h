@@ -0,0 +1,213 @@
+#ifndef PRODESP32_EXECUTOR_H
+#define PRODESP32_EXECUTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Job function, run on one of the worker tasks
+ *
+ * Jobs share the worker stacks (CONFIG_EXECUTOR_WORKER_STACK_SIZE) and should not block for
+ * long: a blocked job holds up every job queued behind it on that worker.
+ *
+ * @param arg Argument given at submission
+ */
+typedef void (*executor_fn_t)(void* arg);
+
+/**
+ * @brief Completion handle for a submitted job
+ *
+ * Caller-owned; it must stay valid until executor_future_wait() has returned ESP_OK. No
+ * cleanup is needed afterwards.
+ */
+typedef struct {
+  StaticSemaphore_t storage;
+  SemaphoreHandle_t done;
+  bool completed;  // Set by the worker before it gives done
+} executor_future_t;
+
+/**
+ * @brief Per-worker statistics
+ *
+ * Written only by the worker itself; a copy taken while it runs may be off by a job.
+ */
+typedef struct {
+  uint32_t jobs_run;        ///< Jobs executed by this worker
+  uint32_t jobs_stolen;     ///< Of those, jobs taken from another worker's deque
+  uint32_t jobs_received;   ///< Jobs submitted from outside the executor to this worker
+  uint32_t local_submits;   ///< Jobs submitted by jobs running on this worker
+  uint32_t sleeps;          ///< Times the worker found no work and blocked
+  uint64_t busy_us;         ///< Total time spent running jobs
+  uint32_t max_job_us;      ///< Longest job
+} executor_worker_stats_t;
+
+/**
+ * @brief Start one worker task per core
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t executor_start(void);
+
+/**
+ * @brief Stop the workers after they have run every queued job
+ *
+ * Call it only once nothing submits any more; it blocks until the workers have exited.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t executor_stop(void);
+
+/**
+ * @brief Whether the executor is running
+ */
+bool executor_is_running(void);
+
+/**
+ * @brief Queue a job
+ *
+ * From a job, the new job goes on the current worker's own deque (newest first, so related
+ * work stays on one core) and an idle worker on the other core may steal it. From any other
+ * task it goes to the inbox of an idle worker, or round robin if none is idle.
+ *
+ * @param fn Job function
+ * @param arg Argument passed to fn
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running, ESP_ERR_NO_MEM if the
+ *         queues are full
+ */
+esp_err_t executor_submit(executor_fn_t fn, void* arg);
+
+/**
+ * @brief Queue a job from an ISR
+ *
+ * @param fn Job function
+ * @param arg Argument passed to fn
+ * @param higher_priority_task_woken Set to pdTRUE if a worker was woken; yield at the end of the ISR
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running, ESP_ERR_NO_MEM if the inbox is full
+ */
+esp_err_t executor_submit_from_isr(executor_fn_t fn, void* arg, BaseType_t* higher_priority_task_woken);
+
+/**
+ * @brief Queue a job and get a future that completes when it has run
+ *
+ * @param fn Job function
+ * @param arg Argument passed to fn; return results through it
+ * @param future Caller-owned future, initialized here
+ * @return As executor_submit()
+ */
+esp_err_t executor_submit_future(executor_fn_t fn, void* arg, executor_future_t* future);
+
+/**
+ * @brief Wait for a future
+ *
+ * Called from a job, the worker runs other jobs while it waits instead of blocking, so jobs
+ * can wait on jobs they submitted without tying up the worker.
+ *
+ * @param future Future from executor_submit_future()
+ * @param timeout Ticks to wait
+ * @return ESP_OK once the job has run, ESP_ERR_TIMEOUT otherwise (the future stays in use)
+ */
+esp_err_t executor_future_wait(executor_future_t* future, TickType_t timeout);
+
+/**
+ * @brief Number of workers (one per core)
+ */
+int executor_worker_count(void);
+
+/**
+ * @brief Copy the statistics of one worker
+ *
+ * @param worker Worker index, 0 .. executor_worker_count() - 1
+ * @param out Receives the statistics
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad index
+ */
+esp_err_t executor_get_stats(int worker, executor_worker_stats_t* out);
+
+#ifdef __cplusplus
+}
+
+#include <new>
+#include <utility>
+
+/**
+ * @brief Queue a closure (lambda, functor)
+ *
+ * The closure is moved into one heap allocation that is freed after it runs.
+ *
+ * @code
+ * executor_submit([reading] { process(reading); });
+ * @endcode
+ */
+template <typename F>
+esp_err_t executor_submit(F&& fn) {
+  using Closure = typename std::decay<F>::type;
+  Closure* closure = new (std::nothrow) Closure(std::forward<F>(fn));
+  if (!closure) {
+    return ESP_ERR_NO_MEM;
+  }
+  esp_err_t ret = executor_submit(
+      [](void* arg) {
+        Closure* c = static_cast<Closure*>(arg);
+        (*c)();
+        delete c;
+      },
+      closure);
+  if (ret != ESP_OK) {
+    delete closure;
+  }
+  return ret;
+}
+
+/**
+ * @brief A closure run on the executor with its result kept for the caller
+ *
+ * Owns the closure, the result and the future without a heap allocation; it must outlive
+ * the job (wait() returning ESP_OK).
+ *
+ * @code
+ * ExecutorTask<float> mean([&] { return compute_mean(samples, count); });
+ * mean.start();
+ * ...
+ * if (mean.wait() == ESP_OK) use(mean.result());
+ * @endcode
+ */
+template <typename T, typename F>
+class ExecutorTask {
+ public:
+  explicit ExecutorTask(F fn) : fn_(std::move(fn)) {}
+  ExecutorTask(const ExecutorTask&) = delete;
+  ExecutorTask& operator=(const ExecutorTask&) = delete;
+
+  esp_err_t start() { return executor_submit_future(&run, this, &future_); }
+  esp_err_t wait(TickType_t timeout = portMAX_DELAY) { return executor_future_wait(&future_, timeout); }
+  T& result() { return value_; }
+
+ private:
+  static void run(void* arg) {
+    ExecutorTask* self = static_cast<ExecutorTask*>(arg);
+    self->value_ = self->fn_();
+  }
+
+  F fn_;
+  T value_{};
+  executor_future_t future_;
+};
+
+/**
+ * @brief Deduce ExecutorTask<T, F> from a closure: auto task = make_executor_task([&] { ... });
+ */
+template <typename F>
+ExecutorTask<decltype(std::declval<F&>()()), F> make_executor_task(F fn) {
+  return ExecutorTask<decltype(std::declval<F&>()()), F>(std::move(fn));
+}
+
+#endif  // __cplusplus
+
+#endif  // PRODESP32_EXECUTOR_H
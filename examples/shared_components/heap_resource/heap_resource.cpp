@@ -0,0 +1,188 @@
+#include "heap_resource.h"
+
+#include <stdlib.h>
+
+#include <new>
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "heap_resource";
+
+// Alignment heap_caps_malloc() guarantees without asking for more
+static constexpr size_t HEAP_ALIGNMENT = alignof(void*);
+
+static size_t align_up(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+void HeapResource::get_stats(heap_resource_stats_t* out) const {
+  out->bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  out->peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+  out->capacity = capacity_;
+  out->allocations = allocations_.load(std::memory_order_relaxed);
+  out->deallocations = deallocations_.load(std::memory_order_relaxed);
+  out->failures = failures_.load(std::memory_order_relaxed);
+  out->fallbacks = fallbacks_.load(std::memory_order_relaxed);
+}
+
+void HeapResource::log_stats() const {
+  heap_resource_stats_t stats;
+  get_stats(&stats);
+  ESP_LOGI(TAG, "%s: %u bytes in use (peak %u, capacity %u), %lu allocs, %lu frees, %lu failures, %lu fallbacks",
+           name_, (unsigned)stats.bytes_in_use, (unsigned)stats.peak_bytes, (unsigned)stats.capacity,
+           (unsigned long)stats.allocations, (unsigned long)stats.deallocations, (unsigned long)stats.failures,
+           (unsigned long)stats.fallbacks);
+}
+
+void HeapResource::count_allocation(size_t bytes) {
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  size_t in_use = bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+  while (in_use > peak && !peak_bytes_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+  }
+}
+
+void HeapResource::count_deallocation(size_t bytes) {
+  deallocations_.fetch_add(1, std::memory_order_relaxed);
+  bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void HeapResource::fail(size_t bytes, size_t alignment) {
+  failures_.fetch_add(1, std::memory_order_relaxed);
+  ESP_LOGE(TAG, "%s: cannot allocate %u bytes (alignment %u)", name_, (unsigned)bytes, (unsigned)alignment);
+#if __cpp_exceptions
+  throw std::bad_alloc();
+#else
+  abort();
+#endif
+}
+
+void* HeapCapsResource::do_allocate(size_t bytes, size_t alignment) {
+  void* p = alignment <= HEAP_ALIGNMENT ? heap_caps_malloc(bytes, caps_)
+                                        : heap_caps_aligned_alloc(alignment, bytes, caps_);
+  if (!p) {
+    fail(bytes, alignment);
+  }
+  count_allocation(bytes);
+  return p;
+}
+
+void HeapCapsResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+  // heap_caps_free() also frees heap_caps_aligned_alloc() blocks
+  heap_caps_free(p);
+  count_deallocation(bytes);
+}
+
+ArenaResource::ArenaResource(size_t capacity, uint32_t caps, const char* name)
+    : HeapResource(name), buffer_(static_cast<uint8_t*>(heap_caps_malloc(capacity, caps))), owned_(true) {
+  if (!buffer_) {
+    ESP_LOGE(TAG, "%s: cannot allocate a %u byte arena", name, (unsigned)capacity);
+    capacity = 0;
+  }
+  next_ = buffer_;
+  capacity_ = capacity;
+}
+
+ArenaResource::ArenaResource(void* buffer, size_t capacity, const char* name)
+    : HeapResource(name), buffer_(static_cast<uint8_t*>(buffer)), next_(buffer_), owned_(false) {
+  capacity_ = capacity;
+}
+
+ArenaResource::~ArenaResource() {
+  if (owned_) {
+    heap_caps_free(buffer_);
+  }
+}
+
+void ArenaResource::release() {
+  count_deallocation(used());
+  next_ = buffer_;
+}
+
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+  uintptr_t start = align_up(reinterpret_cast<uintptr_t>(next_), alignment);
+  uintptr_t end = reinterpret_cast<uintptr_t>(buffer_) + capacity_;
+  if (!buffer_ || start > end || bytes > end - start) {
+    fail(bytes, alignment);
+  }
+  // Alignment padding counts as in use: it is only given back by release()
+  uint8_t* p = reinterpret_cast<uint8_t*>(start);
+  count_allocation(p + bytes - next_);
+  next_ = p + bytes;
+  return p;
+}
+
+void ArenaResource::do_deallocate(void* p, size_t bytes, size_t alignment) {}
+
+PoolResource::PoolResource(size_t block_size, size_t block_count, uint32_t caps, const char* name,
+                           std::pmr::memory_resource* upstream)
+    : HeapResource(name),
+      block_size_(align_up(block_size < sizeof(FreeBlock) ? sizeof(FreeBlock) : block_size, alignof(std::max_align_t))),
+      block_count_(block_count),
+      upstream_(upstream) {
+  blocks_ = static_cast<uint8_t*>(heap_caps_aligned_alloc(alignof(std::max_align_t), block_size_ * block_count, caps));
+  if (!blocks_) {
+    ESP_LOGE(TAG, "%s: cannot allocate %u blocks of %u bytes", name, (unsigned)block_count, (unsigned)block_size_);
+    block_count_ = 0;
+  }
+  // Threaded back to front, so the first allocations come from the start of the pool
+  for (size_t i = block_count_; i > 0; i--) {
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(blocks_ + (i - 1) * block_size_);
+    block->next = free_list_;
+    free_list_ = block;
+  }
+  free_count_ = block_count_;
+  capacity_ = block_size_ * block_count_;
+}
+
+PoolResource::~PoolResource() { heap_caps_free(blocks_); }
+
+void* PoolResource::do_allocate(size_t bytes, size_t alignment) {
+  FreeBlock* block = nullptr;
+  if (bytes <= block_size_ && alignment <= alignof(std::max_align_t)) {
+    portENTER_CRITICAL(&lock_);
+    block = free_list_;
+    if (block) {
+      free_list_ = block->next;
+      free_count_--;
+    }
+    portEXIT_CRITICAL(&lock_);
+  }
+  if (block) {
+    count_allocation(bytes);
+    return block;
+  }
+  if (!upstream_) {
+    fail(bytes, alignment);
+  }
+  // Not counted as in use here: the upstream resource counts it
+  count_fallback();
+  return upstream_->allocate(bytes, alignment);
+}
+
+void PoolResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+  if (!owns(p)) {
+    upstream_->deallocate(p, bytes, alignment);
+    return;
+  }
+  FreeBlock* block = static_cast<FreeBlock*>(p);
+  portENTER_CRITICAL(&lock_);
+  block->next = free_list_;
+  free_list_ = block;
+  free_count_++;
+  portEXIT_CRITICAL(&lock_);
+  count_deallocation(bytes);
+}
+
+HeapCapsResource* heap_resource_internal() {
+  static HeapCapsResource resource(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, "internal");
+  return &resource;
+}
+
+HeapCapsResource* heap_resource_psram() {
+#if CONFIG_SPIRAM
+  static HeapCapsResource resource(MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, "psram");
+  return &resource;
+#else
+  return heap_resource_internal();
+#endif
+}
@@ -0,0 +1,227 @@
+#ifndef PRODESP32_HEAP_RESOURCE_H
+#define PRODESP32_HEAP_RESOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory_resource>
+
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief Allocation statistics of one resource
+ */
+typedef struct {
+  size_t bytes_in_use;     ///< Bytes handed out and not yet returned (as requested, without overhead)
+  size_t peak_bytes;       ///< Highest bytes_in_use since creation or reset_peak()
+  size_t capacity;         ///< Bytes the resource can hand out, 0 if bounded only by the heap
+  uint32_t allocations;    ///< Successful allocations
+  uint32_t deallocations;  ///< Deallocations
+  uint32_t failures;       ///< Allocations the resource could not serve
+  uint32_t fallbacks;      ///< Allocations passed on to the upstream resource (PoolResource)
+} heap_resource_stats_t;
+
+/**
+ * @brief A std::pmr::memory_resource that counts what goes through it
+ *
+ * Base of the resources below. Pass one to a std::pmr container, SimpleCLI or McpServer:
+ *
+ * @code
+ * std::pmr::vector<sample_t> samples(heap_resource_psram());
+ * @endcode
+ *
+ * When a resource cannot serve an allocation it logs, counts a failure and throws
+ * std::bad_alloc as the standard requires. ESP-IDF builds without exceptions by default, where
+ * that aborts, as a failed `new` does.
+ */
+class HeapResource : public std::pmr::memory_resource {
+ public:
+  explicit HeapResource(const char* name) : name_(name) {}
+  HeapResource(const HeapResource&) = delete;
+  HeapResource& operator=(const HeapResource&) = delete;
+
+  const char* name() const { return name_; }
+
+  /**
+   * @brief Copy the statistics; counters are read one by one, not as a snapshot
+   */
+  void get_stats(heap_resource_stats_t* out) const;
+
+  /**
+   * @brief Restart peak_bytes from the current bytes_in_use
+   */
+  void reset_peak() { peak_bytes_.store(bytes_in_use_.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+  /**
+   * @brief Log the statistics at info level
+   */
+  void log_stats() const;
+
+ protected:
+  void count_allocation(size_t bytes);
+  void count_deallocation(size_t bytes);
+  void count_fallback() { fallbacks_.fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * @brief Count and log a failure, then throw std::bad_alloc (or abort without exceptions)
+   */
+  [[noreturn]] void fail(size_t bytes, size_t alignment);
+
+  size_t capacity_ = 0;
+
+ private:
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  const char* name_;
+  std::atomic<size_t> bytes_in_use_{0};
+  std::atomic<size_t> peak_bytes_{0};
+  std::atomic<uint32_t> allocations_{0};
+  std::atomic<uint32_t> deallocations_{0};
+  std::atomic<uint32_t> failures_{0};
+  std::atomic<uint32_t> fallbacks_{0};
+};
+
+/**
+ * @brief General-purpose resource over heap_caps_malloc() with fixed capabilities
+ *
+ * Thread-safe. Use heap_resource_internal() and heap_resource_psram() rather than creating one
+ * per user, so their statistics add up per memory type.
+ */
+class HeapCapsResource : public HeapResource {
+ public:
+  /**
+   * @param caps MALLOC_CAP_* flags every allocation must satisfy
+   * @param name Name for logs, kept by pointer
+   */
+  HeapCapsResource(uint32_t caps, const char* name) : HeapResource(name), caps_(caps) {}
+
+  uint32_t caps() const { return caps_; }
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+  uint32_t caps_;
+};
+
+/**
+ * @brief Monotonic arena: one block, bump-pointer allocation, freed all at once
+ *
+ * Allocation is a pointer increment, and deallocate() does nothing; release() hands the whole
+ * block back for reuse. Suited to work with a clear end (parsing one request, building one
+ * report) whose peak is known. There is no upstream: an arena that runs out fails, so its
+ * timing never depends on the heap. Not thread-safe.
+ *
+ * @code
+ * ArenaResource arena(4096, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, "report");
+ * std::pmr::string report(&arena);
+ * ...
+ * arena.release();
+ * @endcode
+ */
+class ArenaResource : public HeapResource {
+ public:
+  /**
+   * @brief Arena over a block allocated with heap_caps_malloc(); check valid()
+   */
+  ArenaResource(size_t capacity, uint32_t caps, const char* name);
+
+  /**
+   * @brief Arena over caller-provided memory (a static buffer, for instance), not freed by the arena
+   */
+  ArenaResource(void* buffer, size_t capacity, const char* name);
+
+  ~ArenaResource() override;
+
+  /**
+   * @brief False if the block could not be allocated
+   */
+  bool valid() const { return buffer_ != nullptr; }
+
+  /**
+   * @brief Forget every allocation; everything allocated from the arena becomes invalid
+   */
+  void release();
+
+  size_t used() const { return static_cast<size_t>(next_ - buffer_); }
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+  uint8_t* buffer_;
+  uint8_t* next_;
+  bool owned_;
+};
+
+/**
+ * @brief Pool of equal-sized blocks, allocated up front
+ *
+ * Allocation and deallocation pop and push a free list in a short critical section, so they
+ * take the same time whatever the heap looks like, and the pool never fragments. Suited to
+ * node-based containers (std::pmr::list, map, unordered_map), whose allocations share one size.
+ * Requests larger than a block, more aligned than a block, or made while the pool is empty go
+ * to the upstream resource if there is one, and fail otherwise. Thread-safe.
+ *
+ * @code
+ * PoolResource pool(48, 64, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, "sessions");
+ * std::pmr::map<int, session_t> sessions(&pool);
+ * @endcode
+ */
+class PoolResource : public HeapResource {
+ public:
+  /**
+   * @param block_size Bytes per block, rounded up to alignof(std::max_align_t)
+   * @param block_count Number of blocks
+   * @param caps MALLOC_CAP_* flags for the pool memory
+   * @param name Name for logs, kept by pointer
+   * @param upstream Resource for requests the pool cannot serve, NULL to fail them
+   */
+  PoolResource(size_t block_size, size_t block_count, uint32_t caps, const char* name,
+               std::pmr::memory_resource* upstream = nullptr);
+  ~PoolResource() override;
+
+  /**
+   * @brief False if the pool memory could not be allocated
+   */
+  bool valid() const { return blocks_ != nullptr; }
+
+  size_t block_size() const { return block_size_; }
+  size_t free_blocks() const { return free_count_; }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+  bool owns(const void* p) const { return p >= blocks_ && p < blocks_ + block_size_ * block_count_; }
+
+  uint8_t* blocks_;
+  size_t block_size_;
+  size_t block_count_;
+  FreeBlock* free_list_ = nullptr;
+  size_t free_count_ = 0;
+  std::pmr::memory_resource* upstream_;
+  portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+/**
+ * @brief Shared resource for internal, byte-addressable RAM
+ */
+HeapCapsResource* heap_resource_internal();
+
+/**
+ * @brief Shared resource for PSRAM
+ *
+ * Without CONFIG_SPIRAM this is heap_resource_internal(), so code can ask for PSRAM
+ * unconditionally and still run on boards without it.
+ */
+HeapCapsResource* heap_resource_psram();
+
+#endif  // PRODESP32_HEAP_RESOURCE_H
@@ -0,0 +1,66 @@
+#ifndef PRODESP32_JSON_KERNELS_H
+#define PRODESP32_JSON_KERNELS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Name of the implementation compiled in: "sse2", "neon" or "swar"
+ */
+const char* json_kernels_impl(void);
+
+/**
+ * @brief Length of the longest prefix of s that a JSON string can hold as is
+ *
+ * Stops at the first '"', '\\' or control character (below 0x20). Bytes from 0x80 up pass, so
+ * UTF-8 text is copied unchanged, as cJSON does.
+ *
+ * @param s Text, need not be NUL-terminated
+ * @param len Length of s in bytes
+ * @return Index of the first byte that needs escaping, len if none does
+ */
+size_t json_escape_scan(const char* s, size_t len);
+
+/**
+ * @brief Length of s once escaped, without the surrounding quotes
+ *
+ * @param s Text, need not be NUL-terminated
+ * @param len Length of s in bytes
+ * @return Bytes json_escape() writes for s
+ */
+size_t json_escaped_len(const char* s, size_t len);
+
+/**
+ * @brief Escape s for the inside of a JSON string, byte for byte as cJSON prints it
+ *
+ * '"' and '\\' get a backslash, \\b \\f \\n \\r \\t their short forms, other control
+ * characters \\u00xx. Does not NUL-terminate.
+ *
+ * @param dst Output, at least json_escaped_len(s, len) bytes
+ * @param s Text, need not be NUL-terminated
+ * @param len Length of s in bytes
+ * @return Bytes written to dst
+ */
+size_t json_escape(char* dst, const char* s, size_t len);
+
+/**
+ * @brief Whether s is well-formed UTF-8 (RFC 3629)
+ *
+ * Rejects overlong forms, surrogates (U+D800..U+DFFF), code points above U+10FFFF and
+ * truncated sequences. NUL bytes are valid.
+ *
+ * @param s Text, need not be NUL-terminated
+ * @param len Length of s in bytes
+ * @return true if all of s is valid
+ */
+bool json_utf8_valid(const char* s, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_JSON_KERNELS_H
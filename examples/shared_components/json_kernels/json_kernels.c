@@ -0,0 +1,267 @@
+#include "json_kernels.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// One block scanner per build: 16-byte vectors on the host, 32-bit words (SWAR) on the ESP32
+// targets and anywhere else. Every variant finishes the tail, and locates a hit inside a block,
+// with the same scalar code.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_KERNELS_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define JSON_KERNELS_NEON 1
+#else
+#define JSON_KERNELS_SWAR 1
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The SWAR kernels take the first byte in memory to be the lowest byte of a word"
+#endif
+#endif
+
+// Short escapes by control character; 0 where cJSON writes \u00xx
+static const char SHORT_ESCAPE[0x20] = {
+    ['\b'] = 'b', ['\t'] = 't', ['\n'] = 'n', ['\f'] = 'f', ['\r'] = 'r',
+};
+
+static inline bool needs_escape(unsigned char c) { return c < 0x20 || c == '"' || c == '\\'; }
+
+static size_t escape_scan_scalar(const unsigned char* p, size_t len) {
+  size_t i = 0;
+  while (i < len && !needs_escape(p[i])) {
+    i++;
+  }
+  return i;
+}
+
+static size_t ascii_run_scalar(const unsigned char* p, size_t len) {
+  size_t i = 0;
+  while (i < len && p[i] < 0x80) {
+    i++;
+  }
+  return i;
+}
+
+#if JSON_KERNELS_SSE2
+
+const char* json_kernels_impl(void) { return "sse2"; }
+
+size_t json_escape_scan(const char* s, size_t len) {
+  const unsigned char* p = (const unsigned char*)s;
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control_max = _mm_set1_epi8(0x1F);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+    // max(v, 0x1F) == 0x1F is the unsigned v <= 0x1F that SSE2 has no compare for
+    __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                               _mm_cmpeq_epi8(_mm_max_epu8(v, control_max), control_max));
+    int mask = _mm_movemask_epi8(hit);
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + escape_scan_scalar(p + i, len - i);
+}
+
+static size_t ascii_run(const unsigned char* p, size_t len) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(p + i)));
+    if (mask) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ascii_run_scalar(p + i, len - i);
+}
+
+#elif JSON_KERNELS_NEON
+
+const char* json_kernels_impl(void) { return "neon"; }
+
+size_t json_escape_scan(const char* s, size_t len) {
+  const unsigned char* p = (const unsigned char*)s;
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t space = vdupq_n_u8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8(p + i);
+    uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, space));
+    if (vmaxvq_u8(hit)) {
+      break;  // The scalar scan finds it within this block
+    }
+  }
+  return i + escape_scan_scalar(p + i, len - i);
+}
+
+static size_t ascii_run(const unsigned char* p, size_t len) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    if (vmaxvq_u8(vld1q_u8(p + i)) >= 0x80) {
+      break;
+    }
+  }
+  return i + ascii_run_scalar(p + i, len - i);
+}
+
+#else  // JSON_KERNELS_SWAR
+
+#define ONES 0x01010101u
+#define HIGHS 0x80808080u
+
+const char* json_kernels_impl(void) { return "swar"; }
+
+/**
+ * @brief High bit set in each byte of w that needs escaping
+ *
+ * (x - ONES) & ~x & HIGHS marks the zero bytes of x, and (w - 0x20 * ONES) & ~w & HIGHS the bytes
+ * below 0x20. A borrow can also mark bytes above a true hit, but never below one, so the lowest
+ * marked byte is always the first that needs escaping.
+ */
+static inline uint32_t escape_mask(uint32_t w) {
+  uint32_t quote = w ^ (ONES * '"');
+  uint32_t backslash = w ^ (ONES * '\\');
+  return (((quote - ONES) & ~quote) | ((backslash - ONES) & ~backslash) | ((w - ONES * 0x20) & ~w)) & HIGHS;
+}
+
+/**
+ * @brief Aligned 32-bit load; Xtensa has no unaligned loads, so the loops align first
+ */
+static inline uint32_t load_word(const unsigned char* p) {
+  uint32_t w;
+  memcpy(&w, __builtin_assume_aligned(p, 4), sizeof(w));
+  return w;
+}
+
+static inline size_t head_bytes(const unsigned char* p, size_t len) {
+  size_t head = (4 - ((uintptr_t)p & 3)) & 3;
+  return head < len ? head : len;
+}
+
+size_t json_escape_scan(const char* s, size_t len) {
+  const unsigned char* p = (const unsigned char*)s;
+  size_t i = head_bytes(p, len);
+  size_t head = escape_scan_scalar(p, i);
+  if (head < i) {
+    return head;
+  }
+  for (; i + 4 <= len; i += 4) {
+    uint32_t mask = escape_mask(load_word(p + i));
+    if (mask) {
+      return i + (__builtin_ctz(mask) >> 3);
+    }
+  }
+  return i + escape_scan_scalar(p + i, len - i);
+}
+
+static size_t ascii_run(const unsigned char* p, size_t len) {
+  size_t i = head_bytes(p, len);
+  size_t head = ascii_run_scalar(p, i);
+  if (head < i) {
+    return head;
+  }
+  for (; i + 4 <= len; i += 4) {
+    uint32_t mask = load_word(p + i) & HIGHS;
+    if (mask) {
+      return i + (__builtin_ctz(mask) >> 3);
+    }
+  }
+  return i + ascii_run_scalar(p + i, len - i);
+}
+
+#endif
+
+size_t json_escaped_len(const char* s, size_t len) {
+  size_t out = len;
+  size_t i = 0;
+  while ((i += json_escape_scan(s + i, len - i)) < len) {
+    unsigned char c = (unsigned char)s[i++];
+    out += (c >= 0x20 || SHORT_ESCAPE[c]) ? 1 : 5;
+  }
+  return out;
+}
+
+size_t json_escape(char* dst, const char* s, size_t len) {
+  static const char HEX[] = "0123456789abcdef";
+  char* out = dst;
+  size_t i = 0;
+  while (i < len) {
+    size_t run = json_escape_scan(s + i, len - i);
+    memcpy(out, s + i, run);
+    out += run;
+    i += run;
+    if (i == len) {
+      break;
+    }
+
+    unsigned char c = (unsigned char)s[i++];
+    *out++ = '\\';
+    if (c >= 0x20) {
+      *out++ = (char)c;
+    }
+    else if (SHORT_ESCAPE[c]) {
+      *out++ = SHORT_ESCAPE[c];
+    }
+    else {
+      memcpy(out, "u00", 3);
+      out[3] = HEX[c >> 4];
+      out[4] = HEX[c & 0xF];
+      out += 5;
+    }
+  }
+  return (size_t)(out - dst);
+}
+
+/**
+ * @brief Length of the valid multi-byte sequence at p, 0 if it is not one
+ *
+ * The second byte's range excludes overlong forms (E0, F0), surrogates (ED) and code points
+ * above U+10FFFF (F4), as in RFC 3629's table.
+ */
+static size_t utf8_sequence(const unsigned char* p, size_t len) {
+  unsigned char c = p[0];
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xBF;
+  size_t n;
+  if (c >= 0xC2 && c <= 0xDF) {
+    n = 2;
+  }
+  else if (c >= 0xE0 && c <= 0xEF) {
+    n = 3;
+    lo = c == 0xE0 ? 0xA0 : lo;
+    hi = c == 0xED ? 0x9F : hi;
+  }
+  else if (c >= 0xF0 && c <= 0xF4) {
+    n = 4;
+    lo = c == 0xF0 ? 0x90 : lo;
+    hi = c == 0xF4 ? 0x8F : hi;
+  }
+  else {
+    return 0;
+  }
+
+  if (len < n || p[1] < lo || p[1] > hi) {
+    return 0;
+  }
+  for (size_t k = 2; k < n; k++) {
+    if ((p[k] & 0xC0) != 0x80) {
+      return 0;
+    }
+  }
+  return n;
+}
+
+bool json_utf8_valid(const char* s, size_t len) {
+  const unsigned char* p = (const unsigned char*)s;
+  size_t i = 0;
+  while ((i += ascii_run(p + i, len - i)) < len) {
+    size_t n = utf8_sequence(p + i, len - i);
+    if (!n) {
+      return false;
+    }
+    i += n;
+  }
+  return true;
+}
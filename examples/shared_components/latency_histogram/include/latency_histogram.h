@@ -0,0 +1,417 @@
+#ifndef PRODESP32_LATENCY_HISTOGRAM_H
+#define PRODESP32_LATENCY_HISTOGRAM_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#define LATENCY_HISTOGRAM_CORES CONFIG_FREERTOS_NUMBER_OF_CORES
+#define LATENCY_HISTOGRAM_CORE_ID() ((uint32_t)esp_cpu_get_core_id())
+#else
+#define LATENCY_HISTOGRAM_CORES 1
+#define LATENCY_HISTOGRAM_CORE_ID() 0u
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LATENCY_HISTOGRAM_MAGIC0 'L'
+#define LATENCY_HISTOGRAM_MAGIC1 'H'
+#define LATENCY_HISTOGRAM_VERSION 1
+#define LATENCY_HISTOGRAM_HEADER_SIZE 5  ///< Magic, version, sub_bits, max_bits
+
+/**
+ * @brief Number of buckets for a precision, including the overflow bucket
+ *
+ * Values below 2^(sub_bits + 1) get one bucket each. Every further power of two is split into
+ * 2^sub_bits buckets, up to 2^max_bits. Values at or above 2^max_bits go to the overflow bucket.
+ */
+#define LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits) ((((max_bits) - (sub_bits) + 1) << (sub_bits)) + 1)
+
+/**
+ * @brief Worst-case size of a serialized histogram (every bucket non-empty)
+ */
+#define LATENCY_HISTOGRAM_SERIALIZED_MAX(sub_bits, max_bits) \
+  (LATENCY_HISTOGRAM_HEADER_SIZE + 10 * LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits))
+
+/**
+ * @brief Log-bucketed histogram of 32-bit values (usually microseconds)
+ *
+ * A recorded value is reported back with a relative error of at most 2^-sub_bits. Counts are
+ * kept in one slot per core (or a single slot), so recording is a relaxed atomic increment that
+ * never contends with the other core. Readers sum the slots.
+ *
+ * Define with LATENCY_HISTOGRAM_DEFINE() or initialize with latency_histogram_init(); from C++
+ * use the LatencyHistogram template below.
+ */
+typedef struct {
+  uint8_t sub_bits;       ///< Precision: 2^sub_bits buckets per power of two (1..10)
+  uint8_t max_bits;       ///< Values up to 2^max_bits - 1 are bucketed (sub_bits < max_bits <= 31)
+  uint8_t slot_mask;      ///< 0 for a single slot, LATENCY_HISTOGRAM_CORES - 1 for one slot per core
+  uint16_t bucket_count;  ///< LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits)
+  uint32_t* counts;       ///< (slot_mask + 1) * bucket_count counters
+} latency_histogram_t;
+
+/**
+ * @brief Define a file-scope static histogram with one slot per core
+ *
+ * @code
+ * LATENCY_HISTOGRAM_DEFINE(s_write_latency, 4, 24);  // 6.25% precision, up to 16.7 s in us
+ * @endcode
+ */
+#define LATENCY_HISTOGRAM_DEFINE(var, sub_bits, max_bits)                                               \
+  static uint32_t var##_counts[LATENCY_HISTOGRAM_CORES * LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits)]; \
+  static latency_histogram_t var = {(sub_bits), (max_bits), LATENCY_HISTOGRAM_CORES - 1,                  \
+                                    LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits), var##_counts}
+
+/**
+ * @brief Initialize a histogram over caller-provided counters
+ *
+ * @param hist Histogram to initialize
+ * @param sub_bits Precision (1..10)
+ * @param max_bits Largest bucketed value is 2^max_bits - 1 (sub_bits < max_bits <= 31)
+ * @param counts slots * LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits) counters; zeroed here
+ * @param slots 1 for a histogram written by a single task, LATENCY_HISTOGRAM_CORES for per-core slots
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unsupported precision or slot count
+ */
+static inline esp_err_t latency_histogram_init(latency_histogram_t* hist, uint8_t sub_bits, uint8_t max_bits,
+                                               uint32_t* counts, uint8_t slots) {
+  if (!hist || !counts || sub_bits < 1 || sub_bits > 10 || max_bits <= sub_bits || max_bits > 31 ||
+      (slots != 1 && slots != LATENCY_HISTOGRAM_CORES)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  hist->sub_bits = sub_bits;
+  hist->max_bits = max_bits;
+  hist->slot_mask = (uint8_t)(slots - 1);
+  hist->bucket_count = (uint16_t)LATENCY_HISTOGRAM_BUCKETS(sub_bits, max_bits);
+  hist->counts = counts;
+  memset(counts, 0, (size_t)slots * hist->bucket_count * sizeof(uint32_t));
+  return ESP_OK;
+}
+
+/**
+ * @brief Bucket index of a value
+ *
+ * Below 2^(sub_bits + 1) the index is the value itself; or-ing in 2^sub_bits makes that case
+ * fall out of the general formula without a branch.
+ */
+static inline uint32_t latency_histogram_bucket_index(const latency_histogram_t* hist, uint32_t value) {
+  if (value >> hist->max_bits) {
+    return hist->bucket_count - 1u;
+  }
+  uint32_t shift = (31u - (uint32_t)__builtin_clz(value | (1u << hist->sub_bits))) - hist->sub_bits;
+  return (shift << hist->sub_bits) + (value >> shift);
+}
+
+/**
+ * @brief Smallest value counted in a bucket
+ */
+static inline uint32_t latency_histogram_bucket_lower(const latency_histogram_t* hist, uint32_t index) {
+  uint32_t shift = index < (2u << hist->sub_bits) ? 0 : (index >> hist->sub_bits) - 1;
+  return (index - (shift << hist->sub_bits)) << shift;
+}
+
+/**
+ * @brief Largest value counted in a bucket (UINT32_MAX for the overflow bucket)
+ */
+static inline uint32_t latency_histogram_bucket_upper(const latency_histogram_t* hist, uint32_t index) {
+  if (index + 1u >= hist->bucket_count) {
+    return UINT32_MAX;
+  }
+  return latency_histogram_bucket_lower(hist, index + 1u) - 1u;
+}
+
+/**
+ * @brief Record a value
+ *
+ * Lock-free and safe from any task or ISR. With one slot per core this is the bucket
+ * computation plus one uncontended atomic increment.
+ *
+ * @param hist Histogram
+ * @param value Value, usually a duration in microseconds
+ */
+static inline void latency_histogram_record(latency_histogram_t* hist, uint32_t value) {
+  uint32_t* slot = hist->counts + (LATENCY_HISTOGRAM_CORE_ID() & hist->slot_mask) * hist->bucket_count;
+  __atomic_fetch_add(&slot[latency_histogram_bucket_index(hist, value)], 1u, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Count of one bucket summed over all slots
+ */
+static inline uint64_t latency_histogram_bucket_count(const latency_histogram_t* hist, uint32_t index) {
+  uint64_t count = 0;
+  for (uint32_t s = 0; s <= hist->slot_mask; s++) {
+    count += __atomic_load_n(&hist->counts[s * hist->bucket_count + index], __ATOMIC_RELAXED);
+  }
+  return count;
+}
+
+/**
+ * @brief Total number of recorded values
+ */
+static inline uint64_t latency_histogram_count(const latency_histogram_t* hist) {
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < hist->bucket_count; i++) {
+    total += latency_histogram_bucket_count(hist, i);
+  }
+  return total;
+}
+
+/**
+ * @brief Compute several quantiles in one pass
+ *
+ * Each result is the upper bound of the bucket holding that rank, so a quantile never
+ * under-reports. Ranks in the overflow bucket read as UINT32_MAX. An empty histogram gives 0.
+ * Values recorded concurrently may or may not be included.
+ *
+ * @param hist Histogram
+ * @param quantiles Quantiles in ascending order, each in [0, 1] (e.g. 0.5, 0.99, 0.999)
+ * @param out Receives one value per quantile
+ * @param n Number of quantiles
+ */
+static inline void latency_histogram_quantiles(const latency_histogram_t* hist, const float* quantiles, uint32_t* out,
+                                               size_t n) {
+  uint64_t total = latency_histogram_count(hist);
+  uint64_t seen = 0;
+  size_t q = 0;
+  for (uint32_t i = 0; i < hist->bucket_count && q < n && total > 0; i++) {
+    seen += latency_histogram_bucket_count(hist, i);
+    while (q < n) {
+      uint64_t rank = (uint64_t)ceil((double)quantiles[q] * (double)total);
+      if (seen < (rank ? rank : 1)) {
+        break;
+      }
+      out[q++] = latency_histogram_bucket_upper(hist, i);
+    }
+  }
+  // Counts still racing in from recorders can leave the last ranks unreached
+  for (; q < n; q++) {
+    out[q] = total ? UINT32_MAX : 0;
+  }
+}
+
+/**
+ * @brief Compute a single quantile (see latency_histogram_quantiles())
+ */
+static inline uint32_t latency_histogram_quantile(const latency_histogram_t* hist, float quantile) {
+  uint32_t value = 0;
+  latency_histogram_quantiles(hist, &quantile, &value, 1);
+  return value;
+}
+
+/**
+ * @brief Zero all counters
+ *
+ * Values recorded during the reset may be kept or dropped.
+ */
+static inline void latency_histogram_reset(latency_histogram_t* hist) {
+  uint32_t total = ((uint32_t)hist->slot_mask + 1u) * hist->bucket_count;
+  for (uint32_t i = 0; i < total; i++) {
+    __atomic_store_n(&hist->counts[i], 0u, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * @brief Add the counts of src into dst
+ *
+ * Both histograms must have the same precision. With drain set, src is emptied atomically
+ * bucket by bucket, so no value is counted twice or lost: a periodic drain of a live histogram
+ * into an interval histogram gives per-interval quantiles.
+ *
+ * @param dst Destination histogram
+ * @param src Source histogram
+ * @param drain Zero src while reading it
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the precisions differ
+ */
+static inline esp_err_t latency_histogram_merge(latency_histogram_t* dst, latency_histogram_t* src, bool drain) {
+  if (dst->sub_bits != src->sub_bits || dst->max_bits != src->max_bits) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  for (uint32_t s = 0; s <= src->slot_mask; s++) {
+    for (uint32_t i = 0; i < src->bucket_count; i++) {
+      uint32_t* counter = &src->counts[s * src->bucket_count + i];
+      uint32_t count = drain ? __atomic_exchange_n(counter, 0u, __ATOMIC_RELAXED)
+                             : __atomic_load_n(counter, __ATOMIC_RELAXED);
+      if (count) {
+        __atomic_fetch_add(&dst->counts[i], count, __ATOMIC_RELAXED);
+      }
+    }
+  }
+  return ESP_OK;
+}
+
+static inline size_t latency_histogram_put_varint(uint8_t* out, uint32_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static inline bool latency_histogram_get_varint(const uint8_t* data, size_t len, size_t* pos, uint32_t* value) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35 && *pos < len; shift += 7) {
+    uint8_t byte = data[(*pos)++];
+    result |= (uint32_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Serialize the histogram
+ *
+ * Format: 'L' 'H' version sub_bits max_bits, then for every non-empty bucket a varint count of
+ * the empty buckets skipped since the previous one and a varint count. A typical latency
+ * distribution occupies a few dozen buckets, so the encoding is tens of bytes. Slots are
+ * summed; counts above UINT32_MAX saturate.
+ *
+ * @param hist Histogram
+ * @param out Output buffer
+ * @param size Size of out (LATENCY_HISTOGRAM_SERIALIZED_MAX() always fits)
+ * @return Bytes written, or 0 if out is too small
+ */
+static inline size_t latency_histogram_serialize(const latency_histogram_t* hist, uint8_t* out, size_t size) {
+  if (size < LATENCY_HISTOGRAM_HEADER_SIZE) {
+    return 0;
+  }
+  out[0] = LATENCY_HISTOGRAM_MAGIC0;
+  out[1] = LATENCY_HISTOGRAM_MAGIC1;
+  out[2] = LATENCY_HISTOGRAM_VERSION;
+  out[3] = hist->sub_bits;
+  out[4] = hist->max_bits;
+
+  size_t len = LATENCY_HISTOGRAM_HEADER_SIZE;
+  uint32_t skipped = 0;
+  for (uint32_t i = 0; i < hist->bucket_count; i++) {
+    uint64_t count = latency_histogram_bucket_count(hist, i);
+    if (count == 0) {
+      skipped++;
+      continue;
+    }
+    if (size - len < 10) {
+      return 0;
+    }
+    len += latency_histogram_put_varint(out + len, skipped);
+    len += latency_histogram_put_varint(out + len, count > UINT32_MAX ? UINT32_MAX : (uint32_t)count);
+    skipped = 0;
+  }
+  return len;
+}
+
+/**
+ * @brief Add a serialized histogram into hist
+ *
+ * Use it to aggregate histograms from several devices or restore one saved to NVS.
+ *
+ * @param hist Destination histogram
+ * @param data Serialized histogram
+ * @param len Length of data
+ * @return ESP_OK on success, ESP_ERR_INVALID_VERSION for another format version,
+ *         ESP_ERR_INVALID_ARG if the precision differs, ESP_ERR_INVALID_SIZE for truncated data
+ */
+static inline esp_err_t latency_histogram_merge_serialized(latency_histogram_t* hist, const uint8_t* data,
+                                                           size_t len) {
+  if (len < LATENCY_HISTOGRAM_HEADER_SIZE || data[0] != LATENCY_HISTOGRAM_MAGIC0 ||
+      data[1] != LATENCY_HISTOGRAM_MAGIC1) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (data[2] != LATENCY_HISTOGRAM_VERSION) {
+    return ESP_ERR_INVALID_VERSION;
+  }
+  if (data[3] != hist->sub_bits || data[4] != hist->max_bits) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // Validate everything before adding anything, so bad input leaves hist unchanged
+  for (int apply = 0; apply < 2; apply++) {
+    size_t pos = LATENCY_HISTOGRAM_HEADER_SIZE;
+    uint32_t index = 0;
+    while (pos < len) {
+      uint32_t skipped, count;
+      if (!latency_histogram_get_varint(data, len, &pos, &skipped) ||
+          !latency_histogram_get_varint(data, len, &pos, &count) || skipped >= hist->bucket_count - index) {
+        return ESP_ERR_INVALID_SIZE;
+      }
+      index += skipped;
+      if (apply) {
+        __atomic_fetch_add(&hist->counts[index], count, __ATOMIC_RELAXED);
+      }
+      index++;
+    }
+  }
+  return ESP_OK;
+}
+
+#ifdef __cplusplus
+}
+
+/**
+ * @brief Histogram with compile-time precision that owns its counters
+ *
+ * @tparam SubBucketBits Precision: values are reported within 2^-SubBucketBits
+ * @tparam MaxValueBits Largest bucketed value is 2^MaxValueBits - 1
+ * @tparam PerCore One slot per core (any writer) or a single slot (one writing task)
+ *
+ * @code
+ * static LatencyHistogram<4, 24> s_tool_latency;  // 6.25% precision, up to 16.7 s in us
+ * s_tool_latency.record(elapsed_us);
+ * uint32_t p99 = s_tool_latency.quantile(0.99f);
+ * @endcode
+ */
+template <uint8_t SubBucketBits, uint8_t MaxValueBits = 24, bool PerCore = true>
+class LatencyHistogram {
+ public:
+  static_assert(SubBucketBits >= 1 && SubBucketBits <= 10, "SubBucketBits must be 1..10");
+  static_assert(MaxValueBits > SubBucketBits && MaxValueBits <= 31, "MaxValueBits must be SubBucketBits+1..31");
+
+  static constexpr size_t kBuckets = LATENCY_HISTOGRAM_BUCKETS(SubBucketBits, MaxValueBits);
+  static constexpr size_t kSlots = PerCore ? LATENCY_HISTOGRAM_CORES : 1;
+  static constexpr size_t kSerializedMax = LATENCY_HISTOGRAM_SERIALIZED_MAX(SubBucketBits, MaxValueBits);
+  static constexpr float kRelativeError = 1.0f / (1u << SubBucketBits);
+  static constexpr uint32_t kMaxValue = (1u << MaxValueBits) - 1;
+
+  LatencyHistogram() { latency_histogram_init(&hist_, SubBucketBits, MaxValueBits, counts_, kSlots); }
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void record(uint32_t value) { latency_histogram_record(&hist_, value); }
+  uint64_t count() const { return latency_histogram_count(&hist_); }
+  uint32_t quantile(float q) const { return latency_histogram_quantile(&hist_, q); }
+  void quantiles(const float* q, uint32_t* out, size_t n) const { latency_histogram_quantiles(&hist_, q, out, n); }
+  void reset() { latency_histogram_reset(&hist_); }
+
+  template <bool OtherPerCore>
+  void merge(LatencyHistogram<SubBucketBits, MaxValueBits, OtherPerCore>& src, bool drain = false) {
+    latency_histogram_merge(&hist_, src.handle(), drain);
+  }
+
+  size_t serialize(uint8_t* out, size_t size) const { return latency_histogram_serialize(&hist_, out, size); }
+  esp_err_t merge_serialized(const uint8_t* data, size_t len) {
+    return latency_histogram_merge_serialized(&hist_, data, len);
+  }
+
+  /** @brief The underlying C histogram, for APIs that take latency_histogram_t */
+  latency_histogram_t* handle() { return &hist_; }
+
+ private:
+  uint32_t counts_[kSlots * kBuckets] = {};
+  latency_histogram_t hist_;
+};
+
+#endif  // __cplusplus
+
+#endif  // PRODESP32_LATENCY_HISTOGRAM_H
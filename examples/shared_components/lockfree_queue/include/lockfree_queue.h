@@ -0,0 +1,436 @@
+#ifndef PRODESP32_LOCKFREE_QUEUE_H
+#define PRODESP32_LOCKFREE_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Alignment that keeps producer-written and consumer-written indices apart
+ *
+ * Internal SRAM on ESP32 chips is uncached, but PSRAM and host builds go through a data
+ * cache; separating the indices avoids the two cores (or CPUs) bouncing one line.
+ */
+#ifdef ESP_PLATFORM
+#define LFQ_CACHE_LINE 32
+#else
+#define LFQ_CACHE_LINE 64
+#endif
+#define LFQ_ALIGNED __attribute__((aligned(LFQ_CACHE_LINE)))
+
+/**
+ * @brief Single-producer single-consumer ring of fixed-size elements
+ *
+ * The producer owns head, the consumer owns tail; each side keeps a cached copy of the
+ * other's index and only reloads it (with acquire ordering) when the cache says the ring is
+ * full or empty. Publishing is a release store, so element contents written before commit are
+ * visible to the consumer on the other core before the new head is.
+ *
+ * Exactly one task (or ISR) may produce and one may consume at a time.
+ */
+typedef struct {
+  uint32_t head LFQ_ALIGNED;  ///< Next element to write (producer)
+  uint32_t tail_cache;        ///< Producer's last view of tail
+  uint32_t tail LFQ_ALIGNED;  ///< Next element to read (consumer)
+  uint32_t head_cache;        ///< Consumer's last view of head
+  uint32_t mask LFQ_ALIGNED;  ///< Capacity - 1
+  uint32_t elem_size;         ///< Element size in bytes
+  uint8_t* buffer;            ///< capacity * elem_size bytes
+} lfq_spsc_t;
+
+/**
+ * @brief Initialize an SPSC ring over caller-provided storage
+ *
+ * @param q Ring to initialize
+ * @param buffer capacity * elem_size bytes, suitably aligned for the element type
+ * @param elem_size Element size in bytes (1 for a byte ring)
+ * @param capacity Number of elements, a power of two >= 2
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad capacity or argument
+ */
+static inline esp_err_t lfq_spsc_init(lfq_spsc_t* q, void* buffer, uint32_t elem_size, uint32_t capacity) {
+  if (!q || !buffer || elem_size == 0 || capacity < 2 || capacity > (1u << 31) || (capacity & (capacity - 1))) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  memset(q, 0, sizeof(*q));
+  q->mask = capacity - 1;
+  q->elem_size = elem_size;
+  q->buffer = (uint8_t*)buffer;
+  return ESP_OK;
+}
+
+/**
+ * @brief Reserve contiguous free space (producer)
+ *
+ * Returns the run of free elements that starts at head and does not wrap. Write into it and
+ * publish with lfq_spsc_commit(); nothing is visible to the consumer until then.
+ *
+ * @param q Ring
+ * @param ptr Receives a pointer to the first free element
+ * @return Number of contiguous free elements (0 when full)
+ */
+static inline uint32_t lfq_spsc_reserve(lfq_spsc_t* q, void** ptr) {
+  uint32_t head = q->head;
+  uint32_t index = head & q->mask;
+  uint32_t contiguous = q->mask + 1 - index;
+  uint32_t free = q->mask + 1 - (head - q->tail_cache);
+  if (free < contiguous) {
+    // Acquire pairs with the consumer's release: its reads of these slots are done
+    q->tail_cache = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    free = q->mask + 1 - (head - q->tail_cache);
+  }
+  *ptr = q->buffer + (size_t)index * q->elem_size;
+  return free < contiguous ? free : contiguous;
+}
+
+/**
+ * @brief Publish elements written into reserved space (producer)
+ *
+ * @param q Ring
+ * @param count Elements to publish, at most the count returned by lfq_spsc_reserve()
+ */
+static inline void lfq_spsc_commit(lfq_spsc_t* q, uint32_t count) {
+  __atomic_store_n(&q->head, q->head + count, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Look at contiguous readable elements without removing them (consumer)
+ *
+ * @param q Ring
+ * @param ptr Receives a pointer to the oldest element
+ * @return Number of contiguous readable elements (0 when empty)
+ */
+static inline uint32_t lfq_spsc_peek(lfq_spsc_t* q, const void** ptr) {
+  uint32_t tail = q->tail;
+  uint32_t index = tail & q->mask;
+  uint32_t contiguous = q->mask + 1 - index;
+  uint32_t available = q->head_cache - tail;
+  if (available < contiguous) {
+    // Acquire pairs with the producer's release: the element contents are visible
+    q->head_cache = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    available = q->head_cache - tail;
+  }
+  *ptr = q->buffer + (size_t)index * q->elem_size;
+  return available < contiguous ? available : contiguous;
+}
+
+/**
+ * @brief Free elements returned by lfq_spsc_peek() (consumer)
+ *
+ * @param q Ring
+ * @param count Elements to free, at most the count returned by lfq_spsc_peek()
+ */
+static inline void lfq_spsc_release(lfq_spsc_t* q, uint32_t count) {
+  __atomic_store_n(&q->tail, q->tail + count, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Copy up to count elements in (producer)
+ *
+ * @return Elements written; fewer than count when the ring fills up
+ */
+static inline uint32_t lfq_spsc_push(lfq_spsc_t* q, const void* items, uint32_t count) {
+  const uint8_t* src = (const uint8_t*)items;
+  uint32_t written = 0;
+  // At most two runs: up to the end of the buffer, then from its start
+  for (int run = 0; run < 2 && written < count; run++) {
+    void* dst;
+    uint32_t n = lfq_spsc_reserve(q, &dst);
+    if (n == 0) {
+      break;
+    }
+    n = n < count - written ? n : count - written;
+    memcpy(dst, src + (size_t)written * q->elem_size, (size_t)n * q->elem_size);
+    lfq_spsc_commit(q, n);
+    written += n;
+  }
+  return written;
+}
+
+/**
+ * @brief Copy up to max elements out (consumer)
+ *
+ * @return Elements read; 0 when empty
+ */
+static inline uint32_t lfq_spsc_pop(lfq_spsc_t* q, void* out, uint32_t max) {
+  uint8_t* dst = (uint8_t*)out;
+  uint32_t read = 0;
+  for (int run = 0; run < 2 && read < max; run++) {
+    const void* src;
+    uint32_t n = lfq_spsc_peek(q, &src);
+    if (n == 0) {
+      break;
+    }
+    n = n < max - read ? n : max - read;
+    memcpy(dst + (size_t)read * q->elem_size, src, (size_t)n * q->elem_size);
+    lfq_spsc_release(q, n);
+    read += n;
+  }
+  return read;
+}
+
+/**
+ * @brief Number of elements in the ring (exact only on the producer or consumer side)
+ */
+static inline uint32_t lfq_spsc_count(const lfq_spsc_t* q) {
+  // Tail first: a later head is never behind it
+  uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+  return __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) - tail;
+}
+
+/**
+ * @brief Empty the ring; only while neither side is using it
+ */
+static inline void lfq_spsc_reset(lfq_spsc_t* q) {
+  q->head = q->tail = q->tail_cache = q->head_cache = 0;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Multi-producer single-consumer ring of fixed-size elements
+ *
+ * A bounded sequence-numbered ring (Vyukov): every slot carries a sequence number that says
+ * whether it is free for ticket t (seq == t) or holds ticket t's element (seq == t + 1).
+ * Producers claim a ticket with a compare-and-swap on head, write the slot and publish it with
+ * a release store of its sequence. Producers never wait on each other.
+ *
+ * The consumer reads in ticket order, so a producer that was preempted between reserve and
+ * commit holds back the elements behind it until it commits. Keep that window short, and never
+ * let the consumer spin on an empty queue: a spinning consumer at higher priority would starve
+ * the producer it waits for on the same core. Block on a task notification or semaphore instead.
+ *
+ * Producers may be tasks on either core or ISRs; exactly one task consumes.
+ */
+typedef struct {
+  uint32_t head LFQ_ALIGNED;  ///< Next ticket to hand out (producers)
+  uint32_t tail LFQ_ALIGNED;  ///< Next ticket to read (consumer)
+  uint32_t mask LFQ_ALIGNED;  ///< Capacity - 1
+  uint32_t elem_size;         ///< Element size in bytes
+  uint32_t* seq;              ///< Per-slot sequence numbers
+  uint8_t* data;              ///< capacity * elem_size bytes
+} lfq_mpsc_t;
+
+/**
+ * @brief Initialize an MPSC ring over caller-provided storage
+ *
+ * @param q Ring to initialize
+ * @param seq capacity sequence numbers
+ * @param data capacity * elem_size bytes, suitably aligned for the element type
+ * @param elem_size Element size in bytes
+ * @param capacity Number of elements, a power of two >= 2
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad capacity or argument
+ */
+static inline esp_err_t lfq_mpsc_init(lfq_mpsc_t* q, uint32_t* seq, void* data, uint32_t elem_size,
+                                      uint32_t capacity) {
+  if (!q || !seq || !data || elem_size == 0 || capacity < 2 || capacity > (1u << 30) ||
+      (capacity & (capacity - 1))) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  memset(q, 0, sizeof(*q));
+  q->mask = capacity - 1;
+  q->elem_size = elem_size;
+  q->seq = seq;
+  q->data = (uint8_t*)data;
+  for (uint32_t i = 0; i < capacity; i++) {
+    seq[i] = i;
+  }
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  return ESP_OK;
+}
+
+/**
+ * @brief Claim a slot (any producer)
+ *
+ * @param q Ring
+ * @param ticket Receives the ticket to pass to lfq_mpsc_commit()
+ * @return Pointer to the slot to write, or NULL when the ring is full
+ */
+static inline void* lfq_mpsc_reserve(lfq_mpsc_t* q, uint32_t* ticket) {
+  uint32_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+  for (;;) {
+    uint32_t index = pos & q->mask;
+    // Acquire pairs with the consumer's release: its read of the previous element is done
+    int32_t diff = (int32_t)(__atomic_load_n(&q->seq[index], __ATOMIC_ACQUIRE) - pos);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        *ticket = pos;
+        return q->data + (size_t)index * q->elem_size;
+      }
+      // pos was reloaded by the failed compare-and-swap
+    }
+    else if (diff < 0) {
+      return NULL;
+    }
+    else {
+      pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+/**
+ * @brief Publish a reserved slot (the producer that reserved it)
+ */
+static inline void lfq_mpsc_commit(lfq_mpsc_t* q, uint32_t ticket) {
+  __atomic_store_n(&q->seq[ticket & q->mask], ticket + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Look at the oldest element (consumer)
+ *
+ * @return Pointer to the element, or NULL if the queue is empty or its producer has not committed yet
+ */
+static inline const void* lfq_mpsc_peek(lfq_mpsc_t* q) {
+  uint32_t pos = q->tail;
+  uint32_t index = pos & q->mask;
+  if (__atomic_load_n(&q->seq[index], __ATOMIC_ACQUIRE) != pos + 1) {
+    return NULL;
+  }
+  return q->data + (size_t)index * q->elem_size;
+}
+
+/**
+ * @brief Free the element returned by lfq_mpsc_peek() (consumer)
+ */
+static inline void lfq_mpsc_release(lfq_mpsc_t* q) {
+  uint32_t pos = q->tail;
+  // The slot becomes free for the ticket one lap later
+  __atomic_store_n(&q->seq[pos & q->mask], pos + q->mask + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&q->tail, pos + 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Copy one element in (any producer)
+ *
+ * @return true if queued, false if the ring is full
+ */
+static inline bool lfq_mpsc_push(lfq_mpsc_t* q, const void* item) {
+  uint32_t ticket;
+  void* slot = lfq_mpsc_reserve(q, &ticket);
+  if (!slot) {
+    return false;
+  }
+  memcpy(slot, item, q->elem_size);
+  lfq_mpsc_commit(q, ticket);
+  return true;
+}
+
+/**
+ * @brief Copy one element out (consumer)
+ *
+ * @return true if an element was read, false if none is ready
+ */
+static inline bool lfq_mpsc_pop(lfq_mpsc_t* q, void* out) {
+  const void* slot = lfq_mpsc_peek(q);
+  if (!slot) {
+    return false;
+  }
+  memcpy(out, slot, q->elem_size);
+  lfq_mpsc_release(q);
+  return true;
+}
+
+/**
+ * @brief Approximate number of elements, including reserved but uncommitted ones
+ */
+static inline uint32_t lfq_mpsc_count(const lfq_mpsc_t* q) {
+  uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+  return __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) - tail;
+}
+
+#ifdef __cplusplus
+}
+
+#include <type_traits>
+
+/**
+ * @brief Typed SPSC ring with compile-time capacity that owns its storage
+ *
+ * @code
+ * static SpscQueue<sample_t, 256> s_samples;
+ * s_samples.try_push(sample);                  // producer
+ * sample_t s; while (s_samples.try_pop(s)) {}  // consumer
+ * @endcode
+ */
+template <typename T, uint32_t Capacity>
+class SpscQueue {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value, "elements are copied with memcpy");
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two >= 2");
+
+  SpscQueue() { lfq_spsc_init(&q_, storage_, sizeof(T), Capacity); }
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  bool try_push(const T& item) { return lfq_spsc_push(&q_, &item, 1) == 1; }
+  uint32_t push(const T* items, uint32_t count) { return lfq_spsc_push(&q_, items, count); }
+  bool try_pop(T& out) { return lfq_spsc_pop(&q_, &out, 1) == 1; }
+  uint32_t pop(T* out, uint32_t max) { return lfq_spsc_pop(&q_, out, max); }
+
+  /** @brief Contiguous free elements; write them and call commit() */
+  T* reserve(uint32_t* count) {
+    void* ptr;
+    *count = lfq_spsc_reserve(&q_, &ptr);
+    return static_cast<T*>(ptr);
+  }
+  void commit(uint32_t count) { lfq_spsc_commit(&q_, count); }
+
+  /** @brief Contiguous readable elements; read them and call release() */
+  const T* peek(uint32_t* count) {
+    const void* ptr;
+    *count = lfq_spsc_peek(&q_, &ptr);
+    return static_cast<const T*>(ptr);
+  }
+  void release(uint32_t count) { lfq_spsc_release(&q_, count); }
+
+  uint32_t size() const { return lfq_spsc_count(&q_); }
+  static constexpr uint32_t capacity() { return Capacity; }
+  lfq_spsc_t* handle() { return &q_; }
+
+ private:
+  alignas(T) uint8_t storage_[sizeof(T) * Capacity];
+  lfq_spsc_t q_;
+};
+
+/**
+ * @brief Typed MPSC ring with compile-time capacity that owns its storage
+ */
+template <typename T, uint32_t Capacity>
+class MpscQueue {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value, "elements are copied with memcpy");
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two >= 2");
+
+  MpscQueue() { lfq_mpsc_init(&q_, seq_, storage_, sizeof(T), Capacity); }
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  bool try_push(const T& item) { return lfq_mpsc_push(&q_, &item); }
+  bool try_pop(T& out) { return lfq_mpsc_pop(&q_, &out); }
+
+  /** @brief Claim a slot to construct an element in place; nullptr when full */
+  T* reserve(uint32_t* ticket) { return static_cast<T*>(lfq_mpsc_reserve(&q_, ticket)); }
+  void commit(uint32_t ticket) { lfq_mpsc_commit(&q_, ticket); }
+
+  /** @brief Oldest committed element, or nullptr; call release() when done with it */
+  const T* peek() { return static_cast<const T*>(lfq_mpsc_peek(&q_)); }
+  void release() { lfq_mpsc_release(&q_); }
+
+  uint32_t size() const { return lfq_mpsc_count(&q_); }
+  static constexpr uint32_t capacity() { return Capacity; }
+  lfq_mpsc_t* handle() { return &q_; }
+
+ private:
+  uint32_t seq_[Capacity];
+  alignas(T) uint8_t storage_[sizeof(T) * Capacity];
+  lfq_mpsc_t q_;
+};
+
+#endif  // __cplusplus
+
+#endif  // PRODESP32_LOCKFREE_QUEUE_H
@@ -10,6 +10,11 @@
 extern "C" {
 #endif
 
+/**
+ * @brief MCP protocol version advertised when the client does not request one
+ */
+#define MCP_PROTOCOL_VERSION "2024-11-05"
+
 /**
  * @brief MCP JSON-RPC request structure
  */
@@ -25,6 +30,8 @@ typedef struct {
 /**
  * @brief Parse JSON-RPC request
  *
+ * Fails for text that is not valid UTF-8, which cJSON would otherwise accept.
+ *
  * @param json_str JSON string
  * @param request Output request structure
  * @return ESP_OK on success
@@ -47,6 +54,18 @@ void mcp_protocol_free_request(mcp_request_t* request);
  */
 char* mcp_protocol_create_response(int id, cJSON* result);
 
+/**
+ * @brief Create the success response for a tool result with text content
+ *
+ * The same bytes as mcp_protocol_create_response() with mcp_tool_result_to_json() of a
+ * successful result, written in one allocation without building a cJSON tree.
+ *
+ * @param id Request ID
+ * @param text Result text (NULL for empty), escaped with json_kernels
+ * @return JSON string (must be freed by caller)
+ */
+char* mcp_protocol_create_text_response(int id, const char* text);
+
 /**
  * @brief Create a JSON-RPC error response
  *
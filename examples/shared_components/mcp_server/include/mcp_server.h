@@ -23,6 +23,18 @@ typedef struct mcp_server mcp_server_t;
  */
 mcp_server_t* mcp_server_create(mcp_transport_type_t transport_type);
 
+/**
+ * @brief Create an MCP server on a caller-provided transport
+ *
+ * For transports that are not in mcp_transport_type_t, such as an in-process loopback for
+ * benchmarks. The server takes ownership of the transport and destroys it in
+ * mcp_server_destroy(), or right away if creation fails.
+ *
+ * @param transport Transport instance with its vtable set
+ * @return Server instance or NULL on failure (must be destroyed with mcp_server_destroy)
+ */
+mcp_server_t* mcp_server_create_with_transport(mcp_transport_t* transport);
+
 /**
  * @brief Destroy the MCP server and free resources
  *
@@ -61,6 +73,24 @@ esp_err_t mcp_server_register_tool(mcp_server_t* server, const mcp_tool_definiti
  */
 esp_err_t mcp_server_register_tools(mcp_server_t* server, const mcp_tool_definition_t* tools[], size_t count);
 
+/**
+ * @brief Advertise the server over mDNS/DNS-SD when it starts
+ *
+ * Registers an `_mcp._tcp` service on start with TXT records carrying the protocol version
+ * (`proto`), the endpoint path (`path`), the number of tools (`tools`) and a digest of the
+ * tools/list result (`digest`). The same digest is returned in the `_meta.digest` field of
+ * every tools/list response, so clients can cache the list and skip tools/list whenever the
+ * advertised digest matches. The TXT record is refreshed when tools are registered later.
+ *
+ * Must be called before mcp_server_start.
+ *
+ * @param server Server instance
+ * @param hostname mDNS host name to set, or NULL to keep the one set by the application
+ * @param instance_name Service instance name (e.g. "ESP32 MCP Server")
+ * @return ESP_OK on success
+ */
+esp_err_t mcp_server_enable_mdns(mcp_server_t* server, const char* hostname, const char* instance_name);
+
 /**
  * @brief Start the MCP server
  *
@@ -0,0 +1,415 @@
+#ifndef MCP_SERVER_CPP_H
+#define MCP_SERVER_CPP_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "mcp_server.h"
+
+/**
+ * @brief Read-only view of a tool's arguments
+ *
+ * Strings are views into the request JSON and stay valid until the handler returns.
+ */
+class McpToolArgs {
+ public:
+  explicit McpToolArgs(const mcp_tool_args_t* args) : args_(args) {}
+
+  std::string_view get_string(const char* key, std::string_view default_value = {}) const {
+    const char* value = mcp_tool_args_get_string(args_, key, nullptr);
+    return value ? std::string_view(value) : default_value;
+  }
+  int get_int(const char* key, int default_value = 0) const { return mcp_tool_args_get_int(args_, key, default_value); }
+  double get_double(const char* key, double default_value = 0.0) const {
+    return mcp_tool_args_get_double(args_, key, default_value);
+  }
+  bool get_bool(const char* key, bool default_value = false) const {
+    return mcp_tool_args_get_bool(args_, key, default_value);
+  }
+
+  /**
+   * @brief Whether the argument is present (of any type)
+   */
+  bool has(const char* key) const { return args_->json && cJSON_GetObjectItemCaseSensitive(args_->json, key); }
+
+  /**
+   * @brief Raw arguments object, may be NULL
+   */
+  const cJSON* json() const { return args_->json; }
+
+ private:
+  const mcp_tool_args_t* args_;
+};
+
+/**
+ * @brief Owning, move-only tool result
+ *
+ * Frees its strings when it goes out of scope, so a handler cannot leak one on an early return.
+ *
+ * @code
+ * if (!ready) {
+ *   return McpToolResult::error("Not ready");
+ * }
+ * return McpToolResult::format("{\"temperature\": %.1f}", temperature);
+ * @endcode
+ */
+class McpToolResult {
+ public:
+  /**
+   * @brief Adopt a result from the C API
+   */
+  explicit McpToolResult(mcp_tool_result_t result) : result_(result) {}
+
+  static McpToolResult success(std::string_view content) {
+    return McpToolResult(mcp_tool_result_success_len(content.data(), content.size()));
+  }
+  static McpToolResult error(std::string_view message) {
+    return McpToolResult(mcp_tool_result_error_len(message.data(), message.size()));
+  }
+
+  /**
+   * @brief Success with printf-style content, formatted straight into the result's buffer
+   */
+  __attribute__((format(printf, 1, 2))) static McpToolResult format(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int length = vsnprintf(nullptr, 0, fmt, args);
+    va_end(args);
+    char* content = length >= 0 ? static_cast<char*>(malloc(length + 1)) : nullptr;
+    if (content) {
+      va_start(args, fmt);
+      vsnprintf(content, length + 1, fmt, args);
+      va_end(args);
+    }
+    return McpToolResult(mcp_tool_result_success_take(content));
+  }
+
+  McpToolResult(McpToolResult&& other) noexcept : result_(std::exchange(other.result_, mcp_tool_result_t{})) {}
+  McpToolResult& operator=(McpToolResult&& other) noexcept {
+    if (this != &other) {
+      mcp_tool_result_free(&result_);
+      result_ = std::exchange(other.result_, mcp_tool_result_t{});
+    }
+    return *this;
+  }
+  McpToolResult(const McpToolResult&) = delete;
+  McpToolResult& operator=(const McpToolResult&) = delete;
+  ~McpToolResult() { mcp_tool_result_free(&result_); }
+
+  bool ok() const { return result_.success; }
+  std::string_view content() const { return result_.content ? result_.content : ""; }
+  std::string_view error_message() const { return result_.error_message ? result_.error_message : ""; }
+
+  /**
+   * @brief Hand the result to the C API, which then frees it
+   */
+  mcp_tool_result_t release() { return std::exchange(result_, mcp_tool_result_t{}); }
+
+ private:
+  mcp_tool_result_t result_;
+};
+
+/**
+ * @brief Type-erased tool handler with small-buffer storage (internal to McpServer)
+ *
+ * Holds any callable taking `const McpToolArgs&` (or nothing) and returning McpToolResult or
+ * mcp_tool_result_t. Callables up to INLINE_SIZE bytes, such as lambdas capturing a few
+ * pointers or values, live inside the object; larger ones get one allocation from the
+ * memory resource passed to assign(), or from the heap if that is NULL.
+ */
+class McpToolFunction {
+ public:
+  static constexpr size_t INLINE_SIZE = 4 * sizeof(void*);
+
+  McpToolFunction() = default;
+  McpToolFunction(const McpToolFunction&) = delete;
+  McpToolFunction& operator=(const McpToolFunction&) = delete;
+  ~McpToolFunction() { reset(); }
+
+  /**
+   * @brief Allocate without throwing: from the resource if there is one, else from the heap
+   *
+   * @return The memory, or NULL on failure (a resource may instead abort when built without
+   *         exceptions)
+   */
+  static void* allocate(std::pmr::memory_resource* resource, size_t size, size_t alignment) {
+    if (!resource) {
+      return ::operator new(size, std::align_val_t(alignment), std::nothrow);
+    }
+#if __cpp_exceptions
+    try {
+      return resource->allocate(size, alignment);
+    } catch (const std::bad_alloc&) {
+      return nullptr;
+    }
+#else
+    return resource->allocate(size, alignment);
+#endif
+  }
+  static void deallocate(std::pmr::memory_resource* resource, void* p, size_t size, size_t alignment) {
+    if (!resource) {
+      ::operator delete(p, std::align_val_t(alignment));
+    }
+    else {
+      resource->deallocate(p, size, alignment);
+    }
+  }
+
+  /**
+   * @brief Store a callable
+   *
+   * @param fn Callable
+   * @param resource Memory resource for a callable too large to store inline, NULL for the heap
+   * @return false if a large callable could not be allocated
+   */
+  template <typename F>
+  bool assign(F&& fn, std::pmr::memory_resource* resource = nullptr) {
+    using Fn = std::decay_t<F>;
+    static_assert(std::is_invocable_v<Fn&, const McpToolArgs&> || std::is_invocable_v<Fn&>,
+                  "tool handlers take (const McpToolArgs&) or nothing");
+    reset();
+    if constexpr (fits_inline<Fn>()) {
+      new (storage_) Fn(std::forward<F>(fn));
+      ops_ = &INLINE_OPS<Fn>;
+    }
+    else {
+      void* memory = allocate(resource, sizeof(Fn), alignof(Fn));
+      if (!memory) {
+        return false;
+      }
+      *reinterpret_cast<Fn**>(storage_) = new (memory) Fn(std::forward<F>(fn));
+      resource_ = resource;
+      ops_ = &HEAP_OPS<Fn>;
+    }
+    return true;
+  }
+
+  mcp_tool_result_t operator()(const mcp_tool_args_t* args) { return ops_->invoke(storage_, args); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+ private:
+  struct Ops {
+    mcp_tool_result_t (*invoke)(void* storage, const mcp_tool_args_t* args);
+    void (*destroy)(void* storage, std::pmr::memory_resource* resource);
+  };
+
+  template <typename Fn>
+  static constexpr bool fits_inline() {
+    return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(void*) && std::is_nothrow_move_constructible_v<Fn>;
+  }
+
+  template <typename Fn>
+  static mcp_tool_result_t call(Fn& fn, const mcp_tool_args_t* args) {
+    if constexpr (std::is_invocable_v<Fn&, const McpToolArgs&>) {
+      return to_c(fn(McpToolArgs(args)));
+    }
+    else {
+      return to_c(fn());
+    }
+  }
+  static mcp_tool_result_t to_c(McpToolResult result) { return result.release(); }
+  static mcp_tool_result_t to_c(mcp_tool_result_t result) { return result; }
+
+  template <typename Fn>
+  static constexpr Ops INLINE_OPS = {
+      [](void* storage, const mcp_tool_args_t* args) { return call(*static_cast<Fn*>(storage), args); },
+      [](void* storage, std::pmr::memory_resource*) { static_cast<Fn*>(storage)->~Fn(); },
+  };
+  template <typename Fn>
+  static constexpr Ops HEAP_OPS = {
+      [](void* storage, const mcp_tool_args_t* args) { return call(**static_cast<Fn**>(storage), args); },
+      [](void* storage, std::pmr::memory_resource* resource) {
+        Fn* fn = *static_cast<Fn**>(storage);
+        fn->~Fn();
+        deallocate(resource, fn, sizeof(Fn), alignof(Fn));
+      },
+  };
+
+  void reset() {
+    if (ops_) {
+      ops_->destroy(storage_, resource_);
+      ops_ = nullptr;
+    }
+  }
+
+  alignas(void*) unsigned char storage_[INLINE_SIZE];
+  const Ops* ops_ = nullptr;
+  std::pmr::memory_resource* resource_ = nullptr;
+};
+
+/**
+ * @brief Owning, move-only MCP server
+ *
+ * Destroys the server (stopping it if running) when it goes out of scope. Tools can be plain
+ * C definitions or lambdas with captured state:
+ *
+ * @code
+ * McpServer server(MCP_TRANSPORT_HTTP);
+ * server.add_tool("set_gain", "Sets the amplifier gain", GAIN_PARAMS, [&stage](const McpToolArgs& args) {
+ *   stage.set_gain(args.get_double("gain"));
+ *   return McpToolResult::success("ok");
+ * });
+ * server.start(3000);
+ * @endcode
+ *
+ * Handlers run on the transport task, one at a time. The wrapper's own allocations (one small
+ * node per lambda tool, plus large captures) come from the memory resource given to the
+ * constructor; the C server underneath allocates from the heap as before.
+ */
+class McpServer {
+ public:
+  /**
+   * @param transport_type Transport
+   * @param resource Memory resource for tool handlers (such as one from heap_resource), NULL for
+   *                 the heap; must outlive the server
+   */
+  explicit McpServer(mcp_transport_type_t transport_type = MCP_TRANSPORT_HTTP,
+                     std::pmr::memory_resource* resource = nullptr)
+      : server_(mcp_server_create(transport_type)), resource_(resource) {}
+  /**
+   * @param transport Caller-created transport, owned by the server from here on
+   * @param resource Memory resource for tool handlers, NULL for the heap; must outlive the server
+   */
+  explicit McpServer(mcp_transport_t* transport, std::pmr::memory_resource* resource = nullptr)
+      : server_(mcp_server_create_with_transport(transport)), resource_(resource) {}
+  McpServer(McpServer&& other) noexcept
+      : server_(std::exchange(other.server_, nullptr)),
+        handlers_(std::exchange(other.handlers_, nullptr)),
+        resource_(other.resource_) {}
+  McpServer& operator=(McpServer&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      server_ = std::exchange(other.server_, nullptr);
+      handlers_ = std::exchange(other.handlers_, nullptr);
+      resource_ = other.resource_;
+    }
+    return *this;
+  }
+  McpServer(const McpServer&) = delete;
+  McpServer& operator=(const McpServer&) = delete;
+  ~McpServer() { destroy(); }
+
+  /**
+   * @brief False if the server could not be created
+   */
+  bool valid() const { return server_ != nullptr; }
+
+  /**
+   * @brief Register a tool whose handler is any callable
+   *
+   * @param name Tool name (copied)
+   * @param description Tool description (copied)
+   * @param handler Callable taking (const McpToolArgs&) or nothing, returning McpToolResult
+   * @param parameters Parameter schemas, kept by pointer (usually a static array), may be NULL
+   * @param parameter_count Number of parameters
+   * @return As mcp_server_register_tool(), or ESP_ERR_NO_MEM if the handler could not be stored
+   */
+  template <typename F>
+  esp_err_t add_tool(const char* name, const char* description, F&& handler,
+                     const mcp_param_schema_t* parameters = nullptr, size_t parameter_count = 0) {
+    if (!server_) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    Handler* node = new_handler();
+    if (!node) {
+      return ESP_ERR_NO_MEM;
+    }
+    if (!node->fn.assign(std::forward<F>(handler), resource_)) {
+      delete_handler(node);
+      return ESP_ERR_NO_MEM;
+    }
+    mcp_tool_definition_t tool = {};
+    tool.name = name;
+    tool.description = description;
+    tool.parameters = parameters;
+    tool.parameter_count = parameter_count;
+    tool.context_handler = invoke_handler;
+    tool.context = node;
+    esp_err_t ret = mcp_server_register_tool(server_, &tool);
+    if (ret != ESP_OK) {
+      delete_handler(node);
+      return ret;
+    }
+    node->next = handlers_;
+    handlers_ = node;
+    return ESP_OK;
+  }
+
+  /**
+   * @brief Register a tool with a parameter schema array, its size deduced
+   */
+  template <size_t N, typename F>
+  esp_err_t add_tool(const char* name, const char* description, const mcp_param_schema_t (&parameters)[N],
+                     F&& handler) {
+    return add_tool(name, description, std::forward<F>(handler), parameters, N);
+  }
+
+  esp_err_t register_tool(const mcp_tool_definition_t& tool) { return mcp_server_register_tool(server_, &tool); }
+
+  template <size_t N>
+  esp_err_t register_tools(const mcp_tool_definition_t* const (&tools)[N]) {
+    for (const mcp_tool_definition_t* tool : tools) {
+      esp_err_t ret = mcp_server_register_tool(server_, tool);
+      if (ret != ESP_OK) {
+        return ret;
+      }
+    }
+    return ESP_OK;
+  }
+
+  esp_err_t enable_mdns(const char* hostname, const char* instance_name) {
+    return mcp_server_enable_mdns(server_, hostname, instance_name);
+  }
+  esp_err_t start(uint16_t port) { return mcp_server_start(server_, port); }
+  esp_err_t stop() { return mcp_server_stop(server_); }
+  size_t tool_count() const { return mcp_server_get_tool_count(server_); }
+  bool has_tool(const char* name) const { return mcp_server_has_tool(server_, name); }
+
+  /**
+   * @brief The C handle, for APIs that take one; still owned by this object
+   */
+  mcp_server_t* get() const { return server_; }
+
+ private:
+  // Heap nodes, so their addresses (the C context) survive moves of the McpServer
+  struct Handler {
+    McpToolFunction fn;
+    Handler* next = nullptr;
+  };
+
+  Handler* new_handler() {
+    void* memory = McpToolFunction::allocate(resource_, sizeof(Handler), alignof(Handler));
+    return memory ? new (memory) Handler : nullptr;
+  }
+  void delete_handler(Handler* node) {
+    node->~Handler();
+    McpToolFunction::deallocate(resource_, node, sizeof(Handler), alignof(Handler));
+  }
+
+  static mcp_tool_result_t invoke_handler(const mcp_tool_args_t* args, void* context) {
+    return static_cast<Handler*>(context)->fn(args);
+  }
+
+  void destroy() {
+    // The server first: it stops the transport, after which no handler can be running
+    mcp_server_destroy(server_);
+    server_ = nullptr;
+    while (handlers_) {
+      delete_handler(std::exchange(handlers_, handlers_->next));
+    }
+  }
+
+  mcp_server_t* server_ = nullptr;
+  Handler* handlers_ = nullptr;
+  std::pmr::memory_resource* resource_ = nullptr;
+};
+
+#endif  // MCP_SERVER_CPP_H
@@ -17,6 +17,7 @@ extern "C" {
  */
 typedef struct {
   cJSON* json;  ///< Raw JSON arguments object
+  void* _call;  ///< Internal: the tools/call being handled, for mcp_tool_defer()
 } mcp_tool_args_t;
 
 /**
@@ -28,8 +29,14 @@ typedef struct {
   char* error_message;      ///< Error message if failed (owned by struct)
   bool _content_allocated;  ///< Internal: whether content was allocated
   bool _error_allocated;    ///< Internal: whether error was allocated
+  bool _deferred;           ///< Internal: sent later with mcp_tool_deferred_complete()
 } mcp_tool_result_t;
 
+/**
+ * @brief A tool call answered after its handler returned (see mcp_tool_defer())
+ */
+typedef struct mcp_tool_deferred mcp_tool_deferred_t;
+
 /**
  * @brief Tool handler function signature
  *
@@ -38,15 +45,29 @@ typedef struct {
  */
 typedef mcp_tool_result_t (*mcp_tool_handler_t)(const mcp_tool_args_t* args);
 
+/**
+ * @brief Tool handler that also receives the context given at registration
+ *
+ * Lets one handler serve several tools, or carry state without globals (the C++ wrapper in
+ * mcp_server_cpp.h uses it for lambdas).
+ *
+ * @param args Tool arguments
+ * @param context Context from the tool definition
+ * @return Tool result (caller must free with mcp_tool_result_free)
+ */
+typedef mcp_tool_result_t (*mcp_tool_context_handler_t)(const mcp_tool_args_t* args, void* context);
+
 /**
  * @brief Tool definition structure
  */
 typedef struct {
-  const char* name;                      ///< Tool name (must be unique)
-  const char* description;               ///< Human-readable description
-  mcp_tool_handler_t handler;            ///< Handler function
-  const mcp_param_schema_t* parameters;  ///< Array of parameter schemas (optional)
-  size_t parameter_count;                ///< Number of parameters
+  const char* name;                            ///< Tool name (must be unique)
+  const char* description;                     ///< Human-readable description
+  mcp_tool_handler_t handler;                  ///< Handler function
+  const mcp_param_schema_t* parameters;        ///< Array of parameter schemas (optional)
+  size_t parameter_count;                      ///< Number of parameters
+  mcp_tool_context_handler_t context_handler;  ///< Used instead of handler when handler is NULL
+  void* context;                               ///< Passed to context_handler
 } mcp_tool_definition_t;
 
 /**
@@ -97,6 +118,25 @@ double mcp_tool_args_get_double(const mcp_tool_args_t* args, const char* key, do
  */
 mcp_tool_result_t mcp_tool_result_success(const char* content);
 
+/**
+ * @brief Create a success result from a string that need not be NUL-terminated
+ *
+ * @param content Success content (length bytes are copied)
+ * @param length Content length
+ * @return Tool result (must be freed with mcp_tool_result_free)
+ */
+mcp_tool_result_t mcp_tool_result_success_len(const char* content, size_t length);
+
+/**
+ * @brief Create a success result that takes ownership of a heap-allocated string
+ *
+ * Avoids a copy for large results built directly into a malloc'd buffer.
+ *
+ * @param content Success content allocated with malloc (freed by mcp_tool_result_free)
+ * @return Tool result (must be freed with mcp_tool_result_free)
+ */
+mcp_tool_result_t mcp_tool_result_success_take(char* content);
+
 /**
  * @brief Create an error result
  *
@@ -105,6 +145,43 @@ mcp_tool_result_t mcp_tool_result_success(const char* content);
  */
 mcp_tool_result_t mcp_tool_result_error(const char* error_message);
 
+/**
+ * @brief Create an error result from a string that need not be NUL-terminated
+ *
+ * @param error_message Error message (length bytes are copied)
+ * @param length Message length
+ * @return Tool result (must be freed with mcp_tool_result_free)
+ */
+mcp_tool_result_t mcp_tool_result_error_len(const char* error_message, size_t length);
+
+/**
+ * @brief Detach the current call from the transport task, to answer it later from another task
+ *
+ * For handlers that wait on something. The handler returns mcp_tool_result_deferred() right
+ * away and the transport goes on serving other requests; the caller's connection stays open
+ * until mcp_tool_deferred_complete() sends the result. The arguments are freed when the handler
+ * returns, so copy what the completion needs. Complete every deferred call, and do so before the
+ * server is stopped.
+ *
+ * @param args The handler's arguments
+ * @return The deferred call, or NULL if this call cannot be deferred (a tools/pipeline step, or
+ *         a transport without support); the handler then returns its result as usual
+ */
+mcp_tool_deferred_t* mcp_tool_defer(const mcp_tool_args_t* args);
+
+/**
+ * @brief Result a handler returns after a successful mcp_tool_defer()
+ */
+mcp_tool_result_t mcp_tool_result_deferred(void);
+
+/**
+ * @brief Send the result of a deferred call; from any task
+ *
+ * @param deferred Call from mcp_tool_defer(), freed by this function
+ * @param result Result to send, freed by this function
+ */
+void mcp_tool_deferred_complete(mcp_tool_deferred_t* deferred, mcp_tool_result_t* result);
+
 /**
  * @brief Free resources allocated by a tool result
  *
@@ -65,6 +65,39 @@ typedef struct {
    * @param transport Transport instance
    */
   void (*destroy)(mcp_transport_t* transport);
+
+  /**
+   * @brief Port the started transport actually listens on (optional)
+   *
+   * It can differ from the port passed to init, for example when the transport shares a
+   * server that was already running on another port. Without it, the init port is used.
+   *
+   * @param transport Transport instance
+   * @return Listening port, or 0 if not running
+   */
+  uint16_t (*get_port)(mcp_transport_t* transport);
+
+  /**
+   * @brief Detach the request being handled, to answer it later (optional)
+   *
+   * Called from the request handler, on the transport task. The transport then sends nothing
+   * when the handler returns and goes on serving other requests; the client's connection stays
+   * open for send_deferred.
+   *
+   * @param transport Transport instance
+   * @return Handle for send_deferred, or NULL if the request cannot be detached
+   */
+  void* (*defer)(mcp_transport_t* transport);
+
+  /**
+   * @brief Answer a request detached with defer; from any task (required with defer)
+   *
+   * @param transport Transport instance
+   * @param handle Handle from defer, released by this call whatever the outcome
+   * @param response JSON-RPC response string, or NULL to fail the request
+   * @return ESP_OK on success
+   */
+  esp_err_t (*send_deferred)(mcp_transport_t* transport, void* handle, const char* response);
 } mcp_transport_vtable_t;
 
 /**
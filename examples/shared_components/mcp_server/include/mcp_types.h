@@ -13,7 +13,8 @@ extern "C" {
 typedef enum {
   MCP_TRANSPORT_HTTP = 0,  ///< HTTP/HTTPS transport
   MCP_TRANSPORT_UART,      ///< UART/Serial transport (future)
-  MCP_TRANSPORT_WEBSOCKET  ///< WebSocket transport (future)
+  MCP_TRANSPORT_WEBSOCKET,  ///< WebSocket transport (future)
+  MCP_TRANSPORT_HTTP_LWIP,  ///< Lightweight HTTP/1.1 transport on raw lwIP sockets
 } mcp_transport_type_t;
 
 /**
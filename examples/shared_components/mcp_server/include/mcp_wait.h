@@ -0,0 +1,54 @@
+#ifndef MCP_WAIT_H
+#define MCP_WAIT_H
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "mcp_tool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sampler for a waitable value
+ *
+ * @param out Where to store the current value
+ * @param context Context passed at registration
+ * @return true if a value was read
+ */
+typedef bool (*mcp_value_sampler_t)(double* out, void* context);
+
+/**
+ * @brief Register a value that the wait_for tool can watch
+ *
+ * @param name Value name used in the tool's "value" argument (e.g. "temperature")
+ * @param sampler Function returning the current value; called from the transport task for the
+ *                first sample and from the timer wheel task after that, so it must not block
+ * @param context User context passed to the sampler
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the registry is full
+ */
+esp_err_t mcp_wait_register_value(const char* name, mcp_value_sampler_t sampler, void* context);
+
+/**
+ * @brief Declarative definition of the built-in wait_for tool
+ *
+ * Register it like any other tool:
+ *
+ * @code
+ * mcp_server_register_tool(server, &MCP_WAIT_FOR_TOOL);
+ * @endcode
+ *
+ * The tool samples a registered value until a comparison against a threshold holds or the
+ * timeout expires, so a client parks one request instead of polling in a loop. The call is
+ * deferred (mcp_tool_defer()) and sampled by a timer_wheel timer, so the transport task keeps
+ * serving other requests; timer_wheel_start() must have been called. Timeouts are capped at
+ * CONFIG_MCP_WAIT_MAX_TIMEOUT_MS; clients call again to wait longer.
+ */
+extern const mcp_tool_definition_t MCP_WAIT_FOR_TOOL;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MCP_WAIT_H
@@ -1,9 +1,11 @@
 #include "mcp_protocol.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "esp_log.h"
+#include "json_kernels.h"
 
 static const char* TAG = "mcp_protocol";
 
@@ -14,6 +16,13 @@ esp_err_t mcp_protocol_parse_request(const char* json_str, mcp_request_t* reques
 
   memset(request, 0, sizeof(mcp_request_t));
 
+  // cJSON copies string bytes as they come, so invalid UTF-8 would reach the tools and be
+  // echoed into responses that clients then fail to decode
+  if (!json_utf8_valid(json_str, strlen(json_str))) {
+    ESP_LOGE(TAG, "Request is not valid UTF-8");
+    return ESP_FAIL;
+  }
+
   cJSON* root = cJSON_Parse(json_str);
   if (!root) {
     ESP_LOGE(TAG, "Failed to parse JSON request");
@@ -107,6 +116,35 @@ char* mcp_protocol_create_response(int id, cJSON* result) {
   return response_str;
 }
 
+char* mcp_protocol_create_text_response(int id, const char* text) {
+  static const char PREFIX[] = "{\"jsonrpc\":\"2.0\",\"id\":";
+  static const char MIDDLE[] = ",\"result\":{\"content\":[{\"type\":\"text\",\"text\":\"";
+  static const char SUFFIX[] = "\"}]}}";
+
+  text = text ? text : "";
+  size_t text_len = strlen(text);
+  char id_str[12];
+  size_t id_len = (size_t)snprintf(id_str, sizeof(id_str), "%d", id);
+  size_t len = sizeof(PREFIX) - 1 + id_len + sizeof(MIDDLE) - 1 + json_escaped_len(text, text_len) + sizeof(SUFFIX) - 1;
+
+  char* response = malloc(len + 1);
+  if (!response) {
+    ESP_LOGE(TAG, "Failed to allocate response");
+    return NULL;
+  }
+
+  char* out = response;
+  memcpy(out, PREFIX, sizeof(PREFIX) - 1);
+  out += sizeof(PREFIX) - 1;
+  memcpy(out, id_str, id_len);
+  out += id_len;
+  memcpy(out, MIDDLE, sizeof(MIDDLE) - 1);
+  out += sizeof(MIDDLE) - 1;
+  out += json_escape(out, text, text_len);
+  memcpy(out, SUFFIX, sizeof(SUFFIX));  // Including the NUL
+  return response;
+}
+
 char* mcp_protocol_create_error(int id, int code, const char* message) {
   cJSON* root = cJSON_CreateObject();
   if (!root) {
@@ -1,16 +1,25 @@
 #include "mcp_server.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "mdns.h"
+#include "metrics.h"
 #include "mcp_protocol.h"
 #include "mcp_schema.h"
 #include "mcp_transport_http.h"
+#include "mcp_transport_socket.h"
+#include "pm_activity.h"
 
 static const char* TAG = "mcp_server";
 
 #define MAX_TOOLS 32
+#define MAX_PIPELINE_STEPS 16
+#define MDNS_SERVICE_TYPE "_mcp"
+#define MDNS_SERVICE_PROTO "_tcp"
 
 /**
  * @brief Tool registry entry (internal)
@@ -19,8 +28,10 @@ typedef struct {
   char* name;
   char* description;
   mcp_tool_handler_t handler;
-  const mcp_param_schema_t* parameters;  // Pointer to parameter schema array
-  size_t parameter_count;                // Number of parameters
+  mcp_tool_context_handler_t context_handler;  // Used when handler is NULL
+  void* context;
+  const mcp_param_schema_t* parameters;        // Pointer to parameter schema array
+  size_t parameter_count;                      // Number of parameters
 } tool_entry_t;
 
 /**
@@ -34,45 +45,102 @@ struct mcp_server {
   bool is_initialized;     // Track initialization state
   char* protocol_version;  // Client protocol version
   char* client_name;       // Client name for logging
+  uint16_t port;           // Port the transport listens on, advertised over mDNS
+
+  // mDNS advertisement
+  bool mdns_enabled;
+  bool mdns_registered;
+  char* mdns_hostname;
+  char* mdns_instance_name;
+  char tools_digest[17];  // Hex FNV-1a 64 of the tools/list result, "" when stale
 };
 
+/**
+ * @brief The tools/call being handled, behind mcp_tool_args_t._call (internal)
+ */
+typedef struct {
+  mcp_server_t* server;
+  int request_id;
+  int64_t start_us;
+  mcp_tool_deferred_t* deferred;  // Set by mcp_tool_defer()
+} tool_call_t;
+
+/**
+ * @brief A tool call answered after its handler returned
+ */
+struct mcp_tool_deferred {
+  mcp_server_t* server;
+  int request_id;
+  int64_t start_us;
+  void* handle;  // From the transport's defer
+};
+
+// Scrape metrics, shared by all server instances
+static const float TOOL_DURATION_BOUNDS[] = {0.001f, 0.005f, 0.01f, 0.05f, 0.1f, 0.5f, 1.0f, 5.0f, 30.0f};
+static METRICS_COUNTER_DEFINE(s_requests_metric, "mcp_requests_total", "JSON-RPC requests handled");
+static METRICS_COUNTER_DEFINE(s_tool_calls_metric, "mcp_tool_calls_total", "Tool calls executed");
+static METRICS_COUNTER_DEFINE(s_tool_errors_metric, "mcp_tool_errors_total", "Tool calls that returned an error");
+static METRICS_HISTOGRAM_DEFINE(s_tool_duration_metric, "mcp_tool_duration_seconds", "Tool handler execution time",
+                                TOOL_DURATION_BOUNDS);
+
 // Forward declarations
 static void handle_request(const char* request, void* context);
 static void handle_initialize(mcp_server_t* server, cJSON* params, int request_id);
 static void handle_initialized(mcp_server_t* server);
 static void handle_list_tools(mcp_server_t* server, int request_id);
 static void handle_call_tool(mcp_server_t* server, const char* tool_name, cJSON* args, int request_id);
+static void handle_pipeline(mcp_server_t* server, cJSON* params, int request_id);
 static tool_entry_t* find_tool(mcp_server_t* server, const char* name);
+static cJSON* build_tools_array(mcp_server_t* server);
+static const char* get_tools_digest(mcp_server_t* server);
+static esp_err_t mdns_advertise(mcp_server_t* server);
+static void mdns_update_tools(mcp_server_t* server);
+static mcp_tool_result_t run_tool(const tool_entry_t* tool, const mcp_tool_args_t* args);
 
 mcp_server_t* mcp_server_create(mcp_transport_type_t transport_type) {
-  mcp_server_t* server = calloc(1, sizeof(mcp_server_t));
-  if (!server) {
-    ESP_LOGE(TAG, "Failed to allocate server");
-    return NULL;
-  }
+  mcp_transport_t* transport = NULL;
 
   // Create transport based on type
   switch (transport_type) {
     case MCP_TRANSPORT_HTTP:
-      server->transport = mcp_transport_http_create();
+      transport = mcp_transport_http_create();
+      break;
+    case MCP_TRANSPORT_HTTP_LWIP:
+      transport = mcp_transport_socket_create();
       break;
     case MCP_TRANSPORT_UART:
     case MCP_TRANSPORT_WEBSOCKET:
       ESP_LOGE(TAG, "Transport type not yet implemented");
-      free(server);
       return NULL;
     default:
       ESP_LOGE(TAG, "Unknown transport type");
-      free(server);
       return NULL;
   }
 
-  if (!server->transport) {
+  if (!transport) {
     ESP_LOGE(TAG, "Failed to create transport");
-    free(server);
     return NULL;
   }
 
+  return mcp_server_create_with_transport(transport);
+}
+
+mcp_server_t* mcp_server_create_with_transport(mcp_transport_t* transport) {
+  if (!transport || !transport->vtable) {
+    ESP_LOGE(TAG, "Invalid transport");
+    return NULL;
+  }
+
+  mcp_server_t* server = calloc(1, sizeof(mcp_server_t));
+  if (!server) {
+    ESP_LOGE(TAG, "Failed to allocate server");
+    if (transport->vtable->destroy) {
+      transport->vtable->destroy(transport);
+    }
+    return NULL;
+  }
+  server->transport = transport;
+
   // Set request handler
   mcp_transport_set_request_handler(server->transport, handle_request, server);
 
@@ -81,6 +149,12 @@ mcp_server_t* mcp_server_create(mcp_transport_type_t transport_type) {
   server->protocol_version = NULL;
   server->client_name = NULL;
 
+  // Already registered by an earlier server instance is fine
+  metrics_register(&s_requests_metric.base);
+  metrics_register(&s_tool_calls_metric.base);
+  metrics_register(&s_tool_errors_metric.base);
+  metrics_register(&s_tool_duration_metric.base);
+
   ESP_LOGI(TAG, "MCP server created");
   return server;
 }
@@ -112,6 +186,8 @@ void mcp_server_destroy(mcp_server_t* server) {
   if (server->client_name) {
     free(server->client_name);
   }
+  free(server->mdns_hostname);
+  free(server->mdns_instance_name);
 
   // Destroy transport
   if (server->transport && server->transport->vtable && server->transport->vtable->destroy) {
@@ -134,7 +210,7 @@ esp_err_t mcp_server_add_tool(mcp_server_t* server, const char* name, const char
 }
 
 esp_err_t mcp_server_register_tool(mcp_server_t* server, const mcp_tool_definition_t* tool) {
-  if (!server || !tool || !tool->name || !tool->handler) {
+  if (!server || !tool || !tool->name || (!tool->handler && !tool->context_handler)) {
     return ESP_ERR_INVALID_ARG;
   }
 
@@ -155,6 +231,8 @@ esp_err_t mcp_server_register_tool(mcp_server_t* server, const mcp_tool_definiti
   entry->name = strdup(tool->name);
   entry->description = tool->description ? strdup(tool->description) : NULL;
   entry->handler = tool->handler;
+  entry->context_handler = tool->context_handler;
+  entry->context = tool->context;
   entry->parameters = tool->parameters;  // Store pointer to parameter schema
   entry->parameter_count = tool->parameter_count;
 
@@ -166,6 +244,12 @@ esp_err_t mcp_server_register_tool(mcp_server_t* server, const mcp_tool_definiti
   server->tool_count++;
   ESP_LOGI(TAG, "Registered tool: %s", tool->name);
 
+  // Tool list changed, so the advertised digest must be recomputed
+  server->tools_digest[0] = '\0';
+  if (server->mdns_registered) {
+    mdns_update_tools(server);
+  }
+
   return ESP_OK;
 }
 
@@ -185,6 +269,29 @@ esp_err_t mcp_server_register_tools(mcp_server_t* server, const mcp_tool_definit
   return ESP_OK;
 }
 
+esp_err_t mcp_server_enable_mdns(mcp_server_t* server, const char* hostname, const char* instance_name) {
+  if (!server || !instance_name) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (server->is_running) {
+    ESP_LOGE(TAG, "mDNS must be enabled before the server starts");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  free(server->mdns_hostname);
+  free(server->mdns_instance_name);
+  server->mdns_hostname = hostname ? strdup(hostname) : NULL;
+  server->mdns_instance_name = strdup(instance_name);
+  if (!server->mdns_instance_name || (hostname && !server->mdns_hostname)) {
+    ESP_LOGE(TAG, "Failed to allocate mDNS names");
+    return ESP_ERR_NO_MEM;
+  }
+
+  server->mdns_enabled = true;
+  return ESP_OK;
+}
+
 esp_err_t mcp_server_start(mcp_server_t* server, uint16_t port) {
   if (!server) {
     return ESP_ERR_INVALID_ARG;
@@ -210,8 +317,15 @@ esp_err_t mcp_server_start(mcp_server_t* server, uint16_t port) {
   }
 
   server->is_running = true;
+  // The HTTP transport joins shared_httpd, which may already be listening on another port
+  server->port = server->transport->vtable->get_port ? server->transport->vtable->get_port(server->transport) : port;
   ESP_LOGI(TAG, "MCP server started with %zu tools", server->tool_count);
 
+  if (server->mdns_enabled && mdns_advertise(server) != ESP_OK) {
+    // Discovery is optional; the server keeps running without it
+    ESP_LOGW(TAG, "Failed to advertise MCP server over mDNS");
+  }
+
   return ESP_OK;
 }
 
@@ -225,6 +339,11 @@ esp_err_t mcp_server_stop(mcp_server_t* server) {
     return ESP_OK;
   }
 
+  if (server->mdns_registered) {
+    mdns_service_remove(MDNS_SERVICE_TYPE, MDNS_SERVICE_PROTO);
+    server->mdns_registered = false;
+  }
+
   esp_err_t ret = server->transport->vtable->stop(server->transport);
   server->is_running = false;
 
@@ -289,7 +408,7 @@ static void handle_initialize(mcp_server_t* server, cJSON* params, int request_i
 
   // Protocol version
   cJSON_AddStringToObject(result, "protocolVersion",
-                          server->protocol_version ? server->protocol_version : "2024-11-05");
+                          server->protocol_version ? server->protocol_version : MCP_PROTOCOL_VERSION);
 
   // Send response
   char* response = mcp_protocol_create_response(request_id, result);
@@ -327,6 +446,7 @@ static void handle_request(const char* request, void* context) {
   }
 
   ESP_LOGD(TAG, "Handling request: %s", request);
+  metrics_counter_inc(&s_requests_metric);
 
   // Parse request
   mcp_request_t req;
@@ -356,6 +476,9 @@ static void handle_request(const char* request, void* context) {
   else if (strcmp(req.method, "tools/list") == 0) {
     handle_list_tools(server, req.id);
   }
+  else if (strcmp(req.method, "tools/pipeline") == 0) {
+    handle_pipeline(server, req.params, req.id);
+  }
   else if (strcmp(req.method, "tools/call") == 0) {
     // Extract tool name and arguments
     const char* tool_name = NULL;
@@ -393,16 +516,10 @@ static void handle_request(const char* request, void* context) {
   mcp_protocol_free_request(&req);
 }
 
-static void handle_list_tools(mcp_server_t* server, int request_id) {
-  // Create tools array
+static cJSON* build_tools_array(mcp_server_t* server) {
   cJSON* tools_array = cJSON_CreateArray();
   if (!tools_array) {
-    char* error_resp = mcp_protocol_create_error(request_id, -32603, "Internal error");
-    if (error_resp) {
-      server->transport->vtable->send_response(server->transport, error_resp);
-      free(error_resp);
-    }
-    return;
+    return NULL;
   }
 
   for (size_t i = 0; i < server->tool_count; i++) {
@@ -434,10 +551,105 @@ static void handle_list_tools(mcp_server_t* server, int request_id) {
     }
   }
 
+  return tools_array;
+}
+
+/**
+ * @brief Digest of the tools/list result, computed lazily and cached until the tool list changes
+ *
+ * FNV-1a 64 over the unformatted tools array. It only has to detect changes to the list,
+ * not resist tampering, and it fits in a single 16 character TXT value.
+ */
+static const char* get_tools_digest(mcp_server_t* server) {
+  if (server->tools_digest[0] != '\0') {
+    return server->tools_digest;
+  }
+
+  cJSON* tools_array = build_tools_array(server);
+  char* serialized = tools_array ? cJSON_PrintUnformatted(tools_array) : NULL;
+  cJSON_Delete(tools_array);
+  if (!serialized) {
+    return NULL;
+  }
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char* p = serialized; *p; p++) {
+    hash ^= (uint8_t)*p;
+    hash *= 0x100000001b3ULL;
+  }
+  free(serialized);
+
+  snprintf(server->tools_digest, sizeof(server->tools_digest), "%016llx", (unsigned long long)hash);
+  return server->tools_digest;
+}
+
+static esp_err_t mdns_advertise(mcp_server_t* server) {
+  esp_err_t ret = mdns_init();
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to initialize mDNS: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  if (server->mdns_hostname) {
+    mdns_hostname_set(server->mdns_hostname);
+  }
+
+  const char* digest = get_tools_digest(server);
+  char tool_count[8];
+  snprintf(tool_count, sizeof(tool_count), "%u", (unsigned)server->tool_count);
+
+  mdns_txt_item_t txt[] = {
+      {"proto", MCP_PROTOCOL_VERSION},
+      {"path", "/"},
+      {"tools", tool_count},
+      {"digest", digest ? digest : ""},
+  };
+
+  ret = mdns_service_add(server->mdns_instance_name, MDNS_SERVICE_TYPE, MDNS_SERVICE_PROTO, server->port, txt,
+                         sizeof(txt) / sizeof(txt[0]));
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to add mDNS service: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  server->mdns_registered = true;
+  ESP_LOGI(TAG, "Advertising %s.%s on port %u (digest %s)", MDNS_SERVICE_TYPE, MDNS_SERVICE_PROTO, server->port,
+           digest ? digest : "-");
+  return ESP_OK;
+}
+
+static void mdns_update_tools(mcp_server_t* server) {
+  const char* digest = get_tools_digest(server);
+  char tool_count[8];
+  snprintf(tool_count, sizeof(tool_count), "%u", (unsigned)server->tool_count);
+
+  mdns_service_txt_item_set(MDNS_SERVICE_TYPE, MDNS_SERVICE_PROTO, "tools", tool_count);
+  mdns_service_txt_item_set(MDNS_SERVICE_TYPE, MDNS_SERVICE_PROTO, "digest", digest ? digest : "");
+}
+
+static void handle_list_tools(mcp_server_t* server, int request_id) {
+  // Create tools array
+  cJSON* tools_array = build_tools_array(server);
+  if (!tools_array) {
+    char* error_resp = mcp_protocol_create_error(request_id, -32603, "Internal error");
+    if (error_resp) {
+      server->transport->vtable->send_response(server->transport, error_resp);
+      free(error_resp);
+    }
+    return;
+  }
+
   // Create result object
   cJSON* result = cJSON_CreateObject();
   cJSON_AddItemToObject(result, "tools", tools_array);
 
+  // Same digest as advertised over mDNS so clients can cache the list
+  const char* digest = get_tools_digest(server);
+  if (digest) {
+    cJSON* meta = cJSON_AddObjectToObject(result, "_meta");
+    cJSON_AddStringToObject(meta, "digest", digest);
+  }
+
   // Create response
   char* response = mcp_protocol_create_response(request_id, result);
   if (response) {
@@ -446,6 +658,93 @@ static void handle_list_tools(mcp_server_t* server, int request_id) {
   }
 }
 
+/**
+ * @brief Call a tool handler and record its outcome and duration
+ *
+ * A deferred call is recorded when it completes instead.
+ */
+static mcp_tool_result_t run_tool(const tool_entry_t* tool, const mcp_tool_args_t* args) {
+  int64_t start_us = esp_timer_get_time();
+  mcp_tool_result_t result = tool->handler ? tool->handler(args) : tool->context_handler(args, tool->context);
+  metrics_counter_inc(&s_tool_calls_metric);
+
+  const tool_call_t* call = (const tool_call_t*)args->_call;
+  if (result._deferred) {
+    if (call && call->deferred) {
+      return result;
+    }
+    ESP_LOGE(TAG, "Tool '%s' returned a deferred result without deferring", tool->name);
+    result = mcp_tool_result_error("Tool did not produce a result");
+  }
+
+  metrics_histogram_observe(&s_tool_duration_metric, (esp_timer_get_time() - start_us) / 1e6);
+  if (!result.success) {
+    metrics_counter_inc(&s_tool_errors_metric);
+  }
+  return result;
+}
+
+static char* create_tool_response(int request_id, const mcp_tool_result_t* result) {
+  // Text results, the common case, are escaped straight into the response without a cJSON tree
+  return result->success ? mcp_protocol_create_text_response(request_id, result->content)
+                         : mcp_protocol_create_response(request_id, mcp_tool_result_to_json(result));
+}
+
+mcp_tool_deferred_t* mcp_tool_defer(const mcp_tool_args_t* args) {
+  tool_call_t* call = args ? (tool_call_t*)args->_call : NULL;
+  if (!call || call->deferred) {
+    return NULL;
+  }
+
+  mcp_transport_t* transport = call->server->transport;
+  if (!transport->vtable->defer || !transport->vtable->send_deferred) {
+    return NULL;
+  }
+
+  mcp_tool_deferred_t* deferred = malloc(sizeof(mcp_tool_deferred_t));
+  if (!deferred) {
+    ESP_LOGE(TAG, "Failed to allocate deferred call");
+    return NULL;
+  }
+  deferred->handle = transport->vtable->defer(transport);
+  if (!deferred->handle) {
+    free(deferred);
+    return NULL;
+  }
+
+  deferred->server = call->server;
+  deferred->request_id = call->request_id;
+  deferred->start_us = call->start_us;
+  call->deferred = deferred;
+  return deferred;
+}
+
+void mcp_tool_deferred_complete(mcp_tool_deferred_t* deferred, mcp_tool_result_t* result) {
+  if (!deferred || !result) {
+    return;
+  }
+
+  // Runs on whichever task finished the work, which is not a request handler
+  pm_activity_begin();
+  metrics_histogram_observe(&s_tool_duration_metric, (esp_timer_get_time() - deferred->start_us) / 1e6);
+  if (!result->success) {
+    metrics_counter_inc(&s_tool_errors_metric);
+  }
+
+  // The transport releases the handle even without a response, so the client is not left hanging
+  char* response = create_tool_response(deferred->request_id, result);
+  mcp_transport_t* transport = deferred->server->transport;
+  esp_err_t ret = transport->vtable->send_deferred(transport, deferred->handle, response);
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to send deferred response: %s", esp_err_to_name(ret));
+  }
+  pm_activity_end();
+
+  free(response);
+  mcp_tool_result_free(result);
+  free(deferred);
+}
+
 static void handle_call_tool(mcp_server_t* server, const char* tool_name, cJSON* args, int request_id) {
   // Allow tool calls even if initialized notification wasn't sent
   // Some clients (like our test script) skip the full handshake
@@ -473,17 +772,25 @@ static void handle_call_tool(mcp_server_t* server, const char* tool_name, cJSON*
     ESP_LOGD(TAG, "Tool arguments: NULL");
   }
 
-  mcp_tool_args_t tool_args = {.json = args};
-  mcp_tool_result_t result = tool->handler(&tool_args);
+  tool_call_t call = {.server = server, .request_id = request_id, .start_us = esp_timer_get_time()};
+  mcp_tool_args_t tool_args = {.json = args, ._call = &call};
+  mcp_tool_result_t result = run_tool(tool, &tool_args);
+
+  if (call.deferred) {
+    // A handler that deferred but still returned a result is answered with it now
+    if (!result._deferred) {
+      mcp_tool_deferred_complete(call.deferred, &result);
+    }
+    ESP_LOGD(TAG, "Tool '%s' deferred", tool_name);
+    return;
+  }
 
   ESP_LOGD(TAG, "Tool '%s' completed: %s", tool_name, result.success ? "SUCCESS" : "ERROR");
   if (!result.success && result.error_message) {
     ESP_LOGD(TAG, "Error message: %s", result.error_message);
   }
 
-  // Convert result to JSON and send response
-  cJSON* result_json = mcp_tool_result_to_json(&result);
-  char* response = mcp_protocol_create_response(request_id, result_json);
+  char* response = create_tool_response(request_id, &result);
 
   if (response) {
     server->transport->vtable->send_response(server->transport, response);
@@ -492,3 +799,192 @@ static void handle_call_tool(mcp_server_t* server, const char* tool_name, cJSON*
 
   mcp_tool_result_free(&result);
 }
+
+/**
+ * @brief Per-step state kept while a pipeline runs
+ */
+typedef struct {
+  mcp_tool_result_t result;
+  cJSON* parsed;  // Result content parsed as JSON on first reference (NULL if not yet parsed or not JSON)
+  bool parse_attempted;
+  bool executed;
+} pipeline_step_t;
+
+/**
+ * @brief Resolve a "$ref" path against the results of earlier steps
+ *
+ * The path is "<step>" or "<step>.<key>[.<key>...]". A bare step index refers to the whole
+ * result: its parsed JSON if the content is JSON, otherwise the content as a string. Numeric
+ * keys index into arrays.
+ *
+ * @return New cJSON item (caller owns it) or NULL if the reference cannot be resolved
+ */
+static cJSON* resolve_ref(pipeline_step_t* steps, size_t current, const char* path) {
+  char* end = NULL;
+  unsigned long index = strtoul(path, &end, 10);
+  if (end == path || index >= current || (*end != '\0' && *end != '.')) {
+    return NULL;
+  }
+
+  pipeline_step_t* step = &steps[index];
+  if (!step->executed || !step->result.success) {
+    return NULL;
+  }
+
+  if (!step->parse_attempted) {
+    step->parsed = step->result.content ? cJSON_Parse(step->result.content) : NULL;
+    step->parse_attempted = true;
+  }
+
+  if (*end == '\0') {
+    return step->parsed ? cJSON_Duplicate(step->parsed, true)
+                        : cJSON_CreateString(step->result.content ? step->result.content : "");
+  }
+
+  cJSON* node = step->parsed;
+  const char* key = end + 1;
+  while (node && *key) {
+    const char* dot = strchr(key, '.');
+    size_t key_len = dot ? (size_t)(dot - key) : strlen(key);
+    char segment[64];
+    if (key_len == 0 || key_len >= sizeof(segment)) {
+      return NULL;
+    }
+    memcpy(segment, key, key_len);
+    segment[key_len] = '\0';
+
+    if (cJSON_IsArray(node)) {
+      char* idx_end = NULL;
+      long idx = strtol(segment, &idx_end, 10);
+      node = (*idx_end == '\0') ? cJSON_GetArrayItem(node, (int)idx) : NULL;
+    }
+    else {
+      node = cJSON_GetObjectItem(node, segment);
+    }
+    key = dot ? dot + 1 : key + key_len;
+  }
+
+  return node ? cJSON_Duplicate(node, true) : NULL;
+}
+
+/**
+ * @brief Replace every {"$ref": "..."} object inside args with the referenced value
+ *
+ * @return true if all references resolved
+ */
+static bool resolve_args(cJSON* args, pipeline_step_t* steps, size_t current) {
+  cJSON* item = args ? args->child : NULL;
+  while (item) {
+    cJSON* next = item->next;
+    if (cJSON_IsObject(item)) {
+      cJSON* ref = cJSON_GetObjectItem(item, "$ref");
+      if (ref && cJSON_IsString(ref)) {
+        cJSON* value = resolve_ref(steps, current, ref->valuestring);
+        if (!value) {
+          ESP_LOGW(TAG, "Unresolved pipeline reference: %s", ref->valuestring);
+          return false;
+        }
+        if (cJSON_IsArray(args)) {
+          cJSON_ReplaceItemViaPointer(args, item, value);
+        }
+        else {
+          cJSON_ReplaceItemInObjectCaseSensitive(args, item->string, value);
+        }
+      }
+      else if (!resolve_args(item, steps, current)) {
+        return false;
+      }
+    }
+    else if (cJSON_IsArray(item) && !resolve_args(item, steps, current)) {
+      return false;
+    }
+    item = next;
+  }
+  return true;
+}
+
+static void handle_pipeline(mcp_server_t* server, cJSON* params, int request_id) {
+  cJSON* steps_json = params ? cJSON_GetObjectItem(params, "steps") : NULL;
+  int step_count = cJSON_IsArray(steps_json) ? cJSON_GetArraySize(steps_json) : 0;
+  if (step_count == 0 || step_count > MAX_PIPELINE_STEPS) {
+    char* error_resp = mcp_protocol_create_error(request_id, -32602, "'steps' must be an array of 1-16 tool calls");
+    if (error_resp) {
+      server->transport->vtable->send_response(server->transport, error_resp);
+      free(error_resp);
+    }
+    return;
+  }
+
+  cJSON* stop_item = cJSON_GetObjectItem(params, "stopOnError");
+  bool stop_on_error = !stop_item || cJSON_IsTrue(stop_item);
+
+  pipeline_step_t* steps = calloc(step_count, sizeof(pipeline_step_t));
+  cJSON* result = cJSON_CreateObject();
+  cJSON* results = cJSON_AddArrayToObject(result, "results");
+  if (!steps || !results) {
+    free(steps);
+    cJSON_Delete(result);
+    char* error_resp = mcp_protocol_create_error(request_id, -32603, "Internal error");
+    if (error_resp) {
+      server->transport->vtable->send_response(server->transport, error_resp);
+      free(error_resp);
+    }
+    return;
+  }
+
+  int completed = 0;
+  bool failed = false;
+  for (int i = 0; i < step_count; i++) {
+    cJSON* step_json = cJSON_GetArrayItem(steps_json, i);
+    cJSON* name_item = cJSON_GetObjectItem(step_json, "name");
+    const char* tool_name = cJSON_IsString(name_item) ? name_item->valuestring : NULL;
+    tool_entry_t* tool = find_tool(server, tool_name);
+
+    if (!tool) {
+      steps[i].result = mcp_tool_result_error("Tool not found");
+    }
+    else {
+      // References are resolved on a copy so the request stays untouched
+      cJSON* args = cJSON_Duplicate(cJSON_GetObjectItem(step_json, "arguments"), true);
+      if (!resolve_args(args, steps, i)) {
+        steps[i].result = mcp_tool_result_error("Unresolved $ref in arguments");
+      }
+      else {
+        ESP_LOGD(TAG, "Pipeline step %d: calling '%s'", i, tool_name);
+        mcp_tool_args_t tool_args = {.json = args};
+        steps[i].result = run_tool(tool, &tool_args);
+      }
+      cJSON_Delete(args);
+    }
+    steps[i].executed = true;
+
+    cJSON* step_result = mcp_tool_result_to_json(&steps[i].result);
+    if (step_result) {
+      cJSON_AddStringToObject(step_result, "name", tool_name ? tool_name : "");
+      cJSON_AddItemToArray(results, step_result);
+    }
+
+    completed++;
+    if (!steps[i].result.success) {
+      failed = true;
+      if (stop_on_error) {
+        break;
+      }
+    }
+  }
+
+  for (int i = 0; i < step_count; i++) {
+    mcp_tool_result_free(&steps[i].result);
+    cJSON_Delete(steps[i].parsed);
+  }
+  free(steps);
+
+  cJSON_AddNumberToObject(result, "completed", completed);
+  cJSON_AddBoolToObject(result, "isError", failed);
+
+  char* response = mcp_protocol_create_response(request_id, result);
+  if (response) {
+    server->transport->vtable->send_response(server->transport, response);
+    free(response);
+  }
+}
@@ -77,6 +77,44 @@ mcp_tool_result_t mcp_tool_result_success(const char* content) {
   return result;
 }
 
+/**
+ * @brief Copy length bytes into a new NUL-terminated string
+ */
+static char* copy_len(const char* text, size_t length) {
+  char* copy = malloc(length + 1);
+  if (copy) {
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+  }
+  return copy;
+}
+
+mcp_tool_result_t mcp_tool_result_success_len(const char* content, size_t length) {
+  if (!content) {
+    return mcp_tool_result_success(NULL);
+  }
+  return mcp_tool_result_success_take(copy_len(content, length));
+}
+
+mcp_tool_result_t mcp_tool_result_success_take(char* content) {
+  if (!content) {
+    return mcp_tool_result_error("Memory allocation failed");
+  }
+
+  mcp_tool_result_t result = {0};
+  result.success = true;
+  result.content = content;
+  result._content_allocated = true;
+  return result;
+}
+
+mcp_tool_result_t mcp_tool_result_deferred(void) {
+  mcp_tool_result_t result = {0};
+  result.success = true;
+  result._deferred = true;
+  return result;
+}
+
 mcp_tool_result_t mcp_tool_result_error(const char* error_message) {
   mcp_tool_result_t result = {0};
   result.success = false;
@@ -92,6 +130,21 @@ mcp_tool_result_t mcp_tool_result_error(const char* error_message) {
   return result;
 }
 
+mcp_tool_result_t mcp_tool_result_error_len(const char* error_message, size_t length) {
+  mcp_tool_result_t result = {0};
+  result.success = false;
+
+  if (error_message) {
+    result.error_message = copy_len(error_message, length);
+    result._error_allocated = true;
+    if (!result.error_message) {
+      ESP_LOGE(TAG, "Failed to allocate memory for error message");
+    }
+  }
+
+  return result;
+}
+
 void mcp_tool_result_free(mcp_tool_result_t* result) {
   if (!result) {
     return;
@@ -0,0 +1,254 @@
+#include "mcp_wait.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include "timer_wheel.h"
+
+static const char* TAG = "mcp_wait";
+
+#define MAX_WAITABLE_VALUES 8
+#define MAX_PENDING_WAITS CONFIG_MCP_WAIT_MAX_PENDING
+// The request is parked, not the transport task, but the client's HTTP timeout still applies
+#define MAX_TIMEOUT_MS CONFIG_MCP_WAIT_MAX_TIMEOUT_MS
+#define DEFAULT_INTERVAL_MS 100
+
+/**
+ * @brief Waitable value registry entry (internal)
+ */
+typedef struct {
+  const char* name;
+  mcp_value_sampler_t sampler;
+  void* context;
+} waitable_value_t;
+
+/**
+ * @brief A wait_for call in progress, sampled by its timer (internal)
+ */
+typedef struct {
+  bool in_use;
+  const waitable_value_t* value;
+  const char* op;  // Entry of CONDITION_OPS
+  double threshold;
+  uint32_t interval_ms;
+  int64_t start_us;
+  int64_t deadline_us;
+  bool have_sample;
+  double current;
+  mcp_tool_deferred_t* deferred;
+  timer_wheel_timer_t timer;
+} pending_wait_t;
+
+static waitable_value_t s_values[MAX_WAITABLE_VALUES];
+static size_t s_value_count = 0;
+
+static pending_wait_t s_waits[MAX_PENDING_WAITS];
+static portMUX_TYPE s_waits_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* CONDITION_OPS[] = {">", ">=", "<", "<=", "==", "!="};
+
+static void wait_tick(void* arg);
+
+esp_err_t mcp_wait_register_value(const char* name, mcp_value_sampler_t sampler, void* context) {
+  if (!name || !sampler) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  for (size_t i = 0; i < s_value_count; i++) {
+    if (strcmp(s_values[i].name, name) == 0) {
+      ESP_LOGE(TAG, "Value '%s' already registered", name);
+      return ESP_ERR_INVALID_STATE;
+    }
+  }
+
+  if (s_value_count >= MAX_WAITABLE_VALUES) {
+    ESP_LOGE(TAG, "Maximum number of waitable values (%d) reached", MAX_WAITABLE_VALUES);
+    return ESP_ERR_NO_MEM;
+  }
+
+  // Timers are initialized once, before any wait can use them, and never while pending
+  if (s_value_count == 0) {
+    for (size_t i = 0; i < MAX_PENDING_WAITS; i++) {
+      timer_wheel_timer_init(&s_waits[i].timer, "mcp_wait", wait_tick, &s_waits[i]);
+    }
+  }
+
+  s_values[s_value_count++] = (waitable_value_t){.name = name, .sampler = sampler, .context = context};
+  ESP_LOGI(TAG, "Registered waitable value: %s", name);
+  return ESP_OK;
+}
+
+static const waitable_value_t* find_value(const char* name) {
+  for (size_t i = 0; i < s_value_count; i++) {
+    if (strcmp(s_values[i].name, name) == 0) {
+      return &s_values[i];
+    }
+  }
+  return NULL;
+}
+
+static bool condition_met(const char* op, double value, double threshold) {
+  if (strcmp(op, ">") == 0) return value > threshold;
+  if (strcmp(op, ">=") == 0) return value >= threshold;
+  if (strcmp(op, "<") == 0) return value < threshold;
+  if (strcmp(op, "<=") == 0) return value <= threshold;
+  if (strcmp(op, "==") == 0) return value == threshold;
+  if (strcmp(op, "!=") == 0) return value != threshold;
+  return false;
+}
+
+static const char* find_op(const char* op) {
+  for (size_t i = 0; i < sizeof(CONDITION_OPS) / sizeof(CONDITION_OPS[0]); i++) {
+    if (strcmp(op, CONDITION_OPS[i]) == 0) {
+      return CONDITION_OPS[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Take one sample; true once the condition holds
+ */
+static bool wait_sample(pending_wait_t* wait) {
+  double current;
+  if (!wait->value->sampler(&current, wait->value->context)) {
+    return false;
+  }
+  wait->have_sample = true;
+  wait->current = current;
+  return condition_met(wait->op, current, wait->threshold);
+}
+
+static mcp_tool_result_t wait_result(const pending_wait_t* wait, bool met) {
+  int elapsed_ms = (int)((esp_timer_get_time() - wait->start_us) / 1000);
+
+  char result[160];
+  if (wait->have_sample) {
+    snprintf(result, sizeof(result), "{\"value\": \"%s\", \"met\": %s, \"current\": %.2f, \"elapsed_ms\": %d}",
+             wait->value->name, met ? "true" : "false", wait->current, elapsed_ms);
+  }
+  else {
+    snprintf(result, sizeof(result), "{\"value\": \"%s\", \"met\": false, \"current\": null, \"elapsed_ms\": %d}",
+             wait->value->name, elapsed_ms);
+  }
+  return mcp_tool_result_success(result);
+}
+
+static void wait_release(pending_wait_t* wait) {
+  portENTER_CRITICAL(&s_waits_lock);
+  wait->in_use = false;
+  portEXIT_CRITICAL(&s_waits_lock);
+}
+
+static void wait_finish(pending_wait_t* wait, bool met) {
+  mcp_tool_result_t result = wait_result(wait, met);
+  mcp_tool_deferred_complete(wait->deferred, &result);
+  wait->deferred = NULL;
+  wait_release(wait);
+}
+
+/**
+ * @brief Arm the timer for the next sample: one interval, or less if the deadline is closer
+ */
+static esp_err_t wait_schedule(pending_wait_t* wait) {
+  int64_t remaining_ms = (wait->deadline_us - esp_timer_get_time() + 999) / 1000;
+  uint32_t delay_ms = remaining_ms < (int64_t)wait->interval_ms ? (uint32_t)remaining_ms : wait->interval_ms;
+  return timer_wheel_schedule_once(&wait->timer, delay_ms > 0 ? delay_ms : 1);
+}
+
+// Runs on the timer wheel task; the transport task is free while the request is parked
+static void wait_tick(void* arg) {
+  pending_wait_t* wait = (pending_wait_t*)arg;
+  bool met = wait_sample(wait);
+  if (met || esp_timer_get_time() >= wait->deadline_us || wait_schedule(wait) != ESP_OK) {
+    wait_finish(wait, met);
+  }
+}
+
+static mcp_tool_result_t wait_for_handler(const mcp_tool_args_t* args) {
+  const char* name = mcp_tool_args_get_string(args, "value", NULL);
+  const char* op_arg = mcp_tool_args_get_string(args, "condition", NULL);
+  double threshold = mcp_tool_args_get_double(args, "threshold", 0.0);
+  int timeout_ms = mcp_tool_args_get_int(args, "timeout_ms", MAX_TIMEOUT_MS);
+  int interval_ms = mcp_tool_args_get_int(args, "interval_ms", DEFAULT_INTERVAL_MS);
+
+  const waitable_value_t* value = name ? find_value(name) : NULL;
+  if (!value) {
+    return mcp_tool_result_error("Unknown value");
+  }
+  const char* op = op_arg ? find_op(op_arg) : NULL;
+  if (!op) {
+    return mcp_tool_result_error("Invalid condition (must be one of >, >=, <, <=, ==, !=)");
+  }
+  if (timeout_ms < 0 || timeout_ms > MAX_TIMEOUT_MS || interval_ms < 10) {
+    return mcp_tool_result_error("Invalid timeout_ms or interval_ms");
+  }
+
+  pending_wait_t* wait = NULL;
+  portENTER_CRITICAL(&s_waits_lock);
+  for (size_t i = 0; i < MAX_PENDING_WAITS && !wait; i++) {
+    if (!s_waits[i].in_use) {
+      wait = &s_waits[i];
+      wait->in_use = true;
+    }
+  }
+  portEXIT_CRITICAL(&s_waits_lock);
+  if (!wait) {
+    return mcp_tool_result_error("Too many wait_for calls in progress");
+  }
+
+  wait->value = value;
+  wait->op = op;
+  wait->threshold = threshold;
+  wait->interval_ms = (uint32_t)interval_ms;
+  wait->start_us = esp_timer_get_time();
+  wait->deadline_us = wait->start_us + (int64_t)timeout_ms * 1000;
+  wait->have_sample = false;
+
+  // Answered on the spot when already met, when there is nothing to wait for, or when the call
+  // cannot be parked (a tools/pipeline step)
+  bool met = wait_sample(wait);
+  wait->deferred = (met || timeout_ms == 0) ? NULL : mcp_tool_defer(args);
+  if (!wait->deferred) {
+    mcp_tool_result_t result = wait_result(wait, met);
+    wait_release(wait);
+    return result;
+  }
+
+  ESP_LOGI(TAG, "Waiting up to %d ms for %s %s %.2f", timeout_ms, name, op, threshold);
+  if (wait_schedule(wait) != ESP_OK) {
+    ESP_LOGW(TAG, "Timer wheel not running, answering at once");
+    wait_finish(wait, false);
+  }
+  return mcp_tool_result_deferred();
+}
+
+static const mcp_param_schema_t WAIT_FOR_PARAMS[] = {
+    MCP_PARAM_STRING_REQUIRED("value", "Name of the registered value to watch (e.g. temperature)"),
+    {.name = "condition",
+     .type = MCP_TYPE_STRING,
+     .description = "Comparison applied as <value> <condition> <threshold>",
+     .required = true,
+     .has_minimum = false,
+     .has_maximum = false,
+     .has_min_length = false,
+     .has_max_length = false,
+     .enum_values = CONDITION_OPS,
+     .enum_count = sizeof(CONDITION_OPS) / sizeof(CONDITION_OPS[0])},
+    MCP_PARAM_NUMBER_REQUIRED("threshold", "Threshold the value is compared against", -1e9, 1e9),
+    MCP_PARAM_INTEGER("timeout_ms", "Maximum time to wait in milliseconds (default: the maximum)", 0, MAX_TIMEOUT_MS),
+    MCP_PARAM_INTEGER("interval_ms", "Sampling interval in milliseconds (default 100)", 10, 10000),
+};
+
+const mcp_tool_definition_t MCP_WAIT_FOR_TOOL = {
+    .name = "wait_for",
+    .description = "Waits for up to a few seconds until a sampled value satisfies a condition. "
+                   "Use instead of polling a sensor tool in a loop; call again while it returns met: false.",
+    .handler = wait_for_handler,
+    .parameters = WAIT_FOR_PARAMS,
+    .parameter_count = sizeof(WAIT_FOR_PARAMS) / sizeof(WAIT_FOR_PARAMS[0]),
+};
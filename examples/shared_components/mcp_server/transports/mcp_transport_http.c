@@ -5,6 +5,7 @@
 
 #include "esp_http_server.h"
 #include "esp_log.h"
+#include "shared_httpd.h"
 
 static const char* TAG = "mcp_http";
 
@@ -14,9 +15,11 @@ static const char* TAG = "mcp_http";
  * @brief HTTP transport implementation data
  */
 typedef struct {
-  httpd_handle_t server;
+  bool registered;  // Whether our handlers are registered on the shared server
   uint16_t port;
   char* pending_response;  // Response to send back
+  httpd_req_t* current;    // Request being handled, for http_defer()
+  bool deferred;           // The current request was detached and is answered later
 } mcp_http_impl_t;
 
 // Forward declarations
@@ -25,6 +28,9 @@ static esp_err_t http_start(mcp_transport_t* transport);
 static esp_err_t http_stop(mcp_transport_t* transport);
 static esp_err_t http_send_response(mcp_transport_t* transport, const char* response);
 static void http_destroy(mcp_transport_t* transport);
+static uint16_t http_get_port(mcp_transport_t* transport);
+static void* http_defer(mcp_transport_t* transport);
+static esp_err_t http_send_deferred(mcp_transport_t* transport, void* handle, const char* response);
 static esp_err_t mcp_http_options_handler(httpd_req_t* req);
 
 // HTTP handler for POST requests
@@ -75,8 +81,17 @@ static esp_err_t mcp_http_post_handler(httpd_req_t* req) {
     impl->pending_response = NULL;
   }
 
-  // Invoke the request handler (which will call send_response)
+  // Invoke the request handler (which will call send_response, or defer the request)
+  impl->current = req;
+  impl->deferred = false;
   mcp_transport_invoke_handler(transport, request_buf);
+  impl->current = NULL;
+
+  if (impl->deferred) {
+    // Answered by http_send_deferred() from another task; httpd serves other requests meanwhile
+    free(request_buf);
+    return ESP_OK;
+  }
 
   // Send the response
   if (impl->pending_response) {
@@ -134,13 +149,8 @@ static esp_err_t http_start(mcp_transport_t* transport) {
 
   mcp_http_impl_t* impl = (mcp_http_impl_t*)transport->impl_data;
 
-  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-  config.server_port = impl->port;
-  config.max_uri_handlers = 8;
-  config.max_resp_headers = 8;
-  config.stack_size = 8192;
-
-  esp_err_t ret = httpd_start(&impl->server, &config);
+  // Attach to the shared server so MCP, REST and static assets use one httpd task and socket pool
+  esp_err_t ret = shared_httpd_start(impl->port);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(ret));
     return ret;
@@ -149,25 +159,25 @@ static esp_err_t http_start(mcp_transport_t* transport) {
   // Register POST handler for root path
   httpd_uri_t post_uri = {.uri = "/", .method = HTTP_POST, .handler = mcp_http_post_handler, .user_ctx = transport};
 
-  ret = httpd_register_uri_handler(impl->server, &post_uri);
+  ret = shared_httpd_register_uri(&post_uri);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "Failed to register POST handler: %s", esp_err_to_name(ret));
-    httpd_stop(impl->server);
-    impl->server = NULL;
+    shared_httpd_stop();
     return ret;
   }
+  impl->registered = true;
 
   // Register OPTIONS handler for CORS
   httpd_uri_t options_uri = {
       .uri = "/", .method = HTTP_OPTIONS, .handler = mcp_http_options_handler, .user_ctx = transport};
 
-  ret = httpd_register_uri_handler(impl->server, &options_uri);
+  ret = shared_httpd_register_uri(&options_uri);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "Failed to register OPTIONS handler: %s", esp_err_to_name(ret));
     // Non-fatal, continue anyway
   }
 
-  ESP_LOGI(TAG, "HTTP server started on port %d", impl->port);
+  ESP_LOGI(TAG, "HTTP transport listening on port %d", shared_httpd_get_port());
   return ESP_OK;
 }
 
@@ -178,11 +188,12 @@ static esp_err_t http_stop(mcp_transport_t* transport) {
 
   mcp_http_impl_t* impl = (mcp_http_impl_t*)transport->impl_data;
 
-  if (impl->server) {
-    esp_err_t ret = httpd_stop(impl->server);
-    impl->server = NULL;
-    ESP_LOGI(TAG, "HTTP server stopped");
-    return ret;
+  if (impl->registered) {
+    shared_httpd_unregister_uri("/", HTTP_POST);
+    shared_httpd_unregister_uri("/", HTTP_OPTIONS);
+    impl->registered = false;
+    ESP_LOGI(TAG, "HTTP transport stopped");
+    return shared_httpd_stop();
   }
 
   return ESP_OK;
@@ -217,8 +228,8 @@ static void http_destroy(mcp_transport_t* transport) {
   mcp_http_impl_t* impl = (mcp_http_impl_t*)transport->impl_data;
 
   if (impl) {
-    if (impl->server) {
-      httpd_stop(impl->server);
+    if (impl->registered) {
+      http_stop(transport);
     }
     if (impl->pending_response) {
       free(impl->pending_response);
@@ -230,6 +241,46 @@ static void http_destroy(mcp_transport_t* transport) {
   ESP_LOGI(TAG, "HTTP transport destroyed");
 }
 
+// The shared server keeps the port it was first started on, whatever port was passed to init
+static uint16_t http_get_port(mcp_transport_t* transport) {
+  mcp_http_impl_t* impl = (mcp_http_impl_t*)transport->impl_data;
+  return impl->registered ? shared_httpd_get_port() : 0;
+}
+
+// httpd keeps the socket open for the detached copy and hands the task back to other requests
+static void* http_defer(mcp_transport_t* transport) {
+  mcp_http_impl_t* impl = (mcp_http_impl_t*)transport->impl_data;
+  if (!impl->current) {
+    return NULL;
+  }
+
+  httpd_req_t* async_req = NULL;
+  esp_err_t ret = httpd_req_async_handler_begin(impl->current, &async_req);
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to detach request: %s", esp_err_to_name(ret));
+    return NULL;
+  }
+
+  impl->deferred = true;
+  return async_req;
+}
+
+static esp_err_t http_send_deferred(mcp_transport_t* transport, void* handle, const char* response) {
+  httpd_req_t* req = (httpd_req_t*)handle;
+  esp_err_t ret;
+  if (response) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    ret = httpd_resp_sendstr(req, response);
+  }
+  else {
+    httpd_resp_send_500(req);
+    ret = ESP_ERR_INVALID_ARG;
+  }
+  httpd_req_async_handler_complete(req);
+  return ret;
+}
+
 // Virtual function table
 static const mcp_transport_vtable_t http_vtable = {
     .init = http_init,
@@ -237,6 +288,9 @@ static const mcp_transport_vtable_t http_vtable = {
     .stop = http_stop,
     .send_response = http_send_response,
     .destroy = http_destroy,
+    .get_port = http_get_port,
+    .defer = http_defer,
+    .send_deferred = http_send_deferred,
 };
 
 mcp_transport_t* mcp_transport_http_create(void) {
@@ -0,0 +1,636 @@
+#include "mcp_transport_socket.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "pm_activity.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "mcp_socket";
+
+#define MAX_REQUEST_SIZE 4096
+#define MAX_CLIENTS 4
+#define SELECT_TIMEOUT_MS 500
+#define SEND_TIMEOUT_MS 5000
+
+/**
+ * @brief Per-client connection state
+ *
+ * Headers and body are received into the same buffer and parsed in place. The buffer is
+ * allocated on accept and released on close, so idle slots cost nothing.
+ */
+typedef struct {
+  int fd;
+  size_t len;       // Bytes currently buffered (buf[len] is always '\0')
+  char* buf;        // MAX_REQUEST_SIZE + 1 bytes
+  bool parked;      // A deferred request is outstanding; the socket is not read until it is answered
+  bool keep_alive;  // Whether the parked request keeps the connection open
+  bool resume;      // Answered with pipelined requests still buffered
+  uint32_t serial;  // Bumped on close, so a late answer does not go to the slot's next client
+} mcp_socket_conn_t;
+
+/**
+ * @brief Handle returned by socket_defer()
+ */
+typedef struct {
+  mcp_socket_conn_t* conn;
+  uint32_t serial;
+} parked_request_t;
+
+/**
+ * @brief Socket transport implementation data
+ */
+typedef struct {
+  uint16_t port;
+  int listen_fd;
+  TaskHandle_t task;
+  volatile bool running;
+  // Guards conns; the server task holds it except in select(), deferred answers take it to send.
+  // Recursive, because a handler may answer its own deferred request before returning.
+  SemaphoreHandle_t lock;
+  StaticSemaphore_t lock_storage;
+  mcp_socket_conn_t conns[MAX_CLIENTS];
+  mcp_socket_conn_t* current;  // Connection whose request is being handled
+  bool keep_alive;             // Whether the current request keeps the connection open
+  bool responded;              // Whether send_response was called for the current request
+} mcp_socket_impl_t;
+
+typedef enum {
+  REQUEST_INCOMPLETE,  // Need more bytes
+  REQUEST_HANDLED,     // One request consumed, buffer may hold the next one
+  REQUEST_CLOSE,       // Connection must be closed
+  REQUEST_PARKED,      // Consumed and deferred; stop reading until it is answered
+} request_status_t;
+
+static const char CORS_PREFLIGHT_RESPONSE[] =
+    "HTTP/1.1 204 No Content\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "Access-Control-Allow-Methods: POST, OPTIONS\r\n"
+    "Access-Control-Allow-Headers: Content-Type\r\n"
+    "Access-Control-Max-Age: 86400\r\n"
+    "Content-Length: 0\r\n"
+    "\r\n";
+
+// Send every byte described by iov, waiting for the socket to drain when it would block
+static esp_err_t send_all(int fd, struct iovec* iov, int iovcnt) {
+  while (iovcnt > 0) {
+    ssize_t sent = lwip_writev(fd, iov, iovcnt);
+    if (sent < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        ESP_LOGW(TAG, "writev failed: errno %d", errno);
+        return ESP_FAIL;
+      }
+
+      fd_set wfds;
+      FD_ZERO(&wfds);
+      FD_SET(fd, &wfds);
+      struct timeval tv = {.tv_sec = SEND_TIMEOUT_MS / 1000, .tv_usec = (SEND_TIMEOUT_MS % 1000) * 1000};
+      if (select(fd + 1, NULL, &wfds, NULL, &tv) <= 0) {
+        ESP_LOGW(TAG, "Timed out waiting to send");
+        return ESP_ERR_TIMEOUT;
+      }
+      continue;
+    }
+
+    // Skip fully written vectors and advance into a partially written one
+    while (iovcnt > 0 && (size_t)sent >= iov->iov_len) {
+      sent -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (char*)iov->iov_base + sent;
+      iov->iov_len -= sent;
+    }
+  }
+
+  return ESP_OK;
+}
+
+static esp_err_t send_status(int fd, const char* status) {
+  char header[128];
+  int len = snprintf(header, sizeof(header), "HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+  struct iovec iov = {.iov_base = header, .iov_len = len};
+  return send_all(fd, &iov, 1);
+}
+
+static esp_err_t send_json(int fd, const char* response, bool keep_alive) {
+  size_t body_len = strlen(response);
+  char header[192];
+  int header_len = snprintf(header, sizeof(header),
+                            "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/json\r\n"
+                            "Access-Control-Allow-Origin: *\r\n"
+                            "Content-Length: %u\r\n"
+                            "Connection: %s\r\n"
+                            "\r\n",
+                            (unsigned)body_len, keep_alive ? "keep-alive" : "close");
+
+  // Header and body go out in one call, straight from the caller's response buffer
+  struct iovec iov[2] = {
+      {.iov_base = header, .iov_len = header_len},
+      {.iov_base = (void*)response, .iov_len = body_len},
+  };
+  return send_all(fd, iov, 2);
+}
+
+static void conn_close(mcp_socket_conn_t* conn) {
+  if (conn->fd >= 0) {
+    close(conn->fd);
+    conn->fd = -1;
+  }
+  free(conn->buf);
+  conn->buf = NULL;
+  conn->len = 0;
+  conn->parked = false;
+  conn->resume = false;
+  conn->serial++;
+}
+
+// Case-insensitive header name match; line points at the start of a header line
+static const char* match_header(const char* line, const char* name) {
+  size_t name_len = strlen(name);
+  if (strncasecmp(line, name, name_len) != 0 || line[name_len] != ':') {
+    return NULL;
+  }
+
+  const char* value = line + name_len + 1;
+  while (*value == ' ' || *value == '\t') {
+    value++;
+  }
+  return value;
+}
+
+static request_status_t process_request(mcp_transport_t* transport, mcp_socket_conn_t* conn) {
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  char* buf = conn->buf;
+
+  char* header_end = strstr(buf, "\r\n\r\n");
+  if (!header_end) {
+    if (conn->len >= MAX_REQUEST_SIZE) {
+      send_status(conn->fd, "431 Request Header Fields Too Large");
+      return REQUEST_CLOSE;
+    }
+    return REQUEST_INCOMPLETE;
+  }
+  size_t header_len = (header_end - buf) + 4;
+
+  // Request line: METHOD SP PATH SP VERSION
+  const char* method = buf;
+  char* sp = memchr(buf, ' ', header_len);
+  if (!sp) {
+    send_status(conn->fd, "400 Bad Request");
+    return REQUEST_CLOSE;
+  }
+  size_t method_len = sp - method;
+  const char* path = sp + 1;
+  const char* line_end = strstr(path, "\r\n");
+  bool http_10 = line_end - path >= 8 && strncmp(line_end - 8, "HTTP/1.0", 8) == 0;
+
+  // Headers we care about, scanned without copying
+  // The body must fit in the buffer after the headers; checked before any arithmetic so a huge
+  // Content-Length cannot wrap header_len + content_length
+  size_t body_max = MAX_REQUEST_SIZE - header_len;
+  size_t content_length = 0;
+  bool keep_alive = !http_10;
+  for (const char* line = line_end + 2; line < header_end; line = strstr(line, "\r\n") + 2) {
+    const char* value;
+    if ((value = match_header(line, "Content-Length"))) {
+      if (*value < '0' || *value > '9') {
+        send_status(conn->fd, "400 Bad Request");
+        return REQUEST_CLOSE;
+      }
+      char* end;
+      errno = 0;
+      unsigned long parsed = strtoul(value, &end, 10);
+      if (*end != '\r' && *end != ' ' && *end != '\t') {
+        send_status(conn->fd, "400 Bad Request");
+        return REQUEST_CLOSE;
+      }
+      if (errno == ERANGE || parsed > body_max) {
+        ESP_LOGW(TAG, "Request too large: Content-Length %s", errno == ERANGE ? "out of range" : "over the limit");
+        send_status(conn->fd, "413 Payload Too Large");
+        return REQUEST_CLOSE;
+      }
+      content_length = parsed;
+    }
+    else if ((value = match_header(line, "Connection"))) {
+      if (strncasecmp(value, "close", 5) == 0) {
+        keep_alive = false;
+      }
+      else if (strncasecmp(value, "keep-alive", 10) == 0) {
+        keep_alive = true;
+      }
+    }
+  }
+
+  size_t total_len = header_len + content_length;
+  if (conn->len < total_len) {
+    return REQUEST_INCOMPLETE;
+  }
+
+  bool is_root = path[0] == '/' && path[1] == ' ';
+  esp_err_t ret = ESP_OK;
+
+  if (method_len == 7 && strncmp(method, "OPTIONS", 7) == 0 && is_root) {
+    struct iovec iov = {.iov_base = (void*)CORS_PREFLIGHT_RESPONSE, .iov_len = sizeof(CORS_PREFLIGHT_RESPONSE) - 1};
+    ret = send_all(conn->fd, &iov, 1);
+  }
+  else if (method_len == 4 && strncmp(method, "POST", 4) == 0 && is_root) {
+    // Terminate the body in place; the byte after it belongs to the next pipelined request
+    char* body = buf + header_len;
+    char saved = body[content_length];
+    body[content_length] = '\0';
+
+    ESP_LOGD(TAG, "Request body: %s", body);
+
+    impl->current = conn;
+    impl->keep_alive = keep_alive;
+    impl->responded = false;
+    mcp_transport_invoke_handler(transport, body);
+    impl->current = NULL;
+
+    body[content_length] = saved;
+
+    if (conn->parked) {
+      conn->len -= total_len;
+      memmove(buf, buf + total_len, conn->len);
+      buf[conn->len] = '\0';
+      return REQUEST_PARKED;
+    }
+    if (!impl->responded) {
+      ESP_LOGW(TAG, "No response generated");
+      send_status(conn->fd, "500 Internal Server Error");
+      return REQUEST_CLOSE;
+    }
+  }
+  else {
+    send_status(conn->fd, is_root ? "405 Method Not Allowed" : "404 Not Found");
+    return REQUEST_CLOSE;
+  }
+
+  if (ret != ESP_OK || !keep_alive) {
+    return REQUEST_CLOSE;
+  }
+
+  // Keep any pipelined bytes for the next request
+  conn->len -= total_len;
+  memmove(buf, buf + total_len, conn->len);
+  buf[conn->len] = '\0';
+  return REQUEST_HANDLED;
+}
+
+// Handle the complete requests in the buffer, up to the first one that is deferred
+static void conn_process(mcp_transport_t* transport, mcp_socket_conn_t* conn) {
+  // Full CPU speed while the buffered requests are parsed and their tools run
+  request_status_t status;
+  pm_activity_begin();
+  do {
+    status = process_request(transport, conn);
+  } while (status == REQUEST_HANDLED && conn->len > 0);
+  pm_activity_end();
+
+  if (status == REQUEST_CLOSE) {
+    conn_close(conn);
+  }
+}
+
+static void conn_on_readable(mcp_transport_t* transport, mcp_socket_conn_t* conn) {
+  ssize_t received = recv(conn->fd, conn->buf + conn->len, MAX_REQUEST_SIZE - conn->len, 0);
+  if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    conn_close(conn);
+    return;
+  }
+  if (received < 0) {
+    return;
+  }
+
+  conn->len += received;
+  conn->buf[conn->len] = '\0';
+  conn_process(transport, conn);
+}
+
+static void accept_client(mcp_socket_impl_t* impl) {
+  int fd = accept(impl->listen_fd, NULL, NULL);
+  if (fd < 0) {
+    return;
+  }
+
+  mcp_socket_conn_t* slot = NULL;
+  for (int i = 0; i < MAX_CLIENTS; i++) {
+    if (impl->conns[i].fd < 0) {
+      slot = &impl->conns[i];
+      break;
+    }
+  }
+
+  if (!slot) {
+    ESP_LOGW(TAG, "Too many clients, rejecting connection");
+    send_status(fd, "503 Service Unavailable");
+    close(fd);
+    return;
+  }
+
+  slot->buf = malloc(MAX_REQUEST_SIZE + 1);
+  if (!slot->buf) {
+    ESP_LOGE(TAG, "Failed to allocate connection buffer");
+    close(fd);
+    return;
+  }
+
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  slot->fd = fd;
+  slot->len = 0;
+  slot->buf[0] = '\0';
+  slot->parked = false;
+  slot->resume = false;
+}
+
+static void server_task(void* arg) {
+  mcp_transport_t* transport = (mcp_transport_t*)arg;
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+
+  xSemaphoreTakeRecursive(impl->lock, portMAX_DELAY);
+  while (impl->running) {
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(impl->listen_fd, &rfds);
+    int max_fd = impl->listen_fd;
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+      if (impl->conns[i].fd >= 0 && !impl->conns[i].parked) {
+        FD_SET(impl->conns[i].fd, &rfds);
+        if (impl->conns[i].fd > max_fd) {
+          max_fd = impl->conns[i].fd;
+        }
+      }
+    }
+
+    // Bounded timeout so stop() is noticed without a control socket
+    struct timeval tv = {.tv_sec = 0, .tv_usec = SELECT_TIMEOUT_MS * 1000};
+    xSemaphoreGiveRecursive(impl->lock);
+    int ready = select(max_fd + 1, &rfds, NULL, NULL, &tv);
+    xSemaphoreTakeRecursive(impl->lock, portMAX_DELAY);
+
+    // Pipelined requests that queued up behind a deferred one; picked up within SELECT_TIMEOUT_MS
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+      if (impl->conns[i].resume) {
+        impl->conns[i].resume = false;
+        conn_process(transport, &impl->conns[i]);
+      }
+    }
+
+    if (ready < 0) {
+      if (errno != EINTR) {
+        ESP_LOGE(TAG, "select failed: errno %d", errno);
+        vTaskDelay(pdMS_TO_TICKS(10));
+      }
+      continue;
+    }
+    if (ready == 0) {
+      continue;
+    }
+
+    if (FD_ISSET(impl->listen_fd, &rfds)) {
+      accept_client(impl);
+    }
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+      if (impl->conns[i].fd >= 0 && !impl->conns[i].parked && FD_ISSET(impl->conns[i].fd, &rfds)) {
+        conn_on_readable(transport, &impl->conns[i]);
+      }
+    }
+  }
+
+  for (int i = 0; i < MAX_CLIENTS; i++) {
+    conn_close(&impl->conns[i]);
+  }
+  xSemaphoreGiveRecursive(impl->lock);
+  close(impl->listen_fd);
+  impl->listen_fd = -1;
+  impl->task = NULL;
+  vTaskDelete(NULL);
+}
+
+static esp_err_t socket_init(mcp_transport_t* transport, uint16_t port) {
+  if (!transport) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  impl->port = port;
+
+  ESP_LOGD(TAG, "Socket transport initialized on port %d", port);
+  return ESP_OK;
+}
+
+static esp_err_t socket_start(mcp_transport_t* transport) {
+  if (!transport) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  if (impl->task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) {
+    ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
+    return ESP_FAIL;
+  }
+
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  struct sockaddr_in addr = {
+      .sin_family = AF_INET,
+      .sin_port = htons(impl->port),
+      .sin_addr.s_addr = htonl(INADDR_ANY),
+  };
+
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, MAX_CLIENTS) != 0) {
+    ESP_LOGE(TAG, "Failed to listen on port %d: errno %d", impl->port, errno);
+    close(fd);
+    return ESP_FAIL;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  // Port 0 binds an ephemeral port; record the one chosen so it can be advertised
+  socklen_t addr_len = sizeof(addr);
+  if (impl->port == 0 && getsockname(fd, (struct sockaddr*)&addr, &addr_len) == 0) {
+    impl->port = ntohs(addr.sin_port);
+  }
+
+  impl->listen_fd = fd;
+  impl->running = true;
+
+  if (xTaskCreate(server_task, "mcp_socket", CONFIG_MCP_SERVER_SOCKET_TASK_STACK_SIZE, transport, tskIDLE_PRIORITY + 5,
+                  &impl->task) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create server task");
+    impl->running = false;
+    close(fd);
+    impl->listen_fd = -1;
+    return ESP_ERR_NO_MEM;
+  }
+
+  ESP_LOGI(TAG, "Socket transport listening on port %d", impl->port);
+  return ESP_OK;
+}
+
+static esp_err_t socket_stop(mcp_transport_t* transport) {
+  if (!transport) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+
+  // The server task closes all sockets and deletes itself on its next wakeup
+  impl->running = false;
+  while (impl->task) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+
+  ESP_LOGI(TAG, "Socket transport stopped");
+  return ESP_OK;
+}
+
+static esp_err_t socket_send_response(mcp_transport_t* transport, const char* response) {
+  if (!transport || !response) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  if (!impl->current) {
+    ESP_LOGE(TAG, "send_response called outside of a request");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  impl->responded = true;
+  return send_json(impl->current->fd, response, impl->keep_alive);
+}
+
+// Runs on the server task, which holds the lock while handling the request
+static void* socket_defer(mcp_transport_t* transport) {
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  if (!impl->current) {
+    return NULL;
+  }
+
+  parked_request_t* parked = malloc(sizeof(parked_request_t));
+  if (!parked) {
+    ESP_LOGE(TAG, "Failed to allocate parked request");
+    return NULL;
+  }
+  parked->conn = impl->current;
+  parked->serial = impl->current->serial;
+
+  impl->current->parked = true;
+  impl->current->keep_alive = impl->keep_alive;
+  return parked;
+}
+
+static esp_err_t socket_send_deferred(mcp_transport_t* transport, void* handle, const char* response) {
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  parked_request_t* parked = (parked_request_t*)handle;
+  mcp_socket_conn_t* conn = parked->conn;
+  esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+  xSemaphoreTakeRecursive(impl->lock, portMAX_DELAY);
+  // Closed in the meantime (transport stopped) if the serial moved on
+  if (conn->fd >= 0 && conn->parked && conn->serial == parked->serial) {
+    conn->parked = false;
+    if (conn == impl->current) {
+      // Answered before the handler returned, on the server task: it finishes as a normal request
+      impl->responded = response != NULL;
+      ret = response ? send_json(conn->fd, response, conn->keep_alive) : ESP_ERR_INVALID_ARG;
+    }
+    else {
+      ret = response ? send_json(conn->fd, response, conn->keep_alive)
+                     : send_status(conn->fd, "500 Internal Server Error");
+      if (ret != ESP_OK || !response || !conn->keep_alive) {
+        conn_close(conn);
+      }
+      else if (conn->len > 0) {
+        conn->resume = true;
+      }
+    }
+  }
+  xSemaphoreGiveRecursive(impl->lock);
+
+  free(parked);
+  return ret;
+}
+
+static void socket_destroy(mcp_transport_t* transport) {
+  if (!transport) {
+    return;
+  }
+
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  if (impl) {
+    if (impl->task) {
+      socket_stop(transport);
+    }
+    free(impl);
+  }
+
+  free(transport);
+  ESP_LOGI(TAG, "Socket transport destroyed");
+}
+
+static uint16_t socket_get_port(mcp_transport_t* transport) {
+  mcp_socket_impl_t* impl = (mcp_socket_impl_t*)transport->impl_data;
+  return impl->task ? impl->port : 0;
+}
+
+// Virtual function table
+static const mcp_transport_vtable_t socket_vtable = {
+    .init = socket_init,
+    .start = socket_start,
+    .stop = socket_stop,
+    .send_response = socket_send_response,
+    .destroy = socket_destroy,
+    .get_port = socket_get_port,
+    .defer = socket_defer,
+    .send_deferred = socket_send_deferred,
+};
+
+mcp_transport_t* mcp_transport_socket_create(void) {
+  mcp_transport_t* transport = calloc(1, sizeof(mcp_transport_t));
+  if (!transport) {
+    ESP_LOGE(TAG, "Failed to allocate transport");
+    return NULL;
+  }
+
+  mcp_socket_impl_t* impl = calloc(1, sizeof(mcp_socket_impl_t));
+  if (!impl) {
+    ESP_LOGE(TAG, "Failed to allocate socket implementation data");
+    free(transport);
+    return NULL;
+  }
+
+  impl->listen_fd = -1;
+  impl->lock = xSemaphoreCreateRecursiveMutexStatic(&impl->lock_storage);
+  for (int i = 0; i < MAX_CLIENTS; i++) {
+    impl->conns[i].fd = -1;
+  }
+
+  transport->vtable = &socket_vtable;
+  transport->impl_data = impl;
+
+  ESP_LOGI(TAG, "Socket transport created");
+  return transport;
+}
@@ -0,0 +1,26 @@
+#ifndef MCP_TRANSPORT_SOCKET_H
+#define MCP_TRANSPORT_SOCKET_H
+
+#include "mcp_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create a lightweight HTTP transport built directly on lwIP sockets
+ *
+ * Serves the same endpoint as the esp_http_server based transport (POST / and OPTIONS /)
+ * from a single select() loop. Requests are parsed in place in one per-connection buffer
+ * and the body is handed to the protocol layer without copying. Responses are written with
+ * a single writev() of the header block and the response body.
+ *
+ * @return Transport instance or NULL on failure (must be destroyed with vtable->destroy)
+ */
+mcp_transport_t* mcp_transport_socket_create(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MCP_TRANSPORT_SOCKET_H
@@ -0,0 +1,194 @@
+#ifndef PRODESP32_METRICS_H
+#define PRODESP32_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Metric type
+ */
+typedef enum {
+  METRICS_TYPE_COUNTER,
+  METRICS_TYPE_GAUGE,
+  METRICS_TYPE_HISTOGRAM,
+} metrics_type_t;
+
+/**
+ * @brief Common metric header, embedded first in every metric type
+ *
+ * Metrics are statically allocated by their owner and linked into the registry through
+ * `next`, so registering and rendering never allocate.
+ */
+typedef struct metrics_metric {
+  const char* name;    ///< Metric name, [a-zA-Z_:][a-zA-Z0-9_:]*
+  const char* help;    ///< HELP text
+  const char* labels;  ///< Constant labels without braces, e.g. "tool=\"hello\"", or NULL
+  metrics_type_t type;
+  struct metrics_metric* next;
+  bool registered;
+} metrics_metric_t;
+
+/**
+ * @brief Monotonic counter
+ */
+typedef struct {
+  metrics_metric_t base;
+  uint64_t value;
+} metrics_counter_t;
+
+/**
+ * @brief Callback evaluated at scrape time for computed gauges
+ */
+typedef double (*metrics_gauge_fn_t)(void* context);
+
+/**
+ * @brief Gauge, either set by its owner or computed by a callback at scrape time
+ */
+typedef struct {
+  metrics_metric_t base;
+  uint32_t bits;  ///< float value, stored as bits so it can be updated atomically
+  metrics_gauge_fn_t read;
+  void* context;
+} metrics_gauge_t;
+
+#define METRICS_HISTOGRAM_MAX_BOUNDS 15  ///< Bucket upper bounds per histogram, plus the implicit +Inf
+
+/**
+ * @brief Histogram with fixed bucket upper bounds
+ */
+typedef struct {
+  metrics_metric_t base;
+  const float* bounds;  ///< Ascending upper bounds, the +Inf bucket is implicit
+  size_t bound_count;
+  uint32_t counts[METRICS_HISTOGRAM_MAX_BOUNDS + 1];  ///< Per-bucket (not cumulative) counts
+  uint64_t sum_bits;                                  ///< double sum of observations, stored as bits
+} metrics_histogram_t;
+
+#define METRICS_HEADER_INIT(metric_name, metric_labels, metric_help, metric_type) \
+  { (metric_name), (metric_help), (metric_labels), (metric_type), NULL, false }
+
+/**
+ * @brief Define a counter, e.g. `static METRICS_COUNTER_DEFINE(s_requests, "http_requests_total", "Requests");`
+ */
+#define METRICS_COUNTER_DEFINE(var, metric_name, metric_help) \
+  metrics_counter_t var = {METRICS_HEADER_INIT(metric_name, NULL, metric_help, METRICS_TYPE_COUNTER), 0}
+
+/**
+ * @brief Define a counter with constant labels (one series of a labeled family)
+ */
+#define METRICS_COUNTER_DEFINE_LABELED(var, metric_name, metric_labels, metric_help) \
+  metrics_counter_t var = {METRICS_HEADER_INIT(metric_name, metric_labels, metric_help, METRICS_TYPE_COUNTER), 0}
+
+/**
+ * @brief Define a gauge set by its owner
+ */
+#define METRICS_GAUGE_DEFINE(var, metric_name, metric_help) \
+  metrics_gauge_t var = {METRICS_HEADER_INIT(metric_name, NULL, metric_help, METRICS_TYPE_GAUGE), 0, NULL, NULL}
+
+/**
+ * @brief Define a gauge computed by read_fn(context) at scrape time
+ */
+#define METRICS_GAUGE_DEFINE_FN(var, metric_name, metric_help, read_fn, fn_context) \
+  metrics_gauge_t var = {                                                           \
+      METRICS_HEADER_INIT(metric_name, NULL, metric_help, METRICS_TYPE_GAUGE), 0, (read_fn), (fn_context)}
+
+/**
+ * @brief Define a histogram over a static array of ascending bucket upper bounds
+ *
+ *     static const float k_latency_bounds[] = {0.001f, 0.01f, 0.1f, 1.0f};
+ *     static METRICS_HISTOGRAM_DEFINE(s_latency, "op_duration_seconds", "Duration", k_latency_bounds);
+ */
+#define METRICS_HISTOGRAM_DEFINE(var, metric_name, metric_help, bounds_array)                              \
+  metrics_histogram_t var = {METRICS_HEADER_INIT(metric_name, NULL, metric_help, METRICS_TYPE_HISTOGRAM), \
+                             (bounds_array), sizeof(bounds_array) / sizeof((bounds_array)[0]), {0}, 0}
+
+/**
+ * @brief Add a metric to the registry
+ *
+ * Safe to call from several tasks. Metrics can't be unregistered, so they must have static
+ * storage duration.
+ *
+ * @param metric &counter.base, &gauge.base or &histogram.base
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid name or too many histogram
+ *         bounds, ESP_ERR_INVALID_STATE if already registered
+ */
+esp_err_t metrics_register(metrics_metric_t* metric);
+
+/**
+ * @brief Output callback for metrics_render()
+ *
+ * @return ESP_OK to continue, anything else aborts rendering
+ */
+typedef esp_err_t (*metrics_write_fn_t)(const char* data, size_t len, void* context);
+
+/**
+ * @brief Render all registered metrics in the Prometheus text exposition format
+ *
+ * Series of the same name are grouped under one HELP/TYPE header. Formats line by line
+ * into a small stack buffer, so it does not allocate.
+ *
+ * @param write Output callback, called once per line
+ * @param context User context passed to write
+ * @return ESP_OK, or the first error returned by write
+ */
+esp_err_t metrics_render(metrics_write_fn_t write, void* context);
+
+/**
+ * @brief Register GET /metrics on the shared HTTP server
+ *
+ * Register it before any catch-all GET handler (wildcard "/" URI), since httpd matches handlers in
+ * registration order.
+ *
+ * @param port Port for the shared server if it is not running yet
+ * @return ESP_OK on success
+ */
+esp_err_t metrics_register_http(uint16_t port);
+
+/**
+ * @brief Register heap and uptime gauges (esp_heap_free_bytes, esp_uptime_seconds, ...)
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t metrics_register_system(void);
+
+/**
+ * @brief Record a histogram observation
+ */
+void metrics_histogram_observe(metrics_histogram_t* histogram, double value);
+
+static inline void metrics_counter_add(metrics_counter_t* counter, uint64_t amount) {
+  __atomic_fetch_add(&counter->value, amount, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_counter_inc(metrics_counter_t* counter) { metrics_counter_add(counter, 1); }
+
+static inline void metrics_gauge_set(metrics_gauge_t* gauge, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  __atomic_store_n(&gauge->bits, bits, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_gauge_add(metrics_gauge_t* gauge, float delta) {
+  uint32_t expected = __atomic_load_n(&gauge->bits, __ATOMIC_RELAXED);
+  uint32_t desired;
+  do {
+    float value;
+    memcpy(&value, &expected, sizeof(value));
+    value += delta;
+    memcpy(&desired, &value, sizeof(desired));
+  } while (!__atomic_compare_exchange_n(&gauge->bits, &expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_METRICS_H
@@ -0,0 +1,194 @@
+#include "metrics.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "esp_log.h"
+
+static const char* TAG = "metrics";
+
+#define LINE_MAX_LEN 192
+
+static metrics_metric_t* s_head = NULL;
+
+static bool valid_name(const char* name) {
+  if (!name || !*name) {
+    return false;
+  }
+  for (const char* c = name; *c; c++) {
+    bool alpha = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || *c == '_' || *c == ':';
+    bool digit = *c >= '0' && *c <= '9';
+    if (!alpha && !(digit && c != name)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+esp_err_t metrics_register(metrics_metric_t* metric) {
+  if (!metric || !valid_name(metric->name)) {
+    ESP_LOGE(TAG, "Invalid metric name: %s", metric && metric->name ? metric->name : "(null)");
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (metric->type == METRICS_TYPE_HISTOGRAM &&
+      ((metrics_histogram_t*)metric)->bound_count > METRICS_HISTOGRAM_MAX_BOUNDS) {
+    ESP_LOGE(TAG, "%s: more than %d bucket bounds", metric->name, METRICS_HISTOGRAM_MAX_BOUNDS);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  bool expected = false;
+  if (!__atomic_compare_exchange_n(&metric->registered, &expected, true, false, __ATOMIC_ACQ_REL,
+                                   __ATOMIC_RELAXED)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Lock-free push; the render walk only follows published next pointers
+  metrics_metric_t* head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+  do {
+    metric->next = head;
+  } while (!__atomic_compare_exchange_n(&s_head, &head, metric, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+  return ESP_OK;
+}
+
+void metrics_histogram_observe(metrics_histogram_t* histogram, double value) {
+  size_t bucket = 0;
+  while (bucket < histogram->bound_count && value > histogram->bounds[bucket]) {
+    bucket++;
+  }
+  __atomic_fetch_add(&histogram->counts[bucket], 1, __ATOMIC_RELAXED);
+
+  uint64_t expected = __atomic_load_n(&histogram->sum_bits, __ATOMIC_RELAXED);
+  uint64_t desired;
+  do {
+    double sum;
+    memcpy(&sum, &expected, sizeof(sum));
+    sum += value;
+    memcpy(&desired, &sum, sizeof(desired));
+  } while (
+      !__atomic_compare_exchange_n(&histogram->sum_bits, &expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static const char* type_name(metrics_type_t type) {
+  switch (type) {
+    case METRICS_TYPE_COUNTER:
+      return "counter";
+    case METRICS_TYPE_GAUGE:
+      return "gauge";
+    case METRICS_TYPE_HISTOGRAM:
+      return "histogram";
+  }
+  return "untyped";
+}
+
+/**
+ * @brief Format one line into the line buffer and pass it to the writer
+ */
+static esp_err_t emit(metrics_write_fn_t write, void* context, char* line, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static esp_err_t emit(metrics_write_fn_t write, void* context, char* line, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(line, LINE_MAX_LEN, format, args);
+  va_end(args);
+  if (len < 0) {
+    return ESP_FAIL;
+  }
+  if (len >= LINE_MAX_LEN) {
+    // Keep the exposition parseable: cut the line but keep its newline
+    len = LINE_MAX_LEN - 1;
+    line[len - 1] = '\n';
+  }
+  return write(line, len, context);
+}
+
+static esp_err_t render_histogram(const metrics_histogram_t* histogram, metrics_write_fn_t write, void* context,
+                                  char* line) {
+  const char* name = histogram->base.name;
+  const char* labels = histogram->base.labels ? histogram->base.labels : "";
+  const char* sep = histogram->base.labels ? "," : "";
+
+  uint64_t cumulative = 0;
+  esp_err_t ret = ESP_OK;
+  for (size_t i = 0; i <= histogram->bound_count && ret == ESP_OK; i++) {
+    cumulative += __atomic_load_n(&histogram->counts[i], __ATOMIC_RELAXED);
+    if (i < histogram->bound_count) {
+      ret = emit(write, context, line, "%s_bucket{%s%sle=\"%g\"} %" PRIu64 "\n", name, labels, sep,
+                 histogram->bounds[i], cumulative);
+    }
+    else {
+      ret = emit(write, context, line, "%s_bucket{%s%sle=\"+Inf\"} %" PRIu64 "\n", name, labels, sep, cumulative);
+    }
+  }
+
+  uint64_t sum_bits = __atomic_load_n(&histogram->sum_bits, __ATOMIC_RELAXED);
+  double sum;
+  memcpy(&sum, &sum_bits, sizeof(sum));
+  const char* open = histogram->base.labels ? "{" : "";
+  const char* close = histogram->base.labels ? "}" : "";
+  if (ret == ESP_OK) {
+    ret = emit(write, context, line, "%s_sum%s%s%s %.9g\n", name, open, labels, close, sum);
+  }
+  if (ret == ESP_OK) {
+    ret = emit(write, context, line, "%s_count%s%s%s %" PRIu64 "\n", name, open, labels, close, cumulative);
+  }
+  return ret;
+}
+
+static esp_err_t render_sample(const metrics_metric_t* metric, metrics_write_fn_t write, void* context, char* line) {
+  const char* open = metric->labels ? "{" : "";
+  const char* labels = metric->labels ? metric->labels : "";
+  const char* close = metric->labels ? "}" : "";
+
+  switch (metric->type) {
+    case METRICS_TYPE_COUNTER: {
+      const metrics_counter_t* counter = (const metrics_counter_t*)metric;
+      return emit(write, context, line, "%s%s%s%s %" PRIu64 "\n", metric->name, open, labels, close,
+                  __atomic_load_n(&counter->value, __ATOMIC_RELAXED));
+    }
+    case METRICS_TYPE_GAUGE: {
+      const metrics_gauge_t* gauge = (const metrics_gauge_t*)metric;
+      double value;
+      if (gauge->read) {
+        value = gauge->read(gauge->context);
+      }
+      else {
+        uint32_t bits = __atomic_load_n(&gauge->bits, __ATOMIC_RELAXED);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        value = f;
+      }
+      return emit(write, context, line, "%s%s%s%s %.9g\n", metric->name, open, labels, close, value);
+    }
+    case METRICS_TYPE_HISTOGRAM:
+      return render_histogram((const metrics_histogram_t*)metric, write, context, line);
+  }
+  return ESP_OK;
+}
+
+esp_err_t metrics_render(metrics_write_fn_t write, void* context) {
+  char line[LINE_MAX_LEN];
+  metrics_metric_t* head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+  esp_err_t ret = ESP_OK;
+
+  for (metrics_metric_t* metric = head; metric && ret == ESP_OK; metric = metric->next) {
+    // A family is rendered at its first member; skip members already covered
+    bool seen = false;
+    for (metrics_metric_t* earlier = head; earlier != metric && !seen; earlier = earlier->next) {
+      seen = strcmp(earlier->name, metric->name) == 0;
+    }
+    if (seen) {
+      continue;
+    }
+
+    ret = emit(write, context, line, "# HELP %s %s\n# TYPE %s %s\n", metric->name, metric->help ? metric->help : "",
+               metric->name, type_name(metric->type));
+    for (metrics_metric_t* member = metric; member && ret == ESP_OK; member = member->next) {
+      if (strcmp(member->name, metric->name) == 0) {
+        ret = render_sample(member, write, context, line);
+      }
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,70 @@
+#include <string.h>
+
+#include "esp_log.h"
+#include "metrics.h"
+#include "shared_httpd.h"
+
+static const char* TAG = "metrics_http";
+
+#define CHUNK_SIZE 512
+
+/**
+ * @brief Chunk assembly state, lives on the handler's stack
+ */
+typedef struct {
+  httpd_req_t* req;
+  char buffer[CHUNK_SIZE];
+  size_t len;
+} chunk_writer_t;
+
+static esp_err_t flush_chunk(chunk_writer_t* writer) {
+  esp_err_t ret = writer->len ? httpd_resp_send_chunk(writer->req, writer->buffer, writer->len) : ESP_OK;
+  writer->len = 0;
+  return ret;
+}
+
+static esp_err_t write_chunked(const char* data, size_t len, void* context) {
+  chunk_writer_t* writer = context;
+  if (writer->len + len > sizeof(writer->buffer)) {
+    esp_err_t ret = flush_chunk(writer);
+    if (ret != ESP_OK) {
+      return ret;
+    }
+  }
+  if (len > sizeof(writer->buffer)) {
+    return httpd_resp_send_chunk(writer->req, data, len);
+  }
+  memcpy(writer->buffer + writer->len, data, len);
+  writer->len += len;
+  return ESP_OK;
+}
+
+static esp_err_t metrics_handler(httpd_req_t* req) {
+  chunk_writer_t writer = {.req = req, .len = 0};
+
+  httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
+  esp_err_t ret = metrics_render(write_chunked, &writer);
+  if (ret == ESP_OK) {
+    ret = flush_chunk(&writer);
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Scrape aborted: %s", esp_err_to_name(ret));
+    return ESP_FAIL;
+  }
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+esp_err_t metrics_register_http(uint16_t port) {
+  esp_err_t ret = shared_httpd_start(port);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  httpd_uri_t metrics_uri = {
+      .uri = "/metrics",
+      .method = HTTP_GET,
+      .handler = metrics_handler,
+      .user_ctx = NULL,
+  };
+  return shared_httpd_register_uri(&metrics_uri);
+}
@@ -0,0 +1,30 @@
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "metrics.h"
+
+static double read_free_heap(void* context) { return esp_get_free_heap_size(); }
+
+static double read_min_free_heap(void* context) { return esp_get_minimum_free_heap_size(); }
+
+static double read_largest_free_block(void* context) { return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); }
+
+static double read_uptime(void* context) { return esp_timer_get_time() / 1e6; }
+
+static METRICS_GAUGE_DEFINE_FN(s_free_heap, "esp_heap_free_bytes", "Free heap", read_free_heap, NULL);
+static METRICS_GAUGE_DEFINE_FN(s_min_free_heap, "esp_heap_min_free_bytes", "Lowest free heap since boot",
+                               read_min_free_heap, NULL);
+static METRICS_GAUGE_DEFINE_FN(s_largest_free_block, "esp_heap_largest_free_block_bytes",
+                               "Largest allocatable 8-bit capable block", read_largest_free_block, NULL);
+static METRICS_GAUGE_DEFINE_FN(s_uptime, "esp_uptime_seconds", "Time since boot", read_uptime, NULL);
+
+esp_err_t metrics_register_system(void) {
+  metrics_metric_t* metrics[] = {&s_free_heap.base, &s_min_free_heap.base, &s_largest_free_block.base, &s_uptime.base};
+  for (size_t i = 0; i < sizeof(metrics) / sizeof(metrics[0]); i++) {
+    esp_err_t ret = metrics_register(metrics[i]);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+      return ret;
+    }
+  }
+  return ESP_OK;
+}
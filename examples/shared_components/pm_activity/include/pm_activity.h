@@ -0,0 +1,71 @@
+#ifndef PRODESP32_PM_ACTIVITY_H
+#define PRODESP32_PM_ACTIVITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Activity and power-management statistics
+ */
+typedef struct {
+  uint32_t active;         ///< Activities running now
+  uint32_t activities;     ///< Activities begun since boot
+  int64_t active_us;       ///< Time with at least one activity running (CPU held at max frequency)
+  int64_t uptime_us;       ///< Time since boot, to compare active_us with
+  uint32_t max_active_us;  ///< Longest single stretch with activity running
+  int max_freq_mhz;        ///< CPU frequency while active, 0 if power management is off
+  int min_freq_mhz;        ///< CPU frequency while idle, 0 if power management is off
+  bool light_sleep;        ///< Whether idle time may be spent in automatic light sleep
+} pm_activity_stats_t;
+
+/**
+ * @brief Enable dynamic frequency scaling (and optionally light sleep) and create the locks
+ *
+ * Idle, the CPU drops to CONFIG_PM_ACTIVITY_MIN_FREQ_MHZ (and sleeps with
+ * CONFIG_PM_ACTIVITY_LIGHT_SLEEP); between pm_activity_begin() and pm_activity_end() it runs at
+ * the default CPU frequency and stays awake. Without CONFIG_PM_ENABLE this only logs that the
+ * frequency stays fixed; activities are still counted.
+ *
+ * Call it early, before starting servers: activities already running when it is called are
+ * counted but do not hold the CPU up.
+ *
+ * Drivers that need a clock (a running gptimer, Wi-Fi between beacons) hold their own locks, so
+ * they keep working.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already initialized, or the esp_pm error
+ */
+esp_err_t pm_activity_init(void);
+
+/**
+ * @brief Start an activity: hold the CPU at max frequency and keep it out of light sleep
+ *
+ * Activities nest and may overlap across tasks; the CPU is released when the last one ends.
+ * Cheap enough to wrap every request. Safe to call before pm_activity_init() or without
+ * power management, in which case only the statistics change. Task context only.
+ */
+void pm_activity_begin(void);
+
+/**
+ * @brief End an activity started with pm_activity_begin()
+ */
+void pm_activity_end(void);
+
+/**
+ * @brief Copy the statistics
+ *
+ * @param out Receives the statistics, active_us including the current stretch
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if out is NULL
+ */
+esp_err_t pm_activity_get_stats(pm_activity_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_PM_ACTIVITY_H
@@ -0,0 +1,131 @@
+#include "pm_activity.h"
+
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "pm_activity";
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_initialized;
+static uint32_t s_active;
+static uint32_t s_activities;
+static int64_t s_active_since;  // Start of the current stretch with activity running
+static int64_t s_active_us;     // Completed stretches
+static uint32_t s_max_active_us;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t s_cpu_lock;    // ESP_PM_CPU_FREQ_MAX
+static esp_pm_lock_handle_t s_awake_lock;  // ESP_PM_NO_LIGHT_SLEEP
+static esp_pm_config_t s_config;
+#endif
+
+esp_err_t pm_activity_init(void) {
+  if (s_initialized) {
+    return ESP_ERR_INVALID_STATE;
+  }
+#if CONFIG_PM_ENABLE
+  esp_pm_config_t config = {
+      .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+      .min_freq_mhz = CONFIG_PM_ACTIVITY_MIN_FREQ_MHZ,
+#if CONFIG_PM_ACTIVITY_LIGHT_SLEEP
+      .light_sleep_enable = true,
+#else
+      .light_sleep_enable = false,
+#endif
+  };
+  esp_err_t ret = esp_pm_configure(&config);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to configure power management (%d-%d MHz): %s", config.min_freq_mhz, config.max_freq_mhz,
+             esp_err_to_name(ret));
+    return ret;
+  }
+
+  esp_pm_lock_handle_t cpu_lock = NULL;
+  esp_pm_lock_handle_t awake_lock = NULL;
+  ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "activity_cpu", &cpu_lock);
+  if (ret == ESP_OK) {
+    ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "activity_awake", &awake_lock);
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create PM locks: %s", esp_err_to_name(ret));
+    if (cpu_lock) {
+      esp_pm_lock_delete(cpu_lock);
+    }
+    return ret;
+  }
+
+  // An activity already running took no lock; releasing one at its end fails harmlessly
+  s_config = config;
+  s_awake_lock = awake_lock;
+  s_cpu_lock = cpu_lock;
+  ESP_LOGI(TAG, "CPU at %d MHz while active, %d MHz idle, light sleep %s", config.max_freq_mhz, config.min_freq_mhz,
+           config.light_sleep_enable ? "on" : "off");
+#else
+  ESP_LOGW(TAG, "CONFIG_PM_ENABLE is off, the CPU frequency stays fixed");
+#endif
+  s_initialized = true;
+  return ESP_OK;
+}
+
+void pm_activity_begin(void) {
+#if CONFIG_PM_ENABLE
+  // Raise the frequency before the work starts; the locks count nested acquisitions
+  if (s_cpu_lock) {
+    esp_pm_lock_acquire(s_cpu_lock);
+    esp_pm_lock_acquire(s_awake_lock);
+  }
+#endif
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&s_lock);
+  if (s_active++ == 0) {
+    s_active_since = now;
+  }
+  s_activities++;
+  portEXIT_CRITICAL(&s_lock);
+}
+
+void pm_activity_end(void) {
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&s_lock);
+  if (s_active > 0 && --s_active == 0) {
+    int64_t stretch = now - s_active_since;
+    s_active_us += stretch;
+    if (stretch > s_max_active_us) {
+      s_max_active_us = stretch > UINT32_MAX ? UINT32_MAX : (uint32_t)stretch;
+    }
+  }
+  portEXIT_CRITICAL(&s_lock);
+#if CONFIG_PM_ENABLE
+  if (s_cpu_lock) {
+    esp_pm_lock_release(s_awake_lock);
+    esp_pm_lock_release(s_cpu_lock);
+  }
+#endif
+}
+
+esp_err_t pm_activity_get_stats(pm_activity_stats_t* out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&s_lock);
+  out->active = s_active;
+  out->activities = s_activities;
+  out->active_us = s_active_us + (s_active > 0 ? now - s_active_since : 0);
+  out->max_active_us = s_max_active_us;
+  portEXIT_CRITICAL(&s_lock);
+  out->uptime_us = now;
+#if CONFIG_PM_ENABLE
+  out->max_freq_mhz = s_cpu_lock ? s_config.max_freq_mhz : 0;
+  out->min_freq_mhz = s_cpu_lock ? s_config.min_freq_mhz : 0;
+  out->light_sleep = s_cpu_lock ? s_config.light_sleep_enable : false;
+#else
+  out->max_freq_mhz = 0;
+  out->min_freq_mhz = 0;
+  out->light_sleep = false;
+#endif
+  return ESP_OK;
+}
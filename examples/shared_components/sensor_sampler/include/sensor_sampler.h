@@ -0,0 +1,141 @@
+#ifndef PRODESP32_SENSOR_SAMPLER_H
+#define PRODESP32_SENSOR_SAMPLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_SAMPLER_MAX_VALUES CONFIG_SENSOR_SAMPLER_MAX_VALUES
+
+/**
+ * @brief Handle of a registered sensor (index into the snapshot table)
+ */
+typedef int sensor_handle_t;
+
+#define SENSOR_HANDLE_INVALID (-1)
+
+/**
+ * @brief Sensor read callback
+ *
+ * Runs on the sampler task and may block on the sensor bus.
+ *
+ * @param values Output array with room for the sensor's value_count values
+ * @param context User context from the sensor configuration
+ * @return ESP_OK if the values are valid, any other code keeps the previous snapshot
+ */
+typedef esp_err_t (*sensor_read_fn_t)(float* values, void* context);
+
+/**
+ * @brief Sensor configuration
+ */
+typedef struct {
+  const char* name;        ///< Sensor name (must stay valid, used for lookup)
+  uint32_t period_ms;      ///< Sampling period
+  uint8_t value_count;     ///< Number of values per sample (1..SENSOR_SAMPLER_MAX_VALUES)
+  sensor_read_fn_t read;   ///< Read callback
+  void* context;           ///< User context passed to read
+} sensor_config_t;
+
+/**
+ * @brief Latest sample of a sensor
+ */
+typedef struct {
+  float values[SENSOR_SAMPLER_MAX_VALUES];  ///< Values from the last successful read
+  uint8_t value_count;                      ///< Number of valid entries in values
+  int64_t timestamp_us;                     ///< esp_timer time of the last successful read
+  uint32_t sample_count;                    ///< Successful reads since registration
+  uint32_t error_count;                     ///< Failed reads since registration
+  esp_err_t last_error;                     ///< Result of the most recent read
+} sensor_snapshot_t;
+
+/**
+ * @brief Register a sensor
+ *
+ * Sensors may be registered before or after sensor_sampler_start(), but registration is
+ * meant to happen from initialization code and is not safe to call concurrently.
+ *
+ * @param config Sensor configuration (copied)
+ * @param out_handle Receives the handle used for O(1) reads (optional)
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t sensor_sampler_register(const sensor_config_t* config, sensor_handle_t* out_handle);
+
+/**
+ * @brief Look up a sensor handle by name
+ *
+ * @param name Sensor name
+ * @return Handle or SENSOR_HANDLE_INVALID if no sensor has that name
+ */
+sensor_handle_t sensor_sampler_find(const char* name);
+
+/**
+ * @brief Start the sampler task
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already running
+ */
+esp_err_t sensor_sampler_start(void);
+
+/**
+ * @brief Stop the sampler task
+ *
+ * Snapshots stay readable after the sampler is stopped.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not running
+ */
+esp_err_t sensor_sampler_stop(void);
+
+/**
+ * @brief Read the latest snapshot of a sensor
+ *
+ * Lock-free and O(1): copies the snapshot under a sequence counter and retries a bounded
+ * number of times if the sampler task published a new sample during the copy. Never sleeps
+ * and never waits on the sensor bus, so it is safe from a periodic control step.
+ *
+ * @param handle Sensor handle
+ * @param out Receives the snapshot; undefined unless ESP_OK is returned
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad handle,
+ *         ESP_ERR_NOT_FOUND if the sensor has not produced a sample yet,
+ *         ESP_ERR_TIMEOUT if every retry overlapped a publish (the reader preempted the
+ *         sampler task mid-copy); keep using the previous snapshot
+ */
+esp_err_t sensor_sampler_read(sensor_handle_t handle, sensor_snapshot_t* out);
+
+/**
+ * @brief Read one value of a sensor's latest snapshot
+ *
+ * @param handle Sensor handle
+ * @param index Value index
+ * @param out_value Receives the value
+ * @param out_age_ms Receives the age of the sample in milliseconds (optional)
+ * @return ESP_OK on success, see sensor_sampler_read() for errors
+ */
+esp_err_t sensor_sampler_read_value(sensor_handle_t handle, size_t index, float* out_value, uint32_t* out_age_ms);
+
+/**
+ * @brief Get the number of registered sensors
+ *
+ * Handles are 0..count-1, so this can be used to enumerate every sensor.
+ *
+ * @return Number of registered sensors
+ */
+size_t sensor_sampler_get_count(void);
+
+/**
+ * @brief Get the name of a registered sensor
+ *
+ * @param handle Sensor handle
+ * @return Sensor name or NULL for a bad handle
+ */
+const char* sensor_sampler_get_name(sensor_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_SENSOR_SAMPLER_H
@@ -0,0 +1,239 @@
+#include "sensor_sampler.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char* TAG = "sensor_sampler";
+
+#define MAX_SENSORS CONFIG_SENSOR_SAMPLER_MAX_SENSORS
+// The publish copy takes well under a microsecond, so this many retries only run out when the
+// sampler task was preempted mid-publish by the reader itself
+#define READ_MAX_ATTEMPTS 64
+
+/**
+ * @brief Snapshot table slot (internal)
+ *
+ * The sampler task is the only writer. It fills `work` privately and publishes it into
+ * `published` under `seq`: odd while the copy is in progress, even when it is stable.
+ * Readers copy `published` and retry if `seq` was odd or changed during the copy.
+ */
+typedef struct {
+  sensor_config_t config;
+  int64_t next_due_us;
+  sensor_snapshot_t work;
+  atomic_uint seq;
+  sensor_snapshot_t published;
+} sensor_slot_t;
+
+static sensor_slot_t s_slots[MAX_SENSORS];
+static atomic_size_t s_count = 0;
+static volatile TaskHandle_t s_task = NULL;
+static volatile bool s_running = false;
+
+static void publish(sensor_slot_t* slot) {
+  unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+  atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  slot->published = slot->work;
+  atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+}
+
+static void sample(sensor_slot_t* slot) {
+  float values[SENSOR_SAMPLER_MAX_VALUES];
+  esp_err_t ret = slot->config.read(values, slot->config.context);
+
+  slot->work.last_error = ret;
+  if (ret == ESP_OK) {
+    memcpy(slot->work.values, values, slot->config.value_count * sizeof(float));
+    slot->work.timestamp_us = esp_timer_get_time();
+    slot->work.sample_count++;
+  }
+  else {
+    slot->work.error_count++;
+    ESP_LOGD(TAG, "Read of %s failed: %s", slot->config.name, esp_err_to_name(ret));
+  }
+  publish(slot);
+}
+
+static void sampler_task(void* arg) {
+  ESP_LOGI(TAG, "Sampler task started");
+
+  while (s_running) {
+    size_t count = atomic_load_explicit(&s_count, memory_order_acquire);
+    int64_t now_us = esp_timer_get_time();
+    int64_t wake_us = now_us + 1000 * 1000;
+
+    for (size_t i = 0; i < count; i++) {
+      sensor_slot_t* slot = &s_slots[i];
+      if (now_us >= slot->next_due_us) {
+        sample(slot);
+        slot->next_due_us += (int64_t)slot->config.period_ms * 1000;
+        // Skip missed periods instead of sampling back-to-back to catch up
+        now_us = esp_timer_get_time();
+        if (slot->next_due_us <= now_us) {
+          slot->next_due_us = now_us + (int64_t)slot->config.period_ms * 1000;
+        }
+      }
+      if (slot->next_due_us < wake_us) {
+        wake_us = slot->next_due_us;
+      }
+    }
+
+    int64_t wait_us = wake_us - esp_timer_get_time();
+    if (wait_us > 0) {
+      TickType_t ticks = pdMS_TO_TICKS((wait_us + 999) / 1000);
+      // Woken early by sensor_sampler_register() and sensor_sampler_stop()
+      ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+    }
+  }
+
+  ESP_LOGI(TAG, "Sampler task stopped");
+  s_task = NULL;
+  vTaskDelete(NULL);
+}
+
+esp_err_t sensor_sampler_register(const sensor_config_t* config, sensor_handle_t* out_handle) {
+  if (!config || !config->name || !config->read || config->period_ms == 0 || config->value_count == 0 ||
+      config->value_count > SENSOR_SAMPLER_MAX_VALUES) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (sensor_sampler_find(config->name) != SENSOR_HANDLE_INVALID) {
+    ESP_LOGE(TAG, "Sensor '%s' already registered", config->name);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  size_t index = atomic_load_explicit(&s_count, memory_order_relaxed);
+  if (index >= MAX_SENSORS) {
+    ESP_LOGE(TAG, "Maximum number of sensors (%d) reached", MAX_SENSORS);
+    return ESP_ERR_NO_MEM;
+  }
+
+  sensor_slot_t* slot = &s_slots[index];
+  memset(slot, 0, sizeof(*slot));
+  slot->config = *config;
+  slot->next_due_us = esp_timer_get_time();
+  slot->work.value_count = config->value_count;
+  slot->work.last_error = ESP_ERR_NOT_FINISHED;
+  slot->published = slot->work;
+  atomic_init(&slot->seq, 0);
+
+  // Make the slot visible to the sampler task and readers only once it is filled in
+  atomic_store_explicit(&s_count, index + 1, memory_order_release);
+
+  if (s_task) {
+    xTaskNotifyGive(s_task);
+  }
+  if (out_handle) {
+    *out_handle = (sensor_handle_t)index;
+  }
+
+  ESP_LOGI(TAG, "Registered sensor %s (%u values every %lu ms)", config->name, config->value_count,
+           (unsigned long)config->period_ms);
+  return ESP_OK;
+}
+
+sensor_handle_t sensor_sampler_find(const char* name) {
+  if (!name) {
+    return SENSOR_HANDLE_INVALID;
+  }
+
+  size_t count = atomic_load_explicit(&s_count, memory_order_acquire);
+  for (size_t i = 0; i < count; i++) {
+    if (strcmp(s_slots[i].config.name, name) == 0) {
+      return (sensor_handle_t)i;
+    }
+  }
+  return SENSOR_HANDLE_INVALID;
+}
+
+esp_err_t sensor_sampler_start(void) {
+  if (s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  s_running = true;
+  TaskHandle_t task = NULL;
+  BaseType_t ok = xTaskCreate(sampler_task, "sensor_sampler", CONFIG_SENSOR_SAMPLER_TASK_STACK_SIZE, NULL,
+                              CONFIG_SENSOR_SAMPLER_TASK_PRIORITY, &task);
+  if (ok != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create sampler task");
+    s_running = false;
+    return ESP_ERR_NO_MEM;
+  }
+  s_task = task;
+  return ESP_OK;
+}
+
+esp_err_t sensor_sampler_stop(void) {
+  if (!s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  s_running = false;
+  xTaskNotifyGive(s_task);
+
+  // Wait for an in-flight read to finish so the task is gone when we return
+  while (s_task) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  return ESP_OK;
+}
+
+esp_err_t sensor_sampler_read(sensor_handle_t handle, sensor_snapshot_t* out) {
+  if (!out || handle < 0 || (size_t)handle >= atomic_load_explicit(&s_count, memory_order_acquire)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sensor_slot_t* slot = &s_slots[handle];
+  for (int attempt = 0; attempt < READ_MAX_ATTEMPTS; attempt++) {
+    unsigned before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if ((before & 1) == 0) {
+      *out = slot->published;
+      atomic_thread_fence(memory_order_acquire);
+      if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == before) {
+        return out->sample_count > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+      }
+    }
+  }
+  // Never sleep here: readers include control loops that must finish their period. A
+  // higher-priority reader on the sampler's core would otherwise spin while the preempted
+  // sampler task holds the sequence odd, so give up and let the caller use its last snapshot.
+  return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t sensor_sampler_read_value(sensor_handle_t handle, size_t index, float* out_value, uint32_t* out_age_ms) {
+  if (!out_value) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sensor_snapshot_t snapshot;
+  esp_err_t ret = sensor_sampler_read(handle, &snapshot);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  if (index >= snapshot.value_count) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  *out_value = snapshot.values[index];
+  if (out_age_ms) {
+    *out_age_ms = (uint32_t)((esp_timer_get_time() - snapshot.timestamp_us) / 1000);
+  }
+  return ESP_OK;
+}
+
+size_t sensor_sampler_get_count(void) { return atomic_load_explicit(&s_count, memory_order_acquire); }
+
+const char* sensor_sampler_get_name(sensor_handle_t handle) {
+  if (handle < 0 || (size_t)handle >= sensor_sampler_get_count()) {
+    return NULL;
+  }
+  return s_slots[handle].config.name;
+}
@@ -0,0 +1,72 @@
+#ifndef PRODESP32_SHARED_HTTPD_H
+#define PRODESP32_SHARED_HTTPD_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start (or attach to) the shared HTTP server
+ *
+ * The first call starts a single httpd instance on the given port using the limits from
+ * menuconfig. Every later call attaches to the running instance and bumps its reference
+ * count. If a later caller asks for a different port a warning is logged and the caller
+ * is attached to the existing listener anyway, since the whole point is to have one.
+ *
+ * Wildcard URI matching is always enabled so modules can register catch-all patterns.
+ *
+ * @param port TCP port to listen on when the server is not running yet
+ * @return ESP_OK on success
+ */
+esp_err_t shared_httpd_start(uint16_t port);
+
+/**
+ * @brief Release a reference to the shared HTTP server
+ *
+ * The server is stopped when the last reference is released.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the server is not running
+ */
+esp_err_t shared_httpd_stop(void);
+
+/**
+ * @brief Get the handle of the shared server
+ *
+ * @return Server handle or NULL if the server is not running
+ */
+httpd_handle_t shared_httpd_get_handle(void);
+
+/**
+ * @brief Get the port the shared server is listening on
+ *
+ * @return Port number or 0 if the server is not running
+ */
+uint16_t shared_httpd_get_port(void);
+
+/**
+ * @brief Register a URI handler on the shared server
+ *
+ * @param uri URI handler description (copied by httpd)
+ * @return ESP_OK on success
+ */
+esp_err_t shared_httpd_register_uri(const httpd_uri_t* uri);
+
+/**
+ * @brief Unregister a URI handler from the shared server
+ *
+ * @param uri URI string the handler was registered with
+ * @param method HTTP method the handler was registered with
+ * @return ESP_OK on success
+ */
+esp_err_t shared_httpd_unregister_uri(const char* uri, httpd_method_t method);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_SHARED_HTTPD_H
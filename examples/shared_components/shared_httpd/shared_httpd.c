@@ -0,0 +1,156 @@
+#include "shared_httpd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "pm_activity.h"
+
+static const char* TAG = "shared_httpd";
+
+/**
+ * @brief A registered route: the caller's handler, run by activity_handler()
+ */
+typedef struct {
+  char* uri;  // NULL for a free slot
+  httpd_method_t method;
+  esp_err_t (*handler)(httpd_req_t* req);
+  void* user_ctx;
+} route_t;
+
+static httpd_handle_t s_server = NULL;
+static uint16_t s_port = 0;
+static int s_ref_count = 0;
+static route_t s_routes[CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS];
+
+// Every handler runs as a power-management activity, so the CPU is at full speed while a
+// request is served and may slow down or sleep in between
+static esp_err_t activity_handler(httpd_req_t* req) {
+  const route_t* route = (const route_t*)req->user_ctx;
+  req->user_ctx = route->user_ctx;
+  pm_activity_begin();
+  esp_err_t ret = route->handler(req);
+  pm_activity_end();
+  return ret;
+}
+
+static void free_route(route_t* route) {
+  free(route->uri);
+  memset(route, 0, sizeof(*route));
+}
+
+esp_err_t shared_httpd_start(uint16_t port) {
+  if (s_server) {
+    if (port != s_port) {
+      ESP_LOGW(TAG, "Requested port %u but shared server already listens on %u, sharing it", port, s_port);
+    }
+    s_ref_count++;
+    return ESP_OK;
+  }
+
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.server_port = port;
+  config.max_open_sockets = CONFIG_SHARED_HTTPD_MAX_OPEN_SOCKETS;
+  config.max_uri_handlers = CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS;
+  config.max_resp_headers = 8;
+  config.stack_size = CONFIG_SHARED_HTTPD_STACK_SIZE;
+  config.uri_match_fn = httpd_uri_match_wildcard;
+#if CONFIG_SHARED_HTTPD_LRU_PURGE
+  config.lru_purge_enable = true;
+#endif
+
+  esp_err_t ret = httpd_start(&s_server, &config);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(ret));
+    s_server = NULL;
+    return ret;
+  }
+
+  s_port = port;
+  s_ref_count = 1;
+  ESP_LOGI(TAG, "Shared HTTP server started on port %u (%d sockets, %d handlers)", port,
+           CONFIG_SHARED_HTTPD_MAX_OPEN_SOCKETS, CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS);
+  return ESP_OK;
+}
+
+esp_err_t shared_httpd_stop(void) {
+  if (!s_server) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  if (--s_ref_count > 0) {
+    return ESP_OK;
+  }
+
+  esp_err_t ret = httpd_stop(s_server);
+  for (size_t i = 0; i < CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS; i++) {
+    free_route(&s_routes[i]);
+  }
+  s_server = NULL;
+  s_port = 0;
+  s_ref_count = 0;
+  ESP_LOGI(TAG, "Shared HTTP server stopped");
+  return ret;
+}
+
+httpd_handle_t shared_httpd_get_handle(void) { return s_server; }
+
+uint16_t shared_httpd_get_port(void) { return s_port; }
+
+esp_err_t shared_httpd_register_uri(const httpd_uri_t* uri) {
+  if (!uri) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_server) {
+    ESP_LOGE(TAG, "Cannot register %s, server not running", uri->uri);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  route_t* route = NULL;
+  for (size_t i = 0; i < CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS && !route; i++) {
+    if (!s_routes[i].uri) {
+      route = &s_routes[i];
+    }
+  }
+  if (!route) {
+    ESP_LOGE(TAG, "Cannot register %s, all %d handlers in use", uri->uri, CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS);
+    return ESP_ERR_HTTPD_HANDLERS_FULL;
+  }
+  route->uri = strdup(uri->uri);
+  if (!route->uri) {
+    return ESP_ERR_NO_MEM;
+  }
+  route->method = uri->method;
+  route->handler = uri->handler;
+  route->user_ctx = uri->user_ctx;
+
+  httpd_uri_t wrapped = *uri;
+  wrapped.handler = activity_handler;
+  wrapped.user_ctx = route;
+  esp_err_t ret = httpd_register_uri_handler(s_server, &wrapped);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to register %s: %s", uri->uri, esp_err_to_name(ret));
+    free_route(route);
+  }
+  return ret;
+}
+
+esp_err_t shared_httpd_unregister_uri(const char* uri, httpd_method_t method) {
+  if (!uri) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_server) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  esp_err_t ret = httpd_unregister_uri_handler(s_server, uri, method);
+  if (ret == ESP_OK) {
+    for (size_t i = 0; i < CONFIG_SHARED_HTTPD_MAX_URI_HANDLERS; i++) {
+      if (s_routes[i].uri && s_routes[i].method == method && strcmp(s_routes[i].uri, uri) == 0) {
+        free_route(&s_routes[i]);
+        break;
+      }
+    }
+  }
+  return ret;
+}
@@ -2,10 +2,14 @@
 #define SIMPLE_CLI_H
 
 #include <array>
+#include <atomic>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 #include "esp_console.h"
 #include "esp_linenoise.h"
+#include "sdkconfig.h"
 
 /**
  * @brief User command registration
@@ -49,7 +53,14 @@ enum class SimpleCLIInterface {
 
 class SimpleCLI {
  public:
-  SimpleCLI(const std::string prompt, SimpleCLIInterface interface) : prompt_(prompt), interface_(interface) {}
+  /**
+   * @param prompt Prompt shown before each line (copied)
+   * @param interface I/O interface
+   * @param resource Memory resource for the CLI's own allocations, such as one from heap_resource
+   */
+  SimpleCLI(std::string_view prompt, SimpleCLIInterface interface,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : prompt_(prompt, resource), interface_(interface) {}
   ~SimpleCLI() = default;
 
   // Register commands from a std::array - size is automatically deduced
@@ -64,16 +75,22 @@ class SimpleCLI {
 
   void start();
   void run_repl();
+
+  /**
+   * @brief End the CLI task after the line it is waiting for
+   *
+   * The console and its commands stay registered; esp_console_deinit() drops them.
+   */
   void stop();
 
  private:
-  const std::string prompt_;
+  const std::pmr::string prompt_;
   SimpleCLIInterface interface_;
 
-  bool cli_running_ = false;
+  std::atomic<bool> cli_running_{false};
   int cli_in_fd = -1;
   int cli_out_fd = -1;
-  esp_linenoise_handle_t linenoise_handle;
+  esp_linenoise_handle_t linenoise_handle = NULL;
 
 #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT)
   void configure_linenoise_uart();
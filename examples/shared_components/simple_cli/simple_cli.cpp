@@ -9,6 +9,8 @@
 #include "esp_log.h"
 #include "esp_vfs_dev.h"
 #include "freertos/task.h"
+#include "pm_activity.h"
+#include "sdkconfig.h"
 
 #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT)
 #include "driver/uart.h"
@@ -111,6 +113,7 @@ void SimpleCLI::configure_linenoise_usb() {
 static void cli_thread(void* params) {
   SimpleCLI* cli = static_cast<SimpleCLI*>(params);
   cli->run_repl();
+  vTaskDelete(NULL);
 }
 
 void SimpleCLI::start() {
@@ -148,9 +151,10 @@ void SimpleCLI::start() {
 
   // 3. Start the CLI loop on a separate thread
   cli_running_ = true;
-  xTaskCreate(cli_thread, "cli_thread", 4096, this, tskIDLE_PRIORITY + 5, NULL);
+  xTaskCreate(cli_thread, "cli_thread", CONFIG_SIMPLE_CLI_TASK_STACK_SIZE, this, tskIDLE_PRIORITY + 5, NULL);
 }
 
+// The REPL checks the flag between lines, so the task ends once the pending read returns
 void SimpleCLI::stop() { cli_running_ = false; }
 
 void SimpleCLI::run_repl() {
@@ -165,7 +169,7 @@ void SimpleCLI::run_repl() {
 
   char buffer[128];
 
-  while (true) {
+  while (cli_running_) {
     memset(buffer, 0, sizeof(buffer));
     esp_err_t err = esp_linenoise_get_line(linenoise_handle, buffer, sizeof(buffer));
     if (err != ESP_OK) { /* Continue on EOF or error */
@@ -174,7 +178,10 @@ void SimpleCLI::run_repl() {
 
     int ret = 0;
     if (strlen(buffer) != 0) {
+      // Commands run at full CPU speed; waiting for input does not hold it
+      pm_activity_begin();
       esp_err_t err = esp_console_run(buffer, &ret);
+      pm_activity_end();
       if (err == ESP_ERR_NOT_FOUND) {
         printf("Unrecognized command\n");
       }
@@ -189,6 +196,9 @@ void SimpleCLI::run_repl() {
       }
     }
   }
+
+  esp_linenoise_delete_instance(linenoise_handle);
+  linenoise_handle = NULL;
 }
 
 void SimpleCLI::register_command(const esp_console_cmd_t& command) {
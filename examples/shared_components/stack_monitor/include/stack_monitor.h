@@ -0,0 +1,72 @@
+#ifndef PRODESP32_STACK_MONITOR_H
+#define PRODESP32_STACK_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Lowest free stack seen for one task name
+ *
+ * Tasks that share a name (one per connection, say) share an entry, which keeps the worst of
+ * them.
+ */
+typedef struct {
+  char name[configMAX_TASK_NAME_LEN];
+  uint32_t free_min;  ///< Smallest stack high-water mark seen, in bytes never touched
+  uint32_t samples;   ///< Samples that saw the task
+} stack_monitor_task_t;
+
+/**
+ * @brief Sample every task every CONFIG_STACK_MONITOR_SAMPLE_MS on the timer wheel
+ *
+ * The high-water mark only grows, so sampling mainly catches tasks before they exit. With
+ * CONFIG_STACK_MONITOR_LOG_INTERVAL_S set, the table is also logged periodically for
+ * stack_report.py.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already started or the timer wheel is not
+ *         started
+ */
+esp_err_t stack_monitor_start(void);
+
+/**
+ * @brief Sample every task now
+ *
+ * Call it at the end of a load test, so every task has its final high-water mark recorded.
+ */
+void stack_monitor_sample(void);
+
+/**
+ * @brief Copy the table
+ *
+ * @param out Receives up to max entries, in the order tasks were first seen
+ * @param max Capacity of out
+ * @return Number of entries copied
+ */
+size_t stack_monitor_get(stack_monitor_task_t* out, size_t max);
+
+/**
+ * @brief Log one line per task, in the form stack_report.py reads
+ *
+ * @code
+ * I (61234) stack_monitor: STACK task=httpd free_min=5120 samples=60
+ * @endcode
+ */
+void stack_monitor_log(void);
+
+/**
+ * @brief Forget every task
+ */
+void stack_monitor_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_STACK_MONITOR_H
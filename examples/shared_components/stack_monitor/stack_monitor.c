@@ -0,0 +1,134 @@
+#include "stack_monitor.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "timer_wheel.h"
+
+#if !CONFIG_FREERTOS_USE_TRACE_FACILITY
+#error "stack_monitor needs CONFIG_FREERTOS_USE_TRACE_FACILITY=y for uxTaskGetSystemState()"
+#endif
+
+static const char* TAG = "stack_monitor";
+
+static stack_monitor_task_t s_tasks[CONFIG_STACK_MONITOR_MAX_TASKS];
+static size_t s_task_count;
+static uint32_t s_dropped;  // Tasks seen that did not fit in the table or in one sample
+
+// Scratch for uxTaskGetSystemState(), static so a sample does not need 1-2 KB of stack
+static TaskStatus_t s_status[CONFIG_STACK_MONITOR_MAX_TASKS];
+
+static StaticSemaphore_t s_lock_storage;
+static SemaphoreHandle_t s_lock = NULL;
+static portMUX_TYPE s_init_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static timer_wheel_timer_t s_timer;
+static uint32_t s_ms_since_log;
+
+// Sampling works without stack_monitor_start(), so the lock is created on first use
+static SemaphoreHandle_t get_lock(void) {
+  portENTER_CRITICAL(&s_init_lock);
+  if (!s_lock) {
+    s_lock = xSemaphoreCreateMutexStatic(&s_lock_storage);
+  }
+  portEXIT_CRITICAL(&s_init_lock);
+  return s_lock;
+}
+
+static stack_monitor_task_t* find_or_add(const char* name) {
+  for (size_t i = 0; i < s_task_count; i++) {
+    if (strncmp(s_tasks[i].name, name, sizeof(s_tasks[i].name)) == 0) {
+      return &s_tasks[i];
+    }
+  }
+  if (s_task_count == CONFIG_STACK_MONITOR_MAX_TASKS) {
+    return NULL;
+  }
+  stack_monitor_task_t* task = &s_tasks[s_task_count++];
+  strlcpy(task->name, name, sizeof(task->name));
+  task->free_min = UINT32_MAX;
+  task->samples = 0;
+  return task;
+}
+
+void stack_monitor_sample(void) {
+  SemaphoreHandle_t lock = get_lock();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  // Fills nothing at all if there are more tasks than entries
+  UBaseType_t count = uxTaskGetSystemState(s_status, CONFIG_STACK_MONITOR_MAX_TASKS, NULL);
+  if (count == 0) {
+    s_dropped += uxTaskGetNumberOfTasks();
+  }
+  for (UBaseType_t i = 0; i < count; i++) {
+    stack_monitor_task_t* task = find_or_add(s_status[i].pcTaskName);
+    if (!task) {
+      s_dropped++;
+      continue;
+    }
+    // ESP-IDF reports the high-water mark in bytes
+    if (s_status[i].usStackHighWaterMark < task->free_min) {
+      task->free_min = s_status[i].usStackHighWaterMark;
+    }
+    task->samples++;
+  }
+  xSemaphoreGive(lock);
+}
+
+size_t stack_monitor_get(stack_monitor_task_t* out, size_t max) {
+  SemaphoreHandle_t lock = get_lock();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  size_t count = s_task_count < max ? s_task_count : max;
+  memcpy(out, s_tasks, count * sizeof(*out));
+  xSemaphoreGive(lock);
+  return count;
+}
+
+void stack_monitor_log(void) {
+  SemaphoreHandle_t lock = get_lock();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  for (size_t i = 0; i < s_task_count; i++) {
+    ESP_LOGI(TAG, "STACK task=%s free_min=%lu samples=%lu", s_tasks[i].name, (unsigned long)s_tasks[i].free_min,
+             (unsigned long)s_tasks[i].samples);
+  }
+  if (s_dropped > 0) {
+    ESP_LOGW(TAG, "%lu task samples dropped, raise CONFIG_STACK_MONITOR_MAX_TASKS", (unsigned long)s_dropped);
+  }
+  xSemaphoreGive(lock);
+}
+
+void stack_monitor_reset(void) {
+  SemaphoreHandle_t lock = get_lock();
+  xSemaphoreTake(lock, portMAX_DELAY);
+  s_task_count = 0;
+  s_dropped = 0;
+  xSemaphoreGive(lock);
+}
+
+static void sample_timer(void* arg) {
+  stack_monitor_sample();
+  if (CONFIG_STACK_MONITOR_LOG_INTERVAL_S == 0) {
+    return;
+  }
+  s_ms_since_log += CONFIG_STACK_MONITOR_SAMPLE_MS;
+  if (s_ms_since_log >= CONFIG_STACK_MONITOR_LOG_INTERVAL_S * 1000u) {
+    s_ms_since_log = 0;
+    stack_monitor_log();
+  }
+}
+
+esp_err_t stack_monitor_start(void) {
+  if (timer_wheel_is_pending(&s_timer)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer_wheel_timer_init(&s_timer, "stack_monitor", sample_timer, NULL);
+  esp_err_t ret = timer_wheel_schedule_periodic(&s_timer, CONFIG_STACK_MONITOR_SAMPLE_MS);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to schedule sampling: %s", esp_err_to_name(ret));
+    return ret;
+  }
+  ESP_LOGI(TAG, "Sampling task stacks every %d ms", CONFIG_STACK_MONITOR_SAMPLE_MS);
+  return ESP_OK;
+}
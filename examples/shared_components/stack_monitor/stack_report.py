@@ -0,0 +1,323 @@
+#!/usr/bin/env python3
+"""
+Size FreeRTOS task stacks from static analysis and runtime measurements.
+
+Static: a build compiled with -fcallgraph-info=su leaves a .ci file next to every object,
+holding each function's frame size (the -fstack-usage figure) and its calls. The worst-case
+stack of a task is its entry function's frame plus the deepest chain of calls below it. Task
+entry points and their stack sizes are found by scanning the sources for xTaskCreate().
+
+Runtime: stack_monitor logs the smallest free stack seen per task as
+"STACK task=<name> free_min=<bytes>" lines. Capture the serial output while the device is
+under load and pass the file with --log.
+
+For each task the recommendation is the larger of the static bound and the measured use, plus
+a margin, rounded up. An incomplete static bound still counts, as a floor: no recommendation
+goes below it. A stack is only shrunk when there is a complete static bound or a measurement
+to back it. With --apply, sizes set by a CONFIG_ option are
+written to an sdkconfig.defaults file:
+
+    idf.py build
+    idf.py monitor | tee load.log          # while running the load test
+    python stack_report.py --build build --src .. --log load.log
+    python stack_report.py --build build --src .. --log load.log --apply sdkconfig.defaults
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+NODE_RE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE_RE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+FRAME_RE = re.compile(r"\\n(\d+) bytes \(([a-z,]+)\)")
+CXX_NAME_RE = re.compile(r"([A-Za-z_]\w*)\s*\(")
+TASK_CREATE_RE = re.compile(
+    r"xTaskCreate(?:PinnedToCore|Static)?\s*\(\s*([A-Za-z_]\w*)\s*,\s*([^,]+?)\s*,\s*([^,]+?)\s*,", re.S
+)
+STACK_LINE_RE = re.compile(r"STACK task=(\S+) free_min=(\d+)")
+CONFIG_RE = re.compile(r"^(CONFIG_\w+)=(.*)$")
+
+# Tasks ESP-IDF creates for components in this repo: (task name, entry function, stack size)
+KNOWN_TASKS = [
+    ("httpd", "httpd_thread", "CONFIG_SHARED_HTTPD_STACK_SIZE"),
+]
+
+INDIRECT = "__indirect_call"
+
+
+class Function:
+    def __init__(self, name, frame, dynamic):
+        self.name = name
+        self.frame = frame
+        self.dynamic = dynamic  # Frame grows at run time without a known bound (alloca, VLA)
+        self.calls = set()
+
+
+class CallGraph:
+    def __init__(self):
+        self.functions = {}  # Node title -> Function, for functions compiled with the flag
+        self.by_name = {}  # Bare name -> titles, to find static functions ("file.c:name")
+        self.pending_edges = []
+
+    def load(self, build_dir):
+        count = 0
+        for root, _, files in os.walk(build_dir):
+            for file in files:
+                if file.endswith(".ci"):
+                    self._load_file(os.path.join(root, file))
+                    count += 1
+        # Resolved after every file is read, since callers usually come before callees
+        for unit, source, target in self.pending_edges:
+            self.functions[source].calls.add(self._resolve(target, unit))
+        return count
+
+    def _load_file(self, path):
+        with open(path, errors="replace") as f:
+            text = f.read()
+        unit = path  # Static functions are resolved within their own file first
+        for title, label in NODE_RE.findall(text):
+            match = FRAME_RE.search(label)
+            if not match:
+                continue  # Declared here, defined elsewhere (or not compiled with the flag)
+            qualifiers = match.group(2).split(",")
+            dynamic = "dynamic" in qualifiers and "bounded" not in qualifiers
+            # The label starts with the source name: "leaf" in C, "void S::run()" in C++
+            display = label.split("\\n")[0]
+            cxx_name = CXX_NAME_RE.search(display)
+            key = (unit, title) if ":" in title else title
+            self.functions[key] = Function(display, int(match.group(1)), dynamic)
+            self.by_name.setdefault(cxx_name.group(1) if cxx_name else display, []).append(key)
+        for source, target in EDGE_RE.findall(text):
+            source_key = (unit, source) if ":" in source else source
+            if source_key in self.functions:
+                self.pending_edges.append((unit, source_key, target))
+
+    def _resolve(self, title, unit):
+        if ":" in title and (unit, title) in self.functions:
+            return (unit, title)
+        return title
+
+    def find(self, name):
+        """Function key for a bare function name, or None (also None if ambiguous)."""
+        if name in self.functions:
+            return name
+        keys = self.by_name.get(name, [])
+        return keys[0] if len(keys) == 1 else None
+
+    def worst_case(self, key):
+        """(bytes, path, problems) for the deepest call chain starting at key."""
+        memo = {}
+        return self._worst(key, memo, set())
+
+    def _worst(self, key, memo, active):
+        if key in memo:
+            return memo[key]
+        function = self.functions[key]
+        problems = set()
+        if function.dynamic:
+            problems.add(f"dynamic frame in {function.name}")
+        active.add(key)
+        deepest, deepest_path = 0, []
+        for callee in sorted(function.calls, key=str):
+            if callee == INDIRECT:
+                problems.add(f"indirect call in {function.name}")
+                continue
+            if callee in active:
+                problems.add(f"recursion through {function.name}")
+                continue
+            if callee not in self.functions:
+                problems.add(f"unknown callee {callee}")
+                continue
+            depth, path, callee_problems = self._worst(callee, memo, active)
+            problems |= callee_problems
+            if depth > deepest:
+                deepest, deepest_path = depth, path
+        active.discard(key)
+        result = (function.frame + deepest, [function.name] + deepest_path, problems)
+        memo[key] = result
+        return result
+
+
+def read_sdkconfig(path):
+    config = {}
+    if path and os.path.exists(path):
+        with open(path) as f:
+            for line in f:
+                match = CONFIG_RE.match(line.strip())
+                if match:
+                    config[match.group(1)] = match.group(2).strip('"')
+    return config
+
+
+def resolve_size(expression, source_text, config):
+    """Stack size of an xTaskCreate() argument: a number, a CONFIG_ option or a #define."""
+    expression = expression.strip()
+    for _ in range(4):  # Macros defined in terms of other macros
+        for name in set(re.findall(r"[A-Za-z_]\w*", expression)):
+            if name in config:
+                value = config[name]
+            else:
+                define = re.search(rf"^\s*#define\s+{name}\s+(.+?)\s*$", source_text, re.M)
+                if not define:
+                    continue
+                value = define.group(1)
+            expression = re.sub(rf"\b{name}\b", f"({value})", expression)
+    if not re.fullmatch(r"[\d\s()+\-*/]+", expression):
+        return None
+    return int(eval(expression))  # Digits and arithmetic only, checked above
+
+
+def find_tasks(src_dirs, config):
+    """Tasks created in the sources: (name, entry, size expression, size) per task."""
+    tasks = []
+    for src_dir in src_dirs:
+        for root, dirs, files in os.walk(src_dir):
+            dirs[:] = [d for d in dirs if d not in ("build", "managed_components") and not d.startswith(".")]
+            for file in files:
+                if not file.endswith((".c", ".cpp")):
+                    continue
+                with open(os.path.join(root, file), errors="replace") as f:
+                    text = f.read()
+                for entry, name, size in TASK_CREATE_RE.findall(text):
+                    literal = re.fullmatch(r'"([^"]*)"', name)
+                    tasks.append((literal.group(1) if literal else None, entry, size, resolve_size(size, text, config)))
+    for name, entry, size in KNOWN_TASKS:
+        if size in config:  # Only if the project uses the component
+            tasks.append((name, entry, size, resolve_size(size, "", config)))
+    return tasks
+
+
+def read_logs(paths):
+    free_min = {}
+    for path in paths:
+        with open(path, errors="replace") as f:
+            for line in f:
+                match = STACK_LINE_RE.search(line)
+                if match:
+                    name, free = match.group(1), int(match.group(2))
+                    free_min[name] = min(free, free_min.get(name, free))
+    return free_min
+
+
+def round_up(value, step):
+    return (value + step - 1) // step * step
+
+
+def recommend(size, static_bound, static_complete, measured_use, args):
+    """Recommended size and a reason, or (None, reason) to keep the current size.
+
+    The static bound is always a floor, complete or not: an incomplete one is still the least
+    the task needs, so nothing is recommended below it plus the margin. Only a complete bound
+    or a measurement can shrink a stack, and reasons resting on an incomplete bound say so.
+    """
+    evidence = [value for value in (static_bound, measured_use) if value is not None]
+    if not evidence:
+        return None, "no static bound and no measurement"
+    need = max(evidence)
+    recommended = max(args.min_size, round_up(int(need * (1 + args.margin / 100.0)) + args.headroom, args.step))
+    lower_bound = static_bound is not None and not static_complete
+    note = " (static bound incomplete)" if lower_bound else ""
+    if size is None:
+        return recommended, "size unknown" + note
+    if recommended > size:
+        return recommended, "too small" + note
+    if size - recommended < args.step:
+        return None, "fits" + note
+    if lower_bound and measured_use is None:
+        return None, "not shrunk, static bound incomplete and no measurement"
+    return recommended, "oversized" + note
+
+
+def apply_defaults(path, values):
+    lines = []
+    if os.path.exists(path):
+        with open(path) as f:
+            lines = f.read().splitlines()
+    written = set()
+    for i, line in enumerate(lines):
+        match = CONFIG_RE.match(line.strip())
+        if match and match.group(1) in values:
+            lines[i] = f"{match.group(1)}={values[match.group(1)]}"
+            written.add(match.group(1))
+    remaining = [option for option in values if option not in written]
+    if remaining:
+        if lines and lines[-1].strip():
+            lines.append("")
+        lines.append("# Task stack sizes from stack_report.py")
+        lines += [f"{option}={values[option]}" for option in sorted(remaining)]
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--build", help="Build directory compiled with -fcallgraph-info=su")
+    parser.add_argument("--src", action="append", default=[], help="Source directory to scan for xTaskCreate()")
+    parser.add_argument("--sdkconfig", help="sdkconfig to resolve CONFIG_ sizes (default: <build>/sdkconfig)")
+    parser.add_argument("--log", action="append", default=[], help="Serial log with stack_monitor STACK lines")
+    parser.add_argument("--margin", type=float, default=25.0, help="Percent added to the need (default 25)")
+    parser.add_argument("--headroom", type=int, default=512, help="Bytes added for interrupt frames (default 512)")
+    parser.add_argument("--step", type=int, default=256, help="Round sizes up to this (default 256)")
+    parser.add_argument("--min-size", type=int, default=2048, help="Never recommend less (default 2048)")
+    parser.add_argument("--apply", metavar="SDKCONFIG_DEFAULTS", help="Write CONFIG_ sizes to this file")
+    args = parser.parse_args()
+    sys.setrecursionlimit(20000)  # Call chains through ESP-IDF run deep
+
+    config = read_sdkconfig(args.sdkconfig or (args.build and os.path.join(args.build, "sdkconfig")))
+    graph = CallGraph()
+    if args.build:
+        if graph.load(args.build) == 0:
+            print(f"No .ci files under {args.build}; build with -fcallgraph-info=su", file=sys.stderr)
+    measured = read_logs(args.log)
+
+    rows = []
+    seen = set()
+    for name, entry, size_expression, size in find_tasks(args.src, config):
+        static_bound, static_complete, path, problems = None, False, [], set()
+        key = graph.find(entry)
+        if key is not None:
+            static_bound, path, problems = graph.worst_case(key)
+            static_complete = not problems
+        free = measured.get(name) if name else None
+        measured_use = size - free if free is not None and size is not None else None
+        recommended, reason = recommend(size, static_bound, static_complete, measured_use, args)
+        rows.append((name or f"<{entry}>", entry, size_expression, size, static_bound, static_complete, problems, path,
+                     measured_use, recommended, reason))
+        seen.add(name)
+
+    print(f"{'task':<16} {'size':>6} {'static':>8} {'measured':>8} {'recommend':>9}  note")
+    changes = {}
+    saved = 0
+    for name, entry, expression, size, bound, complete, problems, path, use, recommended, reason in rows:
+        static_text = "-" if bound is None else f"{bound}{'' if complete else '+'}"
+        use_text = "-" if use is None else str(use)
+        recommended_text = "-" if recommended is None else str(recommended)
+        print(f"{name:<16} {size if size is not None else '?':>6} {static_text:>8} {use_text:>8} {recommended_text:>9}"
+              f"  {reason}")
+        if path:
+            print(f"{'':<16} deepest: {' > '.join(path[:8])}{' > ...' if len(path) > 8 else ''}")
+        for problem in sorted(problems)[:3]:
+            print(f"{'':<16} lower bound only: {problem}")
+        if recommended is not None and expression.startswith("CONFIG_"):
+            changes[expression] = recommended
+            if size is not None:
+                saved += size - recommended
+    for name in sorted(set(measured) - seen):
+        print(f"{name:<16} {'?':>6} {'-':>8} {'-':>8} {'-':>9}  free_min {measured[name]} (not created in the sources)")
+
+    if not changes:
+        print("\nNo CONFIG_ sizes to change")
+    elif saved >= 0:
+        print(f"\nThe CONFIG_ sizes above free {saved} bytes of task stacks")
+    else:
+        print(f"\nThe CONFIG_ sizes above take {-saved} more bytes of task stacks")
+    if args.apply and changes:
+        apply_defaults(args.apply, changes)
+        print(f"Wrote {len(changes)} sizes to {args.apply}; delete the build's sdkconfig or run idf.py reconfigure")
+
+
+if __name__ == "__main__":
+    main()
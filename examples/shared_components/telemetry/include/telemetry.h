@@ -0,0 +1,92 @@
+#ifndef PRODESP32_TELEMETRY_H
+#define PRODESP32_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Uplink configuration
+ */
+typedef struct {
+  const char* url;             ///< Collector endpoint, batches are POSTed here (http:// or https://)
+  const char* device_id;       ///< Identifier sent in every batch header
+  const char* spill_path;      ///< Directory for batches that could not be sent, NULL to keep them in RAM only
+  uint32_t flush_interval_ms;  ///< Maximum age of a batch before it is sent even if not full
+} telemetry_config_t;
+
+/**
+ * @brief Default configuration: no spill directory, batches sent at least every 10 s
+ */
+#define TELEMETRY_DEFAULT_CONFIG(collector_url)                                                 \
+  {                                                                                             \
+    .url = (collector_url), .device_id = "esp32", .spill_path = NULL, .flush_interval_ms = 10000, \
+  }
+
+/**
+ * @brief Uplink statistics
+ */
+typedef struct {
+  uint32_t records;        ///< Records accepted
+  uint32_t dropped;        ///< Records dropped because both batch buffers were full
+  uint32_t batches_sent;   ///< Batches acknowledged by the collector
+  uint32_t bytes_sent;     ///< Batch bytes acknowledged by the collector
+  uint32_t send_failures;  ///< Failed POST attempts
+  uint32_t spilled;        ///< Batches written to the spill directory
+  uint32_t spill_dropped;  ///< Spilled batches deleted unsent because the spill queue was full
+  uint32_t spill_pending;  ///< Batches currently waiting in the spill directory
+} telemetry_stats_t;
+
+/**
+ * @brief Start the uplink task
+ *
+ * The spill directory must be on a mounted file system. Batches left there by a previous
+ * run are sent first.
+ *
+ * @param config Uplink configuration (strings must stay valid)
+ * @return ESP_OK on success
+ */
+esp_err_t telemetry_init(const telemetry_config_t* config);
+
+/**
+ * @brief Record a metric sample, timestamped now
+ *
+ * Only encodes into the RAM batch; never blocks on the network. Safe from any task.
+ *
+ * @param name Metric name (up to 32 bytes)
+ * @param value Sample value, sent with 0.001 resolution
+ * @return ESP_OK, ESP_ERR_NO_MEM if the record was dropped
+ */
+esp_err_t telemetry_metric(const char* name, float value);
+
+/**
+ * @brief Record an event, timestamped now
+ *
+ * @param name Event name (up to 32 bytes)
+ * @param detail Optional detail string, may be NULL
+ * @return ESP_OK, ESP_ERR_NO_MEM if the record was dropped
+ */
+esp_err_t telemetry_event(const char* name, const char* detail);
+
+/**
+ * @brief Send the current batch now instead of waiting for it to fill or age out
+ *
+ * Asynchronous; the uplink task does the sending.
+ */
+esp_err_t telemetry_flush(void);
+
+/**
+ * @brief Get a copy of the uplink statistics
+ */
+esp_err_t telemetry_get_stats(telemetry_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_TELEMETRY_H
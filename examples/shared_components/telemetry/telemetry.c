@@ -0,0 +1,415 @@
+#include "telemetry.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "esp_crt_bundle.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "telemetry_batch.h"
+
+static const char* TAG = "telemetry";
+
+#define BATCH_SIZE CONFIG_TELEMETRY_BATCH_SIZE
+#define SPILL_MAX_FILES CONFIG_TELEMETRY_SPILL_MAX_FILES
+#define BACKOFF_MIN_MS 1000
+#define BACKOFF_MAX_MS 60000
+#define PATH_MAX_LEN 96
+
+static telemetry_config_t s_config;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+
+// Double buffer: producers fill s_batches[s_fill] while the uplink task sends the other
+// one. s_sealed is set while the other buffer holds a batch waiting to be sent.
+static telemetry_batch_t s_batches[2];
+static int s_fill = 0;
+static bool s_sealed = false;
+static int64_t s_fill_started_us = 0;
+static volatile bool s_flush_requested = false;
+
+// Spill queue <spill_path>/<seq>.tb, oldest first; owned by the uplink task
+static bool s_spill_any = false;
+static uint32_t s_spill_first = 0;
+static uint32_t s_spill_last = 0;
+static uint8_t* s_spill_buffer = NULL;
+
+static telemetry_stats_t s_stats;
+static esp_http_client_handle_t s_client = NULL;
+
+static int64_t now_ms(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/**
+ * @brief Hand the filling batch to the uplink task and start an empty one (lock held)
+ */
+static void seal_locked(void) {
+  s_sealed = true;
+  s_fill ^= 1;
+  telemetry_batch_reset(&s_batches[s_fill]);
+}
+
+typedef struct {
+  int64_t ts;
+  const char* name;
+  float value;
+  const char* detail;
+  bool is_event;
+} record_t;
+
+static bool add_record(telemetry_batch_t* batch, const record_t* record) {
+  if (record->is_event) {
+    return telemetry_batch_add_event(batch, record->ts, record->name, record->detail);
+  }
+  return telemetry_batch_add_metric(batch, record->ts, record->name, record->value);
+}
+
+static esp_err_t record(const record_t* rec) {
+  if (!s_lock) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  bool wake = false;
+  esp_err_t ret = ESP_OK;
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  telemetry_batch_t* batch = &s_batches[s_fill];
+  bool added = add_record(batch, rec);
+  if (!added && batch->records > 0 && !s_sealed) {
+    seal_locked();
+    wake = true;
+    batch = &s_batches[s_fill];
+    added = add_record(batch, rec);
+  }
+
+  if (added) {
+    if (batch->records == 1) {
+      s_fill_started_us = esp_timer_get_time();
+    }
+    s_stats.records++;
+  }
+  else {
+    // Both buffers full (uplink down without a spill directory) or the record is too large
+    s_stats.dropped++;
+    ret = ESP_ERR_NO_MEM;
+  }
+  xSemaphoreGive(s_lock);
+
+  if (wake) {
+    xTaskNotifyGive(s_task);
+  }
+  return ret;
+}
+
+esp_err_t telemetry_metric(const char* name, float value) {
+  if (!name) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const record_t rec = {.ts = now_ms(), .name = name, .value = value};
+  return record(&rec);
+}
+
+esp_err_t telemetry_event(const char* name, const char* detail) {
+  if (!name) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const record_t rec = {.ts = now_ms(), .name = name, .detail = detail, .is_event = true};
+  return record(&rec);
+}
+
+esp_err_t telemetry_flush(void) {
+  if (!s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  s_flush_requested = true;
+  xTaskNotifyGive(s_task);
+  return ESP_OK;
+}
+
+esp_err_t telemetry_get_stats(telemetry_stats_t* out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_lock) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  *out = s_stats;
+  xSemaphoreGive(s_lock);
+  return ESP_OK;
+}
+
+/**
+ * @brief POST one batch on the persistent connection
+ *
+ * esp_http_client keeps the connection open between calls (keep-alive), so the TCP and
+ * TLS handshakes are paid once per connection instead of once per batch.
+ */
+static esp_err_t post_batch(const uint8_t* data, size_t len) {
+  esp_http_client_set_post_field(s_client, (const char*)data, (int)len);
+  esp_err_t ret = esp_http_client_perform(s_client);
+  int status = ret == ESP_OK ? esp_http_client_get_status_code(s_client) : 0;
+
+  if (ret == ESP_OK && status / 100 == 2) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.batches_sent++;
+    s_stats.bytes_sent += len;
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+  }
+
+  ESP_LOGW(TAG, "Upload failed: %s (status %d)", esp_err_to_name(ret), status);
+  // Drop the connection so the next attempt starts from a clean one
+  esp_http_client_close(s_client);
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  s_stats.send_failures++;
+  xSemaphoreGive(s_lock);
+  return ESP_FAIL;
+}
+
+static void spill_file_path(uint32_t seq, char* path, size_t size) {
+  snprintf(path, size, "%s/%08lu.tb", s_config.spill_path, (unsigned long)seq);
+}
+
+static uint32_t spill_count(void) { return s_spill_any ? s_spill_last - s_spill_first + 1 : 0; }
+
+static void update_spill_stats(uint32_t spilled, uint32_t dropped) {
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  s_stats.spilled += spilled;
+  s_stats.spill_dropped += dropped;
+  s_stats.spill_pending = spill_count();
+  xSemaphoreGive(s_lock);
+}
+
+static void spill_recover(void) {
+  if (mkdir(s_config.spill_path, 0755) != 0 && errno != EEXIST) {
+    ESP_LOGE(TAG, "Failed to create %s: %s", s_config.spill_path, strerror(errno));
+    return;
+  }
+
+  DIR* dir = opendir(s_config.spill_path);
+  if (!dir) {
+    return;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    unsigned long seq;
+    if (sscanf(entry->d_name, "%lu.tb", &seq) != 1) {
+      continue;
+    }
+    if (!s_spill_any) {
+      s_spill_any = true;
+      s_spill_first = s_spill_last = seq;
+    }
+    else {
+      s_spill_first = seq < s_spill_first ? seq : s_spill_first;
+      s_spill_last = seq > s_spill_last ? seq : s_spill_last;
+    }
+  }
+  closedir(dir);
+
+  if (s_spill_any) {
+    ESP_LOGI(TAG, "%lu batches waiting from a previous run", (unsigned long)spill_count());
+  }
+  update_spill_stats(0, 0);
+}
+
+/**
+ * @brief Append a batch to the spill queue, deleting the oldest one when it is full
+ */
+static esp_err_t spill_write(const uint8_t* data, size_t len) {
+  char path[PATH_MAX_LEN];
+  uint32_t dropped = 0;
+
+  if (spill_count() >= SPILL_MAX_FILES) {
+    spill_file_path(s_spill_first++, path, sizeof(path));
+    unlink(path);
+    dropped++;
+  }
+
+  uint32_t seq = s_spill_any ? s_spill_last + 1 : 0;
+  spill_file_path(seq, path, sizeof(path));
+  FILE* file = fopen(path, "wb");
+  size_t written = file ? fwrite(data, 1, len, file) : 0;
+  if (file) {
+    fclose(file);
+  }
+  if (written != len) {
+    ESP_LOGE(TAG, "Failed to spill batch to %s", path);
+    unlink(path);
+    update_spill_stats(0, dropped);
+    return ESP_FAIL;
+  }
+
+  if (!s_spill_any) {
+    s_spill_any = true;
+    s_spill_first = seq;
+  }
+  s_spill_last = seq;
+  update_spill_stats(1, dropped);
+  return ESP_OK;
+}
+
+/**
+ * @brief Send spilled batches oldest first until the queue is empty or a send fails
+ */
+static esp_err_t spill_drain(void) {
+  char path[PATH_MAX_LEN];
+
+  while (s_spill_any) {
+    spill_file_path(s_spill_first, path, sizeof(path));
+    FILE* file = fopen(path, "rb");
+    size_t len = file ? fread(s_spill_buffer, 1, BATCH_SIZE, file) : 0;
+    if (file) {
+      fclose(file);
+    }
+
+    if (len > 0 && post_batch(s_spill_buffer, len) != ESP_OK) {
+      return ESP_FAIL;
+    }
+
+    // Sent, or unreadable and skipped
+    unlink(path);
+    if (s_spill_first == s_spill_last) {
+      s_spill_any = false;
+    }
+    else {
+      s_spill_first++;
+    }
+    update_spill_stats(0, 0);
+  }
+  return ESP_OK;
+}
+
+static void uplink_task(void* arg) {
+  const uint32_t check_ms = s_config.flush_interval_ms / 4 ? s_config.flush_interval_ms / 4 : 1;
+  uint32_t backoff_ms = 0;
+
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(backoff_ms ? backoff_ms : check_ms));
+
+    // Seal the filling batch if it is old enough or a flush was asked for
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const telemetry_batch_t* filling = &s_batches[s_fill];
+    int64_t age_ms = (esp_timer_get_time() - s_fill_started_us) / 1000;
+    if (!s_sealed && filling->records > 0 && (s_flush_requested || age_ms >= s_config.flush_interval_ms)) {
+      seal_locked();
+    }
+    s_flush_requested = false;
+    const telemetry_batch_t* sealed = s_sealed ? &s_batches[s_fill ^ 1] : NULL;
+    xSemaphoreGive(s_lock);
+
+    // The sealed buffer is not touched by producers until s_sealed is cleared
+    esp_err_t ret = ESP_OK;
+    bool done = sealed == NULL;
+    if (sealed && s_config.spill_path && s_spill_any) {
+      // Keep batches in order behind an existing backlog
+      done = spill_write(sealed->buffer, sealed->len) == ESP_OK;
+    }
+    else if (sealed) {
+      ret = post_batch(sealed->buffer, sealed->len);
+      done = ret == ESP_OK || (s_config.spill_path && spill_write(sealed->buffer, sealed->len) == ESP_OK);
+    }
+
+    if (ret == ESP_OK && s_config.spill_path) {
+      ret = spill_drain();
+    }
+
+    if (done && sealed) {
+      xSemaphoreTake(s_lock, portMAX_DELAY);
+      s_sealed = false;
+      xSemaphoreGive(s_lock);
+    }
+
+    if (ret == ESP_OK) {
+      backoff_ms = 0;
+    }
+    else {
+      backoff_ms = backoff_ms ? backoff_ms * 2 : BACKOFF_MIN_MS;
+      backoff_ms = backoff_ms > BACKOFF_MAX_MS ? BACKOFF_MAX_MS : backoff_ms;
+    }
+  }
+}
+
+static void release(void) {
+  free(s_batches[0].buffer);
+  s_batches[0].buffer = NULL;
+  free(s_spill_buffer);
+  s_spill_buffer = NULL;
+  if (s_client) {
+    esp_http_client_cleanup(s_client);
+    s_client = NULL;
+  }
+  if (s_lock) {
+    vSemaphoreDelete(s_lock);
+    s_lock = NULL;
+  }
+}
+
+esp_err_t telemetry_init(const telemetry_config_t* config) {
+  if (!config || !config->url || config->flush_interval_ms == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  s_config = *config;
+  s_lock = xSemaphoreCreateMutex();
+  uint8_t* buffers = malloc(2 * BATCH_SIZE);
+  s_spill_buffer = config->spill_path ? malloc(BATCH_SIZE) : NULL;
+  bool ok = s_lock && buffers && (!config->spill_path || s_spill_buffer);
+  for (int i = 0; i < 2 && ok; i++) {
+    ok = telemetry_batch_init(&s_batches[i], buffers + i * BATCH_SIZE, BATCH_SIZE, config->device_id);
+  }
+  if (!ok) {
+    ESP_LOGE(TAG, "Failed to allocate batch buffers");
+    s_batches[0].buffer = buffers;
+    release();
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_http_client_config_t http_config = {
+      .url = config->url,
+      .method = HTTP_METHOD_POST,
+      .timeout_ms = CONFIG_TELEMETRY_HTTP_TIMEOUT_MS,
+      .keep_alive_enable = true,
+  };
+  if (strncmp(config->url, "https://", 8) == 0) {
+    http_config.crt_bundle_attach = esp_crt_bundle_attach;
+  }
+  s_client = esp_http_client_init(&http_config);
+  if (!s_client) {
+    release();
+    return ESP_FAIL;
+  }
+  esp_http_client_set_header(s_client, "Content-Type", "application/x-telemetry-batch");
+
+  if (config->spill_path) {
+    spill_recover();
+  }
+
+  if (xTaskCreate(uplink_task, "telemetry", CONFIG_TELEMETRY_TASK_STACK_SIZE, NULL, CONFIG_TELEMETRY_TASK_PRIORITY,
+                  &s_task) != pdPASS) {
+    release();
+    return ESP_ERR_NO_MEM;
+  }
+
+  ESP_LOGI(TAG, "Uplink to %s, %d byte batches", config->url, BATCH_SIZE);
+  return ESP_OK;
+}
@@ -0,0 +1,152 @@
+#include "telemetry_batch.h"
+
+#include <math.h>
+#include <string.h>
+
+static size_t put_varint(uint8_t* out, uint64_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static inline uint64_t zigzag(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+
+static bool put_bytes(telemetry_batch_t* batch, size_t* len, const void* data, size_t size) {
+  if (*len + size > batch->capacity) {
+    return false;
+  }
+  memcpy(batch->buffer + *len, data, size);
+  *len += size;
+  return true;
+}
+
+static bool put_uint(telemetry_batch_t* batch, size_t* len, uint64_t value) {
+  uint8_t encoded[10];
+  return put_bytes(batch, len, encoded, put_varint(encoded, value));
+}
+
+bool telemetry_batch_init(telemetry_batch_t* batch, uint8_t* buffer, size_t capacity, const char* device_id) {
+  memset(batch, 0, sizeof(*batch));
+  batch->buffer = buffer;
+  batch->capacity = capacity > UINT16_MAX ? UINT16_MAX : capacity;
+
+  if (!device_id) {
+    device_id = "";
+  }
+  size_t id_len = strlen(device_id);
+  const uint8_t magic[] = {'T', 'B', TELEMETRY_BATCH_VERSION};
+  size_t len = 0;
+  if (!put_bytes(batch, &len, magic, sizeof(magic)) || !put_uint(batch, &len, id_len) ||
+      !put_bytes(batch, &len, device_id, id_len)) {
+    return false;
+  }
+
+  batch->header_len = batch->len = len;
+  return true;
+}
+
+void telemetry_batch_reset(telemetry_batch_t* batch) {
+  batch->len = batch->header_len;
+  batch->records = 0;
+  batch->last_ts = 0;
+  batch->name_count = 0;
+}
+
+/**
+ * @brief Encode the record prefix (name and timestamp) at *len
+ *
+ * @return Name index, or -1 if it does not fit
+ */
+static int put_prefix(telemetry_batch_t* batch, size_t* len, telemetry_kind_t kind, int64_t* ts_ms, const char* name) {
+  size_t name_len = strnlen(name, TELEMETRY_BATCH_NAME_MAX);
+  int index = 0;
+  while (index < batch->name_count && !(batch->name_len[index] == name_len &&
+                                         memcmp(batch->buffer + batch->name_offset[index], name, name_len) == 0)) {
+    index++;
+  }
+  if (index == TELEMETRY_BATCH_MAX_NAMES) {
+    return -1;
+  }
+
+  if (!put_uint(batch, len, ((uint64_t)index << 1) | kind)) {
+    return -1;
+  }
+  if (index == batch->name_count) {
+    if (!put_uint(batch, len, name_len)) {
+      return -1;
+    }
+    // Not committed until the whole record fits; name_count is bumped by commit()
+    batch->name_offset[index] = (uint16_t)*len;
+    batch->name_len[index] = (uint8_t)name_len;
+    if (!put_bytes(batch, len, name, name_len)) {
+      return -1;
+    }
+  }
+
+  if (batch->records > 0 && *ts_ms < batch->last_ts) {
+    *ts_ms = batch->last_ts;
+  }
+  uint64_t delta = batch->records > 0 ? (uint64_t)(*ts_ms - batch->last_ts) : (uint64_t)*ts_ms;
+  if (!put_uint(batch, len, delta)) {
+    return -1;
+  }
+  return index;
+}
+
+static void commit(telemetry_batch_t* batch, size_t len, int index, int64_t ts_ms) {
+  batch->len = len;
+  batch->records++;
+  batch->last_ts = ts_ms;
+  if (index == batch->name_count) {
+    batch->name_count++;
+  }
+}
+
+bool telemetry_batch_add_metric(telemetry_batch_t* batch, int64_t ts_ms, const char* name, float value) {
+  if (ts_ms < 0 || isnan(value)) {
+    return false;
+  }
+
+  size_t len = batch->len;
+  int index = put_prefix(batch, &len, TELEMETRY_KIND_METRIC, &ts_ms, name);
+  if (index < 0) {
+    return false;
+  }
+
+  int64_t scaled = llround((double)value * TELEMETRY_METRIC_SCALE);
+  int64_t prev = index < batch->name_count ? batch->prev_value[index] : 0;
+  if (!put_uint(batch, &len, zigzag(scaled - prev))) {
+    return false;
+  }
+
+  batch->prev_value[index] = scaled;
+  commit(batch, len, index, ts_ms);
+  return true;
+}
+
+bool telemetry_batch_add_event(telemetry_batch_t* batch, int64_t ts_ms, const char* name, const char* detail) {
+  if (ts_ms < 0) {
+    return false;
+  }
+
+  size_t len = batch->len;
+  int index = put_prefix(batch, &len, TELEMETRY_KIND_EVENT, &ts_ms, name);
+  if (index < 0) {
+    return false;
+  }
+
+  size_t detail_len = detail ? strlen(detail) : 0;
+  if (!put_uint(batch, &len, detail_len) || !put_bytes(batch, &len, detail, detail_len)) {
+    return false;
+  }
+
+  if (index == batch->name_count) {
+    batch->prev_value[index] = 0;
+  }
+  commit(batch, len, index, ts_ms);
+  return true;
+}
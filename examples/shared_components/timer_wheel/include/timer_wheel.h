@@ -0,0 +1,133 @@
+#ifndef PRODESP32_TIMER_WHEEL_H
+#define PRODESP32_TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Timer callback, run on the timer wheel task
+ *
+ * Callbacks share one task and run one after another, so they must be short and must not
+ * block; a slow callback makes every other timer late. Hand longer work to a task or the
+ * executor.
+ *
+ * @param arg Argument given to timer_wheel_timer_init()
+ */
+typedef void (*timer_wheel_cb_t)(void* arg);
+
+/**
+ * @brief A timer
+ *
+ * Caller-owned (usually static), so the wheel never allocates. Initialize it once with
+ * timer_wheel_timer_init(); the fields are internal. It must not be freed or re-initialized
+ * while pending.
+ */
+typedef struct timer_wheel_timer {
+  struct timer_wheel_timer* next;
+  struct timer_wheel_timer** pprev;  ///< Link pointing at this timer, NULL when not pending
+  uint32_t expires;                  ///< Absolute expiry, in wheel ticks
+  uint32_t period;                   ///< Wheel ticks between runs, 0 for one-shot
+  timer_wheel_cb_t cb;
+  void* arg;
+  const char* name;
+  uint32_t fired;        ///< Times the callback ran
+  uint32_t overruns;     ///< Periods skipped because the timer was already a full period late
+  uint32_t max_late_us;  ///< Largest lateness seen by this timer
+} timer_wheel_timer_t;
+
+/**
+ * @brief Statistics of the whole wheel
+ */
+typedef struct {
+  uint32_t pending;      ///< Timers currently scheduled
+  uint32_t fired;        ///< Callbacks run since start or the last reset
+  uint32_t overruns;     ///< Periods skipped by periodic timers
+  uint32_t late_p50_us;  ///< Median lateness: time from the due time to the callback starting
+  uint32_t late_p99_us;
+  uint32_t late_max_us;
+  uint32_t max_cb_us;       ///< Longest callback
+  const char* max_cb_name;  ///< Timer that ran it
+} timer_wheel_stats_t;
+
+/**
+ * @brief Start the timer wheel task
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already started, ESP_ERR_NO_MEM if the
+ *         task could not be created
+ */
+esp_err_t timer_wheel_start(void);
+
+/**
+ * @brief Prepare a timer; call once before scheduling it
+ *
+ * @param timer Timer to initialize
+ * @param name Name shown in the statistics (kept by pointer)
+ * @param cb Callback
+ * @param arg Argument passed to cb
+ */
+void timer_wheel_timer_init(timer_wheel_timer_t* timer, const char* name, timer_wheel_cb_t cb, void* arg);
+
+/**
+ * @brief Run the callback once after a delay
+ *
+ * Rescheduling a pending timer moves it; it does not run twice.
+ *
+ * @param timer Initialized timer
+ * @param delay_ms Delay, rounded up to the wheel resolution
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an uninitialized timer, ESP_ERR_INVALID_STATE
+ *         if the wheel is not started
+ */
+esp_err_t timer_wheel_schedule_once(timer_wheel_timer_t* timer, uint32_t delay_ms);
+
+/**
+ * @brief Run the callback every period, the first time one period from now
+ *
+ * Runs are at fixed times (start + n * period) and do not drift with callback lateness. When a
+ * run is more than a period late, the missed runs are skipped and counted as overruns.
+ *
+ * @param timer Initialized timer
+ * @param period_ms Period, rounded up to the wheel resolution; must be non-zero
+ * @return As timer_wheel_schedule_once()
+ */
+esp_err_t timer_wheel_schedule_periodic(timer_wheel_timer_t* timer, uint32_t period_ms);
+
+/**
+ * @brief Stop a timer
+ *
+ * O(1). From another task, the callback may still be running when this returns; from the
+ * timer's own callback, a periodic timer is not re-armed.
+ *
+ * @param timer Timer
+ * @return ESP_OK if it was pending, ESP_ERR_NOT_FOUND if not
+ */
+esp_err_t timer_wheel_cancel(timer_wheel_timer_t* timer);
+
+/**
+ * @brief Whether a timer is scheduled
+ */
+bool timer_wheel_is_pending(const timer_wheel_timer_t* timer);
+
+/**
+ * @brief Copy the wheel statistics
+ *
+ * @param out Receives the statistics
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the wheel is not started
+ */
+esp_err_t timer_wheel_get_stats(timer_wheel_stats_t* out);
+
+/**
+ * @brief Zero the wheel statistics (per-timer counters are kept)
+ */
+void timer_wheel_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_TIMER_WHEEL_H
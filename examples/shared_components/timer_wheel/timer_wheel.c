@@ -0,0 +1,401 @@
+#include "timer_wheel.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "latency_histogram.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "timer_wheel";
+
+// Four levels of 64 slots: level n slots are 64^n ticks wide, so the wheel spans 2^24 ticks
+// (46 hours at 10 ms). Longer delays park in the last level and are re-filed each time it turns.
+#define LEVELS 4
+#define SLOT_BITS 6
+#define SLOTS (1u << SLOT_BITS)
+#define SLOT_MASK (SLOTS - 1)
+#define MAX_DELTA ((1u << (LEVELS * SLOT_BITS)) - 1)
+
+#define RESOLUTION_US ((int64_t)CONFIG_TIMER_WHEEL_RESOLUTION_MS * 1000)
+#define LATE_SUB_BITS 3
+#define LATE_MAX_BITS 24
+
+static timer_wheel_timer_t* s_slots[LEVELS][SLOTS];
+static uint64_t s_occupied[LEVELS];  // Bit per non-empty slot
+static timer_wheel_timer_t* s_expired;
+static uint32_t s_next_tick;  // Next tick to process
+static uint32_t s_wake_tick;  // Tick the task sleeps until
+static uint32_t s_pending;
+
+static StaticSemaphore_t s_lock_storage;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+
+// The timer whose callback is running, and whether it should be re-armed afterwards
+static timer_wheel_timer_t* s_running;
+static bool s_rearm;
+
+static uint32_t s_fired;
+static uint32_t s_overruns;
+static uint32_t s_late_max_us;
+static uint32_t s_max_cb_us;
+static const char* s_max_cb_name;
+static uint32_t s_late_counts[LATENCY_HISTOGRAM_BUCKETS(LATE_SUB_BITS, LATE_MAX_BITS)];
+static latency_histogram_t s_late;
+
+static inline uint32_t tick_of(int64_t time_us) { return (uint32_t)(time_us / RESOLUTION_US); }
+
+static void link_timer(timer_wheel_timer_t** head, timer_wheel_timer_t* timer) {
+  timer->next = *head;
+  if (timer->next) {
+    timer->next->pprev = &timer->next;
+  }
+  timer->pprev = head;
+  *head = timer;
+}
+
+static void unlink_timer(timer_wheel_timer_t* timer) {
+  timer_wheel_timer_t** pprev = timer->pprev;
+  *pprev = timer->next;
+  if (timer->next) {
+    timer->next->pprev = pprev;
+  }
+  timer->next = NULL;
+  timer->pprev = NULL;
+
+  // Clear the occupancy bit if that emptied a wheel slot
+  if (*pprev == NULL && pprev >= &s_slots[0][0] && pprev < &s_slots[0][0] + LEVELS * SLOTS) {
+    uint32_t index = pprev - &s_slots[0][0];
+    s_occupied[index / SLOTS] &= ~(1ull << (index % SLOTS));
+  }
+}
+
+/**
+ * @brief File a timer in the slot for its expiry (lock held)
+ *
+ * A timer already due goes into the slot of the next tick to process.
+ */
+static void file_timer(timer_wheel_timer_t* timer) {
+  int32_t delta = (int32_t)(timer->expires - s_next_tick);
+  uint32_t slot_tick = timer->expires;
+  if (delta < 0) {
+    delta = 0;
+    slot_tick = s_next_tick;
+  }
+  else if ((uint32_t)delta > MAX_DELTA) {
+    delta = MAX_DELTA;
+    slot_tick = s_next_tick + MAX_DELTA;
+  }
+
+  int level = 0;
+  while (level < LEVELS - 1 && (uint32_t)delta >= (1u << ((level + 1) * SLOT_BITS))) {
+    level++;
+  }
+  uint32_t slot = (slot_tick >> (level * SLOT_BITS)) & SLOT_MASK;
+  link_timer(&s_slots[level][slot], timer);
+  s_occupied[level] |= 1ull << slot;
+}
+
+/**
+ * @brief Re-file every timer of one slot of a higher level (lock held)
+ *
+ * @return The slot index, so the caller knows whether the next level turns as well
+ */
+static uint32_t cascade(int level) {
+  uint32_t slot = (s_next_tick >> (level * SLOT_BITS)) & SLOT_MASK;
+  timer_wheel_timer_t* timer = s_slots[level][slot];
+  s_slots[level][slot] = NULL;
+  s_occupied[level] &= ~(1ull << slot);
+  while (timer) {
+    timer_wheel_timer_t* next = timer->next;
+    file_timer(timer);
+    timer = next;
+  }
+  return slot;
+}
+
+/**
+ * @brief Move the timers of the next tick onto the expired list and advance (lock held)
+ */
+static void expire_next_tick(void) {
+  uint32_t slot = s_next_tick & SLOT_MASK;
+  if (slot == 0) {
+    for (int level = 1; level < LEVELS && cascade(level) == 0; level++) {
+    }
+  }
+
+  timer_wheel_timer_t* timer = s_slots[0][slot];
+  s_slots[0][slot] = NULL;
+  s_occupied[0] &= ~(1ull << slot);
+  while (timer) {
+    timer_wheel_timer_t* next = timer->next;
+    link_timer(&s_expired, timer);
+    timer = next;
+  }
+  // Timers scheduled from the callbacks land in later slots, so this tick cannot refill
+  s_next_tick++;
+}
+
+/**
+ * @brief Skip ticks that have nothing to expire or cascade (lock held)
+ *
+ * With the lowest non-empty level n, nothing happens before the next multiple of 64^n, so a
+ * long sleep costs a few steps rather than one per tick.
+ */
+static void skip_idle_ticks(uint32_t now) {
+  int level = 0;
+  while (level < LEVELS && s_occupied[level] == 0) {
+    level++;
+  }
+  if (level == 0) {
+    return;
+  }
+
+  uint32_t step = level < LEVELS ? 1u << (level * SLOT_BITS) : 0;
+  uint32_t boundary = step ? (s_next_tick + step - 1) & ~(step - 1) : now + 1;
+  s_next_tick = (int32_t)(boundary - now) > 0 ? now + 1 : boundary;
+}
+
+/**
+ * @brief Tick at which something next needs doing (lock held)
+ *
+ * The first occupied level-0 slot, or the next cascade if that comes first.
+ */
+static uint32_t next_event_tick(void) {
+  bool higher = false;
+  for (int level = 1; level < LEVELS; level++) {
+    higher |= s_occupied[level] != 0;
+  }
+  // s_next_tick itself when it is a cascade point that has not been processed yet
+  uint32_t boundary = (s_next_tick + SLOT_MASK) & ~SLOT_MASK;
+
+  uint64_t occupied = s_occupied[0];
+  if (occupied == 0) {
+    return boundary;
+  }
+  uint32_t shift = s_next_tick & SLOT_MASK;
+  uint64_t rotated = shift ? (occupied >> shift) | (occupied << (SLOTS - shift)) : occupied;
+  uint32_t tick = s_next_tick + __builtin_ctzll(rotated);
+  return higher && (int32_t)(tick - boundary) > 0 ? boundary : tick;
+}
+
+static void run_timer(timer_wheel_timer_t* timer, int64_t now_us) {
+  uint32_t now = tick_of(now_us);
+  uint32_t late_us = (uint32_t)((int64_t)(uint32_t)(now - timer->expires) * RESOLUTION_US + now_us % RESOLUTION_US);
+
+  s_running = timer;
+  s_rearm = timer->period != 0;
+  xSemaphoreGive(s_lock);
+
+  int64_t start_us = esp_timer_get_time();
+  timer->cb(timer->arg);
+  uint32_t cb_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  s_running = NULL;
+  timer->fired++;
+  if (late_us > timer->max_late_us) {
+    timer->max_late_us = late_us;
+  }
+  s_fired++;
+  latency_histogram_record(&s_late, late_us);
+  if (late_us > s_late_max_us) {
+    s_late_max_us = late_us;
+  }
+  if (cb_us > s_max_cb_us) {
+    s_max_cb_us = cb_us;
+    s_max_cb_name = timer->name;
+  }
+
+  // Not re-armed if the callback cancelled or rescheduled it
+  if (s_rearm && !timer->pprev) {
+    timer->expires += timer->period;
+    now = tick_of(esp_timer_get_time());
+    if ((int32_t)(now - timer->expires) > 0) {
+      uint32_t missed = (now - timer->expires + timer->period - 1) / timer->period;
+      timer->expires += missed * timer->period;
+      timer->overruns += missed;
+      s_overruns += missed;
+    }
+    file_timer(timer);
+    s_pending++;
+  }
+}
+
+static void wheel_task(void* arg) {
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  while (true) {
+    int64_t now_us = esp_timer_get_time();
+    uint32_t now = tick_of(now_us);
+
+    while ((int32_t)(now - s_next_tick) >= 0) {
+      skip_idle_ticks(now);
+      if ((int32_t)(now - s_next_tick) < 0) {
+        break;
+      }
+      expire_next_tick();
+      while (s_expired) {
+        timer_wheel_timer_t* timer = s_expired;
+        unlink_timer(timer);
+        s_pending--;
+        run_timer(timer, esp_timer_get_time());
+      }
+    }
+
+    TickType_t wait = portMAX_DELAY;
+    s_wake_tick = s_next_tick + MAX_DELTA;
+    if (s_pending > 0) {
+      s_wake_tick = next_event_tick();
+      int64_t wait_us = (int64_t)(uint32_t)(s_wake_tick - now) * RESOLUTION_US - now_us % RESOLUTION_US;
+      int64_t tick_us = (int64_t)portTICK_PERIOD_MS * 1000;
+      wait = (TickType_t)((wait_us + tick_us - 1) / tick_us);
+      if (wait == 0) {
+        wait = 1;
+      }
+    }
+    xSemaphoreGive(s_lock);
+    ulTaskNotifyTake(pdTRUE, wait);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+  }
+}
+
+esp_err_t timer_wheel_start(void) {
+  if (s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  s_lock = xSemaphoreCreateMutexStatic(&s_lock_storage);
+  latency_histogram_init(&s_late, LATE_SUB_BITS, LATE_MAX_BITS, s_late_counts, 1);
+  s_next_tick = tick_of(esp_timer_get_time());
+  s_wake_tick = s_next_tick + MAX_DELTA;
+
+  if (xTaskCreate(wheel_task, "timer_wheel", CONFIG_TIMER_WHEEL_TASK_STACK_SIZE, NULL,
+                  CONFIG_TIMER_WHEEL_TASK_PRIORITY, &s_task) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create task");
+    s_task = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  ESP_LOGI(TAG, "Started, %d ms resolution", CONFIG_TIMER_WHEEL_RESOLUTION_MS);
+  return ESP_OK;
+}
+
+void timer_wheel_timer_init(timer_wheel_timer_t* timer, const char* name, timer_wheel_cb_t cb, void* arg) {
+  memset(timer, 0, sizeof(*timer));
+  timer->name = name;
+  timer->cb = cb;
+  timer->arg = arg;
+}
+
+static esp_err_t schedule(timer_wheel_timer_t* timer, uint32_t delay_ms, uint32_t period_ms) {
+  if (!timer || !timer->cb) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Round up, so a timer never runs before its delay has passed
+  int64_t due_us = esp_timer_get_time() + (int64_t)delay_ms * 1000;
+  uint32_t expires = (uint32_t)((due_us + RESOLUTION_US - 1) / RESOLUTION_US);
+  uint32_t period = (uint32_t)(((int64_t)period_ms * 1000 + RESOLUTION_US - 1) / RESOLUTION_US);
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  if (timer->pprev) {
+    unlink_timer(timer);
+    s_pending--;
+  }
+  timer->expires = expires;
+  timer->period = period;
+  file_timer(timer);
+  s_pending++;
+
+  bool wake = (int32_t)(expires - s_wake_tick) < 0;
+  if (wake) {
+    s_wake_tick = expires;
+  }
+  xSemaphoreGive(s_lock);
+
+  if (wake) {
+    xTaskNotifyGive(s_task);
+  }
+  return ESP_OK;
+}
+
+esp_err_t timer_wheel_schedule_once(timer_wheel_timer_t* timer, uint32_t delay_ms) {
+  return schedule(timer, delay_ms, 0);
+}
+
+esp_err_t timer_wheel_schedule_periodic(timer_wheel_timer_t* timer, uint32_t period_ms) {
+  if (period_ms == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return schedule(timer, period_ms, period_ms);
+}
+
+esp_err_t timer_wheel_cancel(timer_wheel_timer_t* timer) {
+  if (!timer || !s_task) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  esp_err_t ret = ESP_ERR_NOT_FOUND;
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  if (timer->pprev) {
+    unlink_timer(timer);
+    s_pending--;
+    ret = ESP_OK;
+  }
+  if (timer == s_running && s_rearm) {
+    s_rearm = false;
+    ret = ESP_OK;
+  }
+  xSemaphoreGive(s_lock);
+  return ret;
+}
+
+bool timer_wheel_is_pending(const timer_wheel_timer_t* timer) {
+  // Single pointer read; a periodic timer whose callback is running reads as not pending
+  return timer && __atomic_load_n(&timer->pprev, __ATOMIC_RELAXED) != NULL;
+}
+
+esp_err_t timer_wheel_get_stats(timer_wheel_stats_t* out) {
+  if (!out) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!s_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  static const float quantiles[2] = {0.5f, 0.99f};
+  uint32_t late[2];
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  latency_histogram_quantiles(&s_late, quantiles, late, 2);
+  out->pending = s_pending;
+  out->fired = s_fired;
+  out->overruns = s_overruns;
+  out->late_p50_us = late[0];
+  out->late_p99_us = late[1];
+  out->late_max_us = s_late_max_us;
+  out->max_cb_us = s_max_cb_us;
+  out->max_cb_name = s_max_cb_name;
+  xSemaphoreGive(s_lock);
+  return ESP_OK;
+}
+
+void timer_wheel_reset_stats(void) {
+  if (!s_task) {
+    return;
+  }
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  latency_histogram_reset(&s_late);
+  s_fired = 0;
+  s_overruns = 0;
+  s_late_max_us = 0;
+  s_max_cb_us = 0;
+  s_max_cb_name = NULL;
+  xSemaphoreGive(s_lock);
+}
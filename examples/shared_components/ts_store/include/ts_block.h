@@ -0,0 +1,123 @@
+#ifndef PRODESP32_TS_BLOCK_H
+#define PRODESP32_TS_BLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TS_BLOCK_MAGIC 0x5354  // "TS"
+#define TS_BLOCK_VERSION 1
+#define TS_BLOCK_HEADER_SIZE 32
+#define TS_BLOCK_MAX_VALUES 3  ///< Value columns per record (raw: 1, rollups: avg/min/max)
+
+/**
+ * @brief On-flash block header (little-endian, no padding)
+ *
+ * Followed by the timestamp column and then each value column, back to back. The block is
+ * zero padded to the block size so block i of a segment always starts at i * block size.
+ */
+typedef struct {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t columns;                            ///< Value columns (1..TS_BLOCK_MAX_VALUES)
+  uint16_t count;                             ///< Records in the block
+  uint16_t reserved;
+  uint16_t col_len[TS_BLOCK_MAX_VALUES + 1];  ///< Encoded bytes of the timestamp column and each value column
+  int64_t first_ts;                           ///< Timestamp of the first record (ms)
+  int64_t last_ts;                            ///< Timestamp of the last record (ms)
+} ts_block_header_t;
+
+/**
+ * @brief Columnar block encoder
+ *
+ * Timestamps are stored as unsigned varint deltas from the previous record (the first
+ * delta is taken from first_ts, so it is 0). Values are quantized int32 stored as zigzag
+ * varint deltas from the previous record in the same column. Regularly sampled, slowly
+ * changing series take 1 byte per timestamp and 1 byte per value.
+ */
+typedef struct {
+  uint8_t columns;
+  uint16_t count;
+  uint16_t capacity;  ///< Payload bytes available for all columns together
+  int64_t first_ts;
+  int64_t last_ts;
+  int32_t prev[TS_BLOCK_MAX_VALUES];
+  uint16_t len[TS_BLOCK_MAX_VALUES + 1];
+  uint8_t* col[TS_BLOCK_MAX_VALUES + 1];  ///< Column buffers, capacity bytes each
+} ts_block_writer_t;
+
+/**
+ * @brief Columnar block decoder
+ */
+typedef struct {
+  ts_block_header_t header;
+  const uint8_t* col[TS_BLOCK_MAX_VALUES + 1];
+  uint16_t pos[TS_BLOCK_MAX_VALUES + 1];
+  uint16_t index;
+  int64_t ts;
+  int32_t values[TS_BLOCK_MAX_VALUES];
+} ts_block_reader_t;
+
+/**
+ * @brief Initialize a writer
+ *
+ * @param writer Writer state
+ * @param columns Value columns per record
+ * @param block_size Size of a block on flash
+ * @param arena Column storage, (columns + 1) * (block_size - TS_BLOCK_HEADER_SIZE) bytes
+ */
+void ts_block_writer_init(ts_block_writer_t* writer, uint8_t columns, size_t block_size, uint8_t* arena);
+
+/**
+ * @brief Append a record
+ *
+ * @return false if the record does not fit (flush the block and retry), true otherwise
+ */
+bool ts_block_writer_append(ts_block_writer_t* writer, int64_t ts, const int32_t* values);
+
+/**
+ * @brief Serialize the block (header, columns, zero padding)
+ *
+ * Does not reset the writer, so it can also be used to snapshot a partially filled block.
+ *
+ * @param writer Writer state
+ * @param block Output, block_size bytes
+ * @param block_size Size of a block on flash
+ */
+void ts_block_writer_serialize(const ts_block_writer_t* writer, uint8_t* block, size_t block_size);
+
+/**
+ * @brief Start a new empty block
+ */
+void ts_block_writer_reset(ts_block_writer_t* writer);
+
+/**
+ * @brief Parse a block header
+ *
+ * @return false if the header is not a valid block header
+ */
+bool ts_block_read_header(const uint8_t* data, size_t block_size, ts_block_header_t* header);
+
+/**
+ * @brief Initialize a reader on a serialized block
+ *
+ * @return false if the block is invalid
+ */
+bool ts_block_reader_init(ts_block_reader_t* reader, const uint8_t* block, size_t block_size);
+
+/**
+ * @brief Decode the next record into reader->ts and reader->values
+ *
+ * @return false when all records have been read or the block is corrupt
+ */
+bool ts_block_reader_next(ts_block_reader_t* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_TS_BLOCK_H
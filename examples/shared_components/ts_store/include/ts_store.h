@@ -0,0 +1,162 @@
+#ifndef PRODESP32_TS_STORE_H
+#define PRODESP32_TS_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TS_STORE_LEVELS 3      ///< Raw data plus two rollup levels
+#define TS_STORE_NAME_MAX 16   ///< Max series name length including terminator
+
+/**
+ * @brief Opaque series handle
+ */
+typedef struct ts_series ts_series_t;
+
+/**
+ * @brief Series configuration
+ */
+typedef struct {
+  const char* name;                              ///< Series name ([a-z0-9_], used as directory name)
+  float scale;                                   ///< Values are stored as round(value * scale), e.g. 100 for 0.01 resolution
+  uint32_t rollup_interval_s[TS_STORE_LEVELS];   ///< Bucket size per level; [0] is ignored (raw)
+  uint16_t retention_segments[TS_STORE_LEVELS];  ///< Segments kept per level before the oldest is deleted
+} ts_series_config_t;
+
+/**
+ * @brief Default configuration: 0.01 resolution, 1 minute and 1 hour rollups
+ */
+#define TS_SERIES_DEFAULT_CONFIG(series_name)                                                         \
+  {                                                                                                   \
+    .name = (series_name), .scale = 100.0f, .rollup_interval_s = {0, 60, 3600},                       \
+    .retention_segments = {4, 4, 4},                                                                  \
+  }
+
+/**
+ * @brief A point returned by a query
+ *
+ * Raw points have min == max == value. Rollup points carry the bucket start time, the
+ * average and the extremes of the bucket.
+ */
+typedef struct {
+  int64_t ts;   ///< Timestamp in milliseconds
+  float value;  ///< Sample value or bucket average
+  float min;    ///< Bucket minimum
+  float max;    ///< Bucket maximum
+} ts_point_t;
+
+/**
+ * @brief Query callback
+ *
+ * @param point Point in time order
+ * @param context User context
+ * @return true to continue, false to stop the query
+ */
+typedef bool (*ts_point_cb_t)(const ts_point_t* point, void* context);
+
+/**
+ * @brief Set the directory series are stored under (e.g. "/storage/ts")
+ *
+ * The file system must already be mounted. Creates the directory if needed.
+ *
+ * @param base_path Directory path
+ * @return ESP_OK on success
+ */
+esp_err_t ts_store_init(const char* base_path);
+
+/**
+ * @brief Open (or create) a series and recover its state from flash
+ *
+ * @param config Series configuration
+ * @param out_series Receives the series handle
+ * @return ESP_OK on success
+ */
+esp_err_t ts_series_open(const ts_series_config_t* config, ts_series_t** out_series);
+
+/**
+ * @brief Find an open series by name
+ *
+ * @param name Series name
+ * @return Series handle or NULL
+ */
+ts_series_t* ts_series_find(const char* name);
+
+/**
+ * @brief Append a sample
+ *
+ * Buffered in RAM and written to flash one block at a time. Also feeds the rollup levels.
+ *
+ * @param series Series handle
+ * @param ts_ms Timestamp in milliseconds, not older than the previous sample
+ * @param value Sample value
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a timestamp older than the previous one
+ */
+esp_err_t ts_series_append(ts_series_t* series, int64_t ts_ms, float value);
+
+/**
+ * @brief Write the partially filled blocks of every level to flash
+ *
+ * Each flush ends a block early, so call it before a planned restart rather than
+ * periodically.
+ *
+ * @param series Series handle
+ * @return ESP_OK on success
+ */
+esp_err_t ts_series_flush(ts_series_t* series);
+
+/**
+ * @brief Stream the points of one level within [from_ms, to_ms]
+ *
+ * Reads one block at a time; memory use is a single block buffer regardless of the range.
+ * Includes samples still buffered in RAM.
+ *
+ * @param series Series handle
+ * @param level 0 for raw data, 1.. for rollups
+ * @param from_ms Range start (inclusive)
+ * @param to_ms Range end (inclusive)
+ * @param callback Called for every point in time order
+ * @param context User context passed to callback
+ * @return ESP_OK on success
+ */
+esp_err_t ts_series_query(ts_series_t* series, int level, int64_t from_ms, int64_t to_ms, ts_point_cb_t callback,
+                          void* context);
+
+/**
+ * @brief Pick the finest level that returns roughly at most max_points for a range
+ *
+ * @param series Series handle
+ * @param from_ms Range start
+ * @param to_ms Range end
+ * @param max_points Desired upper bound on the number of points
+ * @return Level index
+ */
+int ts_series_pick_level(ts_series_t* series, int64_t from_ms, int64_t to_ms, uint32_t max_points);
+
+/**
+ * @brief Get the bucket size of a level
+ *
+ * @return Interval in milliseconds, 0 for the raw level
+ */
+uint32_t ts_series_get_interval_ms(const ts_series_t* series, int level);
+
+/**
+ * @brief Get the name of a series
+ */
+const char* ts_series_get_name(const ts_series_t* series);
+
+/**
+ * @brief Current wall clock time in milliseconds
+ */
+int64_t ts_store_now_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_TS_STORE_H
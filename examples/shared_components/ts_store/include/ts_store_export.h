@@ -0,0 +1,38 @@
+#ifndef PRODESP32_TS_STORE_EXPORT_H
+#define PRODESP32_TS_STORE_EXPORT_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "mcp_tool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register GET /api/history on the shared HTTP server
+ *
+ * Query parameters: `series` (required), `from` and `to` in epoch milliseconds (default:
+ * the last hour), `max_points` (default 200). The level is picked so the response has
+ * roughly at most max_points points. Points are streamed as chunked JSON straight from the
+ * block reader, so the range is not limited by RAM.
+ *
+ * @param port Port for the shared server if it is not running yet
+ * @return ESP_OK on success
+ */
+esp_err_t ts_store_register_http(uint16_t port);
+
+/**
+ * @brief MCP tool "query_history" returning a downsampled window of a series
+ *
+ * The point count is capped by CONFIG_TS_STORE_MCP_MAX_POINTS, since the whole result is
+ * returned in one response.
+ */
+extern const mcp_tool_definition_t TS_QUERY_HISTORY_TOOL;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRODESP32_TS_STORE_EXPORT_H
@@ -0,0 +1,158 @@
+#include "ts_block.h"
+
+#include <string.h>
+
+_Static_assert(sizeof(ts_block_header_t) == TS_BLOCK_HEADER_SIZE, "block header layout changed");
+
+static size_t put_varint(uint8_t* out, uint64_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static bool get_varint(const uint8_t* data, uint16_t len, uint16_t* pos, uint64_t* value) {
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64 && *pos < len; shift += 7) {
+    uint8_t byte = data[(*pos)++];
+    result |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline uint32_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+
+static inline int32_t unzigzag(uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+
+void ts_block_writer_init(ts_block_writer_t* writer, uint8_t columns, size_t block_size, uint8_t* arena) {
+  memset(writer, 0, sizeof(*writer));
+  writer->columns = columns;
+  writer->capacity = (uint16_t)(block_size - TS_BLOCK_HEADER_SIZE);
+  for (int c = 0; c <= columns; c++) {
+    writer->col[c] = arena + (size_t)c * writer->capacity;
+  }
+}
+
+void ts_block_writer_reset(ts_block_writer_t* writer) {
+  writer->count = 0;
+  writer->first_ts = 0;
+  writer->last_ts = 0;
+  memset(writer->prev, 0, sizeof(writer->prev));
+  memset(writer->len, 0, sizeof(writer->len));
+}
+
+bool ts_block_writer_append(ts_block_writer_t* writer, int64_t ts, const int32_t* values) {
+  uint8_t encoded[TS_BLOCK_MAX_VALUES + 1][10];
+  size_t encoded_len[TS_BLOCK_MAX_VALUES + 1];
+
+  if (writer->count == UINT16_MAX || (writer->count > 0 && ts < writer->last_ts)) {
+    return false;
+  }
+
+  uint64_t delta = writer->count ? (uint64_t)(ts - writer->last_ts) : 0;
+  encoded_len[0] = put_varint(encoded[0], delta);
+  size_t total = writer->len[0] + encoded_len[0];
+  for (int c = 0; c < writer->columns; c++) {
+    // Wrapping difference; decodes back exactly since the sum wraps the same way
+    int32_t diff = (int32_t)((uint32_t)values[c] - (uint32_t)writer->prev[c]);
+    encoded_len[c + 1] = put_varint(encoded[c + 1], zigzag(diff));
+    total += writer->len[c + 1] + encoded_len[c + 1];
+  }
+  if (total > writer->capacity) {
+    return false;
+  }
+
+  for (int c = 0; c <= writer->columns; c++) {
+    memcpy(writer->col[c] + writer->len[c], encoded[c], encoded_len[c]);
+    writer->len[c] += encoded_len[c];
+  }
+  for (int c = 0; c < writer->columns; c++) {
+    writer->prev[c] = values[c];
+  }
+  if (writer->count == 0) {
+    writer->first_ts = ts;
+  }
+  writer->last_ts = ts;
+  writer->count++;
+  return true;
+}
+
+void ts_block_writer_serialize(const ts_block_writer_t* writer, uint8_t* block, size_t block_size) {
+  ts_block_header_t header = {
+      .magic = TS_BLOCK_MAGIC,
+      .version = TS_BLOCK_VERSION,
+      .columns = writer->columns,
+      .count = writer->count,
+      .reserved = 0,
+      .col_len = {0},
+      .first_ts = writer->first_ts,
+      .last_ts = writer->last_ts,
+  };
+  memcpy(header.col_len, writer->len, sizeof(header.col_len));
+
+  memset(block, 0, block_size);
+  memcpy(block, &header, sizeof(header));
+  size_t offset = TS_BLOCK_HEADER_SIZE;
+  for (int c = 0; c <= writer->columns; c++) {
+    memcpy(block + offset, writer->col[c], writer->len[c]);
+    offset += writer->len[c];
+  }
+}
+
+bool ts_block_read_header(const uint8_t* data, size_t block_size, ts_block_header_t* header) {
+  memcpy(header, data, sizeof(*header));
+  if (header->magic != TS_BLOCK_MAGIC || header->version != TS_BLOCK_VERSION || header->columns == 0 ||
+      header->columns > TS_BLOCK_MAX_VALUES) {
+    return false;
+  }
+
+  size_t total = TS_BLOCK_HEADER_SIZE;
+  for (int c = 0; c <= header->columns; c++) {
+    total += header->col_len[c];
+  }
+  return total <= block_size;
+}
+
+bool ts_block_reader_init(ts_block_reader_t* reader, const uint8_t* block, size_t block_size) {
+  memset(reader, 0, sizeof(*reader));
+  if (!ts_block_read_header(block, block_size, &reader->header)) {
+    return false;
+  }
+
+  const uint8_t* column = block + TS_BLOCK_HEADER_SIZE;
+  for (int c = 0; c <= reader->header.columns; c++) {
+    reader->col[c] = column;
+    column += reader->header.col_len[c];
+  }
+  reader->ts = reader->header.first_ts;
+  return true;
+}
+
+bool ts_block_reader_next(ts_block_reader_t* reader) {
+  if (reader->index >= reader->header.count) {
+    return false;
+  }
+
+  uint64_t value;
+  if (!get_varint(reader->col[0], reader->header.col_len[0], &reader->pos[0], &value)) {
+    return false;
+  }
+  reader->ts += (int64_t)value;
+
+  for (int c = 0; c < reader->header.columns; c++) {
+    if (!get_varint(reader->col[c + 1], reader->header.col_len[c + 1], &reader->pos[c + 1], &value)) {
+      return false;
+    }
+    reader->values[c] = (int32_t)((uint32_t)reader->values[c] + (uint32_t)unzigzag((uint32_t)value));
+  }
+
+  reader->index++;
+  return true;
+}
@@ -0,0 +1,566 @@
+#include "ts_store.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+#include "ts_block.h"
+
+static const char* TAG = "ts_store";
+
+#define BLOCK_SIZE CONFIG_TS_STORE_BLOCK_SIZE
+#define SEGMENT_BLOCKS CONFIG_TS_STORE_SEGMENT_BLOCKS
+#define MAX_SERIES CONFIG_TS_STORE_MAX_SERIES
+#define PATH_MAX_LEN 96
+
+/**
+ * @brief Rollup accumulator for the bucket currently being filled (internal)
+ */
+typedef struct {
+  bool active;
+  int64_t bucket_start;
+  uint32_t count;
+  double sum;
+  float min;
+  float max;
+} rollup_t;
+
+/**
+ * @brief Per-level state (internal)
+ *
+ * Each level is a sequence of segment files L<level>_<seq>.blk holding up to
+ * SEGMENT_BLOCKS fixed-size blocks. Only the newest segment is appended to; retention
+ * deletes whole segments from the old end.
+ */
+typedef struct {
+  ts_block_writer_t writer;
+  uint8_t* arena;
+  bool has_segments;
+  uint32_t first_seg;
+  uint32_t last_seg;
+  uint32_t blocks_in_last;
+  rollup_t rollup;
+} level_t;
+
+struct ts_series {
+  char name[TS_STORE_NAME_MAX];
+  char dir[PATH_MAX_LEN];
+  float scale;
+  uint32_t interval_ms[TS_STORE_LEVELS];
+  uint16_t retention[TS_STORE_LEVELS];
+  level_t levels[TS_STORE_LEVELS];
+  uint8_t* block;  // Serialization buffer for flushes
+  int64_t last_ts;
+  uint32_t raw_period_ms;  // Running estimate of the sampling period, for level picking
+  SemaphoreHandle_t lock;
+};
+
+static char s_base_path[PATH_MAX_LEN];
+static ts_series_t* s_series[MAX_SERIES];
+static size_t s_series_count = 0;
+
+static inline uint8_t level_columns(int level) { return level == 0 ? 1 : 3; }
+
+static inline int32_t quantize(const ts_series_t* series, float value) {
+  float scaled = value * series->scale;
+  if (scaled >= 2147483520.0f) {
+    return INT32_MAX;
+  }
+  if (scaled <= -2147483520.0f) {
+    return INT32_MIN;
+  }
+  return (int32_t)lrintf(scaled);
+}
+
+static void segment_path(const ts_series_t* series, int level, uint32_t seq, char* path, size_t size) {
+  snprintf(path, size, "%s/L%d_%08lu.blk", series->dir, level, (unsigned long)seq);
+}
+
+int64_t ts_store_now_ms(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+esp_err_t ts_store_init(const char* base_path) {
+  if (!base_path || strlen(base_path) >= sizeof(s_base_path) - TS_STORE_NAME_MAX - 16) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (mkdir(base_path, 0755) != 0 && errno != EEXIST) {
+    ESP_LOGE(TAG, "Failed to create %s: %s", base_path, strerror(errno));
+    return ESP_FAIL;
+  }
+
+  strlcpy(s_base_path, base_path, sizeof(s_base_path));
+  return ESP_OK;
+}
+
+static bool valid_name(const char* name) {
+  size_t len = strlen(name);
+  if (len == 0 || len >= TS_STORE_NAME_MAX) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    char c = name[i];
+    if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Read the header of block index of a segment file
+ */
+static bool read_header(FILE* file, uint32_t index, ts_block_header_t* header) {
+  uint8_t raw[TS_BLOCK_HEADER_SIZE];
+  if (fseek(file, (long)index * BLOCK_SIZE, SEEK_SET) != 0 || fread(raw, 1, sizeof(raw), file) != sizeof(raw)) {
+    return false;
+  }
+  return ts_block_read_header(raw, BLOCK_SIZE, header);
+}
+
+/**
+ * @brief Rebuild segment ranges from the directory listing after a restart
+ */
+static void recover(ts_series_t* series) {
+  DIR* dir = opendir(series->dir);
+  if (!dir) {
+    return;
+  }
+
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    int level;
+    unsigned long seq;
+    if (sscanf(entry->d_name, "L%d_%lu.blk", &level, &seq) != 2 || level < 0 || level >= TS_STORE_LEVELS) {
+      continue;
+    }
+    level_t* lv = &series->levels[level];
+    if (!lv->has_segments) {
+      lv->has_segments = true;
+      lv->first_seg = lv->last_seg = seq;
+    }
+    else {
+      lv->first_seg = seq < lv->first_seg ? seq : lv->first_seg;
+      lv->last_seg = seq > lv->last_seg ? seq : lv->last_seg;
+    }
+  }
+  closedir(dir);
+
+  for (int level = 0; level < TS_STORE_LEVELS; level++) {
+    level_t* lv = &series->levels[level];
+    if (!lv->has_segments) {
+      continue;
+    }
+
+    char path[PATH_MAX_LEN];
+    segment_path(series, level, lv->last_seg, path, sizeof(path));
+    struct stat st;
+    if (stat(path, &st) != 0) {
+      continue;
+    }
+
+    // A block torn by a reset mid-write would misalign every later block; cut it off
+    lv->blocks_in_last = st.st_size / BLOCK_SIZE;
+    if (st.st_size % BLOCK_SIZE != 0) {
+      ESP_LOGW(TAG, "%s: dropping partial block", path);
+      truncate(path, (off_t)lv->blocks_in_last * BLOCK_SIZE);
+    }
+
+    if (level == 0 && lv->blocks_in_last > 0) {
+      FILE* file = fopen(path, "rb");
+      ts_block_header_t header;
+      if (file && read_header(file, lv->blocks_in_last - 1, &header)) {
+        series->last_ts = header.last_ts;
+        if (header.count > 1) {
+          series->raw_period_ms = (uint32_t)((header.last_ts - header.first_ts) / (header.count - 1));
+        }
+      }
+      if (file) {
+        fclose(file);
+      }
+    }
+  }
+
+  ESP_LOGI(TAG, "Series %s: raw segments %lu..%lu, last sample at %lld", series->name,
+           (unsigned long)series->levels[0].first_seg, (unsigned long)series->levels[0].last_seg,
+           (long long)series->last_ts);
+}
+
+esp_err_t ts_series_open(const ts_series_config_t* config, ts_series_t** out_series) {
+  if (!config || !config->name || !out_series || !valid_name(config->name) || config->scale <= 0.0f) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_base_path[0] == '\0') {
+    ESP_LOGE(TAG, "ts_store_init() not called");
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (ts_series_find(config->name)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (s_series_count >= MAX_SERIES) {
+    ESP_LOGE(TAG, "Maximum number of series (%d) reached", MAX_SERIES);
+    return ESP_ERR_NO_MEM;
+  }
+
+  ts_series_t* series = calloc(1, sizeof(ts_series_t));
+  if (!series) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  strlcpy(series->name, config->name, sizeof(series->name));
+  snprintf(series->dir, sizeof(series->dir), "%s/%s", s_base_path, config->name);
+  series->scale = config->scale;
+  series->lock = xSemaphoreCreateMutex();
+  series->block = malloc(BLOCK_SIZE);
+
+  bool ok = series->lock && series->block;
+  for (int level = 0; level < TS_STORE_LEVELS && ok; level++) {
+    series->interval_ms[level] = level == 0 ? 0 : config->rollup_interval_s[level] * 1000;
+    series->retention[level] = config->retention_segments[level] ? config->retention_segments[level] : 1;
+
+    uint8_t columns = level_columns(level);
+    level_t* lv = &series->levels[level];
+    lv->arena = malloc((size_t)(columns + 1) * (BLOCK_SIZE - TS_BLOCK_HEADER_SIZE));
+    ok = lv->arena != NULL;
+    if (ok) {
+      ts_block_writer_init(&lv->writer, columns, BLOCK_SIZE, lv->arena);
+    }
+  }
+  if (!ok) {
+    for (int level = 0; level < TS_STORE_LEVELS; level++) {
+      free(series->levels[level].arena);
+    }
+    free(series->block);
+    if (series->lock) {
+      vSemaphoreDelete(series->lock);
+    }
+    free(series);
+    return ESP_ERR_NO_MEM;
+  }
+
+  if (mkdir(series->dir, 0755) != 0 && errno != EEXIST) {
+    ESP_LOGW(TAG, "Failed to create %s: %s", series->dir, strerror(errno));
+  }
+  recover(series);
+
+  s_series[s_series_count++] = series;
+  *out_series = series;
+  return ESP_OK;
+}
+
+ts_series_t* ts_series_find(const char* name) {
+  if (!name) {
+    return NULL;
+  }
+  for (size_t i = 0; i < s_series_count; i++) {
+    if (strcmp(s_series[i]->name, name) == 0) {
+      return s_series[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Append the serialized block to the newest segment, rotating segments as needed
+ */
+static esp_err_t write_block(ts_series_t* series, int level) {
+  level_t* lv = &series->levels[level];
+  char path[PATH_MAX_LEN];
+
+  if (!lv->has_segments || lv->blocks_in_last >= SEGMENT_BLOCKS) {
+    lv->last_seg = lv->has_segments ? lv->last_seg + 1 : 0;
+    if (!lv->has_segments) {
+      lv->first_seg = 0;
+    }
+    lv->has_segments = true;
+    lv->blocks_in_last = 0;
+
+    while (lv->last_seg - lv->first_seg + 1 > series->retention[level]) {
+      segment_path(series, level, lv->first_seg, path, sizeof(path));
+      unlink(path);
+      lv->first_seg++;
+    }
+  }
+
+  segment_path(series, level, lv->last_seg, path, sizeof(path));
+  FILE* file = fopen(path, "ab");
+  if (!file) {
+    ESP_LOGE(TAG, "Failed to open %s: %s", path, strerror(errno));
+    return ESP_FAIL;
+  }
+  size_t written = fwrite(series->block, 1, BLOCK_SIZE, file);
+  fclose(file);
+  if (written != BLOCK_SIZE) {
+    ESP_LOGE(TAG, "Short write to %s", path);
+    // Keep later blocks aligned even if this one is damaged
+    truncate(path, (off_t)lv->blocks_in_last * BLOCK_SIZE);
+    return ESP_FAIL;
+  }
+
+  lv->blocks_in_last++;
+  return ESP_OK;
+}
+
+static esp_err_t flush_level(ts_series_t* series, int level) {
+  level_t* lv = &series->levels[level];
+  if (lv->writer.count == 0) {
+    return ESP_OK;
+  }
+
+  ts_block_writer_serialize(&lv->writer, series->block, BLOCK_SIZE);
+  ts_block_writer_reset(&lv->writer);
+  return write_block(series, level);
+}
+
+static esp_err_t level_append(ts_series_t* series, int level, int64_t ts, const int32_t* values) {
+  level_t* lv = &series->levels[level];
+  if (ts_block_writer_append(&lv->writer, ts, values)) {
+    return ESP_OK;
+  }
+
+  // Block full: write it out and start the next one with this record
+  esp_err_t ret = flush_level(series, level);
+  ts_block_writer_append(&lv->writer, ts, values);
+  return ret;
+}
+
+static esp_err_t feed_rollup(ts_series_t* series, int level, int64_t ts, double sum, uint32_t count, float min,
+                             float max) {
+  if (level >= TS_STORE_LEVELS || series->interval_ms[level] == 0) {
+    return ESP_OK;
+  }
+
+  rollup_t* rollup = &series->levels[level].rollup;
+  int64_t bucket = ts - ts % series->interval_ms[level];
+  esp_err_t ret = ESP_OK;
+
+  if (rollup->active && bucket != rollup->bucket_start) {
+    // Bucket complete: store it and pass it on to the next coarser level
+    float avg = (float)(rollup->sum / rollup->count);
+    int32_t values[3] = {quantize(series, avg), quantize(series, rollup->min), quantize(series, rollup->max)};
+    ret = level_append(series, level, rollup->bucket_start, values);
+    esp_err_t next = feed_rollup(series, level + 1, rollup->bucket_start, rollup->sum, rollup->count, rollup->min,
+                                 rollup->max);
+    ret = ret != ESP_OK ? ret : next;
+    rollup->active = false;
+  }
+
+  if (!rollup->active) {
+    rollup->active = true;
+    rollup->bucket_start = bucket;
+    rollup->count = 0;
+    rollup->sum = 0.0;
+    rollup->min = min;
+    rollup->max = max;
+  }
+
+  rollup->count += count;
+  rollup->sum += sum;
+  rollup->min = min < rollup->min ? min : rollup->min;
+  rollup->max = max > rollup->max ? max : rollup->max;
+  return ret;
+}
+
+esp_err_t ts_series_append(ts_series_t* series, int64_t ts_ms, float value) {
+  if (!series || ts_ms < 0 || isnan(value)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  xSemaphoreTake(series->lock, portMAX_DELAY);
+  if (ts_ms < series->last_ts) {
+    xSemaphoreGive(series->lock);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (series->last_ts > 0) {
+    uint32_t period = (uint32_t)(ts_ms - series->last_ts);
+    series->raw_period_ms = series->raw_period_ms ? (series->raw_period_ms * 7 + period) / 8 : period;
+  }
+  series->last_ts = ts_ms;
+
+  int32_t q = quantize(series, value);
+  esp_err_t ret = level_append(series, 0, ts_ms, &q);
+  esp_err_t rollup_ret = feed_rollup(series, 1, ts_ms, value, 1, value, value);
+
+  xSemaphoreGive(series->lock);
+  return ret != ESP_OK ? ret : rollup_ret;
+}
+
+esp_err_t ts_series_flush(ts_series_t* series) {
+  if (!series) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  esp_err_t ret = ESP_OK;
+  xSemaphoreTake(series->lock, portMAX_DELAY);
+  for (int level = 0; level < TS_STORE_LEVELS; level++) {
+    esp_err_t level_ret = flush_level(series, level);
+    ret = ret != ESP_OK ? ret : level_ret;
+  }
+  xSemaphoreGive(series->lock);
+  return ret;
+}
+
+/**
+ * @brief Decode a block and emit the points within range
+ *
+ * @return false to stop the query (callback asked to, or the range end was passed)
+ */
+static bool emit_block(const ts_series_t* series, const uint8_t* block, int64_t from_ms, int64_t to_ms,
+                       ts_point_cb_t callback, void* context) {
+  ts_block_reader_t reader;
+  if (!ts_block_reader_init(&reader, block, BLOCK_SIZE)) {
+    return true;  // Skip a corrupt block
+  }
+
+  float inv_scale = 1.0f / series->scale;
+  while (ts_block_reader_next(&reader)) {
+    if (reader.ts < from_ms) {
+      continue;
+    }
+    if (reader.ts > to_ms) {
+      return false;
+    }
+
+    ts_point_t point = {.ts = reader.ts, .value = reader.values[0] * inv_scale};
+    if (reader.header.columns >= 3) {
+      point.min = reader.values[1] * inv_scale;
+      point.max = reader.values[2] * inv_scale;
+    }
+    else {
+      point.min = point.max = point.value;
+    }
+    if (!callback(&point, context)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Stream the blocks of one segment file
+ *
+ * @return false to stop the query
+ */
+static bool query_segment(ts_series_t* series, int level, uint32_t seq, uint8_t* block, int64_t from_ms,
+                          int64_t to_ms, ts_point_cb_t callback, void* context) {
+  char path[PATH_MAX_LEN];
+  segment_path(series, level, seq, path, sizeof(path));
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    return true;  // Deleted by retention since the query started
+  }
+
+  struct stat st;
+  uint32_t blocks = (fstat(fileno(file), &st) == 0) ? st.st_size / BLOCK_SIZE : 0;
+  bool keep_going = true;
+  ts_block_header_t header;
+
+  // Blocks are time ordered: skip the whole segment if it ends before the range, otherwise
+  // binary search the first block that reaches into it, reading only headers
+  if (blocks == 0 || !read_header(file, blocks - 1, &header) || header.last_ts < from_ms) {
+    fclose(file);
+    return true;
+  }
+  uint32_t lo = 0;
+  uint32_t hi = blocks - 1;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (read_header(file, mid, &header) && header.last_ts < from_ms) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+
+  for (uint32_t i = lo; i < blocks && keep_going; i++) {
+    if (fseek(file, (long)i * BLOCK_SIZE, SEEK_SET) != 0 || fread(block, 1, BLOCK_SIZE, file) != BLOCK_SIZE) {
+      break;
+    }
+    keep_going = emit_block(series, block, from_ms, to_ms, callback, context);
+  }
+
+  fclose(file);
+  return keep_going;
+}
+
+esp_err_t ts_series_query(ts_series_t* series, int level, int64_t from_ms, int64_t to_ms, ts_point_cb_t callback,
+                          void* context) {
+  if (!series || !callback || level < 0 || level >= TS_STORE_LEVELS || from_ms > to_ms) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint8_t* block = malloc(BLOCK_SIZE);
+  if (!block) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  // Snapshot the segment range; appends only ever add segments after it
+  xSemaphoreTake(series->lock, portMAX_DELAY);
+  level_t* lv = &series->levels[level];
+  bool has_segments = lv->has_segments;
+  uint32_t first_seg = lv->first_seg;
+  uint32_t last_seg = lv->last_seg;
+  xSemaphoreGive(series->lock);
+
+  bool keep_going = true;
+  for (uint32_t seq = first_seg; has_segments && seq <= last_seg && keep_going; seq++) {
+    keep_going = query_segment(series, level, seq, block, from_ms, to_ms, callback, context);
+  }
+
+  if (keep_going) {
+    // Samples still buffered in RAM; copy them out so the callback runs without the lock
+    xSemaphoreTake(series->lock, portMAX_DELAY);
+    bool pending = lv->writer.count > 0;
+    if (pending) {
+      ts_block_writer_serialize(&lv->writer, block, BLOCK_SIZE);
+    }
+    xSemaphoreGive(series->lock);
+    if (pending) {
+      emit_block(series, block, from_ms, to_ms, callback, context);
+    }
+  }
+
+  free(block);
+  return ESP_OK;
+}
+
+int ts_series_pick_level(ts_series_t* series, int64_t from_ms, int64_t to_ms, uint32_t max_points) {
+  int64_t span = to_ms - from_ms;
+  for (int level = 0; level < TS_STORE_LEVELS; level++) {
+    uint32_t interval = level == 0 ? series->raw_period_ms : series->interval_ms[level];
+    if (level > 0 && interval == 0) {
+      break;
+    }
+    if (interval > 0 && span / interval <= (int64_t)max_points) {
+      return level;
+    }
+  }
+
+  // Nothing is coarse enough; use the coarsest configured level
+  int coarsest = 0;
+  for (int level = 1; level < TS_STORE_LEVELS && series->interval_ms[level] > 0; level++) {
+    coarsest = level;
+  }
+  return coarsest;
+}
+
+uint32_t ts_series_get_interval_ms(const ts_series_t* series, int level) {
+  return (level > 0 && level < TS_STORE_LEVELS) ? series->interval_ms[level] : 0;
+}
+
+const char* ts_series_get_name(const ts_series_t* series) { return series->name; }
@@ -0,0 +1,195 @@
+#include "ts_store_export.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "mcp_schema.h"
+#include "sdkconfig.h"
+#include "shared_httpd.h"
+#include "ts_store.h"
+
+static const char* TAG = "ts_export";
+
+#define DEFAULT_WINDOW_MS (3600 * 1000LL)
+#define DEFAULT_MAX_POINTS 200
+#define POINT_JSON_MAX 80  // ",[<ts>,<value>,<min>,<max>]" with %.7g floats, worst case
+#define HTTP_CHUNK_SIZE 1024
+
+static int format_point(char* out, size_t size, const ts_point_t* point, bool first) {
+  return snprintf(out, size, "%s[%" PRId64 ",%.7g,%.7g,%.7g]", first ? "" : ",", point->ts, point->value, point->min,
+                  point->max);
+}
+
+/**
+ * @brief Query state shared by the HTTP and MCP callbacks
+ */
+typedef struct {
+  char* buffer;
+  size_t capacity;
+  size_t len;
+  uint32_t count;
+  uint32_t limit;
+  bool truncated;
+  httpd_req_t* req;  // Flush target when streaming, NULL when building one result
+  esp_err_t error;
+} query_ctx_t;
+
+static bool flush_chunk(query_ctx_t* ctx) {
+  if (ctx->len > 0 && ctx->error == ESP_OK) {
+    ctx->error = httpd_resp_send_chunk(ctx->req, ctx->buffer, ctx->len);
+  }
+  ctx->len = 0;
+  return ctx->error == ESP_OK;
+}
+
+static bool collect_point(const ts_point_t* point, void* context) {
+  query_ctx_t* ctx = context;
+  if (ctx->count >= ctx->limit) {
+    ctx->truncated = true;
+    return false;
+  }
+
+  if (ctx->req && ctx->capacity - ctx->len < POINT_JSON_MAX && !flush_chunk(ctx)) {
+    return false;
+  }
+  ctx->len += format_point(ctx->buffer + ctx->len, ctx->capacity - ctx->len, point, ctx->count == 0);
+  ctx->count++;
+  return true;
+}
+
+static esp_err_t history_handler(httpd_req_t* req) {
+  char query[128];
+  char value[24];
+  char name[TS_STORE_NAME_MAX];
+  if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+      httpd_query_key_value(query, "series", name, sizeof(name)) != ESP_OK) {
+    return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing series");
+  }
+
+  ts_series_t* series = ts_series_find(name);
+  if (!series) {
+    return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Unknown series");
+  }
+
+  int64_t to = ts_store_now_ms();
+  int64_t from = to - DEFAULT_WINDOW_MS;
+  uint32_t max_points = DEFAULT_MAX_POINTS;
+  if (httpd_query_key_value(query, "to", value, sizeof(value)) == ESP_OK) {
+    to = strtoll(value, NULL, 10);
+  }
+  if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK) {
+    from = strtoll(value, NULL, 10);
+  }
+  if (httpd_query_key_value(query, "max_points", value, sizeof(value)) == ESP_OK) {
+    max_points = strtoul(value, NULL, 10);
+  }
+  if (from > to || max_points == 0) {
+    return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid range");
+  }
+
+  query_ctx_t ctx = {
+      .buffer = malloc(HTTP_CHUNK_SIZE),
+      .capacity = HTTP_CHUNK_SIZE,
+      // The level only approximates max_points; allow some slack before cutting off
+      .limit = max_points * 2,
+      .req = req,
+  };
+  if (!ctx.buffer) {
+    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+  }
+
+  int level = ts_series_pick_level(series, from, to, max_points);
+  httpd_resp_set_type(req, "application/json");
+  ctx.len = snprintf(ctx.buffer, ctx.capacity, "{\"series\":\"%s\",\"level\":%d,\"interval_ms\":%lu,\"points\":[",
+                     name, level, (unsigned long)ts_series_get_interval_ms(series, level));
+
+  ts_series_query(series, level, from, to, collect_point, &ctx);
+  if (ctx.error == ESP_OK && ctx.capacity - ctx.len < 32) {
+    flush_chunk(&ctx);
+  }
+  if (ctx.error == ESP_OK) {
+    ctx.len += snprintf(ctx.buffer + ctx.len, ctx.capacity - ctx.len, "],\"truncated\":%s}",
+                        ctx.truncated ? "true" : "false");
+    flush_chunk(&ctx);
+  }
+  free(ctx.buffer);
+
+  if (ctx.error != ESP_OK) {
+    ESP_LOGW(TAG, "Client went away after %lu points", (unsigned long)ctx.count);
+    return ESP_FAIL;
+  }
+  return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+esp_err_t ts_store_register_http(uint16_t port) {
+  esp_err_t ret = shared_httpd_start(port);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  httpd_uri_t history_uri = {
+      .uri = "/api/history",
+      .method = HTTP_GET,
+      .handler = history_handler,
+      .user_ctx = NULL,
+  };
+  return shared_httpd_register_uri(&history_uri);
+}
+
+static mcp_tool_result_t query_history_handler(const mcp_tool_args_t* args) {
+  const char* name = mcp_tool_args_get_string(args, "series", NULL);
+  int seconds = mcp_tool_args_get_int(args, "seconds", 3600);
+  int max_points = mcp_tool_args_get_int(args, "max_points", DEFAULT_MAX_POINTS);
+
+  ts_series_t* series = ts_series_find(name);
+  if (!series) {
+    return mcp_tool_result_error("Unknown series");
+  }
+  if (seconds < 1 || max_points < 1 || max_points > CONFIG_TS_STORE_MCP_MAX_POINTS) {
+    return mcp_tool_result_error("Invalid range");
+  }
+
+  // Header, points and closing
+  query_ctx_t ctx = {
+      .capacity = 128 + TS_STORE_NAME_MAX + (size_t)max_points * POINT_JSON_MAX + 32,
+      .limit = max_points,
+  };
+  ctx.buffer = malloc(ctx.capacity);
+  if (!ctx.buffer) {
+    return mcp_tool_result_error("Out of memory");
+  }
+
+  int64_t to = ts_store_now_ms();
+  int64_t from = to - (int64_t)seconds * 1000;
+  int level = ts_series_pick_level(series, from, to, max_points);
+  ctx.len = snprintf(ctx.buffer, ctx.capacity, "{\"series\": \"%s\", \"level\": %d, \"interval_ms\": %lu, \"points\": [",
+                     ts_series_get_name(series), level, (unsigned long)ts_series_get_interval_ms(series, level));
+
+  esp_err_t ret = ts_series_query(series, level, from, to, collect_point, &ctx);
+  if (ret != ESP_OK) {
+    free(ctx.buffer);
+    return mcp_tool_result_error("Query failed");
+  }
+
+  snprintf(ctx.buffer + ctx.len, ctx.capacity - ctx.len, "], \"truncated\": %s}", ctx.truncated ? "true" : "false");
+  return mcp_tool_result_success_take(ctx.buffer);
+}
+
+static const mcp_param_schema_t QUERY_HISTORY_PARAMS[] = {
+    MCP_PARAM_STRING_REQUIRED("series", "Series name, e.g. 'temperature'"),
+    MCP_PARAM_INTEGER("seconds", "How far back to look (default 3600)", 1, 365 * 24 * 3600),
+    MCP_PARAM_INTEGER("max_points", "Upper bound on returned points (default 200)", 1, CONFIG_TS_STORE_MCP_MAX_POINTS),
+};
+
+const mcp_tool_definition_t TS_QUERY_HISTORY_TOOL = {
+    .name = "query_history",
+    .description = "Returns the recent history of a recorded series, downsampled to at most max_points. Each point "
+                   "is [timestamp_ms, value, min, max]; for raw samples min and max equal value, for rollups value "
+                   "is the bucket average.",
+    .handler = query_history_handler,
+    .parameters = QUERY_HISTORY_PARAMS,
+    .parameter_count = sizeof(QUERY_HISTORY_PARAMS) / sizeof(QUERY_HISTORY_PARAMS[0]),
+};
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+Stand-in telemetry collector for the telemetry_uplink example.
+
+Accepts batches POSTed by the telemetry component, decodes them and prints a summary
+line per batch: record count, encoded size, and the size the same records would take as
+JSON. The device under QEMU reaches the host as 10.0.2.2, so the default firmware
+configuration posts to http://10.0.2.2:8080/ingest.
+
+    python collector.py --port 8080
+    python collector.py --port 8080 --offline 60      # reject uploads for the first 60 s
+    python collector.py --port 8080 --jsonl out.jsonl # also append decoded records
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import json
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+METRIC_SCALE = 1000
+
+
+class BatchError(ValueError):
+    pass
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def done(self):
+        return self.pos >= len(self.data)
+
+    def bytes(self, count):
+        if self.pos + count > len(self.data):
+            raise BatchError("truncated batch")
+        chunk = self.data[self.pos : self.pos + count]
+        self.pos += count
+        return chunk
+
+    def varint(self):
+        result = 0
+        shift = 0
+        while True:
+            byte = self.bytes(1)[0]
+            result |= (byte & 0x7F) << shift
+            if not byte & 0x80:
+                return result
+            shift += 7
+
+    def svarint(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+
+def decode_batch(data):
+    """Decode one batch into (device_id, [record, ...])."""
+    reader = Reader(data)
+    if reader.bytes(3) != b"TB\x01":
+        raise BatchError("bad magic or version")
+    device_id = reader.bytes(reader.varint()).decode("utf-8", "replace")
+
+    names = []
+    previous = {}
+    records = []
+    ts = 0
+    while not reader.done():
+        header = reader.varint()
+        kind, index = header & 1, header >> 1
+        if index == len(names):
+            names.append(reader.bytes(reader.varint()).decode("utf-8", "replace"))
+        elif index > len(names):
+            raise BatchError("name index out of range")
+        name = names[index]
+
+        delta = reader.varint()
+        ts = delta if not records else ts + delta
+
+        if kind == 0:
+            value = previous.get(index, 0) + reader.svarint()
+            previous[index] = value
+            records.append({"ts": ts, "metric": name, "value": value / METRIC_SCALE})
+        else:
+            detail = reader.bytes(reader.varint()).decode("utf-8", "replace")
+            records.append({"ts": ts, "event": name, "detail": detail})
+    return device_id, records
+
+
+class Collector:
+    def __init__(self, offline_s, jsonl_path):
+        self.started = time.monotonic()
+        self.offline_s = offline_s
+        self.jsonl = open(jsonl_path, "a") if jsonl_path else None
+        self.lock = threading.Lock()
+        self.batches = 0
+        self.records = 0
+        self.bytes = 0
+        self.json_bytes = 0
+
+    def offline(self):
+        return time.monotonic() - self.started < self.offline_s
+
+    def ingest(self, data):
+        device_id, records = decode_batch(data)
+        json_size = sum(len(json.dumps(record)) for record in records)
+        with self.lock:
+            self.batches += 1
+            self.records += len(records)
+            self.bytes += len(data)
+            self.json_bytes += json_size
+            if self.jsonl:
+                for record in records:
+                    self.jsonl.write(json.dumps({"device": device_id, **record}) + "\n")
+                self.jsonl.flush()
+
+        first = records[0]["ts"] if records else 0
+        last = records[-1]["ts"] if records else 0
+        print(
+            f"{device_id}: {len(records)} records ({(last - first) / 1000:.1f} s) in {len(data)} bytes, "
+            f"{len(data) / max(len(records), 1):.1f} B/record, JSON would be {json_size} bytes "
+            f"({json_size / max(len(data), 1):.1f}x) | total {self.batches} batches, {self.records} records"
+        )
+
+
+def make_handler(collector):
+    class Handler(BaseHTTPRequestHandler):
+        # Keep-alive, so the device can reuse its connection for every batch
+        protocol_version = "HTTP/1.1"
+
+        def reply(self, status, body):
+            payload = body.encode()
+            self.send_response(status)
+            self.send_header("Content-Type", "text/plain")
+            self.send_header("Content-Length", str(len(payload)))
+            self.end_headers()
+            self.wfile.write(payload)
+
+        def do_POST(self):
+            length = int(self.headers.get("Content-Length", 0))
+            data = self.rfile.read(length)
+            if collector.offline():
+                self.reply(503, "offline")
+                return
+            try:
+                collector.ingest(data)
+            except BatchError as error:
+                print(f"Rejected batch from {self.client_address[0]}: {error}", file=sys.stderr)
+                self.reply(400, str(error))
+                return
+            self.reply(200, "ok")
+
+        def log_message(self, format, *args):
+            pass
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--offline", type=float, default=0, help="answer 503 for the first N seconds")
+    parser.add_argument("--jsonl", help="append decoded records to this file")
+    args = parser.parse_args()
+
+    collector = Collector(args.offline, args.jsonl)
+    server = ThreadingHTTPServer(("0.0.0.0", args.port), make_handler(collector))
+    print(f"Collecting on port {args.port}" + (f", offline for {args.offline:.0f} s" if args.offline else ""))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,72 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "esp_event.h"
+#include "esp_littlefs.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "qemu_internet.h"
+#include "telemetry.h"
+#include "timer_wheel.h"
+
+static const char* TAG = "telemetry_uplink";
+
+static timer_wheel_timer_t s_sample_timer;
+static timer_wheel_timer_t s_stats_timer;
+
+static bool mount_storage() {
+  esp_vfs_littlefs_conf_t storage_conf = {
+      .base_path = "/storage",
+      .partition_label = "storage",
+      .format_if_mount_failed = true,
+      .dont_mount = false,
+  };
+
+  esp_err_t ret = esp_vfs_littlefs_register(&storage_conf);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to mount storage (%s), batches will only be kept in RAM", esp_err_to_name(ret));
+    return false;
+  }
+  return true;
+}
+
+static void sample(void* arg) {
+  int64_t now_us = esp_timer_get_time();
+  telemetry_metric("temperature", 21.5f + 2.0f * sinf(now_us / 60e6f));
+  telemetry_metric("heap_free", (float)esp_get_free_heap_size());
+}
+
+static void log_stats(void* arg) {
+  telemetry_stats_t stats;
+  telemetry_get_stats(&stats);
+  ESP_LOGI(TAG, "records %lu (dropped %lu), sent %lu batches / %lu bytes, failures %lu, spill pending %lu",
+           (unsigned long)stats.records, (unsigned long)stats.dropped, (unsigned long)stats.batches_sent,
+           (unsigned long)stats.bytes_sent, (unsigned long)stats.send_failures, (unsigned long)stats.spill_pending);
+}
+
+extern "C" void app_main(void) {
+  ESP_ERROR_CHECK(esp_netif_init());
+  ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+  // Spill directory for batches recorded while the collector is unreachable
+  bool have_storage = mount_storage();
+
+  telemetry_config_t config = TELEMETRY_DEFAULT_CONFIG(CONFIG_EXAMPLE_TELEMETRY_URL);
+  config.device_id = "qemu-esp32";
+  config.spill_path = have_storage ? "/storage/telemetry" : NULL;
+  ESP_ERROR_CHECK(telemetry_init(&config));
+  telemetry_event("boot", esp_reset_reason() == ESP_RST_POWERON ? "power-on" : "reset");
+
+  // Recording starts before the network is up; early batches wait in RAM or the spill queue
+  ESP_ERROR_CHECK(qemu_internet_connect());
+  telemetry_event("network_up", NULL);
+
+  // Both run on the timer wheel task; app_main returns and its stack is freed
+  ESP_ERROR_CHECK(timer_wheel_start());
+  timer_wheel_timer_init(&s_sample_timer, "sample", sample, NULL);
+  timer_wheel_timer_init(&s_stats_timer, "stats", log_stats, NULL);
+  ESP_ERROR_CHECK(timer_wheel_schedule_periodic(&s_sample_timer, CONFIG_EXAMPLE_TELEMETRY_SAMPLE_PERIOD_MS));
+  ESP_ERROR_CHECK(timer_wheel_schedule_periodic(&s_stats_timer, 10 * 1000));
+}